@@ -0,0 +1,46 @@
+#ifndef CORE_BENCHMARKS_HPP_
+#define CORE_BENCHMARKS_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+namespace CoreBenchmarks
+{
+    /// Parameters shared by all the benchmarks.
+    struct BenchmarkParameters
+    {
+        BenchmarkParameters() : size( 100000 ), iterations( 100 ) {}
+
+        /// Number of elements processed by each iteration.
+        uint size;
+
+        /// Number of measured iterations.
+        uint iterations;
+    };
+
+    /// Returns the median of the durations.
+    inline long getMedian( std::vector<long> durations )
+    {
+        if ( durations.empty() )
+        {
+            return 0;
+        }
+        std::nth_element( durations.begin(), durations.begin() + durations.size() / 2, durations.end() );
+        return durations[durations.size() / 2];
+    }
+
+    /// Compares the batch frustum culling kernels with the per object test of the boxes.
+    void runCullingBenchmark( const BenchmarkParameters& parameters, std::ostream& out );
+
+    /// Compares the batch ray casts against a mesh with single ray casts, for coherent
+    /// and incoherent rays.
+    void runRayBenchmark( const BenchmarkParameters& parameters, std::ostream& out );
+
+    /// Compares the parametrization of a mesh on a cage using a kd-tree with the linear search.
+    void runMappingBenchmark( const BenchmarkParameters& parameters, std::ostream& out );
+}
+
+#endif // CORE_BENCHMARKS_HPP_
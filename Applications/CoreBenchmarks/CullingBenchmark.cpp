@@ -0,0 +1,157 @@
+#include <CoreBenchmarks.hpp>
+
+#include <Core/Math/FrustumCulling.hpp>
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Time/Timer.hpp>
+
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <string>
+
+namespace CoreBenchmarks
+{
+    namespace
+    {
+        using Ra::Core::Aabb;
+        using Ra::Core::Frustum;
+        using Ra::Core::Vector3;
+        using Ra::Core::Vector4;
+
+        // Per object test of the culling filter : a box is outside if its 8 corners
+        // are behind one of the planes.
+        bool isVisibleCorners( const Frustum& frustum, const Aabb& aabb )
+        {
+            for ( uint p = 0; p < 6; ++p )
+            {
+                uint out = 0;
+                for ( uint c = 0; c < 8; ++c )
+                {
+                    const Vector3 corner = aabb.corner( Aabb::CornerType( c ) );
+                    out += frustum.m_planes[p].dot( Vector4( corner.x(), corner.y(), corner.z(), 1 ) ) < 0 ? 1 : 0;
+                }
+                if ( out == 8 )
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Per object test of the corner of the box which is the furthest along each normal.
+        bool isVisiblePositiveVertex( const Frustum& frustum, const Aabb& aabb )
+        {
+            for ( uint p = 0; p < 6; ++p )
+            {
+                const Vector4& plane = frustum.m_planes[p];
+                const Vector3 v( plane.x() >= 0 ? aabb.max().x() : aabb.min().x(),
+                                 plane.y() >= 0 ? aabb.max().y() : aabb.min().y(),
+                                 plane.z() >= 0 ? aabb.max().z() : aabb.min().z() );
+                if ( plane.head<3>().dot( v ) + plane.w() < 0 )
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void printResult( std::ostream& out, const std::string& name, long median, long reference,
+                          uint size, uint visible )
+        {
+            out << std::left << std::setw( 24 ) << name << std::right
+                << std::setw( 10 ) << median << " us"
+                << std::setw( 10 ) << std::fixed << std::setprecision( 2 )
+                << double( median ) * 1000.0 / double( size ) << " ns/box"
+                << std::setw( 8 ) << std::setprecision( 1 )
+                << ( median > 0 ? double( reference ) / double( median ) : 0.0 ) << "x"
+                << std::setw( 10 ) << visible << " visible\n";
+        }
+
+        // Runs f the given number of times and returns the median duration.
+        long measure( uint iterations, const std::function<void()>& f )
+        {
+            std::vector<long> durations;
+            durations.reserve( iterations );
+            for ( uint i = 0; i < iterations; ++i )
+            {
+                const Ra::Core::Timer::TimePoint start = Ra::Core::Timer::Clock::now();
+                f();
+                durations.push_back( Ra::Core::Timer::getIntervalMicro( start, Ra::Core::Timer::Clock::now() ) );
+            }
+            return getMedian( durations );
+        }
+    }
+
+    void runCullingBenchmark( const BenchmarkParameters& parameters, std::ostream& out )
+    {
+        // Boxes of various sizes in a cube, seen by a camera outside of it so that
+        // a part of the boxes is culled by each plane.
+        std::mt19937 generator( 1 );
+        std::uniform_real_distribution<Scalar> position( -100.f, 100.f );
+        std::uniform_real_distribution<Scalar> extent( 0.1f, 2.f );
+
+        std::vector<Aabb> aabbs;
+        aabbs.reserve( parameters.size );
+        Ra::Core::AabbArray boxes;
+        for ( uint i = 0; i < parameters.size; ++i )
+        {
+            const Vector3 c( position( generator ), position( generator ), position( generator ) );
+            const Vector3 e( extent( generator ), extent( generator ), extent( generator ) );
+            aabbs.emplace_back( c - e, c + e );
+            boxes.push_back( aabbs.back() );
+        }
+
+        const Ra::Core::Matrix4 proj = Ra::Core::MatrixUtils::perspective( 0.8f, 1.5f, 1.f, 250.f );
+        Ra::Core::Matrix4 view = Ra::Core::Matrix4::Identity();
+        view.block<3, 1>( 0, 3 ) = Vector3( 0.f, 0.f, -150.f );
+        const Frustum frustum( proj * view );
+
+        out << "Frustum culling of " << parameters.size << " boxes, median of "
+            << parameters.iterations << " iterations\n";
+
+        uint visible = 0;
+        const long corners = measure( parameters.iterations, [&]()
+        {
+            visible = 0;
+            for ( const auto& aabb : aabbs )
+            {
+                visible += isVisibleCorners( frustum, aabb ) ? 1 : 0;
+            }
+        } );
+        printResult( out, "per object, corners", corners, corners, parameters.size, visible );
+
+        const long positiveVertex = measure( parameters.iterations, [&]()
+        {
+            visible = 0;
+            for ( const auto& aabb : aabbs )
+            {
+                visible += isVisiblePositiveVertex( frustum, aabb ) ? 1 : 0;
+            }
+        } );
+        printResult( out, "per object, p-vertex", positiveVertex, corners, parameters.size, visible );
+
+        using namespace Ra::Core::FrustumCulling;
+        using namespace Ra::Core::Simd;
+        std::vector<uint> visibility;
+        for ( Kernel kernel : { SCALAR, SSE, AVX } )
+        {
+            if ( !isSupported( kernel ) )
+            {
+                out << "batch, " << getKernelName( kernel ) << " : not supported\n";
+                continue;
+            }
+            const long batch = measure( parameters.iterations, [&]()
+            {
+                cullBoxes( frustum, boxes, visibility, kernel );
+            } );
+            visible = 0;
+            for ( uint i = 0; i < parameters.size; ++i )
+            {
+                visible += isVisible( visibility, i ) ? 1 : 0;
+            }
+            printResult( out, std::string( "batch, " ) + getKernelName( kernel ), batch, corners,
+                         parameters.size, visible );
+        }
+        out << "default kernel : " << getKernelName( getBestKernel() ) << std::endl;
+    }
+}
@@ -0,0 +1,104 @@
+#include <CoreBenchmarks.hpp>
+
+#include <Core/Geometry/Mapping/MappingOperation.hpp>
+#include <Core/Mesh/MeshPrimitives.hpp>
+#include <Core/Time/Timer.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+namespace CoreBenchmarks
+{
+    namespace
+    {
+        void printResult( std::ostream& out, const std::string& name, long median, long reference, uint size )
+        {
+            out << std::left << std::setw( 24 ) << name << std::right
+                << std::setw( 10 ) << median << " us"
+                << std::setw( 10 ) << std::fixed << std::setprecision( 2 )
+                << double( median ) * 1000.0 / double( size ) << " ns/vertex"
+                << std::setw( 8 ) << std::setprecision( 1 )
+                << ( median > 0 ? double( reference ) / double( median ) : 0.0 ) << "x\n";
+        }
+
+        template <typename Func>
+        long measure( uint iterations, const Func& f )
+        {
+            std::vector<long> durations;
+            durations.reserve( iterations );
+            for ( uint i = 0; i < iterations; ++i )
+            {
+                const Ra::Core::Timer::TimePoint start = Ra::Core::Timer::Clock::now();
+                f();
+                durations.push_back( Ra::Core::Timer::getIntervalMicro( start, Ra::Core::Timer::Clock::now() ) );
+            }
+            return getMedian( durations );
+        }
+
+        /// Returns the subdivision level of a geodesic sphere with about the given number of triangles.
+        uint getLevel( uint triangles )
+        {
+            // An icosahedron has 20 triangles, each level multiplies them by 4.
+            uint level = 0;
+            while ( level < 8 && 20u << ( 2 * ( level + 1 ) ) <= triangles )
+            {
+                ++level;
+            }
+            return level;
+        }
+    }
+
+    void runMappingBenchmark( const BenchmarkParameters& parameters, std::ostream& out )
+    {
+        using namespace Ra::Core::Geometry;
+
+        // A sphere mapped on a coarser cage around it, as a skinned mesh on its deformation cage.
+        const uint level = getLevel( parameters.size );
+        const Ra::Core::TriangleMesh source = Ra::Core::MeshUtils::makeGeodesicSphere( 1.f, level );
+        const Ra::Core::TriangleMesh target = Ra::Core::MeshUtils::makeGeodesicSphere( 1.2f, level > 1 ? level - 1 : 0 );
+        const uint size = source.m_vertices.size();
+
+        out << "Mapping of " << size << " vertices on " << target.m_triangles.size()
+            << " triangles, median of " << parameters.iterations << " iterations\n";
+
+        Parametrization linear;
+        Parametrization param;
+        // The linear search is slow : it is only measured on a few iterations.
+        const long reference = measure( std::min( parameters.iterations, 3u ), [&]()
+        {
+            findParametrizationLinear( source, target, linear );
+        } );
+        printResult( out, "linear", reference, reference, size );
+
+        const long tree = measure( parameters.iterations, [&]()
+        {
+            findParametrization( source, target, param );
+        } );
+        printResult( out, "kd-tree with build", tree, reference, size );
+
+        Ra::Core::TriangleKdTree kdTree;
+        kdTree.build( target );
+        const long queries = measure( parameters.iterations, [&]()
+        {
+            findParametrization( source, target, kdTree, param );
+        } );
+        printResult( out, "kd-tree queries", queries, reference, size );
+
+        // Vertices are about 0.2 away from the cage, any triangle close to this distance will do.
+        const Scalar tolerance = 0.25f;
+        const long early = measure( parameters.iterations, [&]()
+        {
+            findParametrization( source, target, kdTree, param, tolerance );
+        } );
+        printResult( out, "kd-tree with tolerance", early, reference, size );
+
+        findParametrization( source, target, kdTree, param );
+        bool same = true;
+        for ( uint i = 0; i < size; ++i )
+        {
+            same = same && param[i].getID() == linear[i].getID() && param[i].getDelta() == linear[i].getDelta();
+        }
+        out << ( same ? "Same parametrizations\n" : "Different parametrizations\n" ) << std::flush;
+    }
+}
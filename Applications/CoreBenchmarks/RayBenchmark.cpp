@@ -0,0 +1,108 @@
+#include <CoreBenchmarks.hpp>
+
+#include <Core/Math/RayBatch.hpp>
+#include <Core/Mesh/MeshPrimitives.hpp>
+#include <Core/Time/Timer.hpp>
+
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <string>
+
+namespace CoreBenchmarks
+{
+    namespace
+    {
+        using Ra::Core::Vector3;
+
+        void printResult( std::ostream& out, const std::string& name, long median, long reference, uint size )
+        {
+            out << std::left << std::setw( 24 ) << name << std::right
+                << std::setw( 10 ) << median << " us"
+                << std::setw( 10 ) << std::fixed << std::setprecision( 2 )
+                << double( median ) * 1000.0 / double( size ) << " ns/ray"
+                << std::setw( 8 ) << std::setprecision( 1 )
+                << ( median > 0 ? double( reference ) / double( median ) : 0.0 ) << "x\n";
+        }
+
+        template <typename Func>
+        long measure( uint iterations, const Func& f )
+        {
+            std::vector<long> durations;
+            durations.reserve( iterations );
+            for ( uint i = 0; i < iterations; ++i )
+            {
+                const Ra::Core::Timer::TimePoint start = Ra::Core::Timer::Clock::now();
+                f();
+                durations.push_back( Ra::Core::Timer::getIntervalMicro( start, Ra::Core::Timer::Clock::now() ) );
+            }
+            return getMedian( durations );
+        }
+
+        void runRays( const BenchmarkParameters& parameters, const Ra::Core::TriangleMesh& mesh,
+                      const Ra::Core::TriangleBVH& bvh, const Ra::Core::RayBatch& rays, std::ostream& out )
+        {
+            using namespace Ra::Core::RayCast;
+
+            const long single = measure( parameters.iterations, [&]()
+            {
+                for ( uint i = 0; i < rays.size(); ++i )
+                {
+                    bvh.castRay( mesh, rays.getRay( i ) );
+                }
+            } );
+            printResult( out, "single rays", single, single, rays.size() );
+
+            std::vector<Ra::Core::TriangleBVH::Hit> hits;
+            const std::pair<BatchMode, const char*> modes[] = {
+                { STREAM, "stream" }, { PACKET_4, "packets of 4" }, { PACKET_8, "packets of 8" }, { PACKET_16, "packets of 16" } };
+            for ( const auto& mode : modes )
+            {
+                const long batch = measure( parameters.iterations, [&]()
+                {
+                    vsTriangleMesh( rays, mesh, bvh, hits, mode.first );
+                } );
+                printResult( out, mode.second, batch, single, rays.size() );
+            }
+        }
+    }
+
+    void runRayBenchmark( const BenchmarkParameters& parameters, std::ostream& out )
+    {
+        const Ra::Core::TriangleMesh mesh = Ra::Core::MeshUtils::makeGeodesicSphere( 1.f, 5 );
+        Ra::Core::TriangleBVH bvh;
+        bvh.build( mesh );
+
+        // Primary rays of a square image in scanline order, so that consecutive rays are coherent.
+        const uint side = std::max( 1u, uint( std::sqrt( double( parameters.size ) ) ) );
+        Ra::Core::RayBatch coherent;
+        for ( uint y = 0; y < side; ++y )
+        {
+            for ( uint x = 0; x < side; ++x )
+            {
+                const Vector3 pixel( 2.4f * ( Scalar( x ) / side - 0.5f ), 2.4f * ( Scalar( y ) / side - 0.5f ), 0.f );
+                coherent.push_back( Ra::Core::Ray( Vector3( 0.f, 0.f, 5.f ), ( pixel - Vector3( 0.f, 0.f, 5.f ) ).normalized() ) );
+            }
+        }
+
+        // Rays between random points around the sphere, as ambient occlusion rays would be.
+        std::mt19937 generator( 1 );
+        std::normal_distribution<Scalar> normal( 0.f, 1.f );
+        Ra::Core::RayBatch incoherent;
+        for ( uint i = 0; i < coherent.size(); ++i )
+        {
+            const Vector3 origin = 1.2f * Vector3( normal( generator ), normal( generator ), normal( generator ) ).normalized();
+            const Vector3 direction( normal( generator ), normal( generator ), normal( generator ) );
+            incoherent.push_back( Ra::Core::Ray( origin, direction.normalized() ) );
+        }
+
+        out << "Ray casts against " << mesh.m_triangles.size() << " triangles, median of "
+            << parameters.iterations << " iterations, " << Ra::Core::Simd::getKernelName( Ra::Core::Simd::getBestKernel() )
+            << " kernel\n";
+        out << coherent.size() << " coherent rays\n";
+        runRays( parameters, mesh, bvh, coherent, out );
+        out << incoherent.size() << " incoherent rays\n";
+        runRays( parameters, mesh, bvh, incoherent, out );
+        out << std::flush;
+    }
+}
@@ -0,0 +1,69 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <CoreBenchmarks.hpp>
+
+/* Micro-benchmarks of Core kernels. Each benchmark runs the compared implementations on
+ * the same data and prints the median time of an iteration. */
+
+namespace
+{
+    void printHelp( char* argv[] )
+    {
+        std::cout << "Usage :\n"
+                  << argv[0] << " benchmark [options]\n\n"
+                  << "Benchmarks :\n"
+                  << "culling           batch frustum culling of boxes\n"
+                  << "rays              batch ray casts against a mesh (size is the number of rays)\n"
+                  << "mapping           parametrization of a mesh on a cage (size is the number of triangles)\n\n"
+                  << "Options :\n"
+                  << "--size n          number of elements (default 100000)\n"
+                  << "--iterations n    number of measured iterations (default 100)\n";
+    }
+
+    bool readUint( int argc, char* argv[], int& i, uint& value )
+    {
+        if ( i + 1 >= argc )
+        {
+            return false;
+        }
+        value = uint( std::stoul( argv[++i] ) );
+        return true;
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    CoreBenchmarks::BenchmarkParameters parameters;
+
+    bool valid = argc > 1;
+    for ( int i = 2; i < argc && valid; ++i )
+    {
+        const std::string arg( argv[i] );
+        if      ( arg == "--size" )       { valid = readUint( argc, argv, i, parameters.size ); }
+        else if ( arg == "--iterations" ) { valid = readUint( argc, argv, i, parameters.iterations ); }
+        else { valid = false; }
+    }
+    valid = valid && parameters.size > 0 && parameters.iterations > 0;
+
+    const std::string benchmark = argc > 1 ? argv[1] : "";
+    if ( valid && benchmark == "culling" )
+    {
+        CoreBenchmarks::runCullingBenchmark( parameters, std::cout );
+        return EXIT_SUCCESS;
+    }
+    if ( valid && benchmark == "rays" )
+    {
+        CoreBenchmarks::runRayBenchmark( parameters, std::cout );
+        return EXIT_SUCCESS;
+    }
+    if ( valid && benchmark == "mapping" )
+    {
+        CoreBenchmarks::runMappingBenchmark( parameters, std::cout );
+        return EXIT_SUCCESS;
+    }
+
+    printHelp( argv );
+    return EXIT_FAILURE;
+}
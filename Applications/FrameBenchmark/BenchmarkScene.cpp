@@ -0,0 +1,201 @@
+#include <BenchmarkScene.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <Core/Mesh/MeshPrimitives.hpp>
+#include <Core/Geometry/Normal/Normal.hpp>
+#include <Core/Animation/Pose/PoseOperation.hpp>
+#include <Core/Animation/Skinning/LinearBlendSkinning.hpp>
+#include <Core/Tasks/Task.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+
+#include <Engine/RadiumEngine.hpp>
+#include <Engine/FrameInfo.hpp>
+#include <Engine/Entity/Entity.hpp>
+#include <Engine/Managers/EntityManager/EntityManager.hpp>
+#include <Engine/Renderer/Mesh/Mesh.hpp>
+#include <Engine/Renderer/RenderObject/RenderObject.hpp>
+#include <Engine/Renderer/RenderObject/RenderObjectTypes.hpp>
+
+namespace FrameBenchmark
+{
+    using Ra::Core::Animation::Handle;
+
+    namespace
+    {
+        /// Simulated time between two frames, so that the animation does not depend on the timings.
+        constexpr Scalar g_frameTime = 1.f / 60.f;
+
+        /// Maximal bending angle of each joint, in radians.
+        constexpr Scalar g_bendAngle = 0.3f;
+
+        /// Length of the bone chain of each entity.
+        constexpr Scalar g_entityLength = 2.f;
+    }
+
+    BenchAnimationComponent::BenchAnimationComponent( const std::string& name, uint numBones,
+                                                      Scalar length, Scalar phase )
+        : Ra::Engine::Component( name )
+        , m_boneLength( length / Scalar( numBones ) )
+        , m_phase( phase )
+    {
+        // Chain of bones along the Y axis, starting at the origin.
+        int parent = -1;
+        for ( uint i = 0; i < numBones; ++i )
+        {
+            Ra::Core::Transform t( Ra::Core::Transform::Identity() );
+            t.translation() = Ra::Core::Vector3( 0, i * m_boneLength, 0 );
+            parent = m_skeleton.addBone( parent, t, Handle::SpaceType::MODEL,
+                                         "Bone_" + std::to_string( i ) );
+        }
+        m_restPose = m_skeleton.getPose( Handle::SpaceType::MODEL );
+    }
+
+    void BenchAnimationComponent::animate( const Ra::Engine::FrameInfo& frameInfo )
+    {
+        const Scalar time = frameInfo.m_numFrame * g_frameTime + m_phase;
+
+        // Each joint bends around Z with a phase shift along the chain, which makes a wave.
+        Ra::Core::Animation::Pose pose( m_restPose.size() );
+        Ra::Core::Transform parent( Ra::Core::Transform::Identity() );
+        for ( uint i = 0; i < pose.size(); ++i )
+        {
+            Ra::Core::Transform local( Ra::Core::Transform::Identity() );
+            local.translation() = Ra::Core::Vector3( 0, i > 0 ? m_boneLength : 0, 0 );
+            local.rotate( Ra::Core::AngleAxis( g_bendAngle * std::sin( time + i ),
+                                               Ra::Core::Vector3::UnitZ() ) );
+            pose[i] = parent * local;
+            parent = pose[i];
+        }
+        m_skeleton.setPose( pose, Handle::SpaceType::MODEL );
+
+        // The entity itself turns around the Y axis.
+        Ra::Core::Transform entityTransform = getEntity()->getTransform();
+        entityTransform.linear() = Ra::Core::AngleAxis( time, Ra::Core::Vector3::UnitY() ).toRotationMatrix();
+        getEntity()->setTransform( entityTransform );
+    }
+
+    BenchSkinningComponent::BenchSkinningComponent( const std::string& name,
+                                                    const BenchAnimationComponent* animation,
+                                                    Scalar length, uint meshSubdivisions )
+        : Ra::Engine::Component( name )
+        , m_animation( animation )
+        , m_length( length )
+        , m_meshSubdivisions( meshSubdivisions )
+    {
+    }
+
+    void BenchSkinningComponent::initialize()
+    {
+        // A sphere stretched over the bone chain.
+        m_refMesh = Ra::Core::MeshUtils::makeGeodesicSphere( 1.f, m_meshSubdivisions );
+        for ( auto& v : m_refMesh.m_vertices )
+        {
+            v = Ra::Core::Vector3( 0.2f * v.x(), 0.5f * m_length * ( v.y() + 1.f ), 0.2f * v.z() );
+        }
+        Ra::Core::Geometry::uniformNormal( m_refMesh.m_vertices, m_refMesh.m_triangles, m_refMesh.m_normals );
+
+        // Each vertex is bound to the two closest bones along the chain.
+        const uint numBones = m_animation->getSkeleton().size();
+        const Scalar boneLength = m_length / Scalar( numBones );
+        std::vector<Eigen::Triplet<Scalar>> triplets;
+        triplets.reserve( 2 * m_refMesh.m_vertices.size() );
+        for ( uint i = 0; i < m_refMesh.m_vertices.size(); ++i )
+        {
+            const Scalar x = Ra::Core::Math::clamp<Scalar>( m_refMesh.m_vertices[i].y() / boneLength - 0.5f,
+                                                            0, numBones - 1 );
+            const uint bone = uint( x );
+            const Scalar w = x - bone;
+            triplets.emplace_back( i, bone, 1.f - w );
+            if ( w > 0 )
+            {
+                triplets.emplace_back( i, bone + 1, w );
+            }
+        }
+        m_weights.resize( m_refMesh.m_vertices.size(), numBones );
+        m_weights.setFromTriplets( triplets.begin(), triplets.end() );
+
+        m_mesh.reset( new Ra::Engine::Mesh( getName() ) );
+        m_mesh->loadGeometry( m_refMesh );
+        addRenderObject( Ra::Engine::RenderObject::createRenderObject( getName() + "_RO", this,
+                                                                      Ra::Engine::RenderObjectType::Fancy,
+                                                                      m_mesh ) );
+    }
+
+    void BenchSkinningComponent::skin()
+    {
+        const Ra::Core::Animation::Pose pose = Ra::Core::Animation::relativePose(
+                m_animation->getSkeleton().getPose( Handle::SpaceType::MODEL ),
+                m_animation->getRestPose() );
+        Ra::Core::Animation::linearBlendSkinning( m_refMesh.m_vertices, pose, m_weights, m_vertices );
+
+        // Only the data of the requested type is valid in the updated mesh, so the
+        // normals are computed with the reference triangles.
+        Ra::Core::TriangleMesh& positions = m_mesh->getGeometryForUpdate( Ra::Engine::Mesh::VERTEX_POSITION );
+        positions.m_vertices = m_vertices;
+        Ra::Core::TriangleMesh& normals = m_mesh->getGeometryForUpdate( Ra::Engine::Mesh::VERTEX_NORMAL );
+        Ra::Core::Geometry::uniformNormal( m_vertices, m_refMesh.m_triangles, normals.m_normals );
+    }
+
+    void BenchAnimationSystem::generateTasks( Ra::Core::TaskQueue* taskQueue,
+                                              const Ra::Engine::FrameInfo& frameInfo )
+    {
+        // The frame info is owned by the engine and updated on each frame, so the
+        // tasks can be replayed when the task graph is persistent.
+        for ( const auto& compEntry : m_components )
+        {
+            BenchAnimationComponent* comp = static_cast<BenchAnimationComponent*>( compEntry.second );
+            taskQueue->registerTask( new Ra::Core::FunctionTask(
+                    std::bind( &BenchAnimationComponent::animate, comp, std::cref( frameInfo ) ),
+                    "BenchAnimationSystem" ) );
+        }
+    }
+
+    void BenchSkinningSystem::generateTasks( Ra::Core::TaskQueue* taskQueue,
+                                             const Ra::Engine::FrameInfo& frameInfo )
+    {
+        for ( const auto& compEntry : m_components )
+        {
+            BenchSkinningComponent* comp = static_cast<BenchSkinningComponent*>( compEntry.second );
+            Ra::Core::TaskQueue::TaskId skinTask = taskQueue->registerTask( new Ra::Core::FunctionTask(
+                    std::bind( &BenchSkinningComponent::skin, comp ), "BenchSkinningSystem" ) );
+            taskQueue->addPendingDependency( "BenchAnimationSystem", skinTask );
+        }
+    }
+
+    void createScene( const SceneParameters& parameters )
+    {
+        Ra::Engine::RadiumEngine* engine = Ra::Engine::RadiumEngine::getInstance();
+
+        BenchAnimationSystem* animationSystem = new BenchAnimationSystem;
+        BenchSkinningSystem* skinningSystem = new BenchSkinningSystem;
+        engine->registerSystem( "BenchAnimationSystem", animationSystem );
+        engine->registerSystem( "BenchSkinningSystem", skinningSystem );
+
+        // Entities on a square grid.
+        const uint side = uint( std::ceil( std::sqrt( Scalar( parameters.numEntities ) ) ) );
+        for ( uint i = 0; i < parameters.numEntities; ++i )
+        {
+            const std::string name = "Bench_" + std::to_string( i );
+            Ra::Engine::Entity* entity = engine->getEntityManager()->createEntity( name );
+
+            Ra::Core::Transform t( Ra::Core::Transform::Identity() );
+            t.translation() = Ra::Core::Vector3( Scalar( i % side ), 0, Scalar( i / side ) );
+            entity->setTransform( t );
+
+            BenchAnimationComponent* animation = new BenchAnimationComponent(
+                    name + "_AC", parameters.numBones, g_entityLength, Scalar( i ) );
+            entity->addComponent( animation );
+            animationSystem->registerComponent( entity, animation );
+            animation->initialize();
+
+            BenchSkinningComponent* skinning = new BenchSkinningComponent(
+                    name + "_SC", animation, g_entityLength, parameters.meshSubdivisions );
+            entity->addComponent( skinning );
+            skinningSystem->registerComponent( entity, skinning );
+            skinning->initialize();
+        }
+    }
+}
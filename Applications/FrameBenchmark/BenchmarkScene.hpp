@@ -0,0 +1,103 @@
+#ifndef RADIUMENGINE_BENCHMARK_SCENE_HPP_
+#define RADIUMENGINE_BENCHMARK_SCENE_HPP_
+
+#include <memory>
+
+#include <Core/Mesh/TriangleMesh.hpp>
+#include <Core/Animation/Handle/Skeleton.hpp>
+#include <Core/Animation/Handle/HandleWeight.hpp>
+#include <Core/Animation/Pose/Pose.hpp>
+
+#include <Engine/Component/Component.hpp>
+#include <Engine/System/System.hpp>
+
+/* Synthetic scene used by the frame benchmark : each entity holds a procedural mesh
+ * skinned on a bone chain which is animated procedurally. The two systems mimic the
+ * animation and skinning plugins with the same Core kernels, without loading any asset. */
+
+namespace Ra
+{
+    namespace Engine
+    {
+        class Mesh;
+        struct FrameInfo;
+    }
+}
+
+namespace FrameBenchmark
+{
+    /// Parameters of the synthetic scene.
+    struct SceneParameters
+    {
+        uint numEntities = 100;     /// Number of animated entities.
+        uint numBones = 8;          /// Number of bones of each skeleton.
+        uint meshSubdivisions = 3;  /// Subdivisions of the geodesic sphere of each entity.
+    };
+
+    /// Holds a bone chain and animates it procedurally from the frame number.
+    class BenchAnimationComponent : public Ra::Engine::Component
+    {
+    public:
+        BenchAnimationComponent( const std::string& name, uint numBones, Scalar length, Scalar phase );
+
+        virtual void initialize() override {}
+
+        /// Computes the pose of the skeleton and moves the entity for the given frame.
+        void animate( const Ra::Engine::FrameInfo& frameInfo );
+
+        const Ra::Core::Animation::Skeleton& getSkeleton() const { return m_skeleton; }
+        const Ra::Core::Animation::RestPose& getRestPose() const { return m_restPose; }
+
+    private:
+        Ra::Core::Animation::Skeleton m_skeleton;
+        Ra::Core::Animation::RestPose m_restPose;
+        Scalar m_boneLength;
+        Scalar m_phase;
+    };
+
+    /// Skins a procedural mesh on the skeleton of an animation component.
+    class BenchSkinningComponent : public Ra::Engine::Component
+    {
+    public:
+        BenchSkinningComponent( const std::string& name, const BenchAnimationComponent* animation,
+                                Scalar length, uint meshSubdivisions );
+
+        /// Creates the mesh, its render object and the skinning weights.
+        virtual void initialize() override;
+
+        /// Deforms the mesh with linear blend skinning and recomputes its normals.
+        void skin();
+
+    private:
+        const BenchAnimationComponent* m_animation;
+        Scalar m_length;
+        uint m_meshSubdivisions;
+
+        Ra::Core::TriangleMesh m_refMesh;
+        Ra::Core::Animation::WeightMatrix m_weights;
+        Ra::Core::Vector3Array m_vertices;
+        std::shared_ptr<Ra::Engine::Mesh> m_mesh;
+    };
+
+    /// Generates one "BenchAnimationSystem" task per component.
+    class BenchAnimationSystem : public Ra::Engine::System
+    {
+    public:
+        virtual void generateTasks( Ra::Core::TaskQueue* taskQueue,
+                                    const Ra::Engine::FrameInfo& frameInfo ) override;
+    };
+
+    /// Generates one "BenchSkinningSystem" task per component, run after the animation tasks.
+    class BenchSkinningSystem : public Ra::Engine::System
+    {
+    public:
+        virtual void generateTasks( Ra::Core::TaskQueue* taskQueue,
+                                    const Ra::Engine::FrameInfo& frameInfo ) override;
+    };
+
+    /// Registers the benchmark systems in the engine and creates the entities of the scene.
+    /// The engine must be initialized.
+    void createScene( const SceneParameters& parameters );
+}
+
+#endif // RADIUMENGINE_BENCHMARK_SCENE_HPP_
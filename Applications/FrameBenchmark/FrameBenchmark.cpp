@@ -0,0 +1,217 @@
+#include <FrameBenchmark.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <Engine/RadiumEngine.hpp>
+
+namespace FrameBenchmark
+{
+    namespace
+    {
+        /// Simulated frame duration passed to the engine.
+        constexpr Scalar g_frameTime = 1.f / 60.f;
+
+        // Returns the value of rank p (between 0 and 1) in the sorted values.
+        Ra::Core::Timer::MicroSeconds percentile( const std::vector<Ra::Core::Timer::MicroSeconds>& sorted, double p )
+        {
+            const std::size_t rank = std::size_t( std::ceil( p * sorted.size() ) );
+            return sorted[std::max<std::size_t>( rank, 1 ) - 1];
+        }
+
+        void writeStatistics( std::ostream& out, const char* name, const Statistics& stats )
+        {
+            out << "    \"" << name << "\": { \"mean\": " << stats.mean << ", \"p50\": " << stats.p50
+                << ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << " }";
+        }
+
+        const char* getModeName( Ra::Core::TaskQueue::SchedulingMode mode )
+        {
+            return mode == Ra::Core::TaskQueue::WORK_STEALING ? "stealing" : "shared";
+        }
+    }
+
+    Statistics::Statistics( std::vector<Ra::Core::Timer::MicroSeconds> values )
+    {
+        if ( values.empty() )
+        {
+            return;
+        }
+        std::sort( values.begin(), values.end() );
+        double sum = 0;
+        for ( auto v : values )
+        {
+            sum += v;
+        }
+        mean = sum / values.size();
+        p50 = percentile( values, 0.5 );
+        p99 = percentile( values, 0.99 );
+        max = values.back();
+    }
+
+    BenchmarkReport::BenchmarkReport( const BenchmarkParameters& parameters )
+        : m_parameters( parameters ), m_maxBusyTime( 0 )
+    {
+        m_frames.reserve( parameters.numFrames );
+    }
+
+    void BenchmarkReport::addTasks( const std::vector<Ra::Core::TaskQueue::TimerData>& taskData )
+    {
+        // The tasks run in parallel, so the queue costs the time during which the busiest
+        // thread was not running a task (waiting for dependencies, dispatching, waking up).
+        // The last entry is the main thread, which runs tasks while waiting for them.
+        std::vector<Ra::Core::Timer::MicroSeconds> busy( m_parameters.numThreads + 1, 0 );
+        for ( const auto& task : taskData )
+        {
+            const Ra::Core::Timer::MicroSeconds duration = Ra::Core::Timer::getIntervalMicro( task.start, task.end );
+            busy[task.threadId] += duration;
+
+            SystemCost& cost = m_systemCosts[task.taskName];
+            cost.total += duration;
+            ++cost.numTasks;
+        }
+
+        m_maxBusyTime = busy.empty() ? 0 : *std::max_element( busy.begin(), busy.end() );
+    }
+
+    void BenchmarkReport::addFrame( const FrameTimings& timings )
+    {
+        FrameTimings frame = timings;
+        frame.queueOverhead = std::max<Ra::Core::Timer::MicroSeconds>( frame.runTasks - m_maxBusyTime, 0 );
+        m_frames.push_back( frame );
+        m_maxBusyTime = 0;
+    }
+
+    Statistics BenchmarkReport::getFrameStatistics() const
+    {
+        std::vector<Ra::Core::Timer::MicroSeconds> values;
+        values.reserve( m_frames.size() );
+        for ( const auto& f : m_frames )
+        {
+            values.push_back( f.frame );
+        }
+        return Statistics( values );
+    }
+
+    void BenchmarkReport::write( std::ostream& out ) const
+    {
+        // Gathers one stage of all the frames.
+        auto stage = [this]( Ra::Core::Timer::MicroSeconds FrameTimings::* member )
+        {
+            std::vector<Ra::Core::Timer::MicroSeconds> values;
+            values.reserve( m_frames.size() );
+            for ( const auto& f : m_frames )
+            {
+                values.push_back( f.*member );
+            }
+            return Statistics( values );
+        };
+
+        const BenchmarkParameters& p = m_parameters;
+        out << "{\n";
+        out << "  \"parameters\": { \"entities\": " << p.scene.numEntities
+            << ", \"bones\": " << p.scene.numBones
+            << ", \"subdivisions\": " << p.scene.meshSubdivisions
+            << ", \"frames\": " << p.numFrames
+            << ", \"warmup\": " << p.numWarmupFrames
+            << ", \"threads\": " << p.numThreads
+            << ", \"mode\": \"" << getModeName( p.mode ) << "\""
+            << ", \"persistent\": " << ( p.persistentTasks ? "true" : "false" )
+            << ", \"critical_path\": " << ( p.criticalPath ? "true" : "false" )
+            << ", \"pipelined\": " << ( p.pipelinedFrames ? "true" : "false" ) << " },\n";
+
+        out << "  \"timings_us\": {\n";
+        writeStatistics( out, "frame", stage( &FrameTimings::frame ) );
+        out << ",\n";
+        writeStatistics( out, "get_tasks", stage( &FrameTimings::getTasks ) );
+        out << ",\n";
+        writeStatistics( out, "run_tasks", stage( &FrameTimings::runTasks ) );
+        out << ",\n";
+        writeStatistics( out, "queue_overhead", stage( &FrameTimings::queueOverhead ) );
+        out << ",\n";
+        writeStatistics( out, "flush", stage( &FrameTimings::flush ) );
+        out << ",\n";
+        writeStatistics( out, "end_frame_sync", stage( &FrameTimings::endFrameSync ) );
+        out << "\n  },\n";
+
+        // Average cost of each system per frame, summed over its tasks.
+        out << "  \"systems\": {";
+        const double numFrames = std::max<std::size_t>( m_frames.size(), 1 );
+        bool first = true;
+        for ( const auto& system : m_systemCosts )
+        {
+            out << ( first ? "\n" : ",\n" );
+            out << "    \"" << system.first << "\": { \"us_per_frame\": " << system.second.total / numFrames
+                << ", \"tasks_per_frame\": " << system.second.numTasks / numFrames
+                << ", \"us_per_task\": " << double( system.second.total ) / std::max<ulong>( system.second.numTasks, 1 )
+                << " }";
+            first = false;
+        }
+        out << "\n  }\n";
+        out << "}\n";
+    }
+
+    void runBenchmark( const BenchmarkParameters& parameters, BenchmarkReport& report )
+    {
+        using Ra::Core::Timer::Clock;
+        using Ra::Core::Timer::getIntervalMicro;
+
+        Ra::Engine::RadiumEngine* engine = Ra::Engine::RadiumEngine::createInstance();
+        engine->initialize();
+        engine->setPersistentTasks( parameters.persistentTasks );
+        engine->setPipelinedFrames( parameters.pipelinedFrames );
+
+        std::unique_ptr<Ra::Core::TaskQueue> taskQueue( new Ra::Core::TaskQueue( parameters.numThreads, parameters.mode ) );
+        taskQueue->setCriticalPathPriorities( parameters.criticalPath );
+        Ra::Core::setParallelTaskQueue( taskQueue.get() );
+
+        createScene( parameters.scene );
+
+        // Same sequence as BaseApplication::radiumFrame(), without rendering.
+        const uint totalFrames = parameters.numWarmupFrames + parameters.numFrames;
+        for ( uint i = 0; i < totalFrames; ++i )
+        {
+            const auto frameStart = Clock::now();
+
+            taskQueue->processCompletedJobs();
+            engine->getTasks( taskQueue.get(), g_frameTime );
+            const auto tasksStart = Clock::now();
+
+            taskQueue->startTasks();
+            taskQueue->waitForTasks();
+            const auto tasksEnd = Clock::now();
+
+            // The report is not part of the measured frame.
+            const bool measured = i >= parameters.numWarmupFrames;
+            if ( measured )
+            {
+                report.addTasks( taskQueue->getTimerData() );
+            }
+
+            const auto flushStart = Clock::now();
+            taskQueue->flushTaskQueue();
+            const auto syncStart = Clock::now();
+            engine->endFrameSync();
+            const auto frameEnd = Clock::now();
+
+            if ( measured )
+            {
+                FrameTimings timings;
+                timings.getTasks = getIntervalMicro( frameStart, tasksStart );
+                timings.runTasks = getIntervalMicro( tasksStart, tasksEnd );
+                timings.flush = getIntervalMicro( flushStart, syncStart );
+                timings.endFrameSync = getIntervalMicro( syncStart, frameEnd );
+                timings.frame = getIntervalMicro( frameStart, tasksEnd ) + getIntervalMicro( flushStart, frameEnd );
+                report.addFrame( timings );
+            }
+        }
+
+        engine->cleanup();
+        Ra::Core::setParallelTaskQueue( nullptr );
+        taskQueue.reset();
+        Ra::Engine::RadiumEngine::destroyInstance();
+    }
+}
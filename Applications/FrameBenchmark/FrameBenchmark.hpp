@@ -0,0 +1,90 @@
+#ifndef RADIUMENGINE_FRAME_BENCHMARK_HPP_
+#define RADIUMENGINE_FRAME_BENCHMARK_HPP_
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <Core/Time/Timer.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+
+#include <BenchmarkScene.hpp>
+
+namespace FrameBenchmark
+{
+    /// Parameters of a benchmark run.
+    struct BenchmarkParameters
+    {
+        SceneParameters scene;
+        uint numFrames = 500;       /// Number of measured frames.
+        uint numWarmupFrames = 50;  /// Number of frames run before the measures.
+        uint numThreads = 1;        /// Number of threads of the task queue.
+        Ra::Core::TaskQueue::SchedulingMode mode = Ra::Core::TaskQueue::SHARED_QUEUE;
+        bool persistentTasks = false;
+        bool criticalPath = false;
+        bool pipelinedFrames = false;
+    };
+
+    /// Durations of the stages of one frame, in microseconds.
+    struct FrameTimings
+    {
+        Ra::Core::Timer::MicroSeconds frame = 0;         /// Whole frame.
+        Ra::Core::Timer::MicroSeconds getTasks = 0;      /// RadiumEngine::getTasks().
+        Ra::Core::Timer::MicroSeconds runTasks = 0;      /// From startTasks() to the end of waitForTasks().
+        Ra::Core::Timer::MicroSeconds queueOverhead = 0; /// runTasks minus the busiest thread time.
+        Ra::Core::Timer::MicroSeconds flush = 0;         /// TaskQueue::flushTaskQueue().
+        Ra::Core::Timer::MicroSeconds endFrameSync = 0;  /// RadiumEngine::endFrameSync().
+    };
+
+    /// Summary of a series of durations, in microseconds.
+    /// Percentiles use the nearest rank method.
+    struct Statistics
+    {
+        explicit Statistics( std::vector<Ra::Core::Timer::MicroSeconds> values );
+
+        double mean = 0;
+        Ra::Core::Timer::MicroSeconds p50 = 0;
+        Ra::Core::Timer::MicroSeconds p99 = 0;
+        Ra::Core::Timer::MicroSeconds max = 0;
+    };
+
+    /// Accumulates the timings of the measured frames and writes them as JSON.
+    class BenchmarkReport
+    {
+    public:
+        explicit BenchmarkReport( const BenchmarkParameters& parameters );
+
+        /// Records the timer data of the tasks of the current frame, before they are flushed.
+        void addTasks( const std::vector<Ra::Core::TaskQueue::TimerData>& taskData );
+
+        /// Records the current frame. Its queue overhead is computed from the tasks given
+        /// to addTasks().
+        void addFrame( const FrameTimings& timings );
+
+        /// Writes the report as a JSON object.
+        void write( std::ostream& out ) const;
+
+        /// Returns the statistics of the whole frame durations.
+        Statistics getFrameStatistics() const;
+
+    private:
+        /// Accumulated cost of the tasks of a system (tasks are named after their system).
+        struct SystemCost
+        {
+            Ra::Core::Timer::MicroSeconds total = 0;
+            ulong numTasks = 0;
+        };
+
+        BenchmarkParameters m_parameters;
+        std::vector<FrameTimings> m_frames;
+        std::map<std::string, SystemCost> m_systemCosts;
+        /// Time spent running tasks by the busiest thread in the current frame.
+        Ra::Core::Timer::MicroSeconds m_maxBusyTime;
+    };
+
+    /// Initializes the engine with the scene, runs the frames and fills the report.
+    void runBenchmark( const BenchmarkParameters& parameters, BenchmarkReport& report );
+}
+
+#endif // RADIUMENGINE_FRAME_BENCHMARK_HPP_
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <FrameBenchmark.hpp>
+
+/* Headless benchmark of the engine loop : builds a synthetic animated scene and runs the
+ * systems and the task queue without any window or OpenGL context. The timings are written
+ * as JSON so that they can be compared between builds. */
+
+namespace
+{
+    void printHelp( char* argv[] )
+    {
+        std::cout << "Usage :\n"
+                  << argv[0] << " [options]\n\n"
+                  << "--entities n      number of animated entities (default 100)\n"
+                  << "--bones n         number of bones of each skeleton (default 8)\n"
+                  << "--subdivisions n  subdivisions of the mesh of each entity (default 3)\n"
+                  << "--frames n        number of measured frames (default 500)\n"
+                  << "--warmup n        number of frames run before the measures (default 50)\n"
+                  << "--threads n       number of threads of the task queue (default : all cores but one)\n"
+                  << "--mode m          task scheduling, shared or stealing (default shared)\n"
+                  << "--persistent      compile the task graph once and replay it\n"
+                  << "--critical-path   schedule the tasks of the critical path first\n"
+                  << "--pipelined       double buffer the meshes as when rendering in parallel\n"
+                  << "--output file     write the report to a file instead of the standard output\n"
+                  << "--max-p99 us      exit with an error if the p99 frame time is above this value\n";
+    }
+
+    bool readUint( int argc, char* argv[], int& i, uint& value )
+    {
+        if ( i + 1 >= argc )
+        {
+            return false;
+        }
+        value = uint( std::stoul( argv[++i] ) );
+        return true;
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    FrameBenchmark::BenchmarkParameters parameters;
+    parameters.numThreads = std::max( std::thread::hardware_concurrency(), 2u ) - 1;
+    std::string outputFilename;
+    uint maxFrameP99 = 0;
+
+    bool valid = true;
+    for ( int i = 1; i < argc && valid; ++i )
+    {
+        const std::string arg( argv[i] );
+        if      ( arg == "--entities" )     { valid = readUint( argc, argv, i, parameters.scene.numEntities ); }
+        else if ( arg == "--bones" )        { valid = readUint( argc, argv, i, parameters.scene.numBones ); }
+        else if ( arg == "--subdivisions" ) { valid = readUint( argc, argv, i, parameters.scene.meshSubdivisions ); }
+        else if ( arg == "--frames" )       { valid = readUint( argc, argv, i, parameters.numFrames ); }
+        else if ( arg == "--warmup" )       { valid = readUint( argc, argv, i, parameters.numWarmupFrames ); }
+        else if ( arg == "--threads" )      { valid = readUint( argc, argv, i, parameters.numThreads ); }
+        else if ( arg == "--max-p99" )      { valid = readUint( argc, argv, i, maxFrameP99 ); }
+        else if ( arg == "--persistent" )   { parameters.persistentTasks = true; }
+        else if ( arg == "--critical-path" ){ parameters.criticalPath = true; }
+        else if ( arg == "--pipelined" )    { parameters.pipelinedFrames = true; }
+        else if ( arg == "--mode" && i + 1 < argc )
+        {
+            const std::string mode( argv[++i] );
+            valid = mode == "shared" || mode == "stealing";
+            parameters.mode = mode == "stealing" ? Ra::Core::TaskQueue::WORK_STEALING
+                                                 : Ra::Core::TaskQueue::SHARED_QUEUE;
+        }
+        else if ( arg == "--output" && i + 1 < argc ) { outputFilename = argv[++i]; }
+        else { valid = false; }
+    }
+
+    valid = valid && parameters.numThreads > 0 && parameters.numFrames > 0
+            && parameters.scene.numEntities > 0 && parameters.scene.numBones > 0;
+    if ( !valid )
+    {
+        printHelp( argv );
+        return EXIT_FAILURE;
+    }
+
+    FrameBenchmark::BenchmarkReport report( parameters );
+    FrameBenchmark::runBenchmark( parameters, report );
+
+    if ( outputFilename.empty() )
+    {
+        report.write( std::cout );
+    }
+    else
+    {
+        std::ofstream file( outputFilename );
+        if ( !file )
+        {
+            std::cerr << "Cannot write " << outputFilename << std::endl;
+            return EXIT_FAILURE;
+        }
+        report.write( file );
+    }
+
+    const FrameBenchmark::Statistics frames = report.getFrameStatistics();
+    if ( maxFrameP99 > 0 && frames.p99 > long( maxFrameP99 ) )
+    {
+        std::cerr << "p99 frame time " << frames.p99 << " us is above " << maxFrameP99 << " us" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -257,24 +257,16 @@ namespace AnimationPlugin
 
     void AnimationComponent::setupIO(const std::string &id)
     {
-        ComponentMessenger::CallbackTypes<Skeleton>::Getter skelOut = std::bind( &AnimationComponent::getSkeletonOutput, this );
-        ComponentMessenger::getInstance()->registerOutput<Skeleton>( getEntity(), this, id, skelOut);
-
-        ComponentMessenger::CallbackTypes<RefPose>::Getter refpOut = std::bind( &AnimationComponent::getRefPoseOutput, this );
-        ComponentMessenger::getInstance()->registerOutput<Ra::Core::Animation::Pose>( getEntity(), this, id, refpOut);
-
-        ComponentMessenger::CallbackTypes<WeightMatrix>::Getter wOut = std::bind( &AnimationComponent::getWeightsOutput, this );
-        ComponentMessenger::getInstance()->registerOutput<Ra::Core::Animation::WeightMatrix>( getEntity(), this, id, wOut);
-
-        ComponentMessenger::CallbackTypes<bool>::Getter resetOut = std::bind( &AnimationComponent::getWasReset, this );
-        ComponentMessenger::getInstance()->registerOutput<bool>( getEntity(), this, id, resetOut);
+        // Data members are registered by address, so that their handles are read without any call.
+        ComponentMessenger::getInstance()->registerOutput<Skeleton>( getEntity(), this, id, getSkeletonOutput() );
+        ComponentMessenger::getInstance()->registerOutput<Ra::Core::Animation::Pose>( getEntity(), this, id, getRefPoseOutput() );
+        ComponentMessenger::getInstance()->registerOutput<Ra::Core::Animation::WeightMatrix>( getEntity(), this, id, getWeightsOutput() );
+        ComponentMessenger::getInstance()->registerOutput<bool>( getEntity(), this, id, getWasReset() );
+        ComponentMessenger::getInstance()->registerOutput<Scalar>( getEntity(), this, id, getTimeOutput() );
 
         ComponentMessenger::CallbackTypes<Animation>::Getter animOut = std::bind( &AnimationComponent::getAnimation, this );
         ComponentMessenger::getInstance()->registerOutput<Animation>(getEntity(), this, id, animOut);
 
-        ComponentMessenger::CallbackTypes<Scalar>::Getter timeOut = std::bind(&AnimationComponent::getTimeOutput, this );
-        ComponentMessenger::getInstance()->registerOutput<Scalar>(getEntity(), this, id, timeOut);
-
     }
 
     const Ra::Core::Animation::Skeleton* AnimationComponent::getSkeletonOutput() const
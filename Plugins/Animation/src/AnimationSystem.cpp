@@ -20,23 +20,32 @@ namespace AnimationPlugin
         m_isPlaying = false;
         m_oneStep = false;
         m_xrayOn = false;
+        m_currentDelta = 0;
     }
 
     void AnimationSystem::generateTasks(Ra::Core::TaskQueue* taskQueue, const Ra::Engine::FrameInfo& frameInfo)
     {
-        const bool playFrame = m_isPlaying || m_oneStep;
-
-        Scalar currentDelta = playFrame ? frameInfo.m_dt : 0;
+        // The time step is computed by a task, so that the tasks can be replayed on later frames.
+        Ra::Core::FunctionTask* frameTask = new Ra::Core::FunctionTask(
+                [this, &frameInfo]() { updateCurrentDelta( frameInfo ); },
+                "AnimatorFrameTask");
+        Ra::Core::TaskQueue::TaskId frameTaskId = taskQueue->registerTask( frameTask );
 
         for (auto compEntry : this->m_components)
         {
             AnimationComponent* component = static_cast<AnimationComponent*>(compEntry.second);
             Ra::Core::FunctionTask* task = new Ra::Core::FunctionTask(
-                    std::bind(&AnimationComponent::update, component, currentDelta),
+                    [this, component]() { component->update( m_currentDelta ); },
                     "AnimatorTask");
-            taskQueue->registerTask( task );
+            Ra::Core::TaskQueue::TaskId taskId = taskQueue->registerTask( task );
+            taskQueue->addDependency( frameTaskId, taskId );
         }
+    }
 
+    void AnimationSystem::updateCurrentDelta( const Ra::Engine::FrameInfo& frameInfo )
+    {
+        const bool playFrame = m_isPlaying || m_oneStep;
+        m_currentDelta = playFrame ? frameInfo.m_dt : 0;
         m_oneStep = false;
     }
 
@@ -45,6 +45,11 @@ namespace AnimationPlugin
         Scalar getTime(const Ra::Engine::ItemEntry& entry) const;
 
     private:
+        /// Computes the time step of the animations for the current frame.
+        void updateCurrentDelta( const Ra::Engine::FrameInfo& frameInfo );
+
+    private:
+        Scalar m_currentDelta; /// Time step of the animations for the current frame.
         bool m_isPlaying; /// See if animation is playing or paused
         bool m_oneStep;   /// True if one step has been required to play.
         bool m_xrayOn;    /// True if we want to show xray-bones
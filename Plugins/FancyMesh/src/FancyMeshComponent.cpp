@@ -15,6 +15,7 @@
 #include <Engine/Managers/ComponentMessenger/ComponentMessenger.hpp>
 
 #include <Engine/Renderer/Mesh/Mesh.hpp>
+#include <Engine/Renderer/Mesh/MeshCache.hpp>
 
 #include <Engine/Renderer/Material/BlinnPhongMaterial.hpp>
 #include <Engine/Renderer/Material/Material.hpp>
@@ -50,7 +51,7 @@ namespace FancyMeshPlugin
 
     void FancyMeshComponent::addMeshRenderObject( const Ra::Core::TriangleMesh& mesh, const std::string& name )
     {
-        setupIO(name);
+        setupIO(name, false);
 
         std::shared_ptr<Ra::Engine::Mesh> displayMesh( new Ra::Engine::Mesh( name ) );
         displayMesh->loadGeometry( mesh );
@@ -59,7 +60,7 @@ namespace FancyMeshPlugin
         addRenderObject(renderObject);
     }
 
-    void FancyMeshComponent::handleMeshLoading( const Ra::Asset::GeometryData* data )
+    void FancyMeshComponent::handleMeshLoading( const Ra::Asset::GeometryData* data, Ra::Engine::MeshCache* meshCache )
     {
         std::string name( m_name );
         name.append( "_" + data->getName() );
@@ -79,8 +80,12 @@ namespace FancyMeshPlugin
 
         auto displayMesh = Ra::Core::make_shared<Ra::Engine::Mesh>(meshName/*, Ra::Engine::Mesh::RM_POINTS*/);
 
+        // Shared meshes stay in the frame of the data, so that the instances differ by their
+        // transform only.
+        const bool shared = meshCache != nullptr && !m_deformable;
+
         Ra::Core::TriangleMesh mesh;
-        Ra::Core::Transform T = data->getFrame();
+        Ra::Core::Transform T = shared ? Ra::Core::Transform::Identity() : data->getFrame();
         Ra::Core::Transform N;
         N.matrix() = (T.matrix()).inverse().transpose();
 
@@ -144,6 +149,11 @@ namespace FancyMeshPlugin
         // FIXME(Charly): Should not weights be part of the geometry ?
         //        mesh->addData( Ra::Engine::Mesh::VERTEX_WEIGHTS, meshData.weights );
 
+        if ( shared )
+        {
+            displayMesh = meshCache->share( displayMesh );
+        }
+
         // The technique for rendering this component
         Ra::Engine::RenderTechnique rt;
 
@@ -152,12 +162,19 @@ namespace FancyMeshPlugin
         {
             const Ra::Asset::MaterialData& loadedMaterial = data->getMaterial();
 
-            // First extract the material from asset
-            auto converter = Ra::Engine::EngineMaterialConverters::getMaterialConverter(loadedMaterial.getType());
-            auto convertedMaterial = converter.second(&loadedMaterial);
+            // First extract the material from asset, shared by the instances of a shared mesh
+            std::shared_ptr<Ra::Engine::Material> radiumMaterial;
+            if ( shared )
+            {
+                radiumMaterial = meshCache->shareMaterial( loadedMaterial );
+            }
+            else
+            {
+                auto converter = Ra::Engine::EngineMaterialConverters::getMaterialConverter(loadedMaterial.getType());
+                radiumMaterial.reset( converter.second(&loadedMaterial) );
+            }
 
             // Second, associate the material to the render technique
-            std::shared_ptr<Ra::Engine::Material> radiumMaterial(convertedMaterial);
             if ( radiumMaterial != nullptr )
             {
                 isTransparent = radiumMaterial->isTransparent();
@@ -180,8 +197,12 @@ namespace FancyMeshPlugin
         
         auto ro = Ra::Engine::RenderObject::createRenderObject( roName, this, Ra::Engine::RenderObjectType::Fancy, displayMesh, rt );
         ro->setTransparent( isTransparent );
+        if ( shared )
+        {
+            ro->setLocalTransform( data->getFrame() );
+        }
         
-        setupIO( m_contentName );
+        setupIO( m_contentName, displayMesh->isShared() );
         m_meshIndex = addRenderObject(ro);
     }
 
@@ -205,20 +226,25 @@ namespace FancyMeshPlugin
         this->m_contentName=name;
     }
 
-    void FancyMeshComponent::setupIO(const std::string& id)
+    void FancyMeshComponent::setupIO(const std::string& id, bool sharedMesh)
     {
         ComponentMessenger::CallbackTypes<TriangleMesh>::Getter cbOut = std::bind( &FancyMeshComponent::getMeshOutput, this );
         ComponentMessenger::getInstance()->registerOutput<TriangleMesh>( getEntity(), this, id, cbOut);
 
-        ComponentMessenger::CallbackTypes<FancyMeshComponent::DuplicateTable>::Getter dtOut = std::bind( &FancyMeshComponent::getDuplicateTableOutput, this );
-        ComponentMessenger::getInstance()->registerOutput<FancyMeshComponent::DuplicateTable>( getEntity(), this, id, dtOut);
+        ComponentMessenger::getInstance()->registerOutput<FancyMeshComponent::DuplicateTable>( getEntity(), this, id, getDuplicateTableOutput() );
+
+        ComponentMessenger::getInstance()->registerOutput<Ra::Core::Index>( getEntity(), this, id, roIndexRead() );
+
+        // A mesh handed out by the mesh cache is drawn by other components too and is read only :
+        // the read-write outputs are written by the frame tasks, which cannot unshare it.
+        if ( sharedMesh )
+        {
+            return;
+        }
 
         ComponentMessenger::CallbackTypes<TriangleMesh>::ReadWrite cbRw = std::bind( &FancyMeshComponent::getMeshRw, this );
         ComponentMessenger::getInstance()->registerReadWrite<TriangleMesh>( getEntity(), this, id, cbRw);
 
-        ComponentMessenger::CallbackTypes<Ra::Core::Index>::Getter roOut = std::bind(&FancyMeshComponent::roIndexRead, this);
-        ComponentMessenger::getInstance()->registerOutput<Ra::Core::Index>(getEntity(), this, id, roOut);
-
         ComponentMessenger::CallbackTypes<Ra::Core::Vector3Array>::ReadWrite vRW = std::bind( &FancyMeshComponent::getVerticesRw, this);
         ComponentMessenger::getInstance()->registerReadWrite<Ra::Core::Vector3Array>( getEntity(), this, id+"v", vRW);
 
@@ -242,7 +268,9 @@ namespace FancyMeshPlugin
 
     Ra::Engine::Mesh& FancyMeshComponent::getDisplayMesh()
     {
-        return *(getRoMgr()->getRenderObject(getRenderObjectIndex())->getMesh());
+        const auto& mesh = getRoMgr()->getRenderObject(getRenderObjectIndex())->getMesh();
+        CORE_ASSERT( !mesh->isShared(), "Shared meshes must not be modified." );
+        return *mesh;
     }
 
     const Ra::Core::TriangleMesh* FancyMeshComponent::getMeshOutput() const
@@ -257,10 +285,9 @@ namespace FancyMeshPlugin
 
     Ra::Core::TriangleMesh *FancyMeshComponent::getMeshRw()
     {
-        getDisplayMesh().setDirty( Ra::Engine::Mesh::VERTEX_POSITION );
-        getDisplayMesh().setDirty( Ra::Engine::Mesh::VERTEX_NORMAL );
-        getDisplayMesh().setDirty( Ra::Engine::Mesh::INDEX);
-        return &(getDisplayMesh().getGeometry());
+        getDisplayMesh().getGeometryForUpdate( Ra::Engine::Mesh::VERTEX_POSITION );
+        getDisplayMesh().getGeometryForUpdate( Ra::Engine::Mesh::VERTEX_NORMAL );
+        return &(getDisplayMesh().getGeometryForUpdate( Ra::Engine::Mesh::INDEX ));
     }
 
     void FancyMeshComponent::setMeshInput(const TriangleMesh *meshptr)
@@ -274,20 +301,17 @@ namespace FancyMeshPlugin
 
     Ra::Core::Vector3Array* FancyMeshComponent::getVerticesRw()
     {
-        getDisplayMesh().setDirty( Ra::Engine::Mesh::VERTEX_POSITION);
-        return &(getDisplayMesh().getGeometry().m_vertices);
+        return &(getDisplayMesh().getGeometryForUpdate( Ra::Engine::Mesh::VERTEX_POSITION ).m_vertices);
     }
 
     Ra::Core::Vector3Array* FancyMeshComponent::getNormalsRw()
     {
-        getDisplayMesh().setDirty( Ra::Engine::Mesh::VERTEX_NORMAL);
-        return &(getDisplayMesh().getGeometry().m_normals);
+        return &(getDisplayMesh().getGeometryForUpdate( Ra::Engine::Mesh::VERTEX_NORMAL ).m_normals);
     }
 
     Ra::Core::VectorArray<Ra::Core::Triangle>* FancyMeshComponent::getTrianglesRw()
     {
-        getDisplayMesh().setDirty( Ra::Engine::Mesh::INDEX);
-        return &(getDisplayMesh().getGeometry().m_triangles);
+        return &(getDisplayMesh().getGeometryForUpdate( Ra::Engine::Mesh::INDEX ).m_triangles);
     }
 
     const Ra::Core::Index* FancyMeshComponent::roIndexRead() const
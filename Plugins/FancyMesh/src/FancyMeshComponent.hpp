@@ -16,6 +16,7 @@ namespace Ra
     {
         class RenderTechnique;
         class Mesh;
+        class MeshCache;
     }
 }
 
@@ -42,7 +43,10 @@ namespace FancyMeshPlugin
         void initialize() override;
 
         void addMeshRenderObject(const Ra::Core::TriangleMesh& mesh, const std::string& name);
-        void handleMeshLoading(const Ra::Asset::GeometryData* data);
+        /// Displays the geometry of data. Unless the component is deformable, its mesh is shared
+        /// through meshCache (if not null) with the components displaying the same geometry : the
+        /// geometry is then kept in the frame of data, which is the local transform of the render object.
+        void handleMeshLoading(const Ra::Asset::GeometryData* data, Ra::Engine::MeshCache* meshCache = nullptr);
 
         /// Returns the index of the associated RO (the display mesh)
         Ra::Core::Index getRenderObjectIndex() const;
@@ -53,11 +57,13 @@ namespace FancyMeshPlugin
 
     public:
         // Component communication management
-        void setupIO(const std::string& id);
+        /// Registers the outputs of the component, read-write ones only if the mesh is not shared.
+        void setupIO(const std::string& id, bool sharedMesh);
         void setContentName (const std::string name);
         void setDeformable (const bool b);
     private:
         const Ra::Engine::Mesh& getDisplayMesh() const;
+        /// Returns the mesh to be modified, which must not be shared with other components.
         Ra::Engine::Mesh& getDisplayMesh();
 
         // Fancy mesh accepts to give its mesh and (if deformable) to update it
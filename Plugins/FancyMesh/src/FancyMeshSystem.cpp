@@ -37,9 +37,10 @@ namespace FancyMeshPlugin
             std::string componentName = "FMC_" + entity->getName() + std::to_string( id++ );
             FancyMeshComponent * comp = new FancyMeshComponent( componentName, fileData->hasHandle() );
             entity->addComponent( comp );
-            comp->handleMeshLoading( data );
+            comp->handleMeshLoading( data, &m_meshCache );
             registerComponent( entity, comp );
         }
+        m_meshCache.clearMaterials();
     }
 
     void FancyMeshSystem::generateTasks( Ra::Core::TaskQueue* taskQueue, const Ra::Engine::FrameInfo& frameInfo )
@@ -4,6 +4,7 @@
 #include <FancyMeshPluginMacros.hpp>
 
 #include <Engine/System/System.hpp>
+#include <Engine/Renderer/Mesh/MeshCache.hpp>
 
 namespace Ra
 {
@@ -44,6 +45,9 @@ namespace FancyMeshPlugin
         static FancyMeshComponent* makeFancyMeshFromGeometry( const Ra::Core::TriangleMesh& mesh, const std::string& name,
                                                              Ra::Engine::RenderTechnique* technique = nullptr );
 
+    private:
+        // Meshes of the loaded assets, shared by the components displaying the same geometry.
+        Ra::Engine::MeshCache m_meshCache;
     };
 
 } // namespace FancyMeshPlugin
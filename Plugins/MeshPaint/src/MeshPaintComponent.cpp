@@ -91,6 +91,9 @@ void MeshPaintComponent::paintMesh( const Ra::Engine::Renderer::PickingResult& p
         return;
     }
 
+    // Only paint this object, even if its mesh is shared with other ones.
+    ro->unshareMesh();
+
     const auto& T = ro->getMesh()->getGeometry().m_triangles;
     auto colors = ro->getMesh()->getData( Ra::Engine::Mesh::VERTEX_COLOR );
 
@@ -36,10 +36,14 @@ namespace SkinningPlugin
 
        if ( hasSkel && hasWeights && hasMesh && hasRefPose )
        {
-           m_skeletonGetter = compMsg->getterCallback<Skeleton>( getEntity(), m_contentsName );
-           m_verticesWriter = compMsg->rwCallback<Ra::Core::Vector3Array>( getEntity(), m_contentsName+"v" );
-           m_normalsWriter  = compMsg->rwCallback<Ra::Core::Vector3Array>( getEntity(), m_contentsName+"n" );
-           m_duplicateTableGetter = compMsg->getterCallback<std::vector<Ra::Core::Index>>( getEntity(), m_contentsName );
+           const ComponentMessenger::EntityHandles handles = compMsg->resolveAll( getEntity() );
+           m_skeletonHandle       = handles.output<Skeleton>( m_contentsName );
+           m_duplicateTableHandle = handles.output<std::vector<Ra::Core::Index>>( m_contentsName );
+           m_resetHandle          = handles.output<bool>( m_contentsName );
+           m_verticesHandle       = handles.readWrite<Ra::Core::Vector3Array>( m_contentsName+"v" );
+           m_normalsHandle        = handles.readWrite<Ra::Core::Vector3Array>( m_contentsName+"n" );
+           CORE_ASSERT( m_skeletonHandle.isValid() && m_duplicateTableHandle.isValid() && m_resetHandle.isValid()
+                        && m_verticesHandle.isValid() && m_normalsHandle.isValid(), "Missing skinning inputs" );
 
            m_refData.m_skeleton      = compMsg->get<Skeleton>( getEntity(), m_contentsName );
            m_refData.m_referenceMesh = compMsg->get<TriangleMesh>( getEntity(), m_contentsName );
@@ -71,9 +75,10 @@ namespace SkinningPlugin
     {
        CORE_ASSERT( m_isReady, "Skinning is not setup");
 
-       const Skeleton* skel = m_skeletonGetter();
+       const ComponentMessenger* compMsg = ComponentMessenger::getInstance();
+       const Skeleton* skel = &compMsg->get( m_skeletonHandle );
 
-       bool reset = ComponentMessenger::getInstance()->get<bool>(getEntity(), m_contentsName);
+       bool reset = compMsg->get( m_resetHandle );
 
        // Reset the skin if it wasn't done before
        if (reset && !m_frameData.m_doReset )
@@ -91,13 +96,20 @@ namespace SkinningPlugin
                m_frameData.m_refToCurrentRelPose = Ra::Core::Animation::relativePose(m_frameData.m_currentPose, m_refData.m_refPose);
                m_frameData.m_prevToCurrentRelPose = Ra::Core::Animation::relativePose(m_frameData.m_currentPose, m_frameData.m_previousPose);
 
-               switch ( m_skinningType )
+               // The centers of rotation may still be computed : use dual quaternions meanwhile.
+               const SkinningType skinningType = ( m_skinningType == COR && m_refData.m_CoR.empty() ) ? DQS : m_skinningType;
+               switch ( skinningType )
                {
                case LBS:
                {
                    Ra::Core::Animation::linearBlendSkinning( m_refData.m_referenceMesh.m_vertices, m_frameData.m_refToCurrentRelPose, m_refData.m_weights, m_frameData.m_currentPos );
                    break;
                }
+               case COR:
+               {
+                   Ra::Core::Animation::corSkinning( m_refData.m_referenceMesh.m_vertices, m_frameData.m_refToCurrentRelPose, m_refData.m_weights, m_refData.m_CoR, m_frameData.m_currentPos );
+                   break;
+               }
                case DQS:
                {
                    Ra::Core::AlignedStdVector< DualQuaternion > DQ;
@@ -106,11 +118,6 @@ namespace SkinningPlugin
                    Ra::Core::Animation::dualQuaternionSkinning( m_refData.m_referenceMesh.m_vertices, DQ, m_frameData.m_currentPos );
                    break;
                }
-               case COR:
-               {
-                   Ra::Core::Animation::corSkinning( m_refData.m_referenceMesh.m_vertices, m_frameData.m_refToCurrentRelPose, m_refData.m_weights, m_refData.m_CoR, m_frameData.m_currentPos );
-                   break;
-               }
                }
                Ra::Core::Animation::computeDQ( m_frameData.m_refToCurrentRelPose, m_refData.m_weights, m_DQ );
            }
@@ -121,12 +128,13 @@ namespace SkinningPlugin
     {
        if (m_frameData.m_doSkinning)
        {
-           Ra::Core::Vector3Array& vertices = *(m_verticesWriter());
-           Ra::Core::Vector3Array& normals = *(m_normalsWriter());
+           const ComponentMessenger* compMsg = ComponentMessenger::getInstance();
+           Ra::Core::Vector3Array& vertices = *(compMsg->rw( m_verticesHandle ));
+           Ra::Core::Vector3Array& normals = *(compMsg->rw( m_normalsHandle ));
 
            vertices = m_frameData.m_currentPos;
 
-           Ra::Core::Geometry::uniformNormal( vertices, m_refData.m_referenceMesh.m_triangles, *(m_duplicateTableGetter()), normals );
+           Ra::Core::Geometry::uniformNormal( vertices, m_refData.m_referenceMesh.m_triangles, compMsg->get( m_duplicateTableHandle ), normals );
 
            std::swap( m_frameData.m_previousPose, m_frameData.m_currentPose );
            std::swap( m_frameData.m_previousPos, m_frameData.m_currentPos );
@@ -137,8 +145,9 @@ namespace SkinningPlugin
        else if (m_frameData.m_doReset)
        {
            // Reset mesh to its initial state.
-           Ra::Core::Vector3Array& vertices = *(m_verticesWriter());
-           Ra::Core::Vector3Array& normals =  *(m_normalsWriter());
+           const ComponentMessenger* compMsg = ComponentMessenger::getInstance();
+           Ra::Core::Vector3Array& vertices = *(compMsg->rw( m_verticesHandle ));
+           Ra::Core::Vector3Array& normals =  *(compMsg->rw( m_normalsHandle ));
 
            vertices = m_refData.m_referenceMesh.m_vertices;
            normals = m_refData.m_referenceMesh.m_normals;
@@ -203,9 +212,22 @@ namespace SkinningPlugin
        }
        case COR:
        {
-           if ( m_refData.m_CoR.empty() )
+           if ( m_refData.m_CoR.empty() && !m_corJob )
            {
-               Ra::Core::Animation::computeCoR( m_refData );
+               // Computing the centers of rotation takes a while : it is done in the background
+               // on a copy of the reference data, and the result is picked up on a later frame.
+               RefData refData = m_refData;
+               m_corJob = Ra::Core::runInBackground<Ra::Core::Vector3Array>( "SkinningCoR",
+                   [refData]( const Ra::Core::AsyncJob& ) mutable
+                   {
+                       Ra::Core::Animation::computeCoR( refData );
+                       return refData.m_CoR;
+                   },
+                   [this]( Ra::Core::Vector3Array& cor )
+                   {
+                       m_refData.m_CoR = std::move( cor );
+                       m_corJob.reset();
+                   } );
     /*
                for ( const auto& v :m_refData.m_CoR )
                {
@@ -9,6 +9,7 @@
 #include <Core/Math/DualQuaternion.hpp>
 #include <Core/Mesh/TriangleMesh.hpp>
 #include <Core/File/HandleData.hpp>
+#include <Core/Tasks/AsyncJob.hpp>
 
 #include <Engine/Component/Component.hpp>
 #include <Engine/Managers/ComponentMessenger/ComponentMessenger.hpp>
@@ -30,7 +31,7 @@ namespace SkinningPlugin
             : Component(name),
             m_skinningType( type ),
             m_isReady(false) {}
-        virtual ~SkinningComponent() {}
+        virtual ~SkinningComponent() { if ( m_corJob ) { m_corJob->cancel(); } }
 
         virtual void initialize() override { setupSkinning();}
 
@@ -60,14 +61,19 @@ namespace SkinningPlugin
         Ra::Core::Skinning::RefData m_refData;
         Ra::Core::Skinning::FrameData m_frameData;
 
-        Ra::Engine::ComponentMessenger::CallbackTypes<Ra::Core::Animation::Skeleton>::Getter m_skeletonGetter;
-        Ra::Engine::ComponentMessenger::CallbackTypes<std::vector<Ra::Core::Index>>::Getter m_duplicateTableGetter;
+        // Handles on the data of the other components, resolved once in setupSkinning().
+        Ra::Engine::ComponentMessenger::OutputHandle<Ra::Core::Animation::Skeleton> m_skeletonHandle;
+        Ra::Engine::ComponentMessenger::OutputHandle<std::vector<Ra::Core::Index>> m_duplicateTableHandle;
+        Ra::Engine::ComponentMessenger::OutputHandle<bool> m_resetHandle;
 
-        Ra::Engine::ComponentMessenger::CallbackTypes<Ra::Core::Vector3Array>::ReadWrite m_verticesWriter;
-        Ra::Engine::ComponentMessenger::CallbackTypes<Ra::Core::Vector3Array>::ReadWrite m_normalsWriter;
+        Ra::Engine::ComponentMessenger::ReadWriteHandle<Ra::Core::Vector3Array> m_verticesHandle;
+        Ra::Engine::ComponentMessenger::ReadWriteHandle<Ra::Core::Vector3Array> m_normalsHandle;
 
         Ra::Core::AlignedStdVector< Ra::Core::DualQuaternion > m_DQ;
 
+        // Background computation of the centers of rotation.
+        std::shared_ptr<Ra::Core::AsyncFunctionJob<Ra::Core::Vector3Array>> m_corJob;
+
         SkinningType m_skinningType;
         bool m_isReady;
     };
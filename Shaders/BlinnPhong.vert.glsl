@@ -10,6 +10,8 @@ layout (location = 4) in vec3 in_texcoord;
 uniform Transform transform;
 uniform Material material;
 
+#include "Instancing.glsl"
+
 uniform mat4 uLightSpace;
 
 layout (location = 0) out vec3 out_position;
@@ -20,12 +22,13 @@ layout (location = 4) out vec3 out_tangent;
 
 void main()
 {
-    mat4 mvp = transform.proj * transform.view * transform.model;
+    mat4 model = getModelMatrix();
+    mat4 mvp = transform.proj * transform.view * model;
     gl_Position = mvp * vec4(in_position, 1.0);
 
-    vec4 pos = transform.model * vec4(in_position, 1.0);
+    vec4 pos = model * vec4(in_position, 1.0);
     pos /= pos.w;
-    vec3 normal = mat3(transform.worldNormal) * in_normal;
+    vec3 normal = mat3(getWorldNormalMatrix()) * in_normal;
 
     vec3 eye = -transform.view[3].xyz * mat3(transform.view);
 
@@ -9,6 +9,8 @@ layout (location = 4) in vec3 in_texcoord;
 uniform Transform transform;
 uniform Material material;
 
+#include "Instancing.glsl"
+
 layout (location = 0) out vec3 out_position;
 layout (location = 1) out vec3 out_normal;
 layout (location = 2) out vec3 out_texcoord;
@@ -17,20 +19,21 @@ layout (location = 4) out mat3 out_TBN;
 
 void main()
 {
-    mat4 mvp = transform.proj * transform.view * transform.model;
+    mat4 model = getModelMatrix();
+    mat4 mvp = transform.proj * transform.view * model;
     gl_Position = mvp * vec4(in_position, 1.0);
 
-    vec4 pos = transform.model * vec4(in_position, 1.0);
+    vec4 pos = model * vec4(in_position, 1.0);
     out_position = pos.xyz / pos.w;
-    out_normal = vec3(transform.worldNormal * vec4(in_normal, 0.0));
+    out_normal = vec3(getWorldNormalMatrix() * vec4(in_normal, 0.0));
 
     out_texcoord = in_texcoord;
 
     if (material.tex.hasNormal == 1)
     {
-        vec3 t = normalize(vec3(transform.model * vec4(in_tangent,   0.0)));
-        vec3 b = normalize(vec3(transform.model * vec4(in_bitangent, 0.0)));
-        vec3 n = normalize(vec3(transform.model * vec4(in_normal,    0.0)));
+        vec3 t = normalize(vec3(model * vec4(in_tangent,   0.0)));
+        vec3 b = normalize(vec3(model * vec4(in_bitangent, 0.0)));
+        vec3 n = normalize(vec3(model * vec4(in_normal,    0.0)));
 
         out_TBN = mat3(t, b, n);
     }
@@ -0,0 +1,16 @@
+// Matrices of the render objects drawn as instances of a shared mesh (see
+// Ra::Engine::Renderer::renderDraws()), which replace transform.model and
+// transform.worldNormal when transform.instanced is not 0.
+// Must be included after the declaration of the transform uniform.
+layout (location = 8) in mat4 in_instanceModel;
+layout (location = 12) in mat4 in_instanceWorldNormal;
+
+mat4 getModelMatrix()
+{
+    return transform.instanced != 0 ? in_instanceModel : transform.model;
+}
+
+mat4 getWorldNormalMatrix()
+{
+    return transform.instanced != 0 ? in_instanceWorldNormal : transform.worldNormal;
+}
@@ -7,6 +7,8 @@ layout (location = 5) in vec4 in_color;
 uniform Transform transform;
 uniform int drawFixedSize;
 
+#include "Instancing.glsl"
+
 layout (location = 0) out vec3 out_position;
 layout (location = 1) out vec3 out_texcoord;
 layout (location = 2) out vec3 out_color;
@@ -14,26 +16,26 @@ layout (location = 2) out vec3 out_color;
 void main()
 {
     mat4 mvp;
+    mat4 model = getModelMatrix();
     if ( drawFixedSize > 0 )
     {
         // distance to camera
-        mat4 modelView = transform.view * transform.model;
+        mat4 modelView = transform.view * model;
         float d = length( modelView[3].xyz );
         mat3 scale3 = mat3(d);
         mat4 scale = mat4(scale3);
-        mat4 model = transform.model * scale;
-        mvp = transform.proj * transform.view * model;
+        mvp = transform.proj * transform.view * model * scale;
     }
     else
     {
-        mvp = transform.proj * transform.view * transform.model;
+        mvp = transform.proj * transform.view * model;
     }
 
     gl_Position = mvp * vec4(in_position.xyz, 1.0);
     out_color = in_color.xyz;
     out_texcoord = in_texcoord;
 
-    vec4 pos = transform.model * vec4(in_position, 1.0);
+    vec4 pos = model * vec4(in_position, 1.0);
     pos /= pos.w;
     out_position = vec3(pos);
 }
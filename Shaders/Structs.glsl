@@ -7,6 +7,7 @@ struct Transform
     mat4 modelView;
     mat4 worldNormal;
     mat4 viewNormal;
+    int instanced;
 };
 
 struct Textures
@@ -3,6 +3,7 @@
 # RADIUM_ROOT_DIR : the root of the radium SDK
 # RADIUM_LIBRARIES
 # RADIUM_INCLUDE_DIRS : the include directories of radium
+# RADIUM_ALLOCATION_HOOK_SOURCE : source to add to an executable to profile its allocations
 # RADIUM_PLUGIN_OUTPUT_PATH : output path for radiums plugin
 # RADIUM_BINARY_OUTPUT_PATH : output path for radiums external binaries
 # RADIUM_SUBMODULES_BUILD_TYPE : build type of the 3rdparties
@@ -117,6 +118,7 @@ if ( RADIUM_ROOT_DIR )
   ENDIF(NOT OPENMESH_INCLUDE_DIR)
 
   set( RADIUM_INCLUDE_DIRS)
+  set( RADIUM_ALLOCATION_HOOK_SOURCE "${RADIUM_SRC_DIR}/Core/Tasks/AllocationHook.cpp")
   list(APPEND RADIUM_INCLUDE_DIRS "${RADIUM_SRC_DIR}" "${EIGEN3_INCLUDE_DIR}" "${ASSIMP_INCLUDE_DIR}" "${GLBINDING_INCLUDE_DIR}" "${GLOBJECTS_INCLUDE_DIR}")
 
   set( RADIUM_LIBRARIES )
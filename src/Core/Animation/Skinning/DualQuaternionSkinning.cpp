@@ -1,8 +1,12 @@
 #include <Core/Animation/Skinning/DualQuaternionSkinning.hpp>
 
+#include <Core/Animation/Skinning/SkinningUtils.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
 namespace Ra {
 namespace Core {
 namespace Animation {
+
 void computeDQ( const Pose& pose, const WeightMatrix& weight, DQList& DQ ) {
     CORE_ASSERT( ( pose.size() == weight.cols() ), "pose/weight size mismatch." );
     DQ.clear();
@@ -22,24 +26,12 @@ void computeDQ( const Pose& pose, const WeightMatrix& weight, DQList& DQ ) {
         const int nonZero = weight.col( j ).nonZeros();
 
         WeightMatrix::InnerIterator it0( weight, j );
-#if defined CORE_USE_OMP
-        omp_set_dynamic(0);
-        #pragma omp parallel for schedule( static ) num_threads(4)
-#endif
-        // This for loop is here just because OpenMP wants classic for loops.
         // Since we cannot iterate directly through the non-zero elements using the InnerIterator,
         // we initialize an InnerIterator to the first element and then we increase it nz times.
-        /*
-        * This crappy piece of code was done in order to avoid the critical section
-        *           DQ[i] += wq;
-        *
-        * that was occurring when parallelizing the main for loop.
-        *
-        * NOTE: this could be definitely improved by using std::thread
-        */
+        // Parallelizing over the vertices of a transform, rather than over the transforms,
+        // avoids a critical section on DQ[i] += wq.
         // Loop through all vertices vi who depend on Tj
-
-        for( int nz = 0; nz < nonZero; ++nz ) {
+        parallelFor( 0, nonZero, [&]( uint nz ) {
             WeightMatrix::InnerIterator itn = it0 + Eigen::Index(nz);
             const uint   i  = itn.row();
             const Scalar w  = itn.value();
@@ -49,17 +41,13 @@ void computeDQ( const Pose& pose, const WeightMatrix& weight, DQList& DQ ) {
 
             const auto  wq = poseDQ[j] * w * sign;
             DQ[i] += wq;
-        }
+        }, SkinningGrainSize );
     }
 
     // Normalize all dual quats.
-#if defined CORE_USE_OMP
-    omp_set_dynamic(0);
-    #pragma omp parallel for schedule( static ) num_threads(4)
-#endif
-    for( int i = 0; i < int(DQ.size()) ; ++i) {
+    parallelFor( 0, DQ.size(), [&DQ]( uint i ) {
         DQ[i].normalize();
-    }
+    }, SkinningGrainSize );
 }
 
 // alternate naive version, for reference purposes.
@@ -107,13 +95,9 @@ void dualQuaternionSkinning( const Vector3Array& input, const DQList& DQ, Vector
     const uint size = input.size();
     CORE_ASSERT( ( size == DQ.size() ), "input/DQ size mismatch." );
     output.resize( size );
-#if defined CORE_USE_OMP
-    omp_set_dynamic(0);
-    #pragma omp parallel for schedule( static ) num_threads(4)
-#endif
-    for( int i = 0; i < int(size); ++i ) {
+    parallelFor( 0, size, [&]( uint i ) {
         output[i] = DQ[i].transform( input[i] );
-    }
+    }, SkinningGrainSize );
 }
 } // namespace Animation
 } // namespace Core
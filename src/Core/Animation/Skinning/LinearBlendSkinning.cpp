@@ -1,5 +1,8 @@
 #include <Core/Animation/Skinning/LinearBlendSkinning.hpp>
 
+#include <Core/Animation/Skinning/SkinningUtils.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
 namespace Ra {
 namespace Core {
 namespace Animation {
@@ -13,14 +16,14 @@ void linearBlendSkinning( const Vector3Array&  inMesh,
     for( int k = 0; k < weight.outerSize(); ++k ) {
         const int nonZero = weight.col( k ).nonZeros();
         WeightMatrix::InnerIterator it0( weight, k );
-        #pragma omp parallel for
-        for( int nz = 0; nz < nonZero; ++nz ) {
+        // A vertex appears at most once in a column, so iterations are independent.
+        parallelFor( 0, nonZero, [&]( uint nz ) {
             WeightMatrix::InnerIterator it = it0 + Eigen::Index(nz);
             const uint   i = it.row();
             const uint   j = it.col();
             const Scalar w = it.value();
             outMesh[i] += w * ( pose[j] * inMesh[i] );
-        }
+        }, SkinningGrainSize );
     }
 }
 
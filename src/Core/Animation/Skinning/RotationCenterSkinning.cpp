@@ -1,12 +1,14 @@
 #include <Core/Animation/Skinning/RotationCenterSkinning.hpp>
 
+#include <Core/Animation/Skinning/SkinningUtils.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
 namespace Ra
 {
     namespace Core
     {
         namespace Animation
         {
-
             Scalar weightSimilarity(const Eigen::SparseVector<Scalar>& v1w,
                                     const Eigen::SparseVector<Scalar>& v2w, Scalar sigma)
             {
@@ -196,11 +198,10 @@ namespace Ra
                 // Do LBS on the COR with weights of their associated vertices
                 Vector3Array transformedCoR;
                 Animation::linearBlendSkinning(CoR, pose, weight, transformedCoR);
-#pragma omp parallel for
-                for (int i = 0; i < int(size); ++i)
+                parallelFor(0, size, [&](uint i)
                 {
                     output[i] = DQ[i].rotate(input[i] - CoR[i]) + transformedCoR[i];
-                }
+                }, SkinningGrainSize);
             }
         }// ns Animation
     } // ns Core
@@ -0,0 +1,18 @@
+#ifndef RADIUMENGINE_SKINNING_UTILS_HPP_
+#define RADIUMENGINE_SKINNING_UTILS_HPP_
+
+#include <Core/RaCore.hpp>
+
+namespace Ra {
+namespace Core {
+namespace Animation {
+
+/// Number of vertices processed by a thread in a row by the parallel skinning loops.
+/// Large enough for the cost of a chunk to dominate the cost of scheduling it.
+constexpr uint SkinningGrainSize = 512;
+
+} // namespace Animation
+} // namespace Core
+} // namespace Ra
+
+#endif // RADIUMENGINE_SKINNING_UTILS_HPP_
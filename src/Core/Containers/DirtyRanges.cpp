@@ -0,0 +1,94 @@
+#include <Core/Containers/DirtyRanges.hpp>
+
+#include <Core/CoreMacros.hpp>
+
+#include <algorithm>
+
+namespace Ra
+{
+    namespace Core
+    {
+        constexpr uint DirtyRanges::MaxRanges;
+        constexpr uint DirtyRanges::DifferencesGrainSize;
+
+        void DirtyRanges::add( uint begin, uint end )
+        {
+            CORE_ASSERT( begin <= end, "Invalid range." );
+            if ( m_all || begin == end )
+            {
+                return;
+            }
+
+            // The ranges overlapping or touching the new one are replaced by their union.
+            auto first = std::lower_bound( m_ranges.begin(), m_ranges.end(), begin,
+                                           []( const Range& r, uint b ) { return r.m_end < b; } );
+            auto last = first;
+            Range merged{ begin, end };
+            while ( last != m_ranges.end() && last->m_begin <= end )
+            {
+                merged.m_begin = std::min( merged.m_begin, last->m_begin );
+                merged.m_end = std::max( merged.m_end, last->m_end );
+                ++last;
+            }
+            if ( first == last )
+            {
+                m_ranges.insert( first, merged );
+            }
+            else
+            {
+                *first = merged;
+                m_ranges.erase( first + 1, last );
+            }
+
+            if ( m_ranges.size() > MaxRanges )
+            {
+                uint closest = 0;
+                for ( uint i = 1; i + 1 < m_ranges.size(); ++i )
+                {
+                    if ( m_ranges[i + 1].m_begin - m_ranges[i].m_end
+                         < m_ranges[closest + 1].m_begin - m_ranges[closest].m_end )
+                    {
+                        closest = i;
+                    }
+                }
+                m_ranges[closest].m_end = m_ranges[closest + 1].m_end;
+                m_ranges.erase( m_ranges.begin() + closest + 1 );
+            }
+        }
+
+        void DirtyRanges::add( const DirtyRanges& other )
+        {
+            if ( other.m_all )
+            {
+                addAll();
+                return;
+            }
+            for ( const auto& r : other.m_ranges )
+            {
+                add( r.m_begin, r.m_end );
+            }
+        }
+
+        void DirtyRanges::addAll()
+        {
+            m_all = true;
+            m_ranges.clear();
+        }
+
+        uint DirtyRanges::getCount() const
+        {
+            uint count = 0;
+            for ( const auto& r : m_ranges )
+            {
+                count += r.m_end - r.m_begin;
+            }
+            return count;
+        }
+
+        void DirtyRanges::clear()
+        {
+            m_all = false;
+            m_ranges.clear();
+        }
+    }
+}
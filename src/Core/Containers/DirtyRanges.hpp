@@ -0,0 +1,71 @@
+#ifndef RADIUMENGINE_DIRTY_RANGES_HPP_
+#define RADIUMENGINE_DIRTY_RANGES_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Ranges of the elements of an array which were modified, e.g. the vertices to send again
+        /// to the GPU. The ranges are kept sorted, and overlapping or adjacent ranges are merged.
+        /// Beyond MaxRanges ranges, the two closest ones are merged, so that the ranges may also
+        /// hold a few elements which were not modified.
+        class RA_CORE_API DirtyRanges
+        {
+        public:
+            /// Maximum number of ranges.
+            static constexpr uint MaxRanges = 16;
+
+            /// Number of elements compared by a thread in a row in addDifferences().
+            static constexpr uint DifferencesGrainSize = 4096;
+
+            /// Range [m_begin, m_end) of elements.
+            struct Range
+            {
+                uint m_begin;
+                uint m_end;
+            };
+
+        public:
+            /// Marks the elements [begin, end) as modified.
+            void add( uint begin, uint end );
+
+            /// Marks all the elements as modified, whatever the size of the array.
+            void addAll();
+
+            /// Marks the elements which differ between two arrays of the same size, e.g. the
+            /// old and new vertices of a mesh. The arrays are compared in parallel.
+            template <typename Array>
+            inline void addDifferences( const Array& before, const Array& after );
+
+            /// Marks the elements of the ranges of other as modified.
+            void add( const DirtyRanges& other );
+
+            /// Returns true if all the elements are modified (see addAll()).
+            inline bool isAll() const { return m_all; }
+
+            /// Returns true if no element is modified.
+            inline bool isEmpty() const { return !m_all && m_ranges.empty(); }
+
+            /// Returns the sorted ranges, which are meaningless if isAll() is true.
+            inline const std::vector<Range>& getRanges() const { return m_ranges; }
+
+            /// Returns the number of elements in the ranges, which is meaningless if isAll() is true.
+            uint getCount() const;
+
+            /// Marks all the elements as unmodified.
+            void clear();
+
+        private:
+            std::vector<Range> m_ranges;
+            bool m_all = false;
+        };
+    }
+}
+
+#include <Core/Containers/DirtyRanges.inl>
+
+#endif // RADIUMENGINE_DIRTY_RANGES_HPP_
@@ -0,0 +1,35 @@
+#include <Core/Containers/DirtyRanges.hpp>
+
+#include <Core/Tasks/ParallelFor.hpp>
+
+namespace Ra
+{
+    namespace Core
+    {
+        template <typename Array>
+        inline void DirtyRanges::addDifferences( const Array& before, const Array& after )
+        {
+            CORE_ASSERT( before.size() == after.size(), "Arrays should have the same size." );
+            if ( m_all )
+            {
+                return;
+            }
+
+            // Each chunk gathers its own runs of different elements, merged in order afterwards.
+            const DirtyRanges ranges = parallelReduce( 0, uint( after.size() ), DirtyRanges(),
+                [&before, &after]( uint i, DirtyRanges& chunkRanges )
+                {
+                    if ( before[i] != after[i] )
+                    {
+                        chunkRanges.add( i, i + 1 );
+                    }
+                },
+                []( DirtyRanges value, const DirtyRanges& chunkRanges )
+                {
+                    value.add( chunkRanges );
+                    return value;
+                }, DifferencesGrainSize );
+            add( ranges );
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#include <Core/Containers/DrawQueue.hpp>
+
+#include <Core/CoreMacros.hpp>
+#include <Core/Containers/RadixSort.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace Ra
+{
+    namespace Core
+    {
+        constexpr uint DrawQueue::PassBits;
+        constexpr uint DrawQueue::ShaderBits;
+        constexpr uint DrawQueue::MaterialBits;
+        constexpr uint DrawQueue::DepthBits;
+        constexpr uint DrawQueue::NoGeometry;
+
+        namespace
+        {
+            constexpr uint MaterialShift = DrawQueue::DepthBits;
+            constexpr uint ShaderShift = MaterialShift + DrawQueue::MaterialBits;
+            constexpr uint PassShift = ShaderShift + DrawQueue::ShaderBits;
+            static_assert( PassShift + DrawQueue::PassBits == 64, "Sort keys should have 64 bits." );
+
+            /// Mask of the pass and shader fields, and of the material field.
+            constexpr std::uint64_t ShaderMask = ~std::uint64_t( 0 ) << ShaderShift;
+            constexpr std::uint64_t MaterialMask = ~std::uint64_t( 0 ) << MaterialShift;
+        }
+
+        std::uint64_t DrawQueue::getKey( uint pass, uint shader, uint material, Scalar depth )
+        {
+            CORE_ASSERT( pass < ( 1u << PassBits ), "Too many passes." );
+            CORE_ASSERT( shader < ( 1u << ShaderBits ), "Too many shaders." );
+            CORE_ASSERT( material < ( 1u << MaterialBits ), "Too many materials." );
+            const Scalar maxBucket = Scalar( ( 1u << DepthBits ) - 1 );
+            // Also puts NaN depths in the first bucket.
+            const Scalar bucket = depth > 0 ? std::min( depth, Scalar( 1 ) ) * maxBucket : Scalar( 0 );
+            return std::uint64_t( pass ) << PassShift | std::uint64_t( shader ) << ShaderShift
+                   | std::uint64_t( material ) << MaterialShift | std::uint64_t( bucket );
+        }
+
+        void DrawQueue::clear()
+        {
+            m_keys.clear();
+            m_objects.clear();
+            m_geometries.clear();
+            m_draws.clear();
+            m_shaderBindCount = 0;
+            m_materialBindCount = 0;
+            m_batchCount = 0;
+        }
+
+        void DrawQueue::add( uint object, uint pass, uint shader, uint material, Scalar depth, uint geometry )
+        {
+            m_keys.push_back( getKey( pass, shader, material, depth ) );
+            m_objects.push_back( object );
+            m_geometries.push_back( geometry );
+        }
+
+        void DrawQueue::sort()
+        {
+            m_order.resize( m_keys.size() );
+            std::iota( m_order.begin(), m_order.end(), 0u );
+            radixSort( m_keys, m_order );
+
+            m_draws.resize( m_keys.size() );
+            m_shaderBindCount = 0;
+            m_materialBindCount = 0;
+            m_batchCount = 0;
+            uint runBegin = 0;
+            for ( uint i = 0; i < m_keys.size(); ++i )
+            {
+                const bool bindShader = i == 0 || ( ( m_keys[i] ^ m_keys[i - 1] ) & ShaderMask ) != 0;
+                const bool bindMaterial = bindShader || ( ( m_keys[i] ^ m_keys[i - 1] ) & MaterialMask ) != 0;
+                m_draws[i] = Draw{ m_order[i], bindShader, bindMaterial, 1 };
+                m_shaderBindCount += bindShader ? 1 : 0;
+                m_materialBindCount += bindMaterial ? 1 : 0;
+                if ( bindMaterial && i > 0 )
+                {
+                    batch( runBegin, i );
+                    runBegin = i;
+                }
+            }
+            if ( !m_draws.empty() )
+            {
+                batch( runBegin, uint( m_draws.size() ) );
+            }
+
+            // The draws give back the objects instead of the indices of the added draws.
+            for ( auto& draw : m_draws )
+            {
+                draw.m_object = m_objects[draw.m_object];
+            }
+        }
+
+        void DrawQueue::batch( uint begin, uint end )
+        {
+            // Finds the batch of each draw, numbering the batches by their first draw.
+            m_batches.clear();
+            m_batchSizes.clear();
+            m_drawBatches.resize( end - begin );
+            for ( uint i = begin; i < end; ++i )
+            {
+                const uint geometry = m_geometries[m_draws[i].m_object];
+                const uint batch = geometry == NoGeometry
+                                   ? uint( m_batchSizes.size() )
+                                   : m_batches.emplace( geometry, uint( m_batchSizes.size() ) ).first->second;
+                if ( batch == m_batchSizes.size() )
+                {
+                    m_batchSizes.push_back( 0 );
+                }
+                ++m_batchSizes[batch];
+                m_drawBatches[i - begin] = batch;
+            }
+            m_batchCount += uint( m_batchSizes.size() );
+            if ( m_batchSizes.size() == end - begin )
+            {
+                return;
+            }
+
+            // Stable counting sort of the draws by batch. The first draw, which binds the state,
+            // stays first.
+            m_batchedDraws.assign( m_draws.begin() + begin, m_draws.begin() + end );
+            m_batchOffsets.resize( m_batchSizes.size() );
+            uint offset = begin;
+            for ( uint b = 0; b < m_batchSizes.size(); ++b )
+            {
+                m_batchOffsets[b] = offset;
+                offset += m_batchSizes[b];
+            }
+            for ( uint i = 0; i < m_batchedDraws.size(); ++i )
+            {
+                const uint batch = m_drawBatches[i];
+                const bool first = m_batchSizes[batch] != 0;
+                m_batchedDraws[i].m_instances = first ? m_batchSizes[batch] : 0;
+                m_batchSizes[batch] = 0;
+                m_draws[m_batchOffsets[batch]++] = m_batchedDraws[i];
+            }
+        }
+
+        void DrawQueue::getPassRange( uint pass, uint& begin, uint& end ) const
+        {
+            CORE_ASSERT( m_draws.size() == m_keys.size(), "The queue is not sorted." );
+            const std::uint64_t first = std::uint64_t( pass ) << PassShift;
+            begin = uint( std::lower_bound( m_keys.begin(), m_keys.end(), first ) - m_keys.begin() );
+            end = pass + 1 < ( 1u << PassBits )
+                  ? uint( std::lower_bound( m_keys.begin(), m_keys.end(), first + ( std::uint64_t( 1 ) << PassShift ) )
+                          - m_keys.begin() )
+                  : uint( m_keys.size() );
+        }
+    }
+}
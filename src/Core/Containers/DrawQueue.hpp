@@ -0,0 +1,101 @@
+#ifndef RADIUMENGINE_DRAW_QUEUE_HPP_
+#define RADIUMENGINE_DRAW_QUEUE_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Orders the draws of a frame to limit the state changes of the renderer. Each draw gets
+        /// a 64 bit sort key holding, from the highest bits, its pass, shader, material and depth
+        /// bucket, and the keys are radix sorted. The sorted draws tell whether the shader or the
+        /// material must be bound again. Draws of the same geometry which share their pass, shader
+        /// and material are also gathered in batches, to be rendered as instances. The queue only
+        /// handles indices, without any GL call.
+        class RA_CORE_API DrawQueue
+        {
+        public:
+            /// Bits of the fields of the sort keys.
+            static constexpr uint PassBits = 4;
+            static constexpr uint ShaderBits = 14;
+            static constexpr uint MaterialBits = 22;
+            static constexpr uint DepthBits = 24;
+
+            /// Geometry of the draws which are never batched.
+            static constexpr uint NoGeometry = ~0u;
+
+            /// Draw of a sorted queue.
+            struct Draw
+            {
+                uint m_object;
+                /// True when the shader differs from the one of the previous draw, or for the
+                /// first draw of a pass.
+                bool m_bindShader;
+                /// True when the shader or the material differ from the ones of the previous draw.
+                bool m_bindMaterial;
+                /// Number of draws of the batch starting with this draw, which all have its
+                /// geometry, or 0 when the draw belongs to the batch of a previous draw.
+                uint m_instances;
+            };
+
+        public:
+            /// Returns the sort key of a draw. Depths in [0, 1] are quantised in buckets, the
+            /// draws of the same pass, shader and material being sorted front to back.
+            static std::uint64_t getKey( uint pass, uint shader, uint material, Scalar depth );
+
+            /// Removes all the draws.
+            void clear();
+
+            /// Adds the draw of an object, which is the index given back by the sorted draws.
+            /// Draws of the same geometry, other than NoGeometry, may be batched.
+            void add( uint object, uint pass, uint shader, uint material, Scalar depth,
+                      uint geometry = NoGeometry );
+
+            /// Sorts the draws added since the last clear(), and finds their state changes and
+            /// batches. The batches of the draws with the same pass, shader and material are
+            /// ordered by their first draw, so that they are still drawn roughly front to back.
+            void sort();
+
+            /// Returns the sorted draws.
+            inline const std::vector<Draw>& getDraws() const { return m_draws; }
+
+            /// Returns the range [begin, end) of the sorted draws of a pass.
+            void getPassRange( uint pass, uint& begin, uint& end ) const;
+
+            /// Returns the number of shader and material binds of the sorted draws.
+            inline uint getShaderBindCount() const { return m_shaderBindCount; }
+            inline uint getMaterialBindCount() const { return m_materialBindCount; }
+
+            /// Returns the number of batches of the sorted draws, i.e. of draw calls.
+            inline uint getBatchCount() const { return m_batchCount; }
+
+        private:
+            /// Gathers the draws of each geometry in the sorted draws [begin, end).
+            void batch( uint begin, uint end );
+
+        private:
+            std::vector<std::uint64_t> m_keys;
+            std::vector<uint> m_order;
+            std::vector<uint> m_objects;
+            std::vector<uint> m_geometries;
+            std::vector<Draw> m_draws;
+            uint m_shaderBindCount = 0;
+            uint m_materialBindCount = 0;
+            uint m_batchCount = 0;
+
+            /// Batch of each geometry and scratch arrays of batch().
+            std::unordered_map<uint, uint> m_batches;
+            std::vector<uint> m_batchSizes;
+            std::vector<uint> m_batchOffsets;
+            std::vector<uint> m_drawBatches;
+            std::vector<Draw> m_batchedDraws;
+        };
+    }
+}
+
+#endif // RADIUMENGINE_DRAW_QUEUE_HPP_
@@ -0,0 +1,100 @@
+#include <Core/Containers/RadixSort.hpp>
+
+#include <Core/CoreMacros.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <algorithm>
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace
+        {
+            /// Number of bits sorted by each counting sort.
+            constexpr uint RadixBits = 8;
+            constexpr uint NumBuckets = 1u << RadixBits;
+            /// Smallest number of entries sorted by a single thread.
+            constexpr uint MinGrainSize = 4096;
+
+            struct SortEntry
+            {
+                std::uint64_t m_key;
+                uint m_value;
+            };
+        }
+
+        void radixSort( std::vector<std::uint64_t>& keys, std::vector<uint>& values, uint keyBits )
+        {
+            CORE_ASSERT( keys.size() == values.size(), "Each key must have a value." );
+            CORE_ASSERT( keyBits <= 64, "Keys have 64 bits." );
+            const uint size = uint( keys.size() );
+            if ( size < 2 )
+            {
+                return;
+            }
+
+            // All the passes split the entries in the same chunks, each chunk counting its
+            // keys and then writing them after the keys of the same bucket of the chunks before it.
+            const uint defaultChunks = getParallelChunkCount( 0, size, 0 );
+            const uint grainSize = std::max( MinGrainSize, ( size + defaultChunks - 1 ) / defaultChunks );
+            const uint numChunks = getParallelChunkCount( 0, size, grainSize );
+
+            std::vector<SortEntry> entries( size );
+            std::vector<SortEntry> sorted( size );
+            parallelFor( 0, size, [&]( uint i )
+            {
+                entries[i] = SortEntry{ keys[i], values[i] };
+            }, grainSize );
+
+            std::vector<uint> offsets( numChunks * NumBuckets );
+            for ( uint shift = 0; shift < keyBits; shift += RadixBits )
+            {
+                parallelRange( 0, size, grainSize, [&]( uint chunk, uint begin, uint end )
+                {
+                    uint* counts = &offsets[chunk * NumBuckets];
+                    std::fill( counts, counts + NumBuckets, 0 );
+                    for ( uint i = begin; i < end; ++i )
+                    {
+                        ++counts[( entries[i].m_key >> shift ) & ( NumBuckets - 1 )];
+                    }
+                } );
+
+                uint offset = 0;
+                bool sortedPass = false;
+                for ( uint b = 0; b < NumBuckets && !sortedPass; ++b )
+                {
+                    const uint first = offset;
+                    for ( uint c = 0; c < numChunks; ++c )
+                    {
+                        const uint count = offsets[c * NumBuckets + b];
+                        offsets[c * NumBuckets + b] = offset;
+                        offset += count;
+                    }
+                    sortedPass = offset - first == size;
+                }
+                if ( sortedPass )
+                {
+                    // All the keys have the same byte : the entries are already in order.
+                    continue;
+                }
+
+                parallelRange( 0, size, grainSize, [&]( uint chunk, uint begin, uint end )
+                {
+                    uint* next = &offsets[chunk * NumBuckets];
+                    for ( uint i = begin; i < end; ++i )
+                    {
+                        sorted[next[( entries[i].m_key >> shift ) & ( NumBuckets - 1 )]++] = entries[i];
+                    }
+                } );
+                entries.swap( sorted );
+            }
+
+            parallelFor( 0, size, [&]( uint i )
+            {
+                keys[i] = entries[i].m_key;
+                values[i] = entries[i].m_value;
+            }, grainSize );
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef RADIUMENGINE_RADIX_SORT_HPP_
+#define RADIUMENGINE_RADIX_SORT_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Sorts values by their integer key, in place. Only the keyBits low bits of the keys
+        /// are sorted, from the lowest to the highest byte, with counting sorts run in parallel
+        /// with parallelRange(). The sort is stable : values with equal keys keep their order.
+        /// Bytes whose value is the same for all the keys are skipped.
+        RA_CORE_API void radixSort( std::vector<std::uint64_t>& keys, std::vector<uint>& values,
+                                    uint keyBits = 64 );
+    }
+}
+
+#endif // RADIUMENGINE_RADIX_SORT_HPP_
@@ -1,6 +1,10 @@
 #include <Core/Geometry/Mapping/MappingOperation.hpp>
 #include <Core/Geometry/Triangle/TriangleOperation.hpp>
+#include <Core/Geometry/Distance/DistanceQueries.hpp>
 #include <Core/Log/Log.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <limits>
 
 namespace Ra {
 namespace Core {
@@ -56,43 +60,72 @@ bool isAllBoundToElement( const Parametrization& param ) {
 
 
 
+namespace {
+
+// Maps the vertex v on the triangle t of the mesh.
+inline Mapping mapOnTriangle( const Vector3& v, const TriangleMesh& mesh, const uint t ) {
+    const Vector3& t0 = mesh.m_vertices[mesh.m_triangles[t][0]];
+    const Vector3& t1 = mesh.m_vertices[mesh.m_triangles[t][1]];
+    const Vector3& t2 = mesh.m_vertices[mesh.m_triangles[t][2]];
+    const Vector3  n  = triangleNormal( t0, t1, t2 );
+    const Plane3   plane( n, t0 );
+    const Vector3  p  = plane.projection( v );
+    const Scalar   d  = plane.signedDistance( v );
+    const Vector3  b  = barycentricCoordinate( p, t0, t1, t2 );
+    return Mapping( b[0], b[1], d, Index( t ) );
+}
+
+} // namespace
+
+
+
 void findParametrization( const TriangleMesh& source, const TriangleMesh& target, Parametrization& param ) {
+    TriangleKdTree tree;
+    tree.build( target );
+    findParametrization( source, target, tree, param );
+}
+
+
+
+void findParametrization( const TriangleMesh& source, const TriangleMesh& target, const TriangleKdTree& tree,
+                          Parametrization& param, const Scalar tolerance ) {
     const uint size = source.m_vertices.size();
     param.clear();
     param.resize( size );
-#if defined(CORE_USE_OMP)
-    #pragma omp parallel for
-#endif
-    for( uint i = 0; i < size; ++i ) {
+    parallelFor( 0, size, [&]( uint i ) {
         const Vector3& v = source.m_vertices[i];
-        Mapping map;
+        const TriangleKdTree::ClosestPoint closest =
+            tree.getClosestPoint( target, v, std::numeric_limits<Scalar>::max(), tolerance );
+        if( closest.m_triangle >= 0 ) {
+            param[i] = mapOnTriangle( v, target, uint( closest.m_triangle ) );
+        }
+    } );
+}
+
+
+
+void findParametrizationLinear( const TriangleMesh& source, const TriangleMesh& target, Parametrization& param ) {
+    const uint size = source.m_vertices.size();
+    param.clear();
+    param.resize( size );
+    parallelFor( 0, size, [&]( uint i ) {
+        const Vector3& v = source.m_vertices[i];
+        int    closest = -1;
+        Scalar best    = std::numeric_limits<Scalar>::max();
         for( uint t = 0; t < target.m_triangles.size(); ++t ) {
             const Vector3& t0 = target.m_vertices[target.m_triangles[t][0]];
             const Vector3& t1 = target.m_vertices[target.m_triangles[t][1]];
             const Vector3& t2 = target.m_vertices[target.m_triangles[t][2]];
-            const Vector3  n  = triangleNormal( t0, t1, t2 );
-            const Plane3   plane( n, t0 );
-            const Vector3  p  = plane.projection( v );
-            const Scalar   d  = plane.signedDistance( v );
-            const Vector3  b  = barycentricCoordinate( p, t0, t1, t2 );
-            //if( ( b[0] >= 0.0 ) && ( b[1] >= 0.0 ) && ( b[2] >= 0.0 ) ) {
-                if( map.isBoundToElement() ) {
-                    if( std::abs( d ) < std::abs( map.getDelta() ) ) {
-                        map.setID( Index( t ) );
-                        map.setDelta( d );
-                        map.setAlpha( b[0] );
-                        map.setBeta( b[1] );
-                    }
-                } else {
-                    map.setID( Index( t ) );
-                    map.setDelta( d );
-                    map.setAlpha( b[0] );
-                    map.setBeta( b[1] );
-                }
-            //}
+            const Scalar   d  = DistanceQueries::pointToTriSq( v, t0, t1, t2 ).distanceSquared;
+            if( d < best || closest < 0 ) {
+                best    = d;
+                closest = int( t );
+            }
         }
-        param[i] = map;
-    }
+        if( closest >= 0 ) {
+            param[i] = mapOnTriangle( v, target, uint( closest ) );
+        }
+    } );
 }
 
 
@@ -100,10 +133,7 @@ void findParametrization( const TriangleMesh& source, const TriangleMesh& target
 void applyParametrization( const TriangleMesh& inMesh, const Parametrization& param, Vector3Array& outPoint, const bool FORCE_DISPLACEMENT_TO_ZERO ) {
     const uint size = param.size();
     outPoint.resize( size, Vector3::Zero() );
-#if defined(CORE_USE_OMP)
-    #pragma omp parallel for
-#endif
-    for( uint v = 0; v < size; ++v ) {
+    parallelFor( 0, size, [&]( uint v ) {
         const Mapping map   = param[v];
         //const Scalar  alpha = map.getAlpha();
         //const Scalar  beta  = map.getBeta();
@@ -121,7 +151,7 @@ void applyParametrization( const TriangleMesh& inMesh, const Parametrization& pa
         const Vector3 n     = triangleNormal( p0, p1, p2 ); //( alpha * n0 ) + ( beta * n1 ) + ( gamma * n2 );
         const Vector3 N     = ( FORCE_DISPLACEMENT_TO_ZERO ) ? Vector3::Zero() : n;
         outPoint[v] = map.getPoint( p0, p1, p2, N );
-    }
+    } );
 }
 
 
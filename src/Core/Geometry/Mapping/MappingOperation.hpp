@@ -3,6 +3,7 @@
 
 #include <Core/Mesh/TriangleMesh.hpp>
 #include <Core/Geometry/Mapping/Mapping.hpp>
+#include <Core/TreeStructures/TriangleKdTree.hpp>
 
 namespace Ra {
 namespace Core {
@@ -12,7 +13,22 @@ bool isAllFinite( const Parametrization& param );
 bool isAllInside( const Parametrization& param );
 bool isAllBoundToElement( const Parametrization& param );
 
+/// Maps each vertex of source on the closest triangle of target : the mapping stores the barycentric
+/// coordinates of the projection of the vertex on the plane of the triangle, and the signed distance
+/// of the vertex to this plane. Ties are broken by the lowest triangle index.
+/// The closest triangles are found with a TriangleKdTree of target, vertices are processed in
+/// parallel (see Core::parallelFor()).
 void findParametrization( const TriangleMesh& source, const TriangleMesh& target, Parametrization& param );
+
+/// Same as above, with a tree already built from target. If tolerance is positive, a vertex
+/// is mapped on the first triangle found at a distance of at most tolerance, which may not be
+/// the closest one.
+void findParametrization( const TriangleMesh& source, const TriangleMesh& target, const TriangleKdTree& tree,
+                          Parametrization& param, const Scalar tolerance = 0 );
+
+/// Same as findParametrization(), testing each vertex against all the triangles in O(V.T).
+/// Gives exactly the same mapping, it is kept as a reference.
+void findParametrizationLinear( const TriangleMesh& source, const TriangleMesh& target, Parametrization& param );
 void applyParametrization( const TriangleMesh& inMesh, const Parametrization& param, Vector3Array& outPoint, const bool FORCE_DISPLACEMENT_TO_ZERO = false );
 
 void print( const Mapping& map );
@@ -4,11 +4,17 @@
 #include <Core/Geometry/Triangle/TriangleOperation.hpp>
 
 #include <Core/Time/Timer.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
 
 namespace Ra {
 namespace Core {
 namespace Geometry {
 
+namespace {
+/// Number of normals processed by a thread in a row.
+constexpr uint NormalGrainSize = 1024;
+}
+
 //////////////
 /// GLOBAL ///
 //////////////
@@ -31,12 +37,11 @@ void uniformNormal( const VectorArray< Vector3 >& p, const VectorArray< Triangle
         normal[k] += triN;
     }
 
-    #pragma omp parallel for
-    for( uint i = 0; i < N; ++i ) {
+    parallelFor( 0, N, [&normal]( uint i ) {
         if( !normal[i].isApprox( Vector3::Zero() ) ) {
             normal[i].normalize();
         }
-    }
+    }, NormalGrainSize );
 }
 
 
@@ -61,17 +66,15 @@ void uniformNormal( const VectorArray< Vector3 >& p,
         normal[k] += triN;
     }
 
-    #pragma omp parallel for
-    for( uint i = 0; i < N; ++i ) {
+    parallelFor( 0, N, [&normal]( uint i ) {
         if( !normal[i].isApprox( Vector3::Zero() ) ) {
             normal[i].normalize();
         }
-    }
+    }, NormalGrainSize );
 
-    #pragma omp parallel for
-    for( uint i = 0; i < N; ++i ) {
+    parallelFor( 0, N, [&]( uint i ) {
         normal[i] = normal[ duplicateTable[i] ];
-    }
+    }, NormalGrainSize );
 }
 
 
@@ -0,0 +1,66 @@
+#include <Core/Geometry/PointCloud/PointCloud.hpp>
+#include <Core/Geometry/PointCloud/PointHashGrid.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace PointCloud
+        {
+            void estimateNormals(const Vector3Array& pts, Vector3Array& normalsOut, uint k)
+            {
+                PointHashGrid grid;
+                grid.build(pts);
+                estimateNormals(pts, grid, normalsOut, k);
+            }
+
+            void estimateNormals(const Vector3Array& pts, const PointHashGrid& grid,
+                                 Vector3Array& normalsOut, uint k)
+            {
+                CORE_ASSERT(k > 0, "Normals need at least one neighbour.");
+                normalsOut.resize(pts.size());
+                if (pts.size() == 0)
+                {
+                    return;
+                }
+                const Vector3 center = meanPoint(pts);
+
+                parallelRange(0, pts.size(), 0, [&](uint, uint begin, uint end)
+                {
+                    // The neighbours are reused by all the points of the chunk.
+                    std::vector<PointHashGrid::Neighbour> neighbours;
+                    for (uint i = begin; i < end; ++i)
+                    {
+                        grid.getNearestPoints(pts[i], k, neighbours);
+
+                        Vector3 mean = Vector3::Zero();
+                        for (const auto& n : neighbours)
+                        {
+                            mean += pts[n.m_index];
+                        }
+                        mean /= Scalar(neighbours.size());
+
+                        Matrix3 covariance = Matrix3::Zero();
+                        for (const auto& n : neighbours)
+                        {
+                            const Vector3 d = pts[n.m_index] - mean;
+                            covariance += d * d.transpose();
+                        }
+
+                        // Eigen values are sorted in increasing order.
+                        Eigen::SelfAdjointEigenSolver<Matrix3> solver(covariance);
+                        Vector3 normal = solver.eigenvectors().col(0);
+                        if (normal.dot(pts[i] - center) < 0)
+                        {
+                            normal = -normal;
+                        }
+                        normalsOut[i] = normal;
+                    }
+                });
+            }
+        }
+    }
+}
@@ -14,6 +14,8 @@ namespace Ra
 {
     namespace Core
     {
+        class PointHashGrid;
+
         /// This file contains functions operating on any unstructured set of points.
         /// If not stated otherwise the functions behaviour is undefined if the set
         /// of points is empty.
@@ -36,6 +38,15 @@ namespace Ra
             /// Computes an oriented bounding box based on PCA of the points coordinates.
             RA_CORE_API inline Obb pcaObb(const Vector3Array& pts);
 
+            /// Estimates the normal of each point as the direction of least variance of its
+            /// k nearest neighbours (the point included). Normals are oriented away from the
+            /// barycenter of the set of points. Points are processed in parallel.
+            RA_CORE_API void estimateNormals(const Vector3Array& pts, Vector3Array& normalsOut, uint k = 10);
+
+            /// Same as above, with a grid already built from the points.
+            RA_CORE_API void estimateNormals(const Vector3Array& pts, const PointHashGrid& grid,
+                                             Vector3Array& normalsOut, uint k = 10);
+
         }
     }
 }
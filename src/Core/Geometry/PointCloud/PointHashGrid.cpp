@@ -0,0 +1,476 @@
+#include <Core/Geometry/PointCloud/PointHashGrid.hpp>
+
+#include <Core/Containers/RadixSort.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Ra
+{
+    namespace Core
+    {
+        constexpr uint PointHashGrid::TargetCellSize;
+        constexpr int PointHashGrid::MaxResolution;
+
+        namespace
+        {
+            typedef PointHashGrid::Neighbour Neighbour;
+
+            /// Spreads the 21 low bits of x so that they are 3 bits apart.
+            inline std::uint64_t spreadBits( std::uint64_t x )
+            {
+                x &= 0x1fffff;
+                x = ( x | x << 32 ) & 0x1f00000000ffffull;
+                x = ( x | x << 16 ) & 0x1f0000ff0000ffull;
+                x = ( x | x << 8 ) & 0x100f00f00f00f00full;
+                x = ( x | x << 4 ) & 0x10c30c30c30c30c3ull;
+                x = ( x | x << 2 ) & 0x1249249249249249ull;
+                return x;
+            }
+
+            /// Inverse of spreadBits().
+            inline int compactBits( std::uint64_t x )
+            {
+                x &= 0x1249249249249249ull;
+                x = ( x | x >> 2 ) & 0x10c30c30c30c30c3ull;
+                x = ( x | x >> 4 ) & 0x100f00f00f00f00full;
+                x = ( x | x >> 8 ) & 0x1f0000ff0000ffull;
+                x = ( x | x >> 16 ) & 0x1f00000000ffffull;
+                x = ( x | x >> 32 ) & 0x1fffff;
+                return int( x );
+            }
+
+            inline std::uint64_t getMortonCode( const Vector3i& cell )
+            {
+                return spreadBits( std::uint64_t( cell[0] ) ) | spreadBits( std::uint64_t( cell[1] ) ) << 1
+                       | spreadBits( std::uint64_t( cell[2] ) ) << 2;
+            }
+
+            inline uint getSlot( std::uint64_t key, uint shift )
+            {
+                return uint( ( key * 0x9e3779b97f4a7c15ull ) >> shift );
+            }
+
+            /// Order of the k nearest points query : by distance, then by index.
+            inline bool isCloser( const Neighbour& a, const Neighbour& b )
+            {
+                return a.m_squaredDistance < b.m_squaredDistance
+                       || ( a.m_squaredDistance == b.m_squaredDistance && a.m_index < b.m_index );
+            }
+        }
+
+        void PointHashGrid::build( const VectorArray<Vector3>& points, Scalar cellSize )
+        {
+            clear();
+            const uint numPoints = points.size();
+            if ( numPoints == 0 )
+            {
+                return;
+            }
+
+            Aabb bounds;
+            for ( const auto& p : points )
+            {
+                bounds.extend( p );
+            }
+            const Vector3 extent = bounds.sizes();
+
+            if ( !( cellSize > 0 ) )
+            {
+                // A surface in the box has about the area of half the faces of the box.
+                const Scalar area = extent.x() * extent.y() + extent.y() * extent.z() + extent.z() * extent.x();
+                cellSize = area > 0 ? std::sqrt( area * TargetCellSize / numPoints )
+                                    : extent.maxCoeff() * TargetCellSize / numPoints;
+            }
+            cellSize = std::max( cellSize, extent.maxCoeff() / Scalar( MaxResolution - 1 ) );
+            if ( !( cellSize > 0 ) )
+            {
+                cellSize = 1;
+            }
+
+            m_origin = bounds.min();
+            m_cellSize = cellSize;
+            m_invCellSize = 1 / cellSize;
+            m_margin = 16 * std::numeric_limits<Scalar>::epsilon()
+                       * ( m_origin.cwiseAbs().maxCoeff() + extent.maxCoeff() + cellSize );
+            for ( uint k = 0; k < 3; ++k )
+            {
+                m_resolution[k] = std::min( int( extent[k] * m_invCellSize ) + 1, MaxResolution );
+            }
+
+            std::vector<std::uint64_t> keys( numPoints );
+            std::vector<uint> order( numPoints );
+            parallelFor( 0, numPoints, [&]( uint i )
+            {
+                keys[i] = getMortonCode( getCell( points[i] ) );
+                order[i] = i;
+            } );
+
+            // The sort is stable : the points of a cell stay in index order.
+            uint bits = 1;
+            while ( ( 1 << bits ) < m_resolution.maxCoeff() )
+            {
+                ++bits;
+            }
+            radixSort( keys, order, 3 * bits );
+
+            m_points.resize( numPoints );
+            m_indices.resize( numPoints );
+            for ( uint i = 0; i < numPoints; ++i )
+            {
+                if ( i == 0 || keys[i] != keys[i - 1] )
+                {
+                    m_keys.push_back( keys[i] );
+                    m_offsets.push_back( i );
+                }
+                m_indices[i] = order[i];
+                m_points[i] = points[order[i]];
+            }
+            m_offsets.push_back( numPoints );
+
+            // The table is at most half full.
+            uint tableBits = 1;
+            while ( ( 1u << tableBits ) < 2 * m_keys.size() )
+            {
+                ++tableBits;
+            }
+            m_tableShift = 64 - tableBits;
+            m_table.assign( 1u << tableBits, 0 );
+            const uint mask = ( 1u << tableBits ) - 1;
+            for ( uint c = 0; c < m_keys.size(); ++c )
+            {
+                uint slot = getSlot( m_keys[c], m_tableShift );
+                while ( m_table[slot] != 0 )
+                {
+                    slot = ( slot + 1 ) & mask;
+                }
+                m_table[slot] = c + 1;
+            }
+        }
+
+        void PointHashGrid::clear()
+        {
+            m_cellSize = 0;
+            m_invCellSize = 0;
+            m_keys.clear();
+            m_offsets.clear();
+            m_table.clear();
+            m_points.clear();
+            m_indices.clear();
+        }
+
+        Vector3i PointHashGrid::getCell( const Vector3& p ) const
+        {
+            Vector3i cell;
+            for ( uint k = 0; k < 3; ++k )
+            {
+                const Scalar x = ( p[k] - m_origin[k] ) * m_invCellSize;
+                cell[k] = !( x >= 0 ) ? -1 : x >= Scalar( m_resolution[k] ) ? m_resolution[k] : int( x );
+            }
+            return cell;
+        }
+
+        int PointHashGrid::findCell( const Vector3i& cell ) const
+        {
+            if ( m_keys.empty() || ( cell.array() < 0 ).any() || ( cell.array() >= m_resolution.array() ).any() )
+            {
+                return -1;
+            }
+            const std::uint64_t key = getMortonCode( cell );
+            const uint mask = uint( m_table.size() - 1 );
+            for ( uint slot = getSlot( key, m_tableShift ); m_table[slot] != 0; slot = ( slot + 1 ) & mask )
+            {
+                if ( m_keys[m_table[slot] - 1] == key )
+                {
+                    return int( m_table[slot] - 1 );
+                }
+            }
+            return -1;
+        }
+
+        Vector3i PointHashGrid::getCellCoordinates( uint c ) const
+        {
+            const std::uint64_t key = m_keys[c];
+            return Vector3i( compactBits( key ), compactBits( key >> 1 ), compactBits( key >> 2 ) );
+        }
+
+        template <typename Func>
+        inline void PointHashGrid::forEachCell( const Vector3i& lo, const Vector3i& hi, const Func& f ) const
+        {
+            const Vector3i first = lo.cwiseMax( Vector3i::Zero() );
+            const Vector3i last = hi.cwiseMin( m_resolution - Vector3i::Ones() );
+            if ( ( first.array() > last.array() ).any() )
+            {
+                return;
+            }
+
+            // Large ranges are faster to filter from the list of the occupied cells.
+            const Vector3i size = last - first + Vector3i::Ones();
+            if ( double( size[0] ) * double( size[1] ) * double( size[2] ) > double( m_keys.size() ) )
+            {
+                for ( uint c = 0; c < m_keys.size(); ++c )
+                {
+                    const Vector3i cell = getCellCoordinates( c );
+                    if ( ( cell.array() >= first.array() ).all() && ( cell.array() <= last.array() ).all() )
+                    {
+                        f( c );
+                    }
+                }
+                return;
+            }
+
+            for ( int x = first[0]; x <= last[0]; ++x )
+            {
+                for ( int y = first[1]; y <= last[1]; ++y )
+                {
+                    for ( int z = first[2]; z <= last[2]; ++z )
+                    {
+                        const int c = findCell( Vector3i( x, y, z ) );
+                        if ( c >= 0 )
+                        {
+                            f( uint( c ) );
+                        }
+                    }
+                }
+            }
+        }
+
+        void PointHashGrid::getPointsInRadius( const Vector3& q, Scalar radius, std::vector<uint>& pointsOut ) const
+        {
+            pointsOut.clear();
+            if ( !( radius >= 0 ) )
+            {
+                return;
+            }
+
+            const Scalar squaredRadius = radius * radius;
+            const Vector3 reach = Vector3::Constant( radius + m_margin );
+            forEachCell( getCell( q - reach ), getCell( q + reach ), [&]( uint c )
+            {
+                for ( uint i = m_offsets[c]; i < m_offsets[c + 1]; ++i )
+                {
+                    if ( ( m_points[i] - q ).squaredNorm() <= squaredRadius )
+                    {
+                        pointsOut.push_back( m_indices[i] );
+                    }
+                }
+            } );
+            std::sort( pointsOut.begin(), pointsOut.end() );
+        }
+
+        void PointHashGrid::getNearestPoints( const Vector3& q, uint k, std::vector<Neighbour>& neighboursOut ) const
+        {
+            neighboursOut.resize( k );
+            uint count = 0;
+
+            // The neighbours are kept in a heap whose top is the farthest one.
+            auto visit = [&]( uint c )
+            {
+                for ( uint i = m_offsets[c]; i < m_offsets[c + 1]; ++i )
+                {
+                    const Neighbour neighbour( int( m_indices[i] ), ( m_points[i] - q ).squaredNorm() );
+                    if ( count < k )
+                    {
+                        neighboursOut[count++] = neighbour;
+                        std::push_heap( neighboursOut.begin(), neighboursOut.begin() + count, isCloser );
+                    }
+                    else if ( isCloser( neighbour, neighboursOut[0] ) )
+                    {
+                        std::pop_heap( neighboursOut.begin(), neighboursOut.end(), isCloser );
+                        neighboursOut[k - 1] = neighbour;
+                        std::push_heap( neighboursOut.begin(), neighboursOut.end(), isCloser );
+                    }
+                }
+            };
+
+            // Visit the rings of cells around the cell of q, until the points of the next
+            // rings cannot be closer than the k-th neighbour.
+            const Vector3i center = getCell( q ).cwiseMax( Vector3i::Zero() ).cwiseMin( m_resolution - Vector3i::Ones() );
+            const int lastRing = ( center.cwiseMax( m_resolution - Vector3i::Ones() - center ) ).maxCoeff();
+            for ( int r = 0; k > 0 && !m_keys.empty() && r <= lastRing; ++r )
+            {
+                const double ringSize = std::pow( 2.0 * r + 1, 3 ) - std::pow( 2.0 * r - 1, 3 );
+                if ( r > 0 && ringSize > double( m_keys.size() ) )
+                {
+                    // Visit all the remaining cells at once.
+                    for ( uint c = 0; c < m_keys.size(); ++c )
+                    {
+                        if ( ( getCellCoordinates( c ) - center ).cwiseAbs().maxCoeff() >= r )
+                        {
+                            visit( c );
+                        }
+                    }
+                    break;
+                }
+
+                for ( int x = -r; x <= r; ++x )
+                {
+                    for ( int y = -r; y <= r; ++y )
+                    {
+                        // Inside the ring, only the cells on the faces of the block are visited.
+                        const bool side = std::abs( x ) == r || std::abs( y ) == r;
+                        const int step = side || r == 0 ? 1 : 2 * r;
+                        for ( int z = -r; z <= r; z += step )
+                        {
+                            const int c = findCell( center + Vector3i( x, y, z ) );
+                            if ( c >= 0 )
+                            {
+                                visit( uint( c ) );
+                            }
+                        }
+                    }
+                }
+
+                if ( count == k )
+                {
+                    // Distance from q to the outside of the block of the visited rings.
+                    Scalar bound = std::numeric_limits<Scalar>::max();
+                    for ( uint a = 0; a < 3; ++a )
+                    {
+                        const Scalar lo = m_origin[a] + Scalar( center[a] - r ) * m_cellSize;
+                        const Scalar hi = m_origin[a] + Scalar( center[a] + r + 1 ) * m_cellSize;
+                        bound = std::min( bound, std::min( q[a] - lo, hi - q[a] ) - m_margin );
+                    }
+                    if ( bound > 0 && neighboursOut[0].m_squaredDistance < bound * bound )
+                    {
+                        break;
+                    }
+                }
+            }
+
+            std::sort_heap( neighboursOut.begin(), neighboursOut.begin() + count, isCloser );
+            neighboursOut.resize( count );
+        }
+
+        int PointHashGrid::getNearestToRay( const Ray& ray ) const
+        {
+            if ( m_keys.empty() )
+            {
+                return -1;
+            }
+
+            Scalar best = std::numeric_limits<Scalar>::max();
+            int nearest = -1;
+            auto visit = [&]( uint c )
+            {
+                for ( uint i = m_offsets[c]; i < m_offsets[c + 1]; ++i )
+                {
+                    const Scalar d = ray.squaredDistance( m_points[i] );
+                    const int index = int( m_indices[i] );
+                    if ( d < best || ( d == best && index < nearest ) )
+                    {
+                        best = d;
+                        nearest = index;
+                    }
+                }
+            };
+
+            const Vector3& o = ray.origin();
+            const Vector3& dir = ray.direction();
+            uint axis;
+            dir.cwiseAbs().maxCoeff( &axis );
+
+            // Marches the slices of cells along the main axis of the ray, visiting the cells crossed
+            // by the ray, which hold points close to it if the ray passes through the cloud.
+            auto march = [&]()
+            {
+                const Vector3 reach = Vector3::Constant( m_margin );
+                for ( int s = 0; s < m_resolution[axis]; ++s )
+                {
+                    const Scalar x0 = m_origin[axis] + Scalar( s ) * m_cellSize;
+                    const Scalar t0 = ( x0 - o[axis] ) / dir[axis];
+                    const Scalar t1 = ( x0 + m_cellSize - o[axis] ) / dir[axis];
+                    const Vector3 p0 = ray.pointAt( t0 );
+                    const Vector3 p1 = ray.pointAt( t1 );
+                    Vector3i lo = getCell( p0.cwiseMin( p1 ) - reach );
+                    Vector3i hi = getCell( p0.cwiseMax( p1 ) + reach );
+                    lo[axis] = s;
+                    hi[axis] = s;
+                    forEachCell( lo, hi, visit );
+                }
+            };
+
+            // Lower bound of the squared distance of the points of a block of cells to the ray, lowered
+            // by the rounding error of the distances as in PointKdTree::getNearestToRay().
+            constexpr Scalar tolerance = 8 * std::numeric_limits<Scalar>::epsilon();
+            auto getBound = [&]( int level, uint c )
+            {
+                Vector3i corner = getCellCoordinates( c );
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    corner[k] = corner[k] >> level << level;
+                }
+                const Scalar size = Scalar( 1 << level ) * m_cellSize;
+                const Vector3 center = m_origin + corner.cast<Scalar>() * m_cellSize + Vector3::Constant( size / 2 );
+                const Scalar radius = Scalar( 0.87 ) * size + m_margin;
+                const Scalar distance = std::sqrt( ray.squaredDistance( center ) ) - radius;
+                const Scalar range = ( center - o ).norm() + radius;
+                return distance > 0 ? distance * distance - tolerance * range * range : Scalar( 0 );
+            };
+
+            // Best-first search of the blocks of 2^level cells along each axis. The Morton codes of
+            // the cells of a block share their high bits, so the block is a range of m_keys.
+            struct Block
+            {
+                Scalar m_bound;
+                int m_level;
+                uint m_begin;
+                uint m_end;
+            };
+            auto searchBlocks = [&]()
+            {
+                int topLevel = 0;
+                while ( ( 1 << topLevel ) < m_resolution.maxCoeff() )
+                {
+                    ++topLevel;
+                }
+                auto isFarther = []( const Block& a, const Block& b ) { return a.m_bound > b.m_bound; };
+                std::vector<Block> blocks( 1, Block{ 0, topLevel, 0, uint( m_keys.size() ) } );
+                while ( !blocks.empty() )
+                {
+                    std::pop_heap( blocks.begin(), blocks.end(), isFarther );
+                    const Block block = blocks.back();
+                    blocks.pop_back();
+                    if ( block.m_bound > best )
+                    {
+                        break;
+                    }
+                    if ( block.m_end - block.m_begin == 1 )
+                    {
+                        visit( block.m_begin );
+                        continue;
+                    }
+
+                    const int level = block.m_level - 1;
+                    const uint shift = 3 * uint( level );
+                    for ( uint begin = block.m_begin; begin < block.m_end; )
+                    {
+                        const std::uint64_t prefix = m_keys[begin] >> shift;
+                        const uint end = uint( std::upper_bound( m_keys.begin() + begin, m_keys.begin() + block.m_end, prefix,
+                                                                 [shift]( std::uint64_t p, std::uint64_t key )
+                                                                 {
+                                                                     return p < key >> shift;
+                                                                 } ) - m_keys.begin() );
+                        const Scalar bound = getBound( level, begin );
+                        if ( bound <= best )
+                        {
+                            blocks.push_back( Block{ bound, level, begin, end } );
+                            std::push_heap( blocks.begin(), blocks.end(), isFarther );
+                        }
+                        begin = end;
+                    }
+                }
+            };
+
+            // The cells crossed by the ray give a first point, whose distance prunes the blocks.
+            if ( dir[axis] != 0 )
+            {
+                march();
+            }
+            searchBlocks();
+            return nearest;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef RADIUMENGINE_POINT_HASH_GRID_HPP_
+#define RADIUMENGINE_POINT_HASH_GRID_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Math/Ray.hpp>
+#include <Core/Containers/VectorArray.hpp>
+#include <Core/Containers/AlignedStdVector.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Sparse uniform grid of a point cloud. Only the occupied cells are stored : they are
+        /// sorted by the Morton code of their coordinates, and a hash table maps a Morton code
+        /// to its cell. The grid keeps a copy of the points, sorted by cell, so that the points
+        /// of a cell are contiguous in memory.
+        /// All the queries give the results of a linear scan of the points, ties being broken
+        /// by the lowest index.
+        class RA_CORE_API PointHashGrid
+        {
+        public:
+            /// Result of a k nearest points query.
+            struct Neighbour
+            {
+                Neighbour() : m_index( -1 ), m_squaredDistance( std::numeric_limits<Scalar>::max() ) {}
+                Neighbour( int index, Scalar squaredDistance )
+                    : m_index( index ), m_squaredDistance( squaredDistance ) {}
+
+                int m_index;                /// Index of the point in the cloud, -1 if there is none.
+                Scalar m_squaredDistance;   /// Squared distance to the query point.
+            };
+
+            /// Average number of points of the occupied cells when build() chooses the cell size.
+            static constexpr uint TargetCellSize = 8;
+            /// Maximum number of cells along an axis, so that Morton codes fit in 63 bits.
+            static constexpr int MaxResolution = 1 << 21;
+
+        public:
+            PointHashGrid() = default;
+
+            /// Builds the grid of the points, sorting them by cell with radixSort().
+            /// If cellSize is not positive, it is chosen from the bounding box of the points so
+            /// that surfaces sampled by the points have about TargetCellSize points per cell.
+            void build( const VectorArray<Vector3>& points, Scalar cellSize = 0 );
+
+            void clear();
+
+            inline bool isEmpty() const { return m_keys.empty(); }
+
+            inline Scalar getCellSize() const { return m_cellSize; }
+
+            /// Returns the number of occupied cells.
+            inline uint getCellCount() const { return uint( m_keys.size() ); }
+
+            /// Writes the indices of the points at a distance of at most radius from q in
+            /// pointsOut, sorted by index.
+            void getPointsInRadius( const Vector3& q, Scalar radius, std::vector<uint>& pointsOut ) const;
+
+            /// Writes the k points closest to q in neighboursOut, sorted by distance.
+            /// neighboursOut has less than k entries if the cloud has less than k points.
+            void getNearestPoints( const Vector3& q, uint k, std::vector<Neighbour>& neighboursOut ) const;
+
+            /// Returns the index of the point with the lowest ray.squaredDistance(), -1 if the grid is
+            /// empty, as PointKdTree::getNearestToRay() does. The cells crossed by the ray are marched
+            /// to find a close point, then the blocks of cells sharing a Morton prefix which may hold
+            /// a closer one are searched, closest first.
+            int getNearestToRay( const Ray& ray ) const;
+
+        private:
+            /// Returns the coordinates of the cell of p, -1 or the resolution on the axes where
+            /// p is outside the grid.
+            Vector3i getCell( const Vector3& p ) const;
+
+            /// Returns the index of the occupied cell with the given coordinates, or -1.
+            int findCell( const Vector3i& cell ) const;
+
+            /// Returns the coordinates of the occupied cell c.
+            Vector3i getCellCoordinates( uint c ) const;
+
+            /// Calls f( c ) for each occupied cell c with coordinates in [lo, hi].
+            template <typename Func>
+            inline void forEachCell( const Vector3i& lo, const Vector3i& hi, const Func& f ) const;
+
+        private:
+            Vector3 m_origin;
+            Scalar m_cellSize = 0;
+            Scalar m_invCellSize = 0;
+            /// Rounding error of the cell coordinates of the points, added to the cell boxes.
+            Scalar m_margin = 0;
+            Vector3i m_resolution;
+
+            /// Morton codes of the occupied cells, sorted.
+            std::vector<std::uint64_t> m_keys;
+            /// The points of the cell c are [m_offsets[c], m_offsets[c + 1]).
+            std::vector<uint> m_offsets;
+            /// Open addressing table of the cells, holding cell indices plus one (0 for an empty slot).
+            std::vector<uint> m_table;
+            uint m_tableShift = 0;
+
+            /// Points sorted by cell, and their index in the cloud the grid was built from.
+            AlignedStdVector<Vector3> m_points;
+            std::vector<uint> m_indices;
+        };
+    }
+}
+
+#endif // RADIUMENGINE_POINT_HASH_GRID_HPP_
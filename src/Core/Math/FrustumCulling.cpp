@@ -0,0 +1,256 @@
+#include <Core/Math/FrustumCulling.hpp>
+
+#include <cmath>
+
+#include <Core/Math/Math.hpp>
+
+#ifdef RA_SIMD_X86
+#   include <immintrin.h>
+#endif
+
+namespace Ra
+{
+    namespace Core
+    {
+        void AabbArray::resize( uint size )
+        {
+            m_centerX.resize( size );
+            m_centerY.resize( size );
+            m_centerZ.resize( size );
+            m_extentX.resize( size );
+            m_extentY.resize( size );
+            m_extentZ.resize( size );
+        }
+
+        void AabbArray::clear()
+        {
+            resize( 0 );
+        }
+
+        void AabbArray::push_back( const Aabb& aabb )
+        {
+            resize( size() + 1 );
+            set( size() - 1, aabb );
+        }
+
+        void AabbArray::set( uint i, const Aabb& aabb )
+        {
+            CORE_ASSERT( i < size(), "Invalid box index" );
+            // The extents are rounded up around the single precision center, so that the
+            // stored box still holds the original one and the culling stays conservative.
+            float c[3];
+            float e[3];
+            for ( uint k = 0; k < 3; ++k )
+            {
+                c[k] = float( aabb.center()[k] );
+                e[k] = Math::floatAbove( std::max( double( aabb.max()[k] ) - c[k],
+                                                   c[k] - double( aabb.min()[k] ) ) );
+            }
+            m_centerX[i] = c[0];
+            m_centerY[i] = c[1];
+            m_centerZ[i] = c[2];
+            m_extentX[i] = e[0];
+            m_extentY[i] = e[1];
+            m_extentZ[i] = e[2];
+        }
+
+        namespace FrustumCulling
+        {
+            namespace
+            {
+                /// Planes of the frustum and absolute values of their normals, in single precision.
+                struct Planes
+                {
+                    float m_normal[6][4];
+                    float m_abs[6][3];
+                };
+
+                Planes getPlanes( const Frustum& frustum )
+                {
+                    Planes planes;
+                    for ( uint p = 0; p < 6; ++p )
+                    {
+                        for ( uint k = 0; k < 4; ++k )
+                        {
+                            planes.m_normal[p][k] = float( frustum.m_planes[p][k] );
+                        }
+                        for ( uint k = 0; k < 3; ++k )
+                        {
+                            planes.m_abs[p][k] = std::abs( planes.m_normal[p][k] );
+                        }
+                    }
+                    return planes;
+                }
+
+                // A box is outside a plane if its center is further behind the plane than
+                // the projection of its extents on the normal. The SIMD kernels below
+                // must evaluate these expressions with the same operations in the same order.
+                void cullScalar( const Planes& planes, const AabbArray& boxes, uint begin, uint end,
+                                 uint* visibility )
+                {
+                    for ( uint i = begin; i < end; ++i )
+                    {
+                        const float cx = boxes.m_centerX[i];
+                        const float cy = boxes.m_centerY[i];
+                        const float cz = boxes.m_centerZ[i];
+                        const float ex = boxes.m_extentX[i];
+                        const float ey = boxes.m_extentY[i];
+                        const float ez = boxes.m_extentZ[i];
+
+                        bool outside = false;
+                        for ( uint p = 0; p < 6 && !outside; ++p )
+                        {
+                            const float* n = planes.m_normal[p];
+                            const float* a = planes.m_abs[p];
+                            float d = n[0] * cx;
+                            d = d + n[1] * cy;
+                            d = d + n[2] * cz;
+                            d = d + n[3];
+                            float r = a[0] * ex;
+                            r = r + a[1] * ey;
+                            r = r + a[2] * ez;
+                            outside = d + r < 0.f;
+                        }
+
+                        if ( !outside )
+                        {
+                            visibility[i / 32] |= 1u << ( i % 32 );
+                        }
+                    }
+                }
+
+#ifdef RA_SIMD_X86
+                // Processes the boxes 4 by 4 and returns the number of boxes processed.
+                RA_TARGET_SSE uint cullSse( const Planes& planes, const AabbArray& boxes, uint* visibility )
+                {
+                    __m128 n[6][4];
+                    __m128 a[6][3];
+                    for ( uint p = 0; p < 6; ++p )
+                    {
+                        for ( uint k = 0; k < 4; ++k )
+                        {
+                            n[p][k] = _mm_set1_ps( planes.m_normal[p][k] );
+                        }
+                        for ( uint k = 0; k < 3; ++k )
+                        {
+                            a[p][k] = _mm_set1_ps( planes.m_abs[p][k] );
+                        }
+                    }
+                    const __m128 zero = _mm_setzero_ps();
+
+                    const uint end = boxes.size() & ~3u;
+                    for ( uint i = 0; i < end; i += 4 )
+                    {
+                        const __m128 cx = _mm_loadu_ps( &boxes.m_centerX[i] );
+                        const __m128 cy = _mm_loadu_ps( &boxes.m_centerY[i] );
+                        const __m128 cz = _mm_loadu_ps( &boxes.m_centerZ[i] );
+                        const __m128 ex = _mm_loadu_ps( &boxes.m_extentX[i] );
+                        const __m128 ey = _mm_loadu_ps( &boxes.m_extentY[i] );
+                        const __m128 ez = _mm_loadu_ps( &boxes.m_extentZ[i] );
+
+                        __m128 outside = zero;
+                        for ( uint p = 0; p < 6; ++p )
+                        {
+                            __m128 d = _mm_mul_ps( n[p][0], cx );
+                            d = _mm_add_ps( d, _mm_mul_ps( n[p][1], cy ) );
+                            d = _mm_add_ps( d, _mm_mul_ps( n[p][2], cz ) );
+                            d = _mm_add_ps( d, n[p][3] );
+                            __m128 r = _mm_mul_ps( a[p][0], ex );
+                            r = _mm_add_ps( r, _mm_mul_ps( a[p][1], ey ) );
+                            r = _mm_add_ps( r, _mm_mul_ps( a[p][2], ez ) );
+                            outside = _mm_or_ps( outside, _mm_cmplt_ps( _mm_add_ps( d, r ), zero ) );
+                        }
+
+                        const uint visible = ~uint( _mm_movemask_ps( outside ) ) & 0xfu;
+                        visibility[i / 32] |= visible << ( i % 32 );
+                    }
+                    return end;
+                }
+
+                // Processes the boxes 8 by 8 and returns the number of boxes processed.
+                RA_TARGET_AVX uint cullAvx( const Planes& planes, const AabbArray& boxes, uint* visibility )
+                {
+                    __m256 n[6][4];
+                    __m256 a[6][3];
+                    for ( uint p = 0; p < 6; ++p )
+                    {
+                        for ( uint k = 0; k < 4; ++k )
+                        {
+                            n[p][k] = _mm256_set1_ps( planes.m_normal[p][k] );
+                        }
+                        for ( uint k = 0; k < 3; ++k )
+                        {
+                            a[p][k] = _mm256_set1_ps( planes.m_abs[p][k] );
+                        }
+                    }
+                    const __m256 zero = _mm256_setzero_ps();
+
+                    const uint end = boxes.size() & ~7u;
+                    for ( uint i = 0; i < end; i += 8 )
+                    {
+                        const __m256 cx = _mm256_loadu_ps( &boxes.m_centerX[i] );
+                        const __m256 cy = _mm256_loadu_ps( &boxes.m_centerY[i] );
+                        const __m256 cz = _mm256_loadu_ps( &boxes.m_centerZ[i] );
+                        const __m256 ex = _mm256_loadu_ps( &boxes.m_extentX[i] );
+                        const __m256 ey = _mm256_loadu_ps( &boxes.m_extentY[i] );
+                        const __m256 ez = _mm256_loadu_ps( &boxes.m_extentZ[i] );
+
+                        __m256 outside = zero;
+                        for ( uint p = 0; p < 6; ++p )
+                        {
+                            __m256 d = _mm256_mul_ps( n[p][0], cx );
+                            d = _mm256_add_ps( d, _mm256_mul_ps( n[p][1], cy ) );
+                            d = _mm256_add_ps( d, _mm256_mul_ps( n[p][2], cz ) );
+                            d = _mm256_add_ps( d, n[p][3] );
+                            __m256 r = _mm256_mul_ps( a[p][0], ex );
+                            r = _mm256_add_ps( r, _mm256_mul_ps( a[p][1], ey ) );
+                            r = _mm256_add_ps( r, _mm256_mul_ps( a[p][2], ez ) );
+                            outside = _mm256_or_ps( outside,
+                                                    _mm256_cmp_ps( _mm256_add_ps( d, r ), zero, _CMP_LT_OQ ) );
+                        }
+
+                        const uint visible = ~uint( _mm256_movemask_ps( outside ) ) & 0xffu;
+                        visibility[i / 32] |= visible << ( i % 32 );
+                    }
+                    return end;
+                }
+#endif // RA_SIMD_X86
+            }
+
+            void cullBoxes( const Frustum& frustum, const AabbArray& boxes, std::vector<uint>& visibility )
+            {
+                cullBoxes( frustum, boxes, visibility, Simd::getBestKernel() );
+            }
+
+            void cullBoxes( const Frustum& frustum, const AabbArray& boxes, std::vector<uint>& visibility,
+                            Simd::Kernel kernel )
+            {
+                CORE_ASSERT( Simd::isSupported( kernel ), "Culling kernel not supported by the processor" );
+                const uint size = boxes.size();
+                visibility.assign( ( size + 31 ) / 32, 0u );
+                if ( size == 0 )
+                {
+                    return;
+                }
+
+                const Planes planes = getPlanes( frustum );
+                uint done = 0;
+#ifdef RA_SIMD_X86
+                switch ( kernel )
+                {
+                    case Simd::SSE:
+                        done = cullSse( planes, boxes, visibility.data() );
+                        break;
+                    case Simd::AVX:
+                        done = cullAvx( planes, boxes, visibility.data() );
+                        break;
+                    default:
+                        break;
+                }
+#endif
+                // Remaining boxes which do not fill a register.
+                cullScalar( planes, boxes, done, size, visibility.data() );
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef RADIUMENGINE_FRUSTUM_CULLING_HPP_
+#define RADIUMENGINE_FRUSTUM_CULLING_HPP_
+
+#include <Core/RaCore.hpp>
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Math/Frustum.hpp>
+#include <Core/Math/SimdKernel.hpp>
+
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Boxes stored as separate arrays of centers and half extents (structure of arrays),
+        /// so that several boxes can be loaded in a single SIMD register.
+        /// Coordinates are stored in single precision whatever the Scalar type.
+        struct RA_CORE_API AabbArray
+        {
+            /// Returns the number of boxes.
+            uint size() const { return uint( m_centerX.size() ); }
+
+            void resize( uint size );
+            void clear();
+
+            /// Appends a box, or sets the box i.
+            void push_back( const Aabb& aabb );
+            void set( uint i, const Aabb& aabb );
+
+            std::vector<float> m_centerX;
+            std::vector<float> m_centerY;
+            std::vector<float> m_centerZ;
+            std::vector<float> m_extentX;
+            std::vector<float> m_extentY;
+            std::vector<float> m_extentZ;
+        };
+
+        namespace FrustumCulling
+        {
+            /// Tests all the boxes against the planes of the frustum. Bit ( i % 32 ) of
+            /// visibility[ i / 32 ] is set if box i is not fully outside one of the planes,
+            /// the unused bits of the last word are cleared.
+            /// All the kernels give exactly the same bits : each plane is evaluated with the
+            /// same single precision operations in the same order.
+            RA_CORE_API void cullBoxes( const Frustum& frustum, const AabbArray& boxes,
+                                        std::vector<uint>& visibility );
+            RA_CORE_API void cullBoxes( const Frustum& frustum, const AabbArray& boxes,
+                                        std::vector<uint>& visibility, Simd::Kernel kernel );
+
+            /// Returns the visibility bit of box i.
+            inline bool isVisible( const std::vector<uint>& visibility, uint i )
+            {
+                return ( visibility[i / 32] >> ( i % 32 ) ) & 1u;
+            }
+        }
+    }
+}
+
+#endif // RADIUMENGINE_FRUSTUM_CULLING_HPP_
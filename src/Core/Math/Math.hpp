@@ -9,6 +9,7 @@
 #endif
 #include <cmath>
 #include <algorithm>
+#include <limits>
 namespace Ra
 {
     namespace Core
@@ -76,6 +77,11 @@ namespace Ra
             template <typename T>
             inline constexpr T lerp( const T& a, const T&b, Scalar t);
 
+            /// Returns the largest float not above x, and the smallest float not below x,
+            /// to store bounds in single precision without shrinking them.
+            inline float floatBelow( double x );
+            inline float floatAbove( double x );
+
         } // namespace Math
     }
 }
@@ -125,6 +125,18 @@ namespace Ra
             {
                 return (1-t) * a + t * b;
             }
+
+            inline float floatBelow( double x )
+            {
+                const float f = float( x );
+                return double( f ) > x ? std::nextafter( f, -std::numeric_limits<float>::infinity() ) : f;
+            }
+
+            inline float floatAbove( double x )
+            {
+                const float f = float( x );
+                return double( f ) < x ? std::nextafter( f, std::numeric_limits<float>::infinity() ) : f;
+            }
         }
     }
 }
@@ -0,0 +1,146 @@
+#include <Core/Math/Packing.hpp>
+
+#include <Core/CoreMacros.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace Packing
+        {
+            namespace
+            {
+                /// Number of vectors packed by the same thread.
+                constexpr uint PackGrainSize = 4096;
+
+                /// Returns x rounded to the nearest multiple of 2^shift, ties to even, divided by 2^shift.
+                inline std::uint32_t roundShift( std::uint32_t x, std::uint32_t shift )
+                {
+                    const std::uint32_t half = 1u << ( shift - 1 );
+                    const std::uint32_t remainder = x & ( ( 1u << shift ) - 1 );
+                    const std::uint32_t result = x >> shift;
+                    return remainder > half || ( remainder == half && ( result & 1 ) ) ? result + 1 : result;
+                }
+
+                /// Signed normalized integer of bits bits, in the low bits of the result.
+                inline std::uint32_t packSnorm( Scalar x, uint bits )
+                {
+                    const Scalar maxValue = Scalar( ( 1 << ( bits - 1 ) ) - 1 );
+                    const Scalar clamped = x > -1 ? std::min( x, Scalar( 1 ) ) : Scalar( -1 );
+                    const int value = int( std::round( clamped * maxValue ) );
+                    return std::uint32_t( value ) & ( ( 1u << bits ) - 1 );
+                }
+
+                inline Scalar unpackSnorm( std::uint32_t p, uint bits )
+                {
+                    int value = int( p & ( ( 1u << bits ) - 1 ) );
+                    if ( value & ( 1 << ( bits - 1 ) ) )
+                    {
+                        value -= 1 << bits;
+                    }
+                    return std::max( Scalar( value ) / Scalar( ( 1 << ( bits - 1 ) ) - 1 ), Scalar( -1 ) );
+                }
+            }
+
+            std::uint16_t packHalf( float x )
+            {
+                std::uint32_t bits;
+                std::memcpy( &bits, &x, sizeof( float ) );
+                const std::uint32_t sign = ( bits >> 16 ) & 0x8000;
+                const std::uint32_t absBits = bits & 0x7fffffff;
+
+                if ( absBits >= 0x7f800000 )
+                {
+                    // Infinities, and NaNs which stay quiet NaNs.
+                    return std::uint16_t( sign | 0x7c00 | ( absBits > 0x7f800000 ? 0x200 : 0 ) );
+                }
+                if ( absBits >= 0x477ff000 )
+                {
+                    // 65520 and above round to infinity.
+                    return std::uint16_t( sign | 0x7c00 );
+                }
+                if ( absBits >= 0x38800000 )
+                {
+                    // Normal halves : the exponent bias goes from 127 to 15, and rounding may carry
+                    // into the exponent.
+                    return std::uint16_t( sign | roundShift( absBits - 0x38000000, 13 ) );
+                }
+                if ( absBits < 0x33000000 )
+                {
+                    // Below half of the smallest denormal.
+                    return std::uint16_t( sign );
+                }
+                // Denormal halves count multiples of 2^-24.
+                const std::uint32_t exponent = absBits >> 23;
+                const std::uint32_t mantissa = ( absBits & 0x7fffff ) | 0x800000;
+                return std::uint16_t( sign | roundShift( mantissa, 126 - exponent ) );
+            }
+
+            float unpackHalf( std::uint16_t h )
+            {
+                const std::uint32_t sign = std::uint32_t( h & 0x8000 ) << 16;
+                const std::uint32_t exponent = ( h >> 10 ) & 0x1f;
+                const std::uint32_t mantissa = h & 0x3ff;
+
+                std::uint32_t bits;
+                if ( exponent == 0 )
+                {
+                    const float value = std::ldexp( float( mantissa ), -24 );
+                    return sign != 0 ? -value : value;
+                }
+                else if ( exponent == 0x1f )
+                {
+                    bits = sign | 0x7f800000 | ( mantissa << 13 );
+                }
+                else
+                {
+                    bits = sign | ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 );
+                }
+                float x;
+                std::memcpy( &x, &bits, sizeof( float ) );
+                return x;
+            }
+
+            std::uint32_t packSnorm1010102( const Vector3& v, Scalar w )
+            {
+                return packSnorm( v.x(), 10 ) | packSnorm( v.y(), 10 ) << 10 | packSnorm( v.z(), 10 ) << 20
+                       | packSnorm( w, 2 ) << 30;
+            }
+
+            Vector3 unpackSnorm1010102( std::uint32_t p )
+            {
+                return Vector3( unpackSnorm( p, 10 ), unpackSnorm( p >> 10, 10 ), unpackSnorm( p >> 20, 10 ) );
+            }
+
+            void packHalf( const Vector3Array& vectors, uint begin, uint end, std::vector<std::uint16_t>& out )
+            {
+                CORE_ASSERT( begin <= end && end <= vectors.size(), "Invalid range." );
+                out.resize( 4 * std::size_t( end - begin ) );
+                parallelFor( begin, end, [&]( uint i )
+                {
+                    std::uint16_t* h = &out[4 * std::size_t( i - begin )];
+                    for ( uint k = 0; k < 3; ++k )
+                    {
+                        h[k] = packHalf( float( vectors[i][k] ) );
+                    }
+                    h[3] = 0;
+                }, PackGrainSize );
+            }
+
+            void packSnorm1010102( const Vector3Array& vectors, uint begin, uint end, std::vector<std::uint32_t>& out )
+            {
+                CORE_ASSERT( begin <= end && end <= vectors.size(), "Invalid range." );
+                out.resize( end - begin );
+                parallelFor( begin, end, [&]( uint i )
+                {
+                    out[i - begin] = packSnorm1010102( vectors[i] );
+                }, PackGrainSize );
+            }
+        }
+    }
+}
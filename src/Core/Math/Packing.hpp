@@ -0,0 +1,47 @@
+#ifndef RADIUMENGINE_PACKING_HPP_
+#define RADIUMENGINE_PACKING_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Containers/VectorArray.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Compact vertex formats, to send less data to the GPU.
+        namespace Packing
+        {
+            /// Converts a float to an IEEE 754 half float, rounding to the nearest (ties to even).
+            /// Values too large for a half become infinities, NaNs stay NaNs and small values
+            /// become denormals, as with the GL_HALF_FLOAT conversions of the GPU.
+            RA_CORE_API std::uint16_t packHalf( float x );
+
+            /// Converts a half float to a float, which is exact.
+            RA_CORE_API float unpackHalf( std::uint16_t h );
+
+            /// Packs a vector with coordinates in [-1, 1], e.g. a unit normal, in the format of
+            /// GL_INT_2_10_10_10_REV : x, y and z are signed normalized 10 bit integers from the
+            /// lowest bits, followed by w, a signed normalized 2 bit integer in [-1, 1].
+            RA_CORE_API std::uint32_t packSnorm1010102( const Vector3& v, Scalar w = 0 );
+
+            /// Returns the x, y and z coordinates of a packed vector, as read by the GPU.
+            RA_CORE_API Vector3 unpackSnorm1010102( std::uint32_t p );
+
+            /// Packs the vectors [begin, end) of an array in out, as 4 half floats per vector
+            /// (the last one being 0) to keep each vector aligned on 8 bytes.
+            RA_CORE_API void packHalf( const Vector3Array& vectors, uint begin, uint end,
+                                       std::vector<std::uint16_t>& out );
+
+            /// Packs the vectors [begin, end) of an array in out, with packSnorm1010102().
+            RA_CORE_API void packSnorm1010102( const Vector3Array& vectors, uint begin, uint end,
+                                               std::vector<std::uint32_t>& out );
+        }
+    }
+}
+
+#endif // RADIUMENGINE_PACKING_HPP_
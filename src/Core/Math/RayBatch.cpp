@@ -0,0 +1,728 @@
+#include <Core/Math/RayBatch.hpp>
+
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#ifdef RA_SIMD_X86
+#   include <immintrin.h>
+#endif
+
+namespace Ra
+{
+    namespace Core
+    {
+        void RayBatch::resize( uint size )
+        {
+            m_originX.resize( size );
+            m_originY.resize( size );
+            m_originZ.resize( size );
+            m_directionX.resize( size );
+            m_directionY.resize( size );
+            m_directionZ.resize( size );
+            m_invDirectionX.resize( size );
+            m_invDirectionY.resize( size );
+            m_invDirectionZ.resize( size );
+            m_tMax.resize( size );
+        }
+
+        void RayBatch::clear()
+        {
+            resize( 0 );
+        }
+
+        void RayBatch::push_back( const Ray& ray, Scalar tMax )
+        {
+            resize( size() + 1 );
+            set( size() - 1, ray, tMax );
+        }
+
+        void RayBatch::set( uint i, const Ray& ray, Scalar tMax )
+        {
+            CORE_ASSERT( i < size(), "Invalid ray index" );
+            // A large finite value avoids 0 * inf when the origin is on a slab.
+            auto inverse = []( float d )
+            {
+                return d != 0.f ? 1.f / d : std::numeric_limits<float>::max();
+            };
+            m_originX[i] = float( ray.origin().x() );
+            m_originY[i] = float( ray.origin().y() );
+            m_originZ[i] = float( ray.origin().z() );
+            m_directionX[i] = float( ray.direction().x() );
+            m_directionY[i] = float( ray.direction().y() );
+            m_directionZ[i] = float( ray.direction().z() );
+            m_invDirectionX[i] = inverse( m_directionX[i] );
+            m_invDirectionY[i] = inverse( m_directionY[i] );
+            m_invDirectionZ[i] = inverse( m_directionZ[i] );
+            m_tMax[i] = float( std::min<Scalar>( tMax, std::numeric_limits<float>::max() ) );
+        }
+
+        Ray RayBatch::getRay( uint i ) const
+        {
+            CORE_ASSERT( i < size(), "Invalid ray index" );
+            return Ray( Vector3( m_originX[i], m_originY[i], m_originZ[i] ),
+                        Vector3( m_directionX[i], m_directionY[i], m_directionZ[i] ) );
+        }
+
+        namespace RayCast
+        {
+            namespace
+            {
+                /// Largest packet of rays traversing a hierarchy together.
+                constexpr uint MaxPacketSize = 16;
+
+                /// The exit parameter of the boxes of a hierarchy is enlarged to cover the rounding
+                /// errors of the slab distances and of the triangle tests, as in TriangleBVH.
+                constexpr float HierarchyRobustness = 1.f + 1e-4f;
+
+                /// A triangle with the edges used by the tests, computed once for all the rays.
+                struct TriangleEdges
+                {
+                    TriangleEdges( const Vector3& a, const Vector3& b, const Vector3& c )
+                    {
+                        for ( uint k = 0; k < 3; ++k )
+                        {
+                            m_a[k] = float( a[k] );
+                            m_ab[k] = float( b[k] ) - m_a[k];
+                            m_ac[k] = float( c[k] ) - m_a[k];
+                        }
+                    }
+
+                    float m_a[3];
+                    float m_ab[3];
+                    float m_ac[3];
+                };
+
+                // Same results as _mm_min_ps() and _mm_max_ps(), including for NaN.
+                inline float minLane( float a, float b ) { return a < b ? a : b; }
+                inline float maxLane( float a, float b ) { return a > b ? a : b; }
+
+                /// Returns the index of the lowest set bit of a non zero mask.
+                inline uint getLowestBit( uint mask )
+                {
+                    CORE_ASSERT( mask != 0, "Empty mask" );
+                    uint bit = 0;
+                    while ( ( mask & 1u ) == 0 )
+                    {
+                        mask >>= 1;
+                        ++bit;
+                    }
+                    return bit;
+                }
+
+                // The kernels below process the rays [begin, end) of the batch. tMax and tOut
+                // hold the values of these rays only : tMax[0] is the maximum parameter of ray begin.
+                // The SIMD kernels must evaluate the expressions of the scalar ones with the same
+                // operations in the same order, and return the number of rays they processed.
+
+                // Slab test : the ray enters the box at the last of its entries in the 3 slabs and
+                // exits at the first of its exits.
+                inline float boxLane( const RayBatch& rays, uint i, const float* boxMin, const float* boxMax,
+                                      float robustness, float tMax )
+                {
+                    const float t0x = ( boxMin[0] - rays.m_originX[i] ) * rays.m_invDirectionX[i];
+                    const float t1x = ( boxMax[0] - rays.m_originX[i] ) * rays.m_invDirectionX[i];
+                    const float t0y = ( boxMin[1] - rays.m_originY[i] ) * rays.m_invDirectionY[i];
+                    const float t1y = ( boxMax[1] - rays.m_originY[i] ) * rays.m_invDirectionY[i];
+                    const float t0z = ( boxMin[2] - rays.m_originZ[i] ) * rays.m_invDirectionZ[i];
+                    const float t1z = ( boxMax[2] - rays.m_originZ[i] ) * rays.m_invDirectionZ[i];
+
+                    float tEntry = maxLane( 0.f, minLane( t0x, t1x ) );
+                    tEntry = maxLane( tEntry, minLane( t0y, t1y ) );
+                    tEntry = maxLane( tEntry, minLane( t0z, t1z ) );
+                    float tExit = minLane( tMax, maxLane( t0x, t1x ) );
+                    tExit = minLane( tExit, maxLane( t0y, t1y ) );
+                    tExit = minLane( tExit, maxLane( t0z, t1z ) );
+
+                    return tEntry <= tExit * robustness ? tEntry : -1.f;
+                }
+
+                void boxScalar( const RayBatch& rays, uint begin, uint end, const float* boxMin, const float* boxMax,
+                                float robustness, const float* tMax, float* tOut, uint* hitMask )
+                {
+                    for ( uint i = begin; i < end; ++i )
+                    {
+                        tOut[i - begin] = boxLane( rays, i, boxMin, boxMax, robustness, tMax[i - begin] );
+                        if ( hitMask != nullptr && tOut[i - begin] >= 0.f )
+                        {
+                            *hitMask |= 1u << ( i - begin );
+                        }
+                    }
+                }
+
+                // Moller-Trumbore test, with the barycentric coordinates divided by the determinant
+                // so that the test does not depend on its sign. A zero determinant gives an infinite
+                // inverse, and coordinates which fail the comparisons.
+                // The scalar test exits as soon as a coordinate is out of the triangle : since v >= 0,
+                // u + v <= 1 implies u <= 1, so this gives the result of the full test.
+                inline float triangleLane( const RayBatch& rays, uint i, const TriangleEdges& tri, float tMax )
+                {
+                    const float* ab = tri.m_ab;
+                    const float* ac = tri.m_ac;
+                    const float dx = rays.m_directionX[i];
+                    const float dy = rays.m_directionY[i];
+                    const float dz = rays.m_directionZ[i];
+                    const float px = dy * ac[2] - dz * ac[1];
+                    const float py = dz * ac[0] - dx * ac[2];
+                    const float pz = dx * ac[1] - dy * ac[0];
+                    const float det = ab[0] * px + ab[1] * py + ab[2] * pz;
+                    const float inv = 1.f / det;
+
+                    const float tx = rays.m_originX[i] - tri.m_a[0];
+                    const float ty = rays.m_originY[i] - tri.m_a[1];
+                    const float tz = rays.m_originZ[i] - tri.m_a[2];
+                    const float u = ( tx * px + ty * py + tz * pz ) * inv;
+                    if ( !( u >= 0.f && u <= 1.f ) )
+                    {
+                        return -1.f;
+                    }
+
+                    const float qx = ty * ab[2] - tz * ab[1];
+                    const float qy = tz * ab[0] - tx * ab[2];
+                    const float qz = tx * ab[1] - ty * ab[0];
+                    const float v = ( dx * qx + dy * qy + dz * qz ) * inv;
+                    if ( !( v >= 0.f && u + v <= 1.f ) )
+                    {
+                        return -1.f;
+                    }
+
+                    const float t = ( ac[0] * qx + ac[1] * qy + ac[2] * qz ) * inv;
+                    return t >= 0.f && t <= tMax ? t : -1.f;
+                }
+
+                void triangleScalar( const RayBatch& rays, uint begin, uint end, const TriangleEdges& tri,
+                                     const float* tMax, float* tOut, uint* hitMask )
+                {
+                    for ( uint i = begin; i < end; ++i )
+                    {
+                        tOut[i - begin] = triangleLane( rays, i, tri, tMax[i - begin] );
+                        if ( hitMask != nullptr && tOut[i - begin] >= 0.f )
+                        {
+                            *hitMask |= 1u << ( i - begin );
+                        }
+                    }
+                }
+
+#ifdef RA_SIMD_X86
+                RA_TARGET_SSE uint boxSse( const RayBatch& rays, uint begin, uint end, const float* boxMin,
+                                           const float* boxMax, float robustness, const float* tMax, float* tOut, uint* hitMask )
+                {
+                    const __m128 minX = _mm_set1_ps( boxMin[0] );
+                    const __m128 minY = _mm_set1_ps( boxMin[1] );
+                    const __m128 minZ = _mm_set1_ps( boxMin[2] );
+                    const __m128 maxX = _mm_set1_ps( boxMax[0] );
+                    const __m128 maxY = _mm_set1_ps( boxMax[1] );
+                    const __m128 maxZ = _mm_set1_ps( boxMax[2] );
+                    const __m128 scale = _mm_set1_ps( robustness );
+                    const __m128 zero = _mm_setzero_ps();
+                    const __m128 miss = _mm_set1_ps( -1.f );
+
+                    const uint count = ( end - begin ) & ~3u;
+                    for ( uint j = 0; j < count; j += 4 )
+                    {
+                        const uint i = begin + j;
+                        const __m128 ox = _mm_loadu_ps( &rays.m_originX[i] );
+                        const __m128 oy = _mm_loadu_ps( &rays.m_originY[i] );
+                        const __m128 oz = _mm_loadu_ps( &rays.m_originZ[i] );
+                        const __m128 ix = _mm_loadu_ps( &rays.m_invDirectionX[i] );
+                        const __m128 iy = _mm_loadu_ps( &rays.m_invDirectionY[i] );
+                        const __m128 iz = _mm_loadu_ps( &rays.m_invDirectionZ[i] );
+
+                        const __m128 t0x = _mm_mul_ps( _mm_sub_ps( minX, ox ), ix );
+                        const __m128 t1x = _mm_mul_ps( _mm_sub_ps( maxX, ox ), ix );
+                        const __m128 t0y = _mm_mul_ps( _mm_sub_ps( minY, oy ), iy );
+                        const __m128 t1y = _mm_mul_ps( _mm_sub_ps( maxY, oy ), iy );
+                        const __m128 t0z = _mm_mul_ps( _mm_sub_ps( minZ, oz ), iz );
+                        const __m128 t1z = _mm_mul_ps( _mm_sub_ps( maxZ, oz ), iz );
+
+                        __m128 tEntry = _mm_max_ps( zero, _mm_min_ps( t0x, t1x ) );
+                        tEntry = _mm_max_ps( tEntry, _mm_min_ps( t0y, t1y ) );
+                        tEntry = _mm_max_ps( tEntry, _mm_min_ps( t0z, t1z ) );
+                        __m128 tExit = _mm_min_ps( _mm_loadu_ps( tMax + j ), _mm_max_ps( t0x, t1x ) );
+                        tExit = _mm_min_ps( tExit, _mm_max_ps( t0y, t1y ) );
+                        tExit = _mm_min_ps( tExit, _mm_max_ps( t0z, t1z ) );
+
+                        const __m128 hit = _mm_cmple_ps( tEntry, _mm_mul_ps( tExit, scale ) );
+                        _mm_storeu_ps( tOut + j, _mm_or_ps( _mm_and_ps( hit, tEntry ), _mm_andnot_ps( hit, miss ) ) );
+                        if ( hitMask != nullptr )
+                        {
+                            *hitMask |= uint( _mm_movemask_ps( hit ) ) << j;
+                        }
+                    }
+                    return count;
+                }
+
+                RA_TARGET_AVX uint boxAvx( const RayBatch& rays, uint begin, uint end, const float* boxMin,
+                                           const float* boxMax, float robustness, const float* tMax, float* tOut, uint* hitMask )
+                {
+                    const __m256 minX = _mm256_set1_ps( boxMin[0] );
+                    const __m256 minY = _mm256_set1_ps( boxMin[1] );
+                    const __m256 minZ = _mm256_set1_ps( boxMin[2] );
+                    const __m256 maxX = _mm256_set1_ps( boxMax[0] );
+                    const __m256 maxY = _mm256_set1_ps( boxMax[1] );
+                    const __m256 maxZ = _mm256_set1_ps( boxMax[2] );
+                    const __m256 scale = _mm256_set1_ps( robustness );
+                    const __m256 zero = _mm256_setzero_ps();
+                    const __m256 miss = _mm256_set1_ps( -1.f );
+
+                    const uint count = ( end - begin ) & ~7u;
+                    for ( uint j = 0; j < count; j += 8 )
+                    {
+                        const uint i = begin + j;
+                        const __m256 ox = _mm256_loadu_ps( &rays.m_originX[i] );
+                        const __m256 oy = _mm256_loadu_ps( &rays.m_originY[i] );
+                        const __m256 oz = _mm256_loadu_ps( &rays.m_originZ[i] );
+                        const __m256 ix = _mm256_loadu_ps( &rays.m_invDirectionX[i] );
+                        const __m256 iy = _mm256_loadu_ps( &rays.m_invDirectionY[i] );
+                        const __m256 iz = _mm256_loadu_ps( &rays.m_invDirectionZ[i] );
+
+                        const __m256 t0x = _mm256_mul_ps( _mm256_sub_ps( minX, ox ), ix );
+                        const __m256 t1x = _mm256_mul_ps( _mm256_sub_ps( maxX, ox ), ix );
+                        const __m256 t0y = _mm256_mul_ps( _mm256_sub_ps( minY, oy ), iy );
+                        const __m256 t1y = _mm256_mul_ps( _mm256_sub_ps( maxY, oy ), iy );
+                        const __m256 t0z = _mm256_mul_ps( _mm256_sub_ps( minZ, oz ), iz );
+                        const __m256 t1z = _mm256_mul_ps( _mm256_sub_ps( maxZ, oz ), iz );
+
+                        __m256 tEntry = _mm256_max_ps( zero, _mm256_min_ps( t0x, t1x ) );
+                        tEntry = _mm256_max_ps( tEntry, _mm256_min_ps( t0y, t1y ) );
+                        tEntry = _mm256_max_ps( tEntry, _mm256_min_ps( t0z, t1z ) );
+                        __m256 tExit = _mm256_min_ps( _mm256_loadu_ps( tMax + j ), _mm256_max_ps( t0x, t1x ) );
+                        tExit = _mm256_min_ps( tExit, _mm256_max_ps( t0y, t1y ) );
+                        tExit = _mm256_min_ps( tExit, _mm256_max_ps( t0z, t1z ) );
+
+                        const __m256 hit = _mm256_cmp_ps( tEntry, _mm256_mul_ps( tExit, scale ), _CMP_LE_OQ );
+                        _mm256_storeu_ps( tOut + j, _mm256_or_ps( _mm256_and_ps( hit, tEntry ), _mm256_andnot_ps( hit, miss ) ) );
+                        if ( hitMask != nullptr )
+                        {
+                            *hitMask |= uint( _mm256_movemask_ps( hit ) ) << j;
+                        }
+                    }
+                    return count;
+                }
+
+                RA_TARGET_SSE uint triangleSse( const RayBatch& rays, uint begin, uint end, const TriangleEdges& tri,
+                                                const float* tMax, float* tOut, uint* hitMask )
+                {
+                    const __m128 ax = _mm_set1_ps( tri.m_a[0] );
+                    const __m128 ay = _mm_set1_ps( tri.m_a[1] );
+                    const __m128 az = _mm_set1_ps( tri.m_a[2] );
+                    const __m128 abx = _mm_set1_ps( tri.m_ab[0] );
+                    const __m128 aby = _mm_set1_ps( tri.m_ab[1] );
+                    const __m128 abz = _mm_set1_ps( tri.m_ab[2] );
+                    const __m128 acx = _mm_set1_ps( tri.m_ac[0] );
+                    const __m128 acy = _mm_set1_ps( tri.m_ac[1] );
+                    const __m128 acz = _mm_set1_ps( tri.m_ac[2] );
+                    const __m128 zero = _mm_setzero_ps();
+                    const __m128 one = _mm_set1_ps( 1.f );
+                    const __m128 miss = _mm_set1_ps( -1.f );
+
+                    const uint count = ( end - begin ) & ~3u;
+                    for ( uint j = 0; j < count; j += 4 )
+                    {
+                        const uint i = begin + j;
+                        const __m128 dx = _mm_loadu_ps( &rays.m_directionX[i] );
+                        const __m128 dy = _mm_loadu_ps( &rays.m_directionY[i] );
+                        const __m128 dz = _mm_loadu_ps( &rays.m_directionZ[i] );
+                        const __m128 px = _mm_sub_ps( _mm_mul_ps( dy, acz ), _mm_mul_ps( dz, acy ) );
+                        const __m128 py = _mm_sub_ps( _mm_mul_ps( dz, acx ), _mm_mul_ps( dx, acz ) );
+                        const __m128 pz = _mm_sub_ps( _mm_mul_ps( dx, acy ), _mm_mul_ps( dy, acx ) );
+                        const __m128 det = _mm_add_ps( _mm_add_ps( _mm_mul_ps( abx, px ), _mm_mul_ps( aby, py ) ),
+                                                       _mm_mul_ps( abz, pz ) );
+
+                        const __m128 tx = _mm_sub_ps( _mm_loadu_ps( &rays.m_originX[i] ), ax );
+                        const __m128 ty = _mm_sub_ps( _mm_loadu_ps( &rays.m_originY[i] ), ay );
+                        const __m128 tz = _mm_sub_ps( _mm_loadu_ps( &rays.m_originZ[i] ), az );
+                        const __m128 qx = _mm_sub_ps( _mm_mul_ps( ty, abz ), _mm_mul_ps( tz, aby ) );
+                        const __m128 qy = _mm_sub_ps( _mm_mul_ps( tz, abx ), _mm_mul_ps( tx, abz ) );
+                        const __m128 qz = _mm_sub_ps( _mm_mul_ps( tx, aby ), _mm_mul_ps( ty, abx ) );
+
+                        const __m128 inv = _mm_div_ps( one, det );
+                        const __m128 t = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( acx, qx ), _mm_mul_ps( acy, qy ) ),
+                                                                 _mm_mul_ps( acz, qz ) ), inv );
+                        const __m128 u = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( tx, px ), _mm_mul_ps( ty, py ) ),
+                                                                 _mm_mul_ps( tz, pz ) ), inv );
+                        const __m128 v = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( dx, qx ), _mm_mul_ps( dy, qy ) ),
+                                                                 _mm_mul_ps( dz, qz ) ), inv );
+
+                        __m128 hit = _mm_and_ps( _mm_cmpge_ps( u, zero ), _mm_cmpge_ps( v, zero ) );
+                        hit = _mm_and_ps( hit, _mm_cmple_ps( _mm_add_ps( u, v ), one ) );
+                        hit = _mm_and_ps( hit, _mm_cmpge_ps( t, zero ) );
+                        hit = _mm_and_ps( hit, _mm_cmple_ps( t, _mm_loadu_ps( tMax + j ) ) );
+                        _mm_storeu_ps( tOut + j, _mm_or_ps( _mm_and_ps( hit, t ), _mm_andnot_ps( hit, miss ) ) );
+                        if ( hitMask != nullptr )
+                        {
+                            *hitMask |= uint( _mm_movemask_ps( hit ) ) << j;
+                        }
+                    }
+                    return count;
+                }
+
+                RA_TARGET_AVX uint triangleAvx( const RayBatch& rays, uint begin, uint end, const TriangleEdges& tri,
+                                                const float* tMax, float* tOut, uint* hitMask )
+                {
+                    const __m256 ax = _mm256_set1_ps( tri.m_a[0] );
+                    const __m256 ay = _mm256_set1_ps( tri.m_a[1] );
+                    const __m256 az = _mm256_set1_ps( tri.m_a[2] );
+                    const __m256 abx = _mm256_set1_ps( tri.m_ab[0] );
+                    const __m256 aby = _mm256_set1_ps( tri.m_ab[1] );
+                    const __m256 abz = _mm256_set1_ps( tri.m_ab[2] );
+                    const __m256 acx = _mm256_set1_ps( tri.m_ac[0] );
+                    const __m256 acy = _mm256_set1_ps( tri.m_ac[1] );
+                    const __m256 acz = _mm256_set1_ps( tri.m_ac[2] );
+                    const __m256 zero = _mm256_setzero_ps();
+                    const __m256 one = _mm256_set1_ps( 1.f );
+                    const __m256 miss = _mm256_set1_ps( -1.f );
+
+                    const uint count = ( end - begin ) & ~7u;
+                    for ( uint j = 0; j < count; j += 8 )
+                    {
+                        const uint i = begin + j;
+                        const __m256 dx = _mm256_loadu_ps( &rays.m_directionX[i] );
+                        const __m256 dy = _mm256_loadu_ps( &rays.m_directionY[i] );
+                        const __m256 dz = _mm256_loadu_ps( &rays.m_directionZ[i] );
+                        const __m256 px = _mm256_sub_ps( _mm256_mul_ps( dy, acz ), _mm256_mul_ps( dz, acy ) );
+                        const __m256 py = _mm256_sub_ps( _mm256_mul_ps( dz, acx ), _mm256_mul_ps( dx, acz ) );
+                        const __m256 pz = _mm256_sub_ps( _mm256_mul_ps( dx, acy ), _mm256_mul_ps( dy, acx ) );
+                        const __m256 det = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( abx, px ), _mm256_mul_ps( aby, py ) ),
+                                                          _mm256_mul_ps( abz, pz ) );
+
+                        const __m256 tx = _mm256_sub_ps( _mm256_loadu_ps( &rays.m_originX[i] ), ax );
+                        const __m256 ty = _mm256_sub_ps( _mm256_loadu_ps( &rays.m_originY[i] ), ay );
+                        const __m256 tz = _mm256_sub_ps( _mm256_loadu_ps( &rays.m_originZ[i] ), az );
+                        const __m256 qx = _mm256_sub_ps( _mm256_mul_ps( ty, abz ), _mm256_mul_ps( tz, aby ) );
+                        const __m256 qy = _mm256_sub_ps( _mm256_mul_ps( tz, abx ), _mm256_mul_ps( tx, abz ) );
+                        const __m256 qz = _mm256_sub_ps( _mm256_mul_ps( tx, aby ), _mm256_mul_ps( ty, abx ) );
+
+                        const __m256 inv = _mm256_div_ps( one, det );
+                        const __m256 t = _mm256_mul_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( acx, qx ), _mm256_mul_ps( acy, qy ) ),
+                                                                       _mm256_mul_ps( acz, qz ) ), inv );
+                        const __m256 u = _mm256_mul_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( tx, px ), _mm256_mul_ps( ty, py ) ),
+                                                                       _mm256_mul_ps( tz, pz ) ), inv );
+                        const __m256 v = _mm256_mul_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( dx, qx ), _mm256_mul_ps( dy, qy ) ),
+                                                                       _mm256_mul_ps( dz, qz ) ), inv );
+
+                        __m256 hit = _mm256_and_ps( _mm256_cmp_ps( u, zero, _CMP_GE_OQ ), _mm256_cmp_ps( v, zero, _CMP_GE_OQ ) );
+                        hit = _mm256_and_ps( hit, _mm256_cmp_ps( _mm256_add_ps( u, v ), one, _CMP_LE_OQ ) );
+                        hit = _mm256_and_ps( hit, _mm256_cmp_ps( t, zero, _CMP_GE_OQ ) );
+                        hit = _mm256_and_ps( hit, _mm256_cmp_ps( t, _mm256_loadu_ps( tMax + j ), _CMP_LE_OQ ) );
+                        _mm256_storeu_ps( tOut + j, _mm256_or_ps( _mm256_and_ps( hit, t ), _mm256_andnot_ps( hit, miss ) ) );
+                        if ( hitMask != nullptr )
+                        {
+                            *hitMask |= uint( _mm256_movemask_ps( hit ) ) << j;
+                        }
+                    }
+                    return count;
+                }
+#endif // RA_SIMD_X86
+
+                // Runs the widest kernels first, then the narrower ones on the remaining rays.
+                // For packets, returns the bit mask of the rays which hit (bit j for ray begin + j).
+                uint testBox( Simd::Kernel kernel, const RayBatch& rays, uint begin, uint end, const float* boxMin,
+                              const float* boxMax, float robustness, const float* tMax, float* tOut )
+                {
+                    const bool packet = end - begin <= MaxPacketSize;
+                    uint mask = 0;
+                    uint done = 0;
+#ifdef RA_SIMD_X86
+                    if ( kernel == Simd::AVX && end - begin >= 8 )
+                    {
+                        done += boxAvx( rays, begin, end, boxMin, boxMax, robustness, tMax, tOut,
+                                        packet ? &mask : nullptr );
+                    }
+                    if ( ( kernel == Simd::AVX || kernel == Simd::SSE ) && end - begin - done >= 4 )
+                    {
+                        uint sseMask = 0;
+                        const uint count = boxSse( rays, begin + done, end, boxMin, boxMax, robustness, tMax + done,
+                                                   tOut + done, packet ? &sseMask : nullptr );
+                        mask |= sseMask << done;
+                        done += count;
+                    }
+#endif
+                    uint scalarMask = 0;
+                    boxScalar( rays, begin + done, end, boxMin, boxMax, robustness, tMax + done, tOut + done,
+                               packet ? &scalarMask : nullptr );
+                    return mask | ( scalarMask << done );
+                }
+
+                uint testTriangle( Simd::Kernel kernel, const RayBatch& rays, uint begin, uint end,
+                                   const TriangleEdges& tri, const float* tMax, float* tOut )
+                {
+                    const bool packet = end - begin <= MaxPacketSize;
+                    uint mask = 0;
+                    uint done = 0;
+#ifdef RA_SIMD_X86
+                    if ( kernel == Simd::AVX && end - begin >= 8 )
+                    {
+                        done += triangleAvx( rays, begin, end, tri, tMax, tOut, packet ? &mask : nullptr );
+                    }
+                    if ( ( kernel == Simd::AVX || kernel == Simd::SSE ) && end - begin - done >= 4 )
+                    {
+                        uint sseMask = 0;
+                        const uint count = triangleSse( rays, begin + done, end, tri, tMax + done, tOut + done,
+                                                        packet ? &sseMask : nullptr );
+                        mask |= sseMask << done;
+                        done += count;
+                    }
+#endif
+                    uint scalarMask = 0;
+                    triangleScalar( rays, begin + done, end, tri, tMax + done, tOut + done,
+                                    packet ? &scalarMask : nullptr );
+                    return mask | ( scalarMask << done );
+                }
+
+                // Traverses the hierarchy with the rays [begin, end) : a node is visited if one of
+                // the rays hits its box before its closest hit so far. Children are visited in the
+                // order of the first entry of the rays in their boxes.
+                void castPacket( Simd::Kernel kernel, const RayBatch& rays, const TriangleMesh& mesh,
+                                 const TriangleBVH& bvh, uint begin, uint end, TriangleBVH::Hit* hitsOut )
+                {
+                    struct StackEntry
+                    {
+                        uint m_node;
+                        float m_tEntry;
+                    };
+
+                    const uint size = end - begin;
+                    float closest[MaxPacketSize];
+                    int triangles[MaxPacketSize];
+                    float t[MaxPacketSize];
+                    std::copy( rays.m_tMax.begin() + begin, rays.m_tMax.begin() + end, closest );
+                    std::fill( triangles, triangles + size, -1 );
+
+                    // Returns the first entry of the rays in the box of the node, or -1 if all miss it.
+                    auto enter = [&]( const TriangleBVH::Node& node )
+                    {
+                        uint mask = testBox( kernel, rays, begin, end, node.m_min, node.m_max, HierarchyRobustness, closest, t );
+                        float tEntry = -1.f;
+                        if ( mask != 0 )
+                        {
+                            tEntry = std::numeric_limits<float>::max();
+                            for ( ; mask != 0; mask &= mask - 1 )
+                            {
+                                tEntry = std::min( tEntry, t[getLowestBit( mask )] );
+                            }
+                        }
+                        return tEntry;
+                    };
+
+                    const auto& nodes = bvh.getNodes();
+                    const auto& indices = bvh.getTriangles();
+                    StackEntry stack[TriangleBVH::StackSize];
+                    uint stackSize = 0;
+                    const float rootEntry = enter( nodes[0] );
+                    if ( rootEntry >= 0.f )
+                    {
+                        stack[stackSize++] = StackEntry{ 0, rootEntry };
+                    }
+
+                    // Nodes entered after the farthest closest hit of the packet are skipped.
+                    float farthest = *std::max_element( closest, closest + size ) * HierarchyRobustness;
+                    while ( stackSize > 0 )
+                    {
+                        const StackEntry entry = stack[--stackSize];
+                        if ( entry.m_tEntry > farthest )
+                        {
+                            continue;
+                        }
+
+                        const TriangleBVH::Node& node = nodes[entry.m_node];
+                        if ( node.isLeaf() )
+                        {
+                            for ( uint n = node.m_index; n < node.m_index + node.m_count; ++n )
+                            {
+                                const int index = int( indices[n] );
+                                const Triangle& tri = mesh.m_triangles[index];
+                                const TriangleEdges edges( mesh.m_vertices[tri[0]], mesh.m_vertices[tri[1]],
+                                                           mesh.m_vertices[tri[2]] );
+                                uint mask = testTriangle( kernel, rays, begin, end, edges, closest, t );
+
+                                // Hits are not further than the closest ones, ties go to the lowest index.
+                                for ( ; mask != 0; mask &= mask - 1 )
+                                {
+                                    const uint j = getLowestBit( mask );
+                                    if ( t[j] < closest[j] || triangles[j] < 0 || index < triangles[j] )
+                                    {
+                                        closest[j] = t[j];
+                                        triangles[j] = index;
+                                    }
+                                }
+                            }
+                            farthest = *std::max_element( closest, closest + size ) * HierarchyRobustness;
+                        }
+                        else
+                        {
+                            // Push the farthest child first so that the closest one is visited first.
+                            const float left = enter( nodes[node.m_index] );
+                            const float right = enter( nodes[node.m_index + 1] );
+                            CORE_ASSERT( stackSize + 2 <= TriangleBVH::StackSize, "Traversal stack overflow." );
+                            const bool leftFirst = right < 0.f || ( left >= 0.f && left <= right );
+                            const StackEntry nearChild{ leftFirst ? node.m_index : node.m_index + 1, leftFirst ? left : right };
+                            const StackEntry farChild{ leftFirst ? node.m_index + 1 : node.m_index, leftFirst ? right : left };
+                            if ( farChild.m_tEntry >= 0.f )
+                            {
+                                stack[stackSize++] = farChild;
+                            }
+                            if ( nearChild.m_tEntry >= 0.f )
+                            {
+                                stack[stackSize++] = nearChild;
+                            }
+                        }
+                    }
+
+                    for ( uint j = 0; j < size; ++j )
+                    {
+                        hitsOut[j].m_triangle = triangles[j];
+                        hitsOut[j].m_t = triangles[j] >= 0 ? Scalar( closest[j] ) : Scalar( -1 );
+                    }
+                }
+
+                // Traversal of a single ray, as in TriangleBVH::castRay(), with the tests of the packets.
+                void castSingle( const RayBatch& rays, const TriangleMesh& mesh, const TriangleBVH& bvh, uint i,
+                                 TriangleBVH::Hit& hitOut )
+                {
+                    struct StackEntry
+                    {
+                        uint m_node;
+                        float m_tEntry;
+                    };
+
+                    const auto& nodes = bvh.getNodes();
+                    const auto& indices = bvh.getTriangles();
+                    float closest = rays.m_tMax[i];
+                    int triangle = -1;
+                    StackEntry stack[TriangleBVH::StackSize];
+                    uint stackSize = 0;
+
+                    uint current = 0;
+                    bool descend = boxLane( rays, i, nodes[0].m_min, nodes[0].m_max, HierarchyRobustness, closest ) >= 0.f;
+                    while ( descend )
+                    {
+                        const TriangleBVH::Node& node = nodes[current];
+                        descend = false;
+                        if ( node.isLeaf() )
+                        {
+                            for ( uint n = node.m_index; n < node.m_index + node.m_count; ++n )
+                            {
+                                const int index = int( indices[n] );
+                                const Triangle& tri = mesh.m_triangles[index];
+                                const float t = triangleLane( rays, i, TriangleEdges( mesh.m_vertices[tri[0]],
+                                                              mesh.m_vertices[tri[1]], mesh.m_vertices[tri[2]] ), closest );
+                                if ( t >= 0.f && ( t < closest || triangle < 0 || index < triangle ) )
+                                {
+                                    closest = t;
+                                    triangle = index;
+                                }
+                            }
+                        }
+                        else
+                        {
+                            const TriangleBVH::Node& leftNode = nodes[node.m_index];
+                            const TriangleBVH::Node& rightNode = nodes[node.m_index + 1];
+                            const float left = boxLane( rays, i, leftNode.m_min, leftNode.m_max, HierarchyRobustness, closest );
+                            const float right = boxLane( rays, i, rightNode.m_min, rightNode.m_max, HierarchyRobustness, closest );
+                            if ( left >= 0.f && right >= 0.f )
+                            {
+                                const bool leftFirst = left <= right;
+                                CORE_ASSERT( stackSize < TriangleBVH::StackSize, "Traversal stack overflow." );
+                                stack[stackSize++] = leftFirst ? StackEntry{ node.m_index + 1, right }
+                                                               : StackEntry{ node.m_index, left };
+                                current = leftFirst ? node.m_index : node.m_index + 1;
+                                descend = true;
+                            }
+                            else if ( left >= 0.f || right >= 0.f )
+                            {
+                                current = left >= 0.f ? node.m_index : node.m_index + 1;
+                                descend = true;
+                            }
+                        }
+
+                        if ( !descend )
+                        {
+                            while ( stackSize > 0 && stack[stackSize - 1].m_tEntry > closest * HierarchyRobustness )
+                            {
+                                --stackSize;
+                            }
+                            if ( stackSize > 0 )
+                            {
+                                current = stack[--stackSize].m_node;
+                                descend = true;
+                            }
+                        }
+                    }
+
+                    hitOut.m_triangle = triangle;
+                    hitOut.m_t = triangle >= 0 ? Scalar( closest ) : Scalar( -1 );
+                }
+            }
+
+            void vsAabb( const RayBatch& rays, const Aabb& aabb, std::vector<float>& hitsOut )
+            {
+                vsAabb( rays, aabb, hitsOut, Simd::getBestKernel() );
+            }
+
+            void vsAabb( const RayBatch& rays, const Aabb& aabb, std::vector<float>& hitsOut, Simd::Kernel kernel )
+            {
+                CORE_ASSERT( Simd::isSupported( kernel ), "Ray kernel not supported by the processor" );
+                hitsOut.resize( rays.size() );
+                if ( aabb.isEmpty() )
+                {
+                    std::fill( hitsOut.begin(), hitsOut.end(), -1.f );
+                    return;
+                }
+                const float boxMin[3] = { float( aabb.min().x() ), float( aabb.min().y() ), float( aabb.min().z() ) };
+                const float boxMax[3] = { float( aabb.max().x() ), float( aabb.max().y() ), float( aabb.max().z() ) };
+                testBox( kernel, rays, 0, rays.size(), boxMin, boxMax, 1.f, rays.m_tMax.data(), hitsOut.data() );
+            }
+
+            void vsTriangle( const RayBatch& rays, const Vector3& a, const Vector3& b, const Vector3& c,
+                             std::vector<float>& hitsOut )
+            {
+                vsTriangle( rays, a, b, c, hitsOut, Simd::getBestKernel() );
+            }
+
+            void vsTriangle( const RayBatch& rays, const Vector3& a, const Vector3& b, const Vector3& c,
+                             std::vector<float>& hitsOut, Simd::Kernel kernel )
+            {
+                CORE_ASSERT( Simd::isSupported( kernel ), "Ray kernel not supported by the processor" );
+                hitsOut.resize( rays.size() );
+                testTriangle( kernel, rays, 0, rays.size(), TriangleEdges( a, b, c ), rays.m_tMax.data(), hitsOut.data() );
+            }
+
+            void vsTriangleMesh( const RayBatch& rays, const TriangleMesh& mesh, const TriangleBVH& bvh,
+                                 std::vector<TriangleBVH::Hit>& hitsOut, BatchMode mode )
+            {
+                vsTriangleMesh( rays, mesh, bvh, hitsOut, mode, Simd::getBestKernel() );
+            }
+
+            void vsTriangleMesh( const RayBatch& rays, const TriangleMesh& mesh, const TriangleBVH& bvh,
+                                 std::vector<TriangleBVH::Hit>& hitsOut, BatchMode mode, Simd::Kernel kernel )
+            {
+                CORE_ASSERT( Simd::isSupported( kernel ), "Ray kernel not supported by the processor" );
+                CORE_ASSERT( uint( mode ) <= MaxPacketSize, "Invalid packet size" );
+                const uint size = rays.size();
+                hitsOut.assign( size, TriangleBVH::Hit() );
+                if ( bvh.isEmpty() )
+                {
+                    return;
+                }
+
+                const uint packetSize = uint( mode );
+                const uint packetCount = ( size + packetSize - 1 ) / packetSize;
+                parallelFor( 0, packetCount, [&]( uint p )
+                {
+                    const uint begin = p * packetSize;
+                    const uint end = std::min( begin + packetSize, size );
+                    if ( packetSize == 1 )
+                    {
+                        castSingle( rays, mesh, bvh, begin, hitsOut[begin] );
+                    }
+                    else
+                    {
+                        castPacket( kernel, rays, mesh, bvh, begin, end, &hitsOut[begin] );
+                    }
+                } );
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef RADIUMENGINE_RAY_BATCH_HPP_
+#define RADIUMENGINE_RAY_BATCH_HPP_
+
+#include <Core/RaCore.hpp>
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Math/Ray.hpp>
+#include <Core/Math/SimdKernel.hpp>
+#include <Core/Mesh/TriangleMesh.hpp>
+#include <Core/TreeStructures/TriangleBVH.hpp>
+
+#include <limits>
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Rays stored as separate arrays of coordinates (structure of arrays), so that several
+        /// rays can be loaded in a single SIMD register. Each ray has a maximum parameter
+        /// beyond which hits are ignored. Coordinates are stored in single precision whatever
+        /// the Scalar type.
+        struct RA_CORE_API RayBatch
+        {
+            /// Returns the number of rays.
+            uint size() const { return uint( m_originX.size() ); }
+
+            void resize( uint size );
+            void clear();
+
+            /// Appends a ray, or sets the ray i.
+            void push_back( const Ray& ray, Scalar tMax = std::numeric_limits<Scalar>::max() );
+            void set( uint i, const Ray& ray, Scalar tMax = std::numeric_limits<Scalar>::max() );
+
+            /// Returns the ray i.
+            Ray getRay( uint i ) const;
+
+            std::vector<float> m_originX;
+            std::vector<float> m_originY;
+            std::vector<float> m_originZ;
+            std::vector<float> m_directionX;
+            std::vector<float> m_directionY;
+            std::vector<float> m_directionZ;
+            /// Inverses of the directions, a zero component giving the largest float.
+            std::vector<float> m_invDirectionX;
+            std::vector<float> m_invDirectionY;
+            std::vector<float> m_invDirectionZ;
+            std::vector<float> m_tMax;
+        };
+
+        namespace RayCast
+        {
+            /// Number of rays traversing a hierarchy together in vsTriangleMesh().
+            enum BatchMode
+            {
+                STREAM = 1,     // Each ray on its own, for incoherent rays (e.g. ambient occlusion).
+                PACKET_4 = 4,   // Packets of coherent rays (e.g. primary rays of neighbouring pixels).
+                PACKET_8 = 8,
+                PACKET_16 = 16,
+            };
+
+            /// Intersects each ray of the batch with the box. hitsOut[i] is the parameter where
+            /// ray i enters the box (0 if it starts inside), or -1 if the ray misses the box
+            /// before its maximum parameter.
+            /// hitsOut is resized to the size of the batch, so it does not allocate when it is reused.
+            RA_CORE_API void vsAabb( const RayBatch& rays, const Aabb& aabb, std::vector<float>& hitsOut );
+            RA_CORE_API void vsAabb( const RayBatch& rays, const Aabb& aabb, std::vector<float>& hitsOut,
+                                     Simd::Kernel kernel );
+
+            /// Intersects each ray of the batch with the triangle abc. hitsOut[i] is the parameter
+            /// of the hit of ray i, or -1 if the ray misses the triangle before its maximum parameter.
+            RA_CORE_API void vsTriangle( const RayBatch& rays, const Vector3& a, const Vector3& b, const Vector3& c,
+                                         std::vector<float>& hitsOut );
+            RA_CORE_API void vsTriangle( const RayBatch& rays, const Vector3& a, const Vector3& b, const Vector3& c,
+                                         std::vector<float>& hitsOut, Simd::Kernel kernel );
+
+            /// Finds the closest triangle hit by each ray of the batch, using the hierarchy built
+            /// from the mesh. Consecutive rays are grouped in packets of the size given by the mode,
+            /// and packets are processed in parallel (see Core::parallelFor()).
+            /// The triangle tests are the ones of vsTriangle() on a batch, so that all the modes and
+            /// kernels give exactly the same hits. Ties are broken by the lowest triangle index.
+            RA_CORE_API void vsTriangleMesh( const RayBatch& rays, const TriangleMesh& mesh, const TriangleBVH& bvh,
+                                             std::vector<TriangleBVH::Hit>& hitsOut, BatchMode mode = PACKET_8 );
+            RA_CORE_API void vsTriangleMesh( const RayBatch& rays, const TriangleMesh& mesh, const TriangleBVH& bvh,
+                                             std::vector<TriangleBVH::Hit>& hitsOut, BatchMode mode,
+                                             Simd::Kernel kernel );
+        }
+    }
+}
+
+#endif // RADIUMENGINE_RAY_BATCH_HPP_
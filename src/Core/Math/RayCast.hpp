@@ -36,6 +36,10 @@ namespace Ra
             inline bool vsTriangle( const Ray& r, const Core::Vector3 a, const Core::Vector3& b, const Core::Vector3& c,
                             std::vector<Scalar>& hitsOut);
 
+            /// Same as above without allocation. hitOut is only meaningful if the function returns true.
+            inline bool vsTriangle( const Ray& r, const Core::Vector3& a, const Core::Vector3& b, const Core::Vector3& c,
+                                    Scalar& hitOut );
+
             // FIXME(Charly): Not efficient, intersecting against a kd-tree would be ways faster.
             inline bool vsTriangleMesh(const Ray& r, const TriangleMesh& mesh, std::vector<Scalar>& hitsOut, std::vector<Triangle>& trianglesIdxOut);
         }
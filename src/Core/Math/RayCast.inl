@@ -313,6 +313,17 @@ namespace Ra
             }
 
             bool vsTriangle(const Ray &ray, const Vector3 a, const Vector3 &b, const Vector3 &c, std::vector<Scalar> &hitsOut)
+            {
+                Scalar t;
+                if ( vsTriangle( ray, a, b, c, t ) )
+                {
+                    hitsOut.push_back( t );
+                    return true;
+                }
+                return false;
+            }
+
+            bool vsTriangle(const Ray &ray, const Vector3 &a, const Vector3 &b, const Vector3 &c, Scalar &hitOut)
             {
                 const Vector3 ab = b-a;
                 const Vector3 ac = c-a;
@@ -366,12 +377,8 @@ namespace Ra
                 }
 
                 // If we're here we really intersect the triangle so let's compute T.
-                const Scalar t =  ac.dot(qvec) * inv_det ;
-                if ( t >= 0 )
-                {
-                    hitsOut.push_back(t);
-                }
-                return ( t >= 0 );
+                hitOut = ac.dot(qvec) * inv_det ;
+                return ( hitOut >= 0 );
             }
 
             bool vsTriangleMesh(const Ray &r, const TriangleMesh &mesh, std::vector<Scalar> &hitsOut, std::vector<Triangle> &trianglesIdxOut)
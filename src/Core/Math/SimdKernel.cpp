@@ -0,0 +1,96 @@
+#include <Core/Math/SimdKernel.hpp>
+
+#if defined( RA_SIMD_X86 ) && defined( COMPILER_MSVC )
+#   include <intrin.h>
+#   include <immintrin.h>
+#endif
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace Simd
+        {
+            namespace
+            {
+#ifdef RA_SIMD_X86
+                bool cpuSupportsSse()
+                {
+#   if defined( ARCH_X64 )
+                    return true;
+#   elif defined( COMPILER_MSVC )
+                    int info[4];
+                    __cpuid( info, 1 );
+                    return ( info[3] >> 25 ) & 1;
+#   else
+                    return __builtin_cpu_supports( "sse" );
+#   endif
+                }
+
+                bool cpuSupportsAvx()
+                {
+#   if defined( COMPILER_MSVC )
+                    // The processor must support AVX and the OS must save the AVX registers.
+                    int info[4];
+                    __cpuid( info, 1 );
+                    const bool avx = ( info[2] >> 28 ) & 1;
+                    const bool osxsave = ( info[2] >> 27 ) & 1;
+                    return avx && osxsave && ( _xgetbv( 0 ) & 0x6 ) == 0x6;
+#   else
+                    return __builtin_cpu_supports( "avx" );
+#   endif
+                }
+#endif // RA_SIMD_X86
+
+                Kernel detectBestKernel()
+                {
+                    if ( isSupported( AVX ) )
+                    {
+                        return AVX;
+                    }
+                    if ( isSupported( SSE ) )
+                    {
+                        return SSE;
+                    }
+                    return SCALAR;
+                }
+            }
+
+            Kernel getBestKernel()
+            {
+                static const Kernel best = detectBestKernel();
+                return best;
+            }
+
+            bool isSupported( Kernel kernel )
+            {
+                switch ( kernel )
+                {
+#ifdef RA_SIMD_X86
+                    case SSE:
+                        return cpuSupportsSse();
+                    case AVX:
+                        return cpuSupportsAvx();
+#endif
+                    case SCALAR:
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            const char* getKernelName( Kernel kernel )
+            {
+                switch ( kernel )
+                {
+                    case SSE:
+                        return "sse";
+                    case AVX:
+                        return "avx";
+                    default:
+                        return "scalar";
+                }
+            }
+        }
+    }
+}
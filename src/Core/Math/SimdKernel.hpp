@@ -0,0 +1,49 @@
+#ifndef RADIUMENGINE_SIMD_KERNEL_HPP_
+#define RADIUMENGINE_SIMD_KERNEL_HPP_
+
+#include <Core/RaCore.hpp>
+
+// Batch functions (e.g. FrustumCulling::cullBoxes(), RayCast::vsAabb() on a RayBatch) have
+// one implementation per instruction set, chosen at runtime so that the library does not
+// require more than the default instruction set of the compiler.
+#if defined( ARCH_X64 ) || defined( ARCH_X86 )
+#   define RA_SIMD_X86
+#endif
+
+// GCC and Clang only allow the intrinsics of the instruction sets enabled for the function,
+// so that the AVX kernels can be built without requiring AVX for the whole library.
+#if defined( RA_SIMD_X86 ) && ( defined( COMPILER_GCC ) || defined( COMPILER_CLANG ) )
+#   define RA_TARGET_SSE __attribute__( ( target( "sse" ) ) )
+#   define RA_TARGET_AVX __attribute__( ( target( "avx" ) ) )
+#else
+#   define RA_TARGET_SSE
+#   define RA_TARGET_AVX
+#endif
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace Simd
+        {
+            /// Implementations of the batch functions.
+            enum Kernel
+            {
+                SCALAR = 0, // Portable code, one element at a time.
+                SSE,        // 4 elements per iteration.
+                AVX,        // 8 elements per iteration.
+            };
+
+            /// Returns the fastest kernel supported by the processor, detected once at runtime.
+            RA_CORE_API Kernel getBestKernel();
+
+            /// Returns true if the kernel can run on this processor.
+            RA_CORE_API bool isSupported( Kernel kernel );
+
+            /// Returns the name of the kernel, for logs and benchmarks.
+            RA_CORE_API const char* getKernelName( Kernel kernel );
+        }
+    }
+}
+
+#endif // RADIUMENGINE_SIMD_KERNEL_HPP_
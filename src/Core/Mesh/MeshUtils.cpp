@@ -1,8 +1,13 @@
 #include <Core/Mesh/MeshUtils.hpp>
+#include <Core/Mesh/VertexWelder.hpp>
 #include <Core/Math/Math.hpp>
 #include <Core/Math/RayCast.hpp>
+#include <Core/TreeStructures/TriangleBVH.hpp>
+#include <Core/TreeStructures/PointKdTree.hpp>
+#include <Core/Geometry/PointCloud/PointHashGrid.hpp>
 #include <Core/String/StringUtils.hpp>
 #include <Core/Log/Log.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
 
 #include <utility>
 #include <set>
@@ -40,90 +45,116 @@ namespace Ra
                 normalsOut.getMap().colwise().normalize();
             }
 
+            Aabb getAabb( const TriangleMesh& mesh, const Transform& transform )
+            {
+                // The vertices are transformed on the fly, without copying the mesh.
+                return parallelReduce( 0, uint( mesh.m_vertices.size() ), Aabb(),
+                                       [&]( uint i, Aabb& aabb )
+                                       {
+                                           aabb.extend( transform * mesh.m_vertices[i] );
+                                       },
+                                       []( const Aabb& a, const Aabb& b ) { return a.merged( b ); } );
+            }
+
 
             bool findDuplicates( const TriangleMesh& mesh, std::vector<VertexIdx>& duplicatesMap )
             {
-                bool hasDuplicates = false;
-                duplicatesMap.clear();
-                const uint numVerts = mesh.m_vertices.size();
-                duplicatesMap.resize( numVerts,VertexIdx(-1) );
-
-                VectorArray<Vector3>::const_iterator vertPos;
-                VectorArray<Vector3>::const_iterator duplicatePos;
-                std::vector<std::pair<Vector3, VertexIdx>> vertices;
-                
-                for ( uint i = 0; i < numVerts; ++i )
-                {
-                    vertices.push_back(std::make_pair(mesh.m_vertices[i], VertexIdx(i)));
-                }
-                
-                std::sort(vertices.begin(), vertices.end(),
-                          [](std::pair<Vector3, int>a , std::pair<Vector3, int>b){
-                              if(a.first.x() == b.first.x())
-                              {
-                                  if(a.first.y() == b.first.y())
-                                      if(a.first.z() == b.first.z())
-                                          return a.second < b.second;
-                                      else
-                                          return a.first.z() < b.first.z();                                         
-                                  else
-                                      return a.first.y() < b.first.y();
-                              }
-                              return a.first.x() < b.first.x();
-                          }
-                    );
-                // Here vertices contains vertex pos and idx, with equal
-                // vertices contiguous, sorted by idx, so checking if current
-                // vertex equals the previous one state if its a duplicated
-                // vertex position.
-                duplicatesMap[vertices[0].second] = vertices[0].second;
-                for ( uint i = 1; i < numVerts; ++i )                    
-                {
-                    if(vertices[i].first == vertices[i-1].first)
-                    {
-                        duplicatesMap[vertices[i].second] = duplicatesMap[vertices[i-1].second];
-                        hasDuplicates = true;
-                    }
-                    else{
-                        duplicatesMap[vertices[i].second] = vertices[i].second;
-                    }
-                }
-              
-                return hasDuplicates;
+                std::vector<uint> welded;
+                const uint numUnique = VertexWelder( mesh.m_vertices ).weld( welded );
+                duplicatesMap.assign( welded.begin(), welded.end() );
+                return numUnique < welded.size();
             }
 
             void removeDuplicates(TriangleMesh& mesh, std::vector<VertexIdx>& vertexMap)
             {
-                std::vector<VertexIdx> duplicatesMap;
-                findDuplicates(mesh, duplicatesMap);
+                std::vector<uint> duplicatesMap;
+                VertexWelder( mesh.m_vertices ).weld( duplicatesMap );
 
-                std::vector<VertexIdx> newIndices(mesh.m_vertices.size(), VertexIdx(-1));
-                Vector3Array uniqueVertices;
+                // Welded vertices share the position of their first occurrence, and its normal.
+                const bool hasNormals = mesh.m_normals.size() == mesh.m_vertices.size();
+                vertexMap.resize(mesh.m_vertices.size());
+                uint numUnique = 0;
                 for (uint i = 0; i < mesh.m_vertices.size(); i++)
                 {
                     if (duplicatesMap[i] == i)
                     {
-                        newIndices[i] = uniqueVertices.size();
-                        uniqueVertices.push_back(mesh.m_vertices[i]);
-
+                        mesh.m_vertices[numUnique] = mesh.m_vertices[i];
+                        if (hasNormals)
+                        {
+                            mesh.m_normals[numUnique] = mesh.m_normals[i];
+                        }
+                        vertexMap[i] = numUnique++;
+                    }
+                    else
+                    {
+                        vertexMap[i] = vertexMap[duplicatesMap[i]];
                     }
                 }
+                mesh.m_vertices.resize(numUnique);
+                if (hasNormals)
+                {
+                    mesh.m_normals.resize(numUnique);
+                }
 
-                for (uint i = 0; i < mesh.m_triangles.size(); i++)
+                for (auto& t : mesh.m_triangles)
                 {
                     for (uint j = 0; j < 3; j++)
                     {
-                        int oldIdx = mesh.m_triangles[i](j);
-                        int newIdx = newIndices[duplicatesMap[oldIdx]];
-                        mesh.m_triangles[i](j) = newIdx;
+                        t(j) = vertexMap[t(j)];
                     }
                 }
+            }
 
-                vertexMap.resize(mesh.m_vertices.size());
-                for (uint i = 0; i < mesh.m_vertices.size(); i++)
-                    vertexMap[i] = newIndices[duplicatesMap[i]];
+            namespace
+            {
+                // Finds the closest vertex and the closest edge of the hit triangle.
+                void setTriangleHit( const TriangleMesh& mesh, const Ray& ray, int triangle, Scalar t,
+                                     RayCastResult& result )
+                {
+                    result.m_hitTriangle = triangle;
+                    result.m_t = t;
+                    Scalar minDist = std::numeric_limits<Scalar>::max();
+                    std::array<Vector3,3> V;
+                    getTriangleVertices(mesh, triangle, V);
+                    const Triangle& T = mesh.m_triangles[triangle];
+                    const Vector3 I = ray.pointAt(t);
+                    // find closest vertex
+                    for (uint i = 0; i < 3; ++i)
+                    {
+                        Scalar dSq = (V[i] - I).squaredNorm();
+                        if (dSq < minDist)
+                        {
+                            result.m_nearestVertex = T(i);
+                            minDist = dSq;
+                        }
+                    }
+                    // find closest edge vertices
+                    const Scalar inv_2area = 1.0 / (V[1]-V[0]).cross(V[2]-V[0]).norm();
+                    const Scalar u = (V[2]-V[1]).cross(I-V[1]).norm() * inv_2area;
+                    const Scalar v = (V[0]-V[2]).cross(I-V[2]).norm() * inv_2area;
+                    const Scalar w = 1.0 - u - v;
+                    if (u < v && u < w)
+                    {
+                        result.m_edgeVertex0 = T(1);
+                        result.m_edgeVertex1 = T(2);
+                    }
+                    else if (v < w)
+                    {
+                        result.m_edgeVertex0 = T(0);
+                        result.m_edgeVertex1 = T(2);
+                    }
+                    else
+                    {
+                        result.m_edgeVertex0 = T(0);
+                        result.m_edgeVertex1 = T(1);
+                    }
+                }
 
-                mesh.m_vertices = uniqueVertices;
+                void setPointHit( const TriangleMesh& mesh, const Ray& ray, int vertex, RayCastResult& result )
+                {
+                    result.m_nearestVertex = vertex;
+                    result.m_t = ray.distance(mesh.m_vertices[vertex]);
+                }
             }
 
             RayCastResult castRay(const TriangleMesh &mesh, const Ray &ray)
@@ -134,79 +165,79 @@ namespace Ra
                 if (mesh.m_triangles.empty()){
 
                     Scalar minSqAngDist = std::numeric_limits<Scalar>::max();
+                    int nearest = -1;
                     for ( uint i = 0; i < mesh.m_vertices.size(); ++i)
                     {
                         Scalar dist = ray.squaredDistance(mesh.m_vertices[i]);
 
                         if (dist < minSqAngDist) {
                             minSqAngDist = dist;
-                            result.m_nearestVertex = int(i);
+                            nearest = int(i);
                         }
                     }
-                    if ( result.m_nearestVertex != -1 ) {
-                        result.m_t = ray.distance(mesh.m_vertices[result.m_nearestVertex]);
+                    if ( nearest != -1 ) {
+                        setPointHit(mesh, ray, nearest, result);
                     }
                 }
                 else
                 {
                     Scalar minT = std::numeric_limits<Scalar>::max();
-                    std::vector<Scalar> tValues;
+                    int hitTriangle = -1;
                     std::array<Vector3,3> v;
                     for ( uint i = 0; i < mesh.m_triangles.size(); ++i)
                     {
-                        tValues.clear();
+                        Scalar t;
                         getTriangleVertices(mesh, i, v);
-                        if ( RayCast::vsTriangle(ray, v[0], v[1], v[2], tValues) && tValues[0] < minT )
+                        if ( RayCast::vsTriangle(ray, v[0], v[1], v[2], t) && t < minT )
                         {
-                            minT = tValues[0];
-                            result.m_hitTriangle = int(i);
+                            minT = t;
+                            hitTriangle = int(i);
                         }
                     }
 
-                    if (result.m_hitTriangle >= 0)
+                    if (hitTriangle >= 0)
                     {
-                        result.m_t = minT;
-                        Scalar minDist = std::numeric_limits<Scalar>::max();
-                        std::array<Vector3,3> V;
-                        getTriangleVertices(mesh, result.m_hitTriangle, V);
-                        const Triangle& T = mesh.m_triangles[result.m_hitTriangle];
-                        const Vector3 I = ray.pointAt(minT);
-                        // find closest vertex
-                        for (uint i = 0; i < 3; ++i)
-                        {
-                            Scalar dSq = (V[i] - I).squaredNorm();
-                            if (dSq < minDist)
-                            {
-                                result.m_nearestVertex = T(i);
-                                minDist = dSq;
-                            }
-                        }
-                        // find closest edge vertices
-                        const Scalar inv_2area = 1.0 / (V[1]-V[0]).cross(V[2]-V[0]).norm();
-                        const Scalar u = (V[2]-V[1]).cross(I-V[1]).norm() * inv_2area;
-                        const Scalar v = (V[0]-V[2]).cross(I-V[2]).norm() * inv_2area;
-                        const Scalar w = 1.0 - u - v;
-                        if (u < v && u < w)
-                        {
-                            result.m_edgeVertex0 = T(1);
-                            result.m_edgeVertex1 = T(2);
-                        }
-                        else if (v < w)
-                        {
-                            result.m_edgeVertex0 = T(0);
-                            result.m_edgeVertex1 = T(2);
-                        }
-                        else
-                        {
-                            result.m_edgeVertex0 = T(0);
-                            result.m_edgeVertex1 = T(1);
-                        }
+                        setTriangleHit(mesh, ray, hitTriangle, minT, result);
                     }
                 }
 
                 return result;
             }
 
+            RayCastResult castRay( const TriangleMesh& mesh, const TriangleBVH& bvh, const Ray& ray )
+            {
+                CORE_ASSERT( !mesh.m_triangles.empty(), "Point clouds should use a PointKdTree." );
+                RayCastResult result;
+                const TriangleBVH::Hit hit = bvh.castRay( mesh, ray );
+                if ( hit.m_triangle >= 0 )
+                {
+                    setTriangleHit( mesh, ray, hit.m_triangle, hit.m_t, result );
+                }
+                return result;
+            }
+
+            RayCastResult castRay( const TriangleMesh& mesh, const PointKdTree& tree, const Ray& ray )
+            {
+                RayCastResult result;
+                const int nearest = tree.getNearestToRay( ray );
+                if ( nearest >= 0 )
+                {
+                    setPointHit( mesh, ray, nearest, result );
+                }
+                return result;
+            }
+
+            RayCastResult castRay( const TriangleMesh& mesh, const PointHashGrid& grid, const Ray& ray )
+            {
+                RayCastResult result;
+                const int nearest = grid.getNearestToRay( ray );
+                if ( nearest >= 0 )
+                {
+                    setPointHit( mesh, ray, nearest, result );
+                }
+                return result;
+            }
+
             /// Return the mean edge length of the given triangle mesh
             Scalar getMeanEdgeLength( const TriangleMesh& mesh ) {
                 typedef std::pair< uint, uint > Key;
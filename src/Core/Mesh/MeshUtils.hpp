@@ -12,6 +12,9 @@ namespace Ra
 {
     namespace Core
     {
+        class TriangleBVH;
+        class PointKdTree;
+        class PointHashGrid;
 
         /// Functions to operate on a TriangleMesh
         namespace MeshUtils
@@ -32,6 +35,10 @@ namespace Ra
 
             inline Aabb getAabb( const TriangleMesh& mesh );
 
+            /// Returns the AABB of the vertices of the mesh moved by transform, which is tighter than
+            /// the transformed AABB of the mesh when transform rotates it.
+            RA_CORE_API Aabb getAabb( const TriangleMesh& mesh, const Transform& transform );
+
             /// If t1 is triangle (v1,v2,v3), returns v3.
             inline uint getLastVertex( const Triangle& t1, uint v1, uint v2 );
 
@@ -42,9 +49,11 @@ namespace Ra
             RA_CORE_API void getAutoNormals( TriangleMesh& mesh, VectorArray<Vector3>& normalsOut );
 
             /// Finds the duplicate vertices in a mesh, returning an array indicating for each vertex where to find the
-            /// first occurrence.
+            /// first occurrence. See VertexWelder to also compare attributes or to use a tolerance.
             RA_CORE_API bool findDuplicates( const TriangleMesh& mesh, std::vector<VertexIdx>& duplicatesMap );
 
+            /// Removes the duplicate vertices of a mesh, keeping the normals of their first occurrence.
+            /// vertexMap gives the new index of each vertex.
             RA_CORE_API void removeDuplicates(TriangleMesh& mesh, std::vector<VertexIdx>& vertexMap);
 
 
@@ -62,8 +71,16 @@ namespace Ra
             };
 
             /// Return the index of the triangle hit by the ray or -1 if there's no hit.
+            /// Linear in the number of triangles, see the overloads below for repeated queries.
             RA_CORE_API RayCastResult castRay( const TriangleMesh& mesh, const Ray& ray);
 
+            /// Same result as castRay(), using a hierarchy built from the triangles of the mesh.
+            RA_CORE_API RayCastResult castRay( const TriangleMesh& mesh, const TriangleBVH& bvh, const Ray& ray );
+
+            /// Same result as castRay() for a point cloud, using a tree built from its vertices.
+            RA_CORE_API RayCastResult castRay( const TriangleMesh& mesh, const PointKdTree& tree, const Ray& ray );
+            RA_CORE_API RayCastResult castRay( const TriangleMesh& mesh, const PointHashGrid& grid, const Ray& ray );
+
             /// Return the mean edge length of the given triangle mesh
             RA_CORE_API Scalar getMeanEdgeLength( const TriangleMesh& mesh );
 
@@ -0,0 +1,332 @@
+#include <Core/Mesh/VertexWelder.hpp>
+
+#include <Core/Containers/RadixSort.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace
+        {
+            /// Number of bits of the hashes of the keys of the vertices.
+            constexpr uint HashBits = 32;
+            /// With a tolerance, the cells are grouped in blocks of 2^BlockBits cells along each axis.
+            constexpr uint BlockBits = 3;
+            /// Number of bits of the Morton code of a cell in its block.
+            constexpr uint LocalBits = 3 * BlockBits;
+            /// Bound of the cell coordinates, keeping huge or infinite positions in the outer cells.
+            constexpr std::int64_t MaxCell = std::int64_t( 1 ) << 40;
+
+            inline std::uint64_t combineHash( std::uint64_t hash, std::uint64_t value )
+            {
+                return hash ^ ( value + 0x9e3779b97f4a7c15ull + ( hash << 6 ) + ( hash >> 2 ) );
+            }
+
+            /// Mixes the bits of hash and keeps HashBits of them.
+            inline std::uint64_t getKey( std::uint64_t hash )
+            {
+                hash ^= hash >> 33;
+                hash *= 0xff51afd7ed558ccdull;
+                hash ^= hash >> 33;
+                hash *= 0xc4ceb9fe1a85ec53ull;
+                hash ^= hash >> 33;
+                return hash >> ( 64 - HashBits );
+            }
+
+            /// Spreads the BlockBits low bits of x so that they are 3 bits apart.
+            inline std::uint64_t spreadBits( std::int64_t x )
+            {
+                std::uint64_t bits = 0;
+                for ( uint b = 0; b < BlockBits; ++b )
+                {
+                    bits |= std::uint64_t( x >> b & 1 ) << ( 3 * b );
+                }
+                return bits;
+            }
+
+            /// Returns the bits of x, which are the same for 0 and -0 as they are equal.
+            inline std::uint64_t getBits( Scalar x )
+            {
+                const Scalar value = x == 0 ? Scalar( 0 ) : x;
+                std::uint64_t bits = 0;
+                std::memcpy( &bits, &value, sizeof( Scalar ) );
+                return bits;
+            }
+
+            inline std::int64_t getCellCoordinate( Scalar x )
+            {
+                return !( x > Scalar( -MaxCell ) ) ? -MaxCell
+                       : x < Scalar( MaxCell ) ? std::int64_t( std::floor( x ) ) : MaxCell;
+            }
+        }
+
+        VertexWelder::VertexWelder( const VectorArray<Vector3>& positions, Scalar tolerance )
+            : m_numVertices( uint( positions.size() ) )
+        {
+            addAttribute( positions, tolerance );
+        }
+
+        void VertexWelder::addAttribute( const Scalar* data, uint size, uint stride, Scalar tolerance )
+        {
+            CORE_ASSERT( tolerance >= 0, "Tolerances cannot be negative." );
+            m_attributes.push_back( Attribute{ data, size, stride, tolerance } );
+        }
+
+        bool VertexWelder::isMatching( uint i, uint j, uint firstAttribute ) const
+        {
+            for ( uint n = firstAttribute; n < m_attributes.size(); ++n )
+            {
+                const Attribute& attribute = m_attributes[n];
+                const Scalar* a = attribute.m_data + std::size_t( i ) * attribute.m_stride;
+                const Scalar* b = attribute.m_data + std::size_t( j ) * attribute.m_stride;
+                for ( uint k = 0; k < attribute.m_size; ++k )
+                {
+                    if ( !( a[k] == b[k] || std::abs( a[k] - b[k] ) <= attribute.m_tolerance ) )
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        uint VertexWelder::weld( std::vector<uint>& duplicatesMap ) const
+        {
+            const uint size = m_numVertices;
+            duplicatesMap.resize( size );
+            if ( size == 0 )
+            {
+                return 0;
+            }
+
+            // With a tolerance, the positions are quantised in cells of four times the tolerance :
+            // the positions close enough to a vertex are in its cell, or along the axes where the
+            // vertex is close to a side of its cell, in the neighbour cell on this side.
+            const Attribute& positions = m_attributes[0];
+            const bool useCells = positions.m_tolerance > 0;
+            const Scalar invCellSize = useCells ? 1 / ( 4 * positions.m_tolerance ) : Scalar( 0 );
+
+            // Hash of the attributes which must be equal.
+            auto getExactHash = [&]( uint i )
+            {
+                std::uint64_t hash = 0;
+                for ( const auto& attribute : m_attributes )
+                {
+                    if ( attribute.m_tolerance == 0 )
+                    {
+                        const Scalar* a = attribute.m_data + std::size_t( i ) * attribute.m_stride;
+                        for ( uint k = 0; k < attribute.m_size; ++k )
+                        {
+                            hash = combineHash( hash, getBits( a[k] ) );
+                        }
+                    }
+                }
+                return hash;
+            };
+            // The key of a cell hashes its block in the high bits, followed by the Morton code of
+            // the cell in its block : the cells of a block are contiguous once sorted.
+            auto getCellKey = [&]( std::uint64_t hash, const std::array<std::int64_t, 3>& cell )
+            {
+                std::uint64_t local = 0;
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    hash = combineHash( hash, std::uint64_t( cell[k] >> BlockBits ) );
+                    local |= spreadBits( cell[k] ) << k;
+                }
+                return getKey( hash ) << LocalBits | local;
+            };
+            auto getCell = [&]( uint i, std::array<std::int64_t, 3>& cell, std::array<int, 3>& side )
+            {
+                const Scalar* p = positions.m_data + std::size_t( i ) * positions.m_stride;
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    const Scalar x = p[k] * invCellSize;
+                    cell[k] = getCellCoordinate( x );
+                    const Scalar fraction = x - Scalar( cell[k] );
+                    side[k] = fraction < Scalar( 0.3 ) ? -1 : fraction >= Scalar( 0.7 ) ? 1 : 0;
+                }
+            };
+
+            std::vector<std::uint64_t> keys( size );
+            std::vector<uint> order( size );
+            parallelFor( 0, size, [&]( uint i )
+            {
+                if ( useCells )
+                {
+                    std::array<std::int64_t, 3> cell;
+                    std::array<int, 3> side;
+                    getCell( i, cell, side );
+                    keys[i] = getCellKey( getExactHash( i ), cell );
+                }
+                else
+                {
+                    keys[i] = getKey( getExactHash( i ) );
+                }
+                order[i] = i;
+            } );
+            // The vertices with equal keys stay sorted by index.
+            radixSort( keys, order, useCells ? HashBits + LocalBits : HashBits );
+
+            // Runs of vertices with equal keys, and with a tolerance an open addressing table of
+            // the blocks giving their runs, holding the first run plus one (0 for an empty slot).
+            std::vector<uint> runs;
+            std::vector<std::uint64_t> runKeys;
+            for ( uint r = 0; r < size; ++r )
+            {
+                if ( r == 0 || keys[r] != keys[r - 1] )
+                {
+                    runs.push_back( r );
+                    runKeys.push_back( keys[r] );
+                }
+            }
+            const uint numRuns = uint( runs.size() );
+            runs.push_back( size );
+
+            struct Slot
+            {
+                std::uint32_t m_block;
+                uint m_firstRun;
+                uint m_endRun;
+            };
+            std::vector<Slot> table;
+            uint mask = 0;
+            if ( useCells )
+            {
+                std::vector<uint> blocks;
+                for ( uint run = 0; run < numRuns; ++run )
+                {
+                    if ( run == 0 || runKeys[run] >> LocalBits != runKeys[run - 1] >> LocalBits )
+                    {
+                        blocks.push_back( run );
+                    }
+                }
+                blocks.push_back( numRuns );
+
+                uint tableSize = 1;
+                while ( tableSize < 2 * blocks.size() )
+                {
+                    tableSize *= 2;
+                }
+                table.assign( tableSize, Slot{ 0, 0, 0 } );
+                mask = tableSize - 1;
+                for ( uint b = 0; b + 1 < blocks.size(); ++b )
+                {
+                    const std::uint32_t block = std::uint32_t( runKeys[blocks[b]] >> LocalBits );
+                    uint slot = block & mask;
+                    while ( table[slot].m_firstRun != 0 )
+                    {
+                        slot = ( slot + 1 ) & mask;
+                    }
+                    table[slot] = Slot{ block, blocks[b] + 1, blocks[b + 1] };
+                }
+            }
+            // Returns the run of a key, searching the runs of its block.
+            auto findRun = [&]( std::uint64_t key )
+            {
+                const std::uint32_t block = std::uint32_t( key >> LocalBits );
+                for ( uint slot = block & mask; table[slot].m_firstRun != 0; slot = ( slot + 1 ) & mask )
+                {
+                    if ( table[slot].m_block == block )
+                    {
+                        const auto first = runKeys.begin() + ( table[slot].m_firstRun - 1 );
+                        const auto last = runKeys.begin() + table[slot].m_endRun;
+                        const auto run = std::lower_bound( first, last, key );
+                        return run != last && *run == key ? int( run - runKeys.begin() ) : -1;
+                    }
+                }
+                return -1;
+            };
+
+            // The positions are compared in the order of the keys, so that the runs are contiguous.
+            Vector3Array sortedPositions( size );
+            parallelFor( 0, size, [&]( uint r )
+            {
+                const Scalar* p = positions.m_data + std::size_t( order[r] ) * positions.m_stride;
+                sortedPositions[r] = Vector3( p[0], p[1], p[2] );
+            } );
+
+            // Finds the first vertex matching each vertex, in the run of its key and, with a
+            // tolerance, in the runs of the neighbour cells.
+            std::vector<uint> firstMatch( size );
+            auto findFirstMatch = [&]( uint i, const Vector3& p, uint runBegin, uint runEnd, uint match )
+            {
+                for ( uint r = runBegin; r < runEnd && order[r] < match; ++r )
+                {
+                    const Vector3& q = sortedPositions[r];
+                    bool isClose = true;
+                    for ( uint k = 0; k < 3; ++k )
+                    {
+                        isClose = isClose && ( p[k] == q[k] || std::abs( p[k] - q[k] ) <= positions.m_tolerance );
+                    }
+                    if ( isClose && isMatching( order[r], i, 1 ) )
+                    {
+                        return order[r];
+                    }
+                }
+                return match;
+            };
+            parallelFor( 0, numRuns, [&]( uint run )
+            {
+                for ( uint r = runs[run]; r < runs[run + 1]; ++r )
+                {
+                    const uint i = order[r];
+                    const Vector3& p = sortedPositions[r];
+                    uint match = findFirstMatch( i, p, runs[run], r, i );
+                    if ( useCells )
+                    {
+                        std::array<std::int64_t, 3> cell;
+                        std::array<int, 3> side;
+                        getCell( i, cell, side );
+                        const std::uint64_t hash = getExactHash( i );
+                        for ( uint neighbour = 1; neighbour < 8; ++neighbour )
+                        {
+                            std::array<std::int64_t, 3> other = cell;
+                            bool isNeeded = true;
+                            for ( uint k = 0; k < 3; ++k )
+                            {
+                                if ( neighbour >> k & 1 )
+                                {
+                                    other[k] += side[k];
+                                    isNeeded = isNeeded && side[k] != 0;
+                                }
+                            }
+                            if ( !isNeeded )
+                            {
+                                continue;
+                            }
+                            const int otherRun = findRun( getCellKey( hash, other ) );
+                            if ( otherRun >= 0 )
+                            {
+                                match = findFirstMatch( i, p, runs[otherRun], runs[otherRun + 1], match );
+                            }
+                        }
+                    }
+                    firstMatch[i] = match;
+                }
+            } );
+
+            // The first matches have lower indices : their duplicates are known.
+            uint numUnique = 0;
+            for ( uint i = 0; i < size; ++i )
+            {
+                if ( firstMatch[i] == i )
+                {
+                    duplicatesMap[i] = i;
+                    ++numUnique;
+                }
+                else
+                {
+                    duplicatesMap[i] = duplicatesMap[firstMatch[i]];
+                }
+            }
+            return numUnique;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef RADIUMENGINE_VERTEX_WELDER_HPP_
+#define RADIUMENGINE_VERTEX_WELDER_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Containers/VectorArray.hpp>
+
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Finds the vertices of a mesh which can be welded in a single vertex because they
+        /// have the same position and attributes (normals, texture coordinates, colours...).
+        /// Each vertex gets a key hashing its quantised position and its exact attributes. The
+        /// keys are radix sorted so that the candidates to welding are contiguous.
+        class RA_CORE_API VertexWelder
+        {
+        public:
+            /// Vertices are welded when each coordinate of their positions differ by at most
+            /// tolerance, or are equal if tolerance is 0.
+            /// The positions must stay valid until weld() is called.
+            explicit VertexWelder( const VectorArray<Vector3>& positions, Scalar tolerance = 0 );
+
+            /// Adds an attribute which must also match for vertices to be welded, each of its
+            /// components differing by at most tolerance. The values must stay valid until weld()
+            /// is called.
+            template <typename Vector>
+            inline void addAttribute( const VectorArray<Vector>& values, Scalar tolerance = 0 );
+
+            /// Writes in duplicatesMap, for each vertex, the index of the vertex it is welded with,
+            /// which is the lowest index of the welded vertices, and returns the number of unique
+            /// vertices. With a tolerance, a vertex is welded with the first vertex matching it, so
+            /// that chains of matching vertices are welded together.
+            uint weld( std::vector<uint>& duplicatesMap ) const;
+
+        private:
+            struct Attribute
+            {
+                const Scalar* m_data;
+                uint m_size;
+                uint m_stride;
+                Scalar m_tolerance;
+            };
+
+            void addAttribute( const Scalar* data, uint size, uint stride, Scalar tolerance );
+
+            /// Returns true if the attributes of vertices i and j match, from firstAttribute on.
+            bool isMatching( uint i, uint j, uint firstAttribute ) const;
+
+        private:
+            uint m_numVertices;
+            /// The positions are the first attribute.
+            std::vector<Attribute> m_attributes;
+        };
+    }
+}
+
+#include <Core/Mesh/VertexWelder.inl>
+
+#endif // RADIUMENGINE_VERTEX_WELDER_HPP_
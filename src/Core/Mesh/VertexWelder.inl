@@ -0,0 +1,16 @@
+#include <Core/Mesh/VertexWelder.hpp>
+
+namespace Ra
+{
+    namespace Core
+    {
+        template <typename Vector>
+        inline void VertexWelder::addAttribute( const VectorArray<Vector>& values, Scalar tolerance )
+        {
+            static_assert( sizeof( Vector ) % sizeof( Scalar ) == 0, "Attributes must be vectors of Scalar." );
+            CORE_ASSERT( values.size() == m_numVertices, "Each vertex must have an attribute value." );
+            addAttribute( values.empty() ? nullptr : values[0].data(), uint( Vector::SizeAtCompileTime ),
+                          uint( sizeof( Vector ) / sizeof( Scalar ) ), tolerance );
+        }
+    }
+}
@@ -1,8 +1,7 @@
 #include <Core/Mesh/Wrapper/TopologicalMeshConvert.hpp>
+#include <Core/Mesh/VertexWelder.hpp>
 #include <Core/Log/Log.hpp>
 
-#include <unordered_map>
-
 namespace Ra
 {
     namespace Core
@@ -10,48 +9,20 @@ namespace Ra
 
         void MeshConverter::convert( TopologicalMesh& in, TriangleMesh& out )
         {
-
-            struct vertexData
-            {
-                Vector3 _vertex;
-                Vector3 _normal;
-            };
-
-            struct comp_vec
-            {
-                bool operator()( const vertexData& lhv, const vertexData& rhv ) const
-                {
-                    if ( lhv._vertex[0] < rhv._vertex[0] || ( lhv._vertex[0] == rhv._vertex[0] &&
-                                                              lhv._vertex[1] < rhv._vertex[1] ) || ( lhv._vertex[0] == rhv._vertex[0] &&
-                                                                                                     lhv._vertex[1] == rhv._vertex[1] && lhv._vertex[2] < rhv._vertex[2] ) )
-                    {
-                        return true;
-                    }
-                    return false;
-                }
-            };
-
             out.clear();
-            typedef std::map<vertexData, int, comp_vec> vMap;
-
-            vMap vertexHandles;
 
             in.request_face_normals();
             in.request_vertex_normals();
             in.update_vertex_normals();
 
-            // iterator over all faces
-            unsigned int vertexIndex = 0;
-
-            // out will have at least least n_vertices and n_normals.
-            out.m_vertices.reserve( in.n_vertices() );
-            out.m_normals.reserve( in.n_vertices() );
-            out.m_triangles.reserve( in.n_faces() );
-            
+            // Gather the position and normal of each face corner, then weld the corners with
+            // the same position and normal in a vertex.
+            Vector3Array points;
+            Vector3Array normals;
+            points.reserve( 3 * in.n_faces() );
+            normals.reserve( 3 * in.n_faces() );
             for ( TopologicalMesh::FaceIter f_it = in.faces_sbegin(); f_it != in.faces_end(); ++f_it )
             {
-                vertexData v;
-                int indices[3];
                 int i = 0;
                 // iterator over vertex (thru halfedge to get access to halfedge normals)
                 for ( TopologicalMesh::FaceHalfedgeIter fv_it = in.fh_iter( *f_it ); fv_it.is_valid(); ++fv_it )
@@ -59,72 +30,68 @@ namespace Ra
                     assert( i < 3 );
                     TopologicalMesh::Point p = in.point( in.to_vertex_handle( *fv_it ) );
                     TopologicalMesh::Normal n = in.normal( in.to_vertex_handle( *fv_it ) );
-                    v._vertex = Core::Vector3( p[0], p[1], p[2] );
-                    v._normal = Core::Vector3( n[0], n[1], n[2] );
-
-                    int vi;
-                    vMap::iterator vtr = vertexHandles.find( v );
-                    if ( vtr == vertexHandles.end() )
-                    {
-                        vi = vertexIndex++;
-                        vertexHandles.insert( vtr, vMap::value_type( v, vi ) );
-                        out.m_vertices.push_back( v._vertex );
-                        out.m_normals.push_back( v._normal );
-                    }
-                    else
-                    {
-                        vi = vtr->second;
-                    }
-                    indices[i] = vi;
+                    points.push_back( Core::Vector3( p[0], p[1], p[2] ) );
+                    normals.push_back( Core::Vector3( n[0], n[1], n[2] ) );
                     i ++;
                 }
-                out.m_triangles.emplace_back( indices[0], indices[1], indices[2] );
             }
-            assert( vertexIndex == out.m_vertices.size() );
 
-        }
-
-        void MeshConverter::convert( const TriangleMesh& in, TopologicalMesh& out )
-        {
+            VertexWelder welder( points );
+            welder.addAttribute( normals );
+            std::vector<uint> duplicatesMap;
+            const uint numVertices = welder.weld( duplicatesMap );
 
-            struct hash_vec
+            // Vertices are numbered in the order of their first corner.
+            out.m_vertices.reserve( numVertices );
+            out.m_normals.reserve( numVertices );
+            out.m_triangles.reserve( in.n_faces() );
+            std::vector<int> vertexIndices( points.size() );
+            for ( uint c = 0; c < points.size(); ++c )
             {
-                size_t operator()( const Vector3& lvalue ) const
+                if ( duplicatesMap[c] == c )
+                {
+                    vertexIndices[c] = int( out.m_vertices.size() );
+                    out.m_vertices.push_back( points[c] );
+                    out.m_normals.push_back( normals[c] );
+                }
+                else
                 {
-                    return lvalue[0] + lvalue[1] + lvalue[2] +
-                           floor( lvalue[0] ) * 1000.f +
-                           floor( lvalue[1] ) * 1000.f +
-                           floor( lvalue[2] ) * 1000.f;
+                    vertexIndices[c] = vertexIndices[duplicatesMap[c]];
                 }
-            };
+            }
+            for ( uint c = 0; c + 2 < points.size(); c += 3 )
+            {
+                out.m_triangles.emplace_back( vertexIndices[c], vertexIndices[c + 1], vertexIndices[c + 2] );
+            }
+            assert( numVertices == out.m_vertices.size() );
+        }
 
+        void MeshConverter::convert( const TriangleMesh& in, TopologicalMesh& out )
+        {
             //Delete old data in out mesh
             out = TopologicalMesh();
             out.garbage_collection();
             out.request_vertex_normals();
-            typedef std::unordered_map<Vector3, TopologicalMesh::VertexHandle, hash_vec> vMap;
-            vMap vertexHandles;
+
+            // Vertices at the same position are a single topological vertex, added at its first corner.
+            std::vector<uint> duplicatesMap;
+            VertexWelder( in.m_vertices ).weld( duplicatesMap );
+            std::vector<TopologicalMesh::VertexHandle> vertexHandles( in.m_vertices.size() );
 
             std::vector<TopologicalMesh::VertexHandle> face_vhandles;
 
             uint num_halfedge = in.m_triangles.size() * 3;
             for ( unsigned int i = 0; i < num_halfedge; i++ )
             {
-                Vector3 p = in.m_vertices[in.m_triangles[i / 3][i % 3]];
-                Vector3 n = in.m_normals[in.m_triangles[i / 3][i % 3]];
-
-                vMap::iterator vtr = vertexHandles.find( p );
-                TopologicalMesh::VertexHandle vh;
-                if ( vtr == vertexHandles.end() )
+                const uint v = duplicatesMap[in.m_triangles[i / 3][i % 3]];
+                TopologicalMesh::VertexHandle& vh = vertexHandles[v];
+                if ( !vh.is_valid() )
                 {
+                    const Vector3& p = in.m_vertices[v];
+                    const Vector3& n = in.m_normals[in.m_triangles[i / 3][i % 3]];
                     vh = out.add_vertex( TopologicalMesh::Point( p[0], p[1], p[2] ) );
-                    vertexHandles.insert( vtr, vMap::value_type( p, vh ) );
                     out.set_normal( vh, TopologicalMesh::Normal( n[0], n[1], n[2] ) );
                 }
-                else
-                {
-                    vh = vtr->second;
-                }
                 face_vhandles.push_back( vh );
 
                 if ( ( ( i + 1 ) % 3 ) == 0 )
@@ -0,0 +1,65 @@
+#include <Core/Tasks/TaskProfiler.hpp>
+
+// Replacement of the global operator new which reports the allocations to the
+// ThreadProfiler. This file is not part of radiumCore, which must not replace the
+// operators of the programs linking it : an executable which wants its tasks to count
+// their allocations adds it to its sources (see RADIUM_ALLOCATION_HOOK_SOURCE).
+// It is empty unless compiled with RADIUM_WITH_PROFILING.
+#if defined( ALLOW_PROFILING )
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    void* countedAlloc( std::size_t size )
+    {
+        Ra::Core::ThreadProfiler::countAllocation( size );
+        // malloc(0) may return nullptr, while operator new must return a unique pointer.
+        const std::size_t allocSize = size > 0 ? size : 1;
+        void* ptr = std::malloc( allocSize );
+        while ( ptr == nullptr )
+        {
+            std::new_handler handler = std::get_new_handler();
+            if ( handler == nullptr )
+            {
+                throw std::bad_alloc();
+            }
+            handler();
+            ptr = std::malloc( allocSize );
+        }
+        return ptr;
+    }
+}
+
+void* operator new( std::size_t size )
+{
+    return countedAlloc( size );
+}
+
+void* operator new[]( std::size_t size )
+{
+    return countedAlloc( size );
+}
+
+void operator delete( void* ptr ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete[]( void* ptr ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete( void* ptr, std::size_t ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete[]( void* ptr, std::size_t ) noexcept
+{
+    std::free( ptr );
+}
+
+#endif // ALLOW_PROFILING
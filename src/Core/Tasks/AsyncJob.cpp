@@ -0,0 +1,62 @@
+#include <Core/Tasks/AsyncJob.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <thread>
+
+namespace Ra
+{
+    namespace Core
+    {
+        AsyncJob::AsyncJob( const std::string& name )
+            : m_name( name ), m_state( PENDING ), m_cancelRequested( false )
+        {
+        }
+
+        bool AsyncJob::isDone() const
+        {
+            const State state = getState();
+            return state == FINISHED || state == CANCELLED;
+        }
+
+        void AsyncJob::wait() const
+        {
+            while ( !isDone() )
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        void AsyncJob::execute()
+        {
+            if ( !m_cancelRequested )
+            {
+                m_state = RUNNING;
+                run();
+            }
+            m_state = m_cancelRequested ? CANCELLED : FINISHED;
+        }
+
+        void AsyncJob::complete()
+        {
+            if ( getState() == FINISHED && !m_cancelRequested )
+            {
+                onCompletion();
+            }
+        }
+
+        void runInBackground( const std::shared_ptr<AsyncJob>& job )
+        {
+            TaskQueue* queue = getParallelTaskQueue();
+            if ( queue != nullptr )
+            {
+                queue->runInBackground( job );
+            }
+            else
+            {
+                job->execute();
+                job->complete();
+            }
+        }
+    }
+}
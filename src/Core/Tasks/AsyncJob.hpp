@@ -0,0 +1,129 @@
+#ifndef RADIUMENGINE_ASYNC_JOB_HPP_
+#define RADIUMENGINE_ASYNC_JOB_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <functional>
+
+namespace Ra
+{
+    namespace Core
+    {
+        class TaskQueue;
+        class AsyncJob;
+
+        /// Runs the job in the background on the threads of the parallel task queue
+        /// (see setParallelTaskQueue()). When no task queue is set, the job is run and
+        /// completed immediately on the calling thread.
+        RA_CORE_API void runInBackground( const std::shared_ptr<AsyncJob>& job );
+    }
+}
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// A long-running job executed in the background by the threads of a task queue.
+        /// Unlike tasks, background jobs are not part of the frame : they run on idle threads
+        /// across several frames and their completion is delivered later on the main thread,
+        /// when the task queue processes its completed jobs (see TaskQueue::runInBackground()).
+        /// The shared pointer to the job acts as a future on its result.
+        class RA_CORE_API AsyncJob
+        {
+        public:
+            enum State
+            {
+                PENDING,    /// Waiting for a thread.
+                RUNNING,    /// Being run by a thread.
+                FINISHED,   /// Run completed, the completion callback may not have been called yet.
+                CANCELLED,  /// Cancelled before or while running.
+            };
+
+            explicit AsyncJob( const std::string& name );
+
+            virtual ~AsyncJob() {}
+
+            /// Return the name of the job.
+            const std::string& getName() const { return m_name; }
+
+            /// Returns the current state of the job.
+            State getState() const { return State( m_state.load() ); }
+
+            /// Returns true if the job is finished or cancelled.
+            bool isDone() const;
+
+            /// Requests the cancellation of the job. A pending job will not be run, a running job
+            /// stops when it next checks isCancelled(). In both cases onCompletion() is not called,
+            /// so the owner of a job must cancel it before being destroyed.
+            void cancel() { m_cancelRequested = true; }
+
+            /// Cancellation token, to be checked regularly by the implementation of run().
+            bool isCancelled() const { return m_cancelRequested; }
+
+            /// Blocks until the job is finished or cancelled.
+            void wait() const;
+
+        protected:
+            /// Do the job. Will be called from one of the task queue threads.
+            virtual void run() = 0;
+
+            /// Called from the main thread after the job has finished, on a later frame.
+            virtual void onCompletion() {}
+
+        private:
+            friend class TaskQueue;
+            friend void runInBackground( const std::shared_ptr<AsyncJob>& job );
+
+            /// Runs the job unless it has been cancelled, and updates its state.
+            void execute();
+
+            /// Calls onCompletion() if the job finished and was not cancelled since.
+            void complete();
+
+            std::string m_name;
+            std::atomic<int> m_state;
+            std::atomic<bool> m_cancelRequested;
+        };
+
+        /// A background job around a std::function computing a result of type T.
+        /// The function receives the job itself, to check for cancellation.
+        /// The optional callback receives the result on the main thread.
+        template <typename T>
+        class AsyncFunctionJob : public AsyncJob
+        {
+        public:
+            typedef std::function<T( const AsyncJob& )> Function;
+            typedef std::function<void( T& )> Callback;
+
+            AsyncFunctionJob( const Function& f, const Callback& callback, const std::string& name )
+                : AsyncJob( name ), m_function( f ), m_callback( callback ) {}
+
+            /// Returns the result of the job, which must be FINISHED.
+            const T& getResult() const;
+            T& getResult();
+
+        protected:
+            virtual void run() override { m_result = m_function( *this ); }
+
+            virtual void onCompletion() override;
+
+        private:
+            Function m_function;
+            Callback m_callback;
+            T m_result;
+        };
+
+        /// Creates an AsyncFunctionJob and runs it in the background.
+        template <typename T>
+        inline std::shared_ptr<AsyncFunctionJob<T>> runInBackground( const std::string& name,
+            const typename AsyncFunctionJob<T>::Function& f,
+            const typename AsyncFunctionJob<T>::Callback& callback = typename AsyncFunctionJob<T>::Callback() );
+    }
+}
+
+#include <Core/Tasks/AsyncJob.inl>
+
+#endif // RADIUMENGINE_ASYNC_JOB_HPP_
@@ -0,0 +1,40 @@
+#include "AsyncJob.hpp"
+
+namespace Ra
+{
+    namespace Core
+    {
+        template <typename T>
+        const T& AsyncFunctionJob<T>::getResult() const
+        {
+            CORE_ASSERT( getState() == FINISHED, "Job " << getName() << " is not finished" );
+            return m_result;
+        }
+
+        template <typename T>
+        T& AsyncFunctionJob<T>::getResult()
+        {
+            CORE_ASSERT( getState() == FINISHED, "Job " << getName() << " is not finished" );
+            return m_result;
+        }
+
+        template <typename T>
+        void AsyncFunctionJob<T>::onCompletion()
+        {
+            if ( m_callback )
+            {
+                m_callback( m_result );
+            }
+        }
+
+        template <typename T>
+        inline std::shared_ptr<AsyncFunctionJob<T>> runInBackground( const std::string& name,
+            const typename AsyncFunctionJob<T>::Function& f,
+            const typename AsyncFunctionJob<T>::Callback& callback )
+        {
+            std::shared_ptr<AsyncFunctionJob<T>> job = std::make_shared<AsyncFunctionJob<T>>( f, callback, name );
+            runInBackground( std::shared_ptr<AsyncJob>( job ) );
+            return job;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include <Core/Tasks/ParallelFor.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace
+        {
+            /// Task queue running the parallel loops. It is read by the threads of the pool
+            /// when they run nested loops, while the main thread may set it.
+            std::atomic<TaskQueue*> g_parallelTaskQueue( nullptr );
+
+            /// Number of chunks per thread used when the grain size is not given,
+            /// to balance the load when chunks have different costs.
+            constexpr uint ChunksPerThread = 4;
+        }
+
+        void setParallelTaskQueue( TaskQueue* queue )
+        {
+            g_parallelTaskQueue.store( queue );
+        }
+
+        TaskQueue* getParallelTaskQueue()
+        {
+            return g_parallelTaskQueue.load();
+        }
+
+        uint getParallelChunkCount( uint begin, uint end, uint grainSize )
+        {
+            if ( end <= begin )
+            {
+                return 0;
+            }
+            const uint size = end - begin;
+            if ( grainSize == 0 )
+            {
+                // The calling thread works with the threads of the pool.
+                const TaskQueue* queue = g_parallelTaskQueue.load();
+                const uint numThreads = queue ? queue->getNumThreads() + 1 : 1;
+                grainSize = std::max( 1u, size / ( ChunksPerThread * numThreads ) );
+            }
+            return ( size + grainSize - 1 ) / grainSize;
+        }
+
+        void parallelRange( uint begin, uint end, uint grainSize,
+                            const std::function<void( uint, uint, uint )>& f )
+        {
+            const uint numChunks = getParallelChunkCount( begin, end, grainSize );
+            if ( numChunks == 0 )
+            {
+                return;
+            }
+            const uint chunkSize = ( end - begin + numChunks - 1 ) / numChunks;
+
+            auto runChunk = [&]( uint chunk )
+            {
+                const uint chunkBegin = begin + chunk * chunkSize;
+                const uint chunkEnd = std::min( end, chunkBegin + chunkSize );
+                f( chunk, chunkBegin, chunkEnd );
+            };
+
+            // Read once, so that the whole loop runs on the same queue.
+            TaskQueue* queue = g_parallelTaskQueue.load();
+            if ( queue == nullptr )
+            {
+                for ( uint c = 0; c < numChunks; ++c )
+                {
+                    runChunk( c );
+                }
+            }
+            else
+            {
+                queue->runParallel( numChunks, runChunk );
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef RADIUMENGINE_PARALLEL_FOR_HPP_
+#define RADIUMENGINE_PARALLEL_FOR_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <functional>
+
+namespace Ra
+{
+    namespace Core
+    {
+        class TaskQueue;
+    }
+}
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Sets the task queue whose threads run the parallel loops below. The application
+        /// should set its main task queue so that the engine only has one pool of threads.
+        /// When no task queue is set (or after setting nullptr) the loops run sequentially.
+        RA_CORE_API void setParallelTaskQueue( TaskQueue* queue );
+
+        /// Returns the task queue used by parallel loops, or nullptr.
+        RA_CORE_API TaskQueue* getParallelTaskQueue();
+
+        /// Returns the number of chunks of grainSize indices needed to cover [begin, end).
+        /// If grainSize is 0, a grain size is chosen from the number of threads available.
+        RA_CORE_API uint getParallelChunkCount( uint begin, uint end, uint grainSize );
+
+        /// Splits [begin, end) in chunks as getParallelChunkCount() does and calls
+        /// f( chunk, chunkBegin, chunkEnd ) for each chunk on the threads of the parallel task queue.
+        /// Returns when all chunks are processed.
+        RA_CORE_API void parallelRange( uint begin, uint end, uint grainSize,
+                                        const std::function<void( uint, uint, uint )>& f );
+
+        /// Calls f( i ) for each i in [begin, end), in parallel. Calls must be independent.
+        /// grainSize is the number of consecutive indices processed by a single thread
+        /// (0 lets the function choose).
+        template <typename Func>
+        inline void parallelFor( uint begin, uint end, const Func& f, uint grainSize = 0 );
+
+        /// Reduces the range [begin, end) in parallel : each chunk of the range is accumulated
+        /// in its own value starting from identity by calling f( i, value ), then the values of
+        /// the chunks are combined in order with value = reduce( value, chunkValue ).
+        /// Results are deterministic for a given grain size.
+        template <typename T, typename Func, typename Reduce>
+        inline T parallelReduce( uint begin, uint end, const T& identity, const Func& f,
+                                 const Reduce& reduce, uint grainSize = 0 );
+    }
+}
+
+#include <Core/Tasks/ParallelFor.inl>
+
+#endif // RADIUMENGINE_PARALLEL_FOR_HPP_
@@ -0,0 +1,43 @@
+#include "ParallelFor.hpp"
+
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        template <typename Func>
+        inline void parallelFor( uint begin, uint end, const Func& f, uint grainSize )
+        {
+            parallelRange( begin, end, grainSize, [&f]( uint, uint chunkBegin, uint chunkEnd )
+            {
+                for ( uint i = chunkBegin; i < chunkEnd; ++i )
+                {
+                    f( i );
+                }
+            } );
+        }
+
+        template <typename T, typename Func, typename Reduce>
+        inline T parallelReduce( uint begin, uint end, const T& identity, const Func& f,
+                                 const Reduce& reduce, uint grainSize )
+        {
+            std::vector<T> chunkValues( getParallelChunkCount( begin, end, grainSize ), identity );
+            parallelRange( begin, end, grainSize, [&f, &chunkValues]( uint chunk, uint chunkBegin, uint chunkEnd )
+            {
+                T& value = chunkValues[chunk];
+                for ( uint i = chunkBegin; i < chunkEnd; ++i )
+                {
+                    f( i, value );
+                }
+            } );
+
+            T result = identity;
+            for ( const auto& value : chunkValues )
+            {
+                result = reduce( result, value );
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,135 @@
+#include <Core/Tasks/TaskProfiler.hpp>
+
+#include <atomic>
+#include <cstring>
+
+#if defined( OS_LINUX )
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace
+        {
+            // Allocations of the current thread, reported by the allocation hook.
+            // Plain integers so that they can be used before any constructor runs.
+            thread_local ulong g_allocatedBytes = 0;
+            thread_local ulong g_allocations = 0;
+
+            // Set by the first reported allocation.
+            std::atomic<bool> g_hasAllocationHook( false );
+
+#if defined( OS_LINUX )
+            int openHardwareCounter( ulong config, int groupFd )
+            {
+                perf_event_attr attr;
+                std::memset( &attr, 0, sizeof( attr ) );
+                attr.size = sizeof( attr );
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = config;
+                attr.read_format = PERF_FORMAT_GROUP;
+                // User space only, which is allowed with the default perf_event_paranoid setting.
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                // Count the calling thread on any cpu.
+                return int( syscall( __NR_perf_event_open, &attr, 0, -1, groupFd, 0 ) );
+            }
+#endif
+        }
+
+        TaskCounters& TaskCounters::operator+=( const TaskCounters& other )
+        {
+            instructions += other.instructions;
+            cacheMisses += other.cacheMisses;
+            contextSwitches += other.contextSwitches;
+            allocatedBytes += other.allocatedBytes;
+            allocations += other.allocations;
+            return *this;
+        }
+
+        TaskCounters TaskCounters::operator-( const TaskCounters& other ) const
+        {
+            TaskCounters result;
+            result.instructions = instructions - other.instructions;
+            result.cacheMisses = cacheMisses - other.cacheMisses;
+            result.contextSwitches = contextSwitches - other.contextSwitches;
+            result.allocatedBytes = allocatedBytes - other.allocatedBytes;
+            result.allocations = allocations - other.allocations;
+            return result;
+        }
+
+        ThreadProfiler::ThreadProfiler()
+            : m_instructionsFd( -1 ), m_cacheMissesFd( -1 )
+        {
+#if defined( OS_LINUX )
+            m_instructionsFd = openHardwareCounter( PERF_COUNT_HW_INSTRUCTIONS, -1 );
+            if ( m_instructionsFd >= 0 )
+            {
+                m_cacheMissesFd = openHardwareCounter( PERF_COUNT_HW_CACHE_MISSES, m_instructionsFd );
+                if ( m_cacheMissesFd < 0 )
+                {
+                    close( m_instructionsFd );
+                    m_instructionsFd = -1;
+                }
+            }
+#endif
+        }
+
+        ThreadProfiler::~ThreadProfiler()
+        {
+#if defined( OS_LINUX )
+            if ( m_instructionsFd >= 0 )
+            {
+                close( m_cacheMissesFd );
+                close( m_instructionsFd );
+            }
+#endif
+        }
+
+        TaskCounters ThreadProfiler::read() const
+        {
+            TaskCounters counters;
+#if defined( OS_LINUX )
+            if ( m_instructionsFd >= 0 )
+            {
+                // Layout of a PERF_FORMAT_GROUP read : number of counters, then their values.
+                struct { __u64 nr; __u64 values[2]; } group;
+                if ( ::read( m_instructionsFd, &group, sizeof( group ) ) == ssize_t( sizeof( group ) ) )
+                {
+                    counters.instructions = ulong( group.values[0] );
+                    counters.cacheMisses = ulong( group.values[1] );
+                }
+            }
+
+            rusage usage;
+            if ( getrusage( RUSAGE_THREAD, &usage ) == 0 )
+            {
+                counters.contextSwitches = ulong( usage.ru_nvcsw + usage.ru_nivcsw );
+            }
+#endif
+            counters.allocatedBytes = g_allocatedBytes;
+            counters.allocations = g_allocations;
+            return counters;
+        }
+
+        bool ThreadProfiler::hasAllocationCounters()
+        {
+            return g_hasAllocationHook.load( std::memory_order_relaxed );
+        }
+
+        void ThreadProfiler::countAllocation( std::size_t size )
+        {
+            g_allocatedBytes += size;
+            ++g_allocations;
+            if ( !g_hasAllocationHook.load( std::memory_order_relaxed ) )
+            {
+                g_hasAllocationHook.store( true, std::memory_order_relaxed );
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef RADIUMENGINE_TASK_PROFILER_HPP_
+#define RADIUMENGINE_TASK_PROFILER_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <cstddef>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Performance counters measured over the execution of a task.
+        /// Counters which are not available stay at zero.
+        struct RA_CORE_API TaskCounters
+        {
+            TaskCounters()
+                : instructions( 0 ), cacheMisses( 0 ), contextSwitches( 0 )
+                , allocatedBytes( 0 ), allocations( 0 ) {}
+
+            TaskCounters& operator+=( const TaskCounters& other );
+            TaskCounters operator-( const TaskCounters& other ) const;
+
+            ulong instructions;     /// Instructions retired (hardware counter).
+            ulong cacheMisses;      /// Last level cache misses (hardware counter).
+            ulong contextSwitches;  /// Voluntary and involuntary context switches.
+            ulong allocatedBytes;   /// Bytes allocated with operator new.
+            ulong allocations;      /// Number of calls to operator new.
+        };
+
+        /// Reads the performance counters of the thread which created it.
+        /// Hardware counters are read with perf_event_open on Linux. They are not available on
+        /// other platforms or when the system does not allow them (see hasHardwareCounters()).
+        /// Allocations are only counted when the executable reports them with countAllocation(),
+        /// which the operator new of Core/Tasks/AllocationHook.cpp does.
+        class RA_CORE_API ThreadProfiler
+        {
+        public:
+            ThreadProfiler();
+            ~ThreadProfiler();
+
+            ThreadProfiler( const ThreadProfiler& ) = delete;
+            ThreadProfiler& operator=( const ThreadProfiler& ) = delete;
+
+            /// Returns true if instructions and cache misses are counted.
+            bool hasHardwareCounters() const { return m_instructionsFd >= 0; }
+
+            /// Returns the current value of the counters of the calling thread, which must
+            /// be the thread which created this object.
+            TaskCounters read() const;
+
+            /// Returns true if allocations are counted.
+            static bool hasAllocationCounters();
+
+            /// Adds an allocation of size bytes to the counters of the calling thread.
+            static void countAllocation( std::size_t size );
+
+        private:
+            /// File descriptors of the hardware counters (-1 if unavailable).
+            /// The instructions counter leads the group, so that both are read at once.
+            int m_instructionsFd;
+            int m_cacheMissesFd;
+        };
+    }
+}
+
+#endif // RADIUMENGINE_TASK_PROFILER_HPP_
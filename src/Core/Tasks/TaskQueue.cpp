@@ -1,5 +1,6 @@
 #include <Core/Tasks/TaskQueue.hpp>
 #include <Core/Tasks/Task.hpp>
+#include <Core/Tasks/AsyncJob.hpp>
 
 #include <stack>
 #include <iostream>
@@ -10,21 +11,59 @@ namespace Ra
     namespace Core
     {
 
-        TaskQueue::TaskQueue( uint numThreads )
-            : m_processingTasks( 0 ), m_shuttingDown( false )
+        TaskQueue::TaskQueue( uint numThreads, SchedulingMode mode )
+            : m_criticalPathPriorities( false ), m_readyOrder( 0 )
+            , m_processingTasks( 0 ), m_shuttingDown( false )
+            , m_unfinishedTasks( 0 ), m_readyTasks( 0 ), m_sleepingThreads( 0 )
+            , m_numParallelJobs( 0 ), m_numBackgroundJobs( 0 )
+            , m_maxRunningJobs( numThreads > 1 ? numThreads - 1 : 1 ), m_profiling( false )
+            , m_mode( mode ), m_isCompiled( false )
         {
             CORE_ASSERT( numThreads > 0, " You need at least one thread" );
+            // The last profiler is used by the thread calling waitForTasks().
+            m_threadProfilers.resize( numThreads + 1 );
+            if ( m_mode == WORK_STEALING )
+            {
+                m_workerQueues.reserve( numThreads );
+                for ( uint i = 0 ; i < numThreads; ++i )
+                {
+                    m_workerQueues.emplace_back( new WorkerQueue );
+                }
+            }
+
             m_workerThreads.reserve( numThreads );
             for ( uint i = 0 ; i < numThreads; ++i )
             {
-                m_workerThreads.emplace_back( std::thread( &TaskQueue::runThread, this, i ) );
+                if ( m_mode == WORK_STEALING )
+                {
+                    m_workerThreads.emplace_back( std::thread( &TaskQueue::runStealingThread, this, i ) );
+                }
+                else
+                {
+                    m_workerThreads.emplace_back( std::thread( &TaskQueue::runThread, this, i ) );
+                }
             }
         }
 
         TaskQueue::~TaskQueue()
         {
-            flushTaskQueue();
-            m_shuttingDown = true;
+            clearGraph();
+            {
+                std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                m_shuttingDown = true;
+
+                // Pending background jobs are dropped, running ones are asked to stop.
+                for ( const auto& job : m_backgroundJobs )
+                {
+                    job->cancel();
+                    job->m_state = AsyncJob::CANCELLED;
+                }
+                m_backgroundJobs.clear();
+                for ( const auto& job : m_runningJobs )
+                {
+                    job->cancel();
+                }
+            }
             m_threadNotifier.notify_all();
             for ( auto& t :  m_workerThreads )
             {
@@ -32,11 +71,13 @@ namespace Ra
             }
         }
 
-        TaskQueue::TaskId TaskQueue::registerTask( Task* task )
+        TaskQueue::TaskId TaskQueue::registerTask( Task* task, Priority priority )
         {
+            CORE_ASSERT( !m_isCompiled, "Cannot add a task to a compiled graph" );
             m_tasks.emplace_back( std::unique_ptr<Task> ( task ) );
             m_dependencies.push_back( std::vector<TaskId>() );
             m_remainingDependencies.push_back( 0 );
+            m_priorities.push_back( priority );
             TimerData tdata;
             tdata.taskName = task->getName();
             m_timerData.push_back( tdata );
@@ -44,14 +85,28 @@ namespace Ra
             CORE_ASSERT( m_tasks.size() == m_dependencies.size(), "Inconsistent task list" );
             CORE_ASSERT( m_tasks.size() == m_remainingDependencies.size(), "Inconsistent task list" );
             CORE_ASSERT( m_tasks.size() == m_timerData.size(), "Inconsistent task list" );
+            CORE_ASSERT( m_tasks.size() == m_priorities.size(), "Inconsistent task list" );
             return TaskId( m_tasks.size() - 1 );
         }
 
+        void TaskQueue::setPriority( TaskQueue::TaskId task, Priority priority )
+        {
+            CORE_ASSERT( task < m_tasks.size(), "Invalid task" );
+            m_priorities[task] = priority;
+        }
+
+        TaskQueue::Priority TaskQueue::getPriority( TaskQueue::TaskId task ) const
+        {
+            CORE_ASSERT( task < m_tasks.size(), "Invalid task" );
+            return m_priorities[task];
+        }
+
         void TaskQueue::addDependency( TaskQueue::TaskId predecessor, TaskQueue::TaskId successor )
         {
             CORE_ASSERT( ( predecessor != InvalidTaskId ) && ( predecessor < m_tasks.size() ), "Invalid predecessor task" );
             CORE_ASSERT( ( successor != InvalidTaskId )   && ( successor < m_tasks.size() ), "Invalid successor task" );
             CORE_ASSERT( predecessor != successor, "Cannot add self-dependency" );
+            CORE_ASSERT( !m_isCompiled, "Cannot add a dependency to a compiled graph" );
 
             CORE_ASSERT( std::find( m_dependencies[predecessor].begin(), m_dependencies[predecessor].end(), successor ) == m_dependencies[predecessor].end(), "Cannot add a dependency twice" );
 
@@ -116,7 +171,60 @@ namespace Ra
         void TaskQueue::queueTask( TaskQueue::TaskId task )
         {
             CORE_ASSERT( m_remainingDependencies[task] == 0, " Task" << m_tasks[task]->getName() <<"has unmet dependencies" );
-            m_taskQueue.push_front( task );
+            m_taskQueue.push_back( ReadyTask{ task, m_priorities[task], m_readyOrder++ } );
+            std::push_heap( m_taskQueue.begin(), m_taskQueue.end() );
+        }
+
+        void TaskQueue::queueLocalTask( TaskQueue::TaskId task, uint threadId )
+        {
+            CORE_ASSERT( m_atomicDependencies[task] == 0, " Task" << m_tasks[task]->getName() <<"has unmet dependencies" );
+            // Count the task before it is visible so that m_readyTasks never underflows.
+            ++m_readyTasks;
+            WorkerQueue& queue = *m_workerQueues[threadId];
+            std::lock_guard<std::mutex> lock( queue.m_mutex );
+            queue.m_tasks.push_front( task );
+        }
+
+        TaskQueue::TaskId TaskQueue::popOrStealTask( uint threadId )
+        {
+            const uint numThreads = m_workerQueues.size();
+            for ( uint i = 0; i < numThreads; ++i )
+            {
+                const uint victim = ( threadId + i ) % numThreads;
+                WorkerQueue& queue = *m_workerQueues[victim];
+                std::lock_guard<std::mutex> lock( queue.m_mutex );
+                if ( !queue.m_tasks.empty() )
+                {
+                    TaskId task = InvalidTaskId;
+                    // Work on our most recent task, but steal the oldest task of others.
+                    if ( victim == threadId )
+                    {
+                        task = queue.m_tasks.front();
+                        queue.m_tasks.pop_front();
+                    }
+                    else
+                    {
+                        task = queue.m_tasks.back();
+                        queue.m_tasks.pop_back();
+                    }
+                    --m_readyTasks;
+                    return task;
+                }
+            }
+            return InvalidTaskId;
+        }
+
+        void TaskQueue::wakeUpThread()
+        {
+            if ( m_sleepingThreads > 0 )
+            {
+                // Taking the lock guarantees the sleeping thread is either waiting on the
+                // notifier or will see the new task when checking its wake-up condition.
+                {
+                    std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                }
+                m_threadNotifier.notify_one();
+            }
         }
 
         void TaskQueue::detectCycles()
@@ -155,20 +263,185 @@ namespace Ra
 #endif
         }
 
-        void TaskQueue::startTasks()
+        void TaskQueue::buildSuccessorArrays()
         {
-            // Add pending dependencies.
-            resolveDependencies();
+            const uint numTasks = m_tasks.size();
+            m_successorOffsets.resize( numTasks + 1 );
+            m_successors.clear();
+            for ( uint t = 0; t < numTasks; ++t )
+            {
+                m_successorOffsets[t] = m_successors.size();
+                m_successors.insert( m_successors.end(), m_dependencies[t].begin(), m_dependencies[t].end() );
+            }
+            m_successorOffsets[numTasks] = m_successors.size();
+
+            m_initialDependencies = m_remainingDependencies;
 
-            // Do a debug check
+            if ( m_mode == WORK_STEALING )
+            {
+                m_atomicDependencies.reset( new std::atomic<uint>[numTasks] );
+            }
+        }
+
+        void TaskQueue::recordTaskStats()
+        {
+            for ( auto& entry : m_taskStats )
+            {
+                entry.second.m_total = 0;
+                entry.second.m_count = 0;
+                entry.second.m_counters = TaskCounters();
+            }
+            for ( const auto& tdata : m_timerData )
+            {
+                NamedTaskStats& stats = m_taskStats[tdata.taskName];
+                stats.m_total += Timer::getIntervalMicro( tdata.start, tdata.end );
+                ++stats.m_count;
+                stats.m_counters += tdata.counters;
+            }
+        }
+
+        void TaskQueue::computeCriticalPathPriorities()
+        {
+            const uint numTasks = m_tasks.size();
+
+            // Sort the tasks in topological order.
+            m_sortCounters = m_initialDependencies;
+            m_sortedTasks.clear();
+            for ( uint t = 0; t < numTasks; ++t )
+            {
+                if ( m_sortCounters[t] == 0 )
+                {
+                    m_sortedTasks.push_back( t );
+                }
+            }
+            for ( uint i = 0; i < m_sortedTasks.size(); ++i )
+            {
+                const TaskId task = m_sortedTasks[i];
+                for ( uint s = m_successorOffsets[task]; s < m_successorOffsets[task + 1]; ++s )
+                {
+                    if ( --m_sortCounters[m_successors[s]] == 0 )
+                    {
+                        m_sortedTasks.push_back( m_successors[s] );
+                    }
+                }
+            }
+            CORE_ASSERT( m_sortedTasks.size() == numTasks, "Cycle detected in tasks !" );
+
+            // Accumulate the durations from the end of the graph.
+            for ( auto it = m_sortedTasks.rbegin(); it != m_sortedTasks.rend(); ++it )
+            {
+                const TaskId task = *it;
+                const TimerData& tdata = m_timerData[task];
+
+                // Tasks of a compiled graph have their own timings, new tasks use their name.
+                Timer::MicroSeconds duration = 0;
+                if ( tdata.end > tdata.start )
+                {
+                    duration = Timer::getIntervalMicro( tdata.start, tdata.end );
+                }
+                else
+                {
+                    auto found = m_taskStats.find( tdata.taskName );
+                    if ( found != m_taskStats.end() && found->second.m_count > 0 )
+                    {
+                        duration = found->second.m_total / found->second.m_count;
+                    }
+                }
+
+                // Unknown tasks still count, so that longer chains come first.
+                Priority longestSuccessor = 0;
+                for ( uint s = m_successorOffsets[task]; s < m_successorOffsets[task + 1]; ++s )
+                {
+                    longestSuccessor = std::max( longestSuccessor, m_priorities[m_successors[s]] );
+                }
+                m_priorities[task] = longestSuccessor + Priority( std::max( duration, Timer::MicroSeconds( 1 ) ) );
+            }
+        }
+
+        void TaskQueue::compileGraph()
+        {
+            CORE_ASSERT( !m_isCompiled, "Graph is already compiled" );
+            resolveDependencies();
             detectCycles();
+            buildSuccessorArrays();
+            m_isCompiled = true;
+        }
+
+        void TaskQueue::clearGraph()
+        {
+            m_isCompiled = false;
+            flushTaskQueue();
+            m_successorOffsets.clear();
+            m_successors.clear();
+            m_initialDependencies.clear();
+        }
+
+        void TaskQueue::startTasks()
+        {
+            // A compiled graph has already been resolved and checked.
+            if ( !m_isCompiled )
+            {
+                // Add pending dependencies.
+                resolveDependencies();
+
+                // Do a debug check
+                detectCycles();
+
+                buildSuccessorArrays();
+            }
+
+            const uint numTasks = m_tasks.size();
+
+            if ( m_criticalPathPriorities )
+            {
+                computeCriticalPathPriorities();
+            }
+
+            if ( m_mode == WORK_STEALING )
+            {
+                // Reset the atomic dependency counters, which can be decremented without lock.
+                for ( uint t = 0; t < numTasks; ++t )
+                {
+                    m_atomicDependencies[t] = m_initialDependencies[t];
+                }
+                m_unfinishedTasks = numTasks;
+
+                // Spread the tasks with no dependencies over the threads, by decreasing priority.
+                m_sortedTasks.clear();
+                for ( uint t = 0; t < numTasks; ++t )
+                {
+                    if ( m_initialDependencies[t] == 0 )
+                    {
+                        m_sortedTasks.push_back( t );
+                    }
+                }
+                std::stable_sort( m_sortedTasks.begin(), m_sortedTasks.end(), [this]( TaskId a, TaskId b )
+                {
+                    return m_priorities[a] > m_priorities[b];
+                } );
+                // Tasks are pushed at the front, so push the lowest priorities first.
+                for ( uint i = m_sortedTasks.size(); i > 0; --i )
+                {
+                    queueLocalTask( m_sortedTasks[i - 1], ( i - 1 ) % m_workerQueues.size() );
+                }
+
+                std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                m_threadNotifier.notify_all();
+                return;
+            }
 
             // Enqueue all tasks with no dependencies.
-            for ( uint t = 0; t < m_tasks.size(); ++t )
             {
-                if ( m_remainingDependencies[t] == 0 )
+                std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                std::copy( m_initialDependencies.begin(), m_initialDependencies.end(),
+                           m_remainingDependencies.begin() );
+                m_readyOrder = 0;
+                for ( uint t = 0; t < numTasks; ++t )
                 {
-                    queueTask( t );
+                    if ( m_remainingDependencies[t] == 0 )
+                    {
+                        queueTask( t );
+                    }
                 }
             }
 
@@ -178,14 +451,40 @@ namespace Ra
 
         void TaskQueue::waitForTasks()
         {
+            // When all the threads of the pool are running background jobs (which happens with
+            // a single thread), the calling thread runs the ready tasks so that the frame goes on.
+            const uint callerId = m_workerThreads.size();
             bool isFinished = false;
             while ( !isFinished )
             {
+                TaskId task = InvalidTaskId;
                 // TODO : use a notifier for task queue empty.
-                m_taskQueueMutex.lock();
-                isFinished = ( m_taskQueue.empty() && m_processingTasks == 0 );
-                m_taskQueueMutex.unlock();
-                if ( !isFinished )
+                if ( m_mode == WORK_STEALING )
+                {
+                    isFinished = ( m_unfinishedTasks == 0 );
+                    if ( !isFinished && m_numBackgroundJobs > 0 && isPoolBusyWithJobs()
+                         && ( task = popOrStealTask( callerId ) ) != InvalidTaskId )
+                    {
+                        processTask( task, callerId );
+                        finishStealingTask( task, callerId );
+                    }
+                }
+                else
+                {
+                    m_taskQueueMutex.lock();
+                    isFinished = ( m_taskQueue.empty() && m_processingTasks == 0 );
+                    if ( !m_taskQueue.empty() && m_runningJobs.size() >= m_workerThreads.size() )
+                    {
+                        task = popReadyTask();
+                    }
+                    m_taskQueueMutex.unlock();
+                    if ( task != InvalidTaskId )
+                    {
+                        processTask( task, callerId );
+                        finishTask( task );
+                    }
+                }
+                if ( !isFinished && task == InvalidTaskId )
                 {
                     std::this_thread::yield();
                 }
@@ -201,10 +500,21 @@ namespace Ra
         {
             CORE_ASSERT( m_processingTasks == 0, "You have tasks still in process" );
             CORE_ASSERT( m_taskQueue.empty(), " You have unprocessed tasks " );
+            CORE_ASSERT( m_unfinishedTasks == 0, " You have unprocessed tasks " );
+            if ( m_criticalPathPriorities || m_profiling )
+            {
+                recordTaskStats();
+            }
+            if ( m_isCompiled )
+            {
+                return;
+            }
+            m_atomicDependencies.reset();
             m_tasks.clear();
             m_dependencies.clear();
             m_timerData.clear();
             m_remainingDependencies.clear();
+            m_priorities.clear();
         }
 
         void TaskQueue::runThread( uint id )
@@ -219,7 +529,12 @@ namespace Ra
 
                     // Wait for a new task
                     // TODO : use the second form of wait()
-                    while ( !m_shuttingDown && m_taskQueue.empty() )
+                    ParallelJob* job = nullptr;
+                    std::shared_ptr<AsyncJob> backgroundJob;
+                    // The parallel loops are looked for before the tasks, so that a queued task
+                    // does not delay a thread which is blocked on a loop.
+                    while ( !m_shuttingDown && ( job = findParallelJob() ) == nullptr && m_taskQueue.empty()
+                            && ( backgroundJob = popBackgroundJob() ) == nullptr )
                     {
                         m_threadNotifier.wait( lock );
                     }
@@ -230,53 +545,342 @@ namespace Ra
                         return;
                     }
 
+                    // Parallel loops are run first, as another thread is blocked on them.
+                    if ( job != nullptr )
+                    {
+                        ++job->m_helpers;
+                        lock.unlock();
+                        runParallelChunks( *job );
+                        --job->m_helpers;
+                        continue;
+                    }
+
+                    // Background jobs are only taken when there is nothing else to do.
+                    if ( backgroundJob != nullptr )
+                    {
+                        lock.unlock();
+                        runBackgroundJob( backgroundJob );
+                        continue;
+                    }
+
                     // If we are here it means we got a task
-                    task = m_taskQueue.back();
-                    m_taskQueue.pop_back();
-                    ++m_processingTasks;
-                    CORE_ASSERT( task != InvalidTaskId && task < m_tasks.size(), "Invalid task" );
+                    task = popReadyTask();
                 }
                 // Release mutex.
 
                 // Run task
-                m_timerData[task].start = Timer::Clock::now();
-                m_timerData[task].threadId = id;
-                m_tasks[task]->process();
-                m_timerData[task].end = Timer::Clock::now();
+                processTask( task, id );
+                finishTask( task );
+            } // End of while(true)
+        }
+
+        TaskQueue::TaskId TaskQueue::popReadyTask()
+        {
+            std::pop_heap( m_taskQueue.begin(), m_taskQueue.end() );
+            const TaskId task = m_taskQueue.back().m_task;
+            m_taskQueue.pop_back();
+            ++m_processingTasks;
+            CORE_ASSERT( task != InvalidTaskId && task < m_tasks.size(), "Invalid task" );
+            return task;
+        }
 
-                // Critical section : mark task as finished and en-queue dependencies.
-                uint newTasks = 0;
+        void TaskQueue::finishTask( TaskQueue::TaskId task )
+        {
+            // Critical section : mark task as finished and en-queue dependencies.
+            uint newTasks = 0;
+            {
+                std::unique_lock<std::mutex> lock( m_taskQueueMutex );
+                for ( uint i = m_successorOffsets[task]; i < m_successorOffsets[task + 1]; ++i )
                 {
-                    std::unique_lock<std::mutex> lock( m_taskQueueMutex );
-                    for ( auto t : m_dependencies[task] )
+                    const TaskId t = m_successors[i];
+                    uint& nDepends = m_remainingDependencies[t];
+                    CORE_ASSERT( nDepends > 0, "Inconsistency in dependencies" );
+                    --nDepends;
+                    if ( nDepends == 0 )
                     {
-                        uint& nDepends = m_remainingDependencies[t];
-                        CORE_ASSERT( nDepends > 0, "Inconsistency in dependencies" );
-                        --nDepends;
-                        if ( nDepends == 0 )
-                        {
-                            queueTask( t );
-                            ++newTasks;
-                        }
-                        // TODO :Easy optimization : grab one of the new task and process it immediately.
+                        queueTask( t );
+                        ++newTasks;
                     }
-                    --m_processingTasks;
+                    // TODO :Easy optimization : grab one of the new task and process it immediately.
+                }
+                --m_processingTasks;
+            }
+            // If we added new tasks, we wake up one thread to execute it.
+            if ( newTasks > 0 )
+            {
+                m_threadNotifier.notify_one();
+            }
+        }
+
+        void TaskQueue::runStealingThread( uint id )
+        {
+            while ( true )
+            {
+                // Parallel loops are run first, as another thread is blocked on them.
+                if ( m_numParallelJobs > 0 && helpParallelJob() )
+                {
+                    continue;
                 }
-                // If we added new tasks, we wake up one thread to execute it.
-                if ( newTasks > 0 )
+
+                TaskId task = popOrStealTask( id );
+
+                // No task available : run a background job or sleep until some work is queued.
+                if ( task == InvalidTaskId )
                 {
-                    m_threadNotifier.notify_one();
+                    std::unique_lock<std::mutex> lock( m_taskQueueMutex );
+                    std::shared_ptr<AsyncJob> backgroundJob = popBackgroundJob();
+                    if ( backgroundJob != nullptr )
+                    {
+                        lock.unlock();
+                        runBackgroundJob( backgroundJob );
+                        continue;
+                    }
+                    ++m_sleepingThreads;
+                    m_threadNotifier.wait( lock, [this]()
+                    {
+                        return m_shuttingDown || m_readyTasks > 0 || findParallelJob() != nullptr
+                               || hasBackgroundJob();
+                    } );
+                    --m_sleepingThreads;
+                    if ( m_shuttingDown )
+                    {
+                        return;
+                    }
+                    continue;
                 }
+
+                CORE_ASSERT( task < m_tasks.size(), "Invalid task" );
+                processTask( task, id );
+                finishStealingTask( task, id );
             } // End of while(true)
         }
 
+        void TaskQueue::finishStealingTask( TaskQueue::TaskId task, uint threadId )
+        {
+            // The thread calling waitForTasks() has no queue of its own and uses the first one.
+            const uint id = threadId < m_workerQueues.size() ? threadId : 0;
+
+            // Mark task as finished and push the successors on our own queue.
+            // The ready successor with the highest priority is pushed last, to be run next.
+            uint newTasks = 0;
+            TaskId nextTask = InvalidTaskId;
+            for ( uint i = m_successorOffsets[task]; i < m_successorOffsets[task + 1]; ++i )
+            {
+                TaskId t = m_successors[i];
+                CORE_ASSERT( m_atomicDependencies[t] > 0, "Inconsistency in dependencies" );
+                if ( m_atomicDependencies[t].fetch_sub( 1 ) == 1 )
+                {
+                    if ( nextTask == InvalidTaskId || m_priorities[t] > m_priorities[nextTask] )
+                    {
+                        std::swap( t, nextTask );
+                    }
+                    if ( t != InvalidTaskId )
+                    {
+                        queueLocalTask( t, id );
+                    }
+                    ++newTasks;
+                }
+            }
+            if ( nextTask != InvalidTaskId )
+            {
+                queueLocalTask( nextTask, id );
+            }
+            --m_unfinishedTasks;
+
+            // We will process one of the new tasks ourselves, others may be stolen.
+            for ( uint i = 1; i < newTasks; ++i )
+            {
+                wakeUpThread();
+            }
+        }
+
+        void TaskQueue::runParallel( uint numChunks, const std::function<void( uint )>& chunkFunction )
+        {
+            // Avoid the synchronization cost when there is nothing to share.
+            if ( numChunks <= 1 )
+            {
+                for ( uint c = 0; c < numChunks; ++c )
+                {
+                    chunkFunction( c );
+                }
+                return;
+            }
+
+            ParallelJob job( numChunks, chunkFunction );
+            {
+                std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                m_parallelJobs.push_back( &job );
+                ++m_numParallelJobs;
+            }
+            m_threadNotifier.notify_all();
+
+            // The calling thread works on the job too, so that this cannot deadlock
+            // even if all the threads of the pool are busy.
+            runParallelChunks( job );
+            while ( job.m_doneChunks < numChunks )
+            {
+                std::this_thread::yield();
+            }
+
+            // Once the job is removed no thread can pick it, wait for the ones still holding it.
+            {
+                std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                m_parallelJobs.erase( std::find( m_parallelJobs.begin(), m_parallelJobs.end(), &job ) );
+                --m_numParallelJobs;
+            }
+            while ( job.m_helpers > 0 )
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        TaskQueue::ParallelJob* TaskQueue::findParallelJob() const
+        {
+            for ( ParallelJob* job : m_parallelJobs )
+            {
+                if ( job->m_nextChunk < job->m_numChunks )
+                {
+                    return job;
+                }
+            }
+            return nullptr;
+        }
+
+        void TaskQueue::runParallelChunks( ParallelJob& job )
+        {
+            uint chunk;
+            while ( ( chunk = job.m_nextChunk++ ) < job.m_numChunks )
+            {
+                job.m_function( chunk );
+                ++job.m_doneChunks;
+            }
+        }
+
+        bool TaskQueue::helpParallelJob()
+        {
+            ParallelJob* job = nullptr;
+            {
+                std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                job = findParallelJob();
+                if ( job == nullptr )
+                {
+                    return false;
+                }
+                ++job->m_helpers;
+            }
+            runParallelChunks( *job );
+            --job->m_helpers;
+            return true;
+        }
+
+        void TaskQueue::runInBackground( const std::shared_ptr<AsyncJob>& job )
+        {
+            CORE_ASSERT( job != nullptr && job->getState() == AsyncJob::PENDING, "Invalid background job" );
+            {
+                std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                m_backgroundJobs.push_back( job );
+                ++m_numBackgroundJobs;
+            }
+            m_threadNotifier.notify_one();
+        }
+
+        void TaskQueue::processCompletedJobs()
+        {
+            std::vector<std::shared_ptr<AsyncJob>> completedJobs;
+            {
+                std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                std::swap( completedJobs, m_completedJobs );
+            }
+            for ( const auto& job : completedJobs )
+            {
+                job->complete();
+                --m_numBackgroundJobs;
+            }
+        }
+
+        bool TaskQueue::isPoolBusyWithJobs()
+        {
+            std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+            return m_runningJobs.size() >= m_workerThreads.size();
+        }
+
+        bool TaskQueue::hasBackgroundJob() const
+        {
+            return !m_backgroundJobs.empty() && m_runningJobs.size() < m_maxRunningJobs;
+        }
+
+        std::shared_ptr<AsyncJob> TaskQueue::popBackgroundJob()
+        {
+            if ( !hasBackgroundJob() )
+            {
+                return nullptr;
+            }
+            std::shared_ptr<AsyncJob> job = m_backgroundJobs.front();
+            m_backgroundJobs.pop_front();
+            m_runningJobs.push_back( job );
+            return job;
+        }
+
+        void TaskQueue::runBackgroundJob( const std::shared_ptr<AsyncJob>& job )
+        {
+            job->execute();
+            {
+                std::lock_guard<std::mutex> lock( m_taskQueueMutex );
+                m_runningJobs.erase( std::find( m_runningJobs.begin(), m_runningJobs.end(), job ) );
+                m_completedJobs.push_back( job );
+            }
+            // Another background job may have been waiting for this one to finish.
+            m_threadNotifier.notify_one();
+        }
+
+        void TaskQueue::processTask( TaskQueue::TaskId task, uint threadId )
+        {
+            TimerData& tdata = m_timerData[task];
+            if ( !m_profiling )
+            {
+                tdata.start = Timer::Clock::now();
+                tdata.threadId = threadId;
+                m_tasks[task]->process();
+                tdata.end = Timer::Clock::now();
+                return;
+            }
+
+            // Each thread opens its own counters, which only count the calling thread.
+            std::unique_ptr<ThreadProfiler>& profiler = m_threadProfilers[threadId];
+            if ( !profiler )
+            {
+                profiler.reset( new ThreadProfiler );
+            }
+            const TaskCounters before = profiler->read();
+            tdata.start = Timer::Clock::now();
+            tdata.threadId = threadId;
+            m_tasks[task]->process();
+            tdata.end = Timer::Clock::now();
+            tdata.counters = profiler->read() - before;
+        }
+
         void TaskQueue::printTaskGraph(std::ostream& output) const
         {
             output<<"digraph tasks {"<<std::endl;
 
             for (const auto& t : m_tasks )
             {
-                output<<"\""<<t->getName()<<"\""<<std::endl;
+                output<<"\""<<t->getName()<<"\"";
+                auto found = m_taskStats.find( t->getName() );
+                if ( m_profiling && found != m_taskStats.end() && found->second.m_count > 0 )
+                {
+                    const NamedTaskStats& stats = found->second;
+                    const TaskCounters& c = stats.m_counters;
+                    const uint n = stats.m_count;
+                    output<<" [label=\""<<t->getName()<<" (x"<<n<<")"
+                          <<"\\n"<<stats.m_total / n<<" us"
+                          <<"\\ninstructions: "<<c.instructions / n
+                          <<"\\ncache misses: "<<c.cacheMisses / n
+                          <<"\\ncontext switches: "<<c.contextSwitches / n
+                          <<"\\nallocations: "<<c.allocations / n
+                          <<" ("<<c.allocatedBytes / n<<" bytes)\"]";
+                }
+                output<<std::endl;
             }
 
 
@@ -8,16 +8,21 @@
 #include <deque>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <string>
 #include <condition_variable>
+#include <functional>
+#include <unordered_map>
 
 #include <Core/Time/Timer.hpp>
+#include <Core/Tasks/TaskProfiler.hpp>
 
 namespace Ra
 {
     namespace Core
     {
         class Task;
+        class AsyncJob;
     }
 }
 
@@ -31,6 +36,18 @@ namespace Ra
         /// Task are allowed to have dependencies. A task will be executed only when all its dependencies
         /// are satisfied, i.e. all dependant tasks are finished.
         /// Note that most functions are not thread safe and must not be called when the task queue is running.
+        /// Two scheduling strategies are available, selected at construction :
+        /// * SHARED_QUEUE : all threads pop from a single queue protected by a global lock.
+        /// * WORK_STEALING : each thread owns a local queue, pushes the successors of the tasks it
+        ///   completes onto it and steals from the other threads when it runs out of work. Dependency
+        ///   counters are atomic, so completing a task never takes a global lock.
+        /// The tasks of a frame can also be compiled into a persistent graph (see compileGraph())
+        /// which is replayed by each startTasks() until clearGraph() is called.
+        /// The threads also run the chunks of parallel loops (see runParallel() and ParallelFor.hpp).
+        /// Among the ready tasks, the ones with the highest priority are started first. Priorities
+        /// can be set by hand, or computed from the critical path of the previous frame
+        /// (see setCriticalPathPriorities()).
+        /// Idle threads also run background jobs, which are not part of the frame (see runInBackground()).
         class RA_CORE_API TaskQueue
         {
         public:
@@ -38,19 +55,33 @@ namespace Ra
             typedef uint TaskId;
             enum { InvalidTaskId = TaskId( -1 ) };
 
-            /// Record of a task's start and end time.
+            /// Priority of a task. Ready tasks with a higher priority are started first.
+            typedef uint Priority;
+
+            /// Scheduling strategy used to dispatch the tasks to the threads.
+            enum SchedulingMode
+            {
+                SHARED_QUEUE,
+                WORK_STEALING,
+            };
+
+            /// Record of a task's start and end time, and of its performance counters
+            /// when profiling is enabled (see setProfiling()).
             struct TimerData
             {
                 Timer::TimePoint start;
                 Timer::TimePoint end;
+                /// Index of the thread of the pool which ran the task, or getNumThreads()
+                /// if it was run by the thread calling waitForTasks().
                 uint threadId;
                 std::string taskName;
+                TaskCounters counters;
             };
 
         public:
 
             /// Constructor. Initializes the thread pools with numThreads threads.
-            TaskQueue( uint numThreads );
+            explicit TaskQueue( uint numThreads, SchedulingMode mode = SHARED_QUEUE );
 
             /// Destructor. Waits for all the threads and safely deletes them.
             ~TaskQueue();
@@ -62,7 +93,22 @@ namespace Ra
             /// Registers a task to be executed.
             /// Task must have been created with new and be initialized with its parameter.
             /// The task queue assumes ownership of the task.
-            TaskId registerTask( Task* task );
+            TaskId registerTask( Task* task, Priority priority = 0 );
+
+            /// Changes the priority of a registered task.
+            void setPriority( TaskId task, Priority priority );
+
+            /// Returns the priority of a registered task.
+            Priority getPriority( TaskId task ) const;
+
+            /// If enabled, the priorities are overwritten on each startTasks() by the length of
+            /// the longest path from each task to the end of the graph, in microseconds.
+            /// The length of each task is its duration in the previous run, or the average duration
+            /// of the tasks with the same name in the previous flushed frame.
+            void setCriticalPathPriorities( bool enabled ) { m_criticalPathPriorities = enabled; }
+
+            /// Returns true if the priorities are computed from the critical path.
+            bool hasCriticalPathPriorities() const { return m_criticalPathPriorities; }
 
             /// Add dependency between two tasks. The successor task will be executed only when all
             /// its predecessor completed.
@@ -87,27 +133,193 @@ namespace Ra
             void startTasks();
 
             /// Blocks until all tasks and dependencies are finished.
+            /// The calling thread runs the ready tasks while all the threads of the pool are
+            /// running background jobs.
             void waitForTasks();
 
             /// Access the data from the last frame execution after processTaskQueue();
             const std::vector<TimerData>& getTimerData();
 
             /// Erases all tasks. Will assert if tasks are unprocessed.
+            /// The tasks of a compiled graph are kept, only clearGraph() erases them.
             void flushTaskQueue();
 
+            //
+            // Compiled task graph
+            //
+
+            /// Resolves the pending dependencies once and freezes the registered tasks and
+            /// their dependencies into a compiled graph. Each subsequent call to startTasks()
+            /// replays the graph, only resetting the dependency counters.
+            /// Tasks of a compiled graph are run once per replay, so they must read any
+            /// per-frame data when processed rather than copying it when created.
+            /// No task or dependency can be added to a compiled graph.
+            void compileGraph();
+
+            /// Returns true if the current tasks form a compiled graph.
+            bool isGraphCompiled() const { return m_isCompiled; }
 
-            /// Prints the current task graph in dot format
+            /// Erases all tasks, whether they have been compiled or not.
+            void clearGraph();
+
+
+            /// Prints the current task graph in dot format.
+            /// When profiling, the nodes are labelled with the average duration and counters
+            /// of the tasks of the same name in the last flushed frame.
             void printTaskGraph( std::ostream& output ) const;
 
+            /// Toggles the measure of the performance counters of each task (see TaskProfiler.hpp).
+            /// Must not be changed while tasks are running.
+            void setProfiling( bool enabled ) { m_profiling = enabled; }
+            bool isProfiling() const { return m_profiling; }
+
+            /// Returns the scheduling strategy of this queue.
+            SchedulingMode getSchedulingMode() const { return m_mode; }
+
+            /// Returns the number of threads of the pool.
+            uint getNumThreads() const { return m_workerThreads.size(); }
+
+            //
+            // Parallel loops
+            //
+
+            /// Calls chunkFunction(c) for each c in [0, numChunks) and blocks until all calls are done.
+            /// The chunks are run by the calling thread and by the idle threads of the pool, before
+            /// any pending task. Unlike the other functions, this function is thread safe and can be
+            /// called from a task or while the task queue is running.
+            void runParallel( uint numChunks, const std::function<void( uint )>& chunkFunction );
+
+            //
+            // Background jobs
+            //
+
+            /// Queues a job to be run in the background. Background jobs have the lowest priority :
+            /// they are only started by threads with no task nor parallel loop to run, and at most
+            /// numThreads - 1 of them run at the same time, so that a thread is left for the frame
+            /// tasks. With a single thread, one job can run and the frame tasks are then run by the
+            /// thread calling waitForTasks().
+            /// This function is thread safe.
+            void runInBackground( const std::shared_ptr<AsyncJob>& job );
+
+            /// Delivers the completion of the jobs finished since the last call, by calling their
+            /// onCompletion() function on the calling thread. Should be called once per frame
+            /// from the main thread, when no task is running.
+            void processCompletedJobs();
+
+            /// Returns the number of background jobs which are not completed yet.
+            uint getNumBackgroundJobs() const { return m_numBackgroundJobs; }
+
+        private:
+            /// Entry of the shared ready queue, which is a heap ordered by priority then by
+            /// insertion order (so that tasks of equal priority run first in, first out).
+            struct ReadyTask
+            {
+                TaskId m_task;
+                Priority m_priority;
+                uint m_order;
+
+                /// Heap ordering : true if a should run after b.
+                bool operator<( const ReadyTask& other ) const
+                {
+                    return m_priority < other.m_priority
+                        || ( m_priority == other.m_priority && m_order > other.m_order );
+                }
+            };
+
+            /// Total duration and counters of the tasks sharing a name during the last flushed frame.
+            struct NamedTaskStats
+            {
+                Timer::MicroSeconds m_total;
+                uint m_count;
+                TaskCounters m_counters;
+            };
+
+            /// Local task queue of a thread in WORK_STEALING mode.
+            /// The owner thread pushes and pops at the front, thieves steal from the back.
+            /// Ready tasks are pushed so that the one with the highest priority is popped first.
+            struct WorkerQueue
+            {
+                std::deque<TaskId> m_tasks;
+                std::mutex m_mutex;
+            };
+
+            /// A parallel loop being run by runParallel().
+            struct ParallelJob
+            {
+                explicit ParallelJob( uint numChunks, const std::function<void( uint )>& function )
+                    : m_function( function ), m_numChunks( numChunks )
+                    , m_nextChunk( 0 ), m_doneChunks( 0 ), m_helpers( 0 ) {}
+
+                const std::function<void( uint )>& m_function;
+                const uint m_numChunks;
+                /// Index of the next chunk to be run.
+                std::atomic<uint> m_nextChunk;
+                /// Number of chunks completed.
+                std::atomic<uint> m_doneChunks;
+                /// Number of pool threads working on this job.
+                std::atomic<uint> m_helpers;
+            };
+
         private:
 
             /// Function called by a new thread.
             void runThread( uint id );
 
+            /// Function called by a new thread in WORK_STEALING mode.
+            void runStealingThread( uint id );
+
+            /// Runs a task and records its timings.
+            void processTask( TaskId task, uint threadId );
+
+            /// Takes the ready task with the highest priority and counts it as being processed
+            /// (SHARED_QUEUE mode). Must be called with m_taskQueueMutex locked on a non empty queue.
+            TaskId popReadyTask();
+
+            /// Marks a processed task as finished and queues its ready successors (SHARED_QUEUE mode).
+            void finishTask( TaskId task );
+
+            /// Marks a processed task as finished and pushes its ready successors on the local queue
+            /// of the thread (WORK_STEALING mode).
+            void finishStealingTask( TaskId task, uint threadId );
+
             /// Puts the task on the queue to be executed. A task can only be queued if it has
             /// no dependencies.
             void queueTask( TaskId task );
 
+            /// Puts a ready task on the local queue of the given thread (WORK_STEALING mode).
+            void queueLocalTask( TaskId task, uint threadId );
+
+            /// Pops a task from the thread's local queue, or steals one from another thread.
+            /// Returns InvalidTaskId if all queues are empty (WORK_STEALING mode).
+            TaskId popOrStealTask( uint threadId );
+
+            /// Wakes up a sleeping thread if there is one (WORK_STEALING mode).
+            void wakeUpThread();
+
+            /// Returns a parallel job which still has chunks to run, or nullptr.
+            /// Must be called with m_taskQueueMutex locked.
+            ParallelJob* findParallelJob() const;
+
+            /// Runs the chunks of a parallel job until all chunks have been started.
+            static void runParallelChunks( ParallelJob& job );
+
+            /// If a parallel job is available, helps running it. Returns true if some work was done.
+            bool helpParallelJob();
+
+            /// Returns true if all the threads of the pool are running background jobs.
+            bool isPoolBusyWithJobs();
+
+            /// Returns true if a background job can be started.
+            /// Must be called with m_taskQueueMutex locked.
+            bool hasBackgroundJob() const;
+
+            /// Takes the next background job to run, or returns nullptr.
+            /// Must be called with m_taskQueueMutex locked.
+            std::shared_ptr<AsyncJob> popBackgroundJob();
+
+            /// Runs a background job taken by popBackgroundJob() and queues its completion.
+            void runBackgroundJob( const std::shared_ptr<AsyncJob>& job );
+
             /// Detect if there are any cycles in the task graph, and asserts if it is the case.
             /// (this function is compiled to nothing in release).
             void detectCycles();
@@ -115,6 +327,17 @@ namespace Ra
             /// Resolves the pending named dependencies. Will assert if dependencies don't resolve.
             void resolveDependencies();
 
+            /// Flattens the dependencies into the successor arrays and stores the initial
+            /// dependency counters.
+            void buildSuccessorArrays();
+
+            /// Stores the duration and counters of the tasks of the frame for each task name.
+            void recordTaskStats();
+
+            /// Sets the priority of each task to its longest path to the end of the graph.
+            /// Needs the successor arrays.
+            void computeCriticalPathPriorities();
+
         private:
 
             /// Threads working on tasks.
@@ -124,6 +347,23 @@ namespace Ra
             /// For each task, stores which tasks depend on it.
             std::vector<std::vector <TaskId>> m_dependencies;
 
+            /// Flat storage of m_dependencies : the successors of task i are stored in
+            /// m_successors from m_successorOffsets[i] to m_successorOffsets[i+1].
+            std::vector<uint> m_successorOffsets;
+            std::vector<TaskId> m_successors;
+            /// Number of predecessors of each task, copied to the counters when tasks start.
+            std::vector<uint> m_initialDependencies;
+
+            /// Priority of each task.
+            std::vector<Priority> m_priorities;
+            /// If true, m_priorities are computed from the critical path.
+            bool m_criticalPathPriorities;
+            /// Durations and counters of the previous frame's tasks, by name.
+            std::unordered_map<std::string, NamedTaskStats> m_taskStats;
+            /// Scratch storage reused on each frame for topological sorts and ready tasks.
+            std::vector<TaskId> m_sortedTasks;
+            std::vector<uint> m_sortCounters;
+
             /// List of pending dependencies
             std::vector<std::pair<TaskId,std::string>> m_pendingDepsPre;
             std::vector<std::pair<std::string,TaskId>> m_pendingDepsSucc;
@@ -137,8 +377,10 @@ namespace Ra
 
             /// Number of tasks each task is waiting on.
             std::vector<uint> m_remainingDependencies;
-            /// Queue holding the pending tasks.
-            std::deque<TaskId> m_taskQueue;
+            /// Heap holding the pending tasks (see ReadyTask).
+            std::vector<ReadyTask> m_taskQueue;
+            /// Insertion counter of the ready tasks.
+            uint m_readyOrder;
             /// Number of tasks currently being processed.
             uint m_processingTasks;
 
@@ -149,6 +391,47 @@ namespace Ra
             /// Global mutex over thread-sensitive variables.
             std::mutex m_taskQueueMutex;
 
+            //
+            // WORK_STEALING mode variables.
+            //
+
+            /// Local queue of each thread.
+            std::vector<std::unique_ptr<WorkerQueue>> m_workerQueues;
+            /// Number of tasks each task is waiting on, decremented without lock.
+            std::unique_ptr<std::atomic<uint>[]> m_atomicDependencies;
+            /// Number of tasks which are not finished yet.
+            std::atomic<uint> m_unfinishedTasks;
+            /// Number of tasks sitting in the local queues.
+            std::atomic<uint> m_readyTasks;
+            /// Number of threads waiting on the notifier.
+            std::atomic<uint> m_sleepingThreads;
+
+            /// Parallel loops currently running (protected by m_taskQueueMutex).
+            std::vector<ParallelJob*> m_parallelJobs;
+            /// Size of m_parallelJobs, readable without lock.
+            std::atomic<uint> m_numParallelJobs;
+
+            /// Background jobs waiting for a thread (protected by m_taskQueueMutex).
+            std::deque<std::shared_ptr<AsyncJob>> m_backgroundJobs;
+            /// Background jobs being run (protected by m_taskQueueMutex).
+            std::vector<std::shared_ptr<AsyncJob>> m_runningJobs;
+            /// Background jobs waiting for processCompletedJobs() (protected by m_taskQueueMutex).
+            std::vector<std::shared_ptr<AsyncJob>> m_completedJobs;
+            /// Number of background jobs not completed yet.
+            std::atomic<uint> m_numBackgroundJobs;
+            /// Maximum number of background jobs running at the same time.
+            const uint m_maxRunningJobs;
+
+            /// If true, the performance counters of each task are recorded.
+            bool m_profiling;
+            /// Counters of each thread, created by the thread when it first profiles a task.
+            std::vector<std::unique_ptr<ThreadProfiler>> m_threadProfilers;
+
+            /// Scheduling strategy.
+            const SchedulingMode m_mode;
+
+            /// True if the tasks form a compiled graph.
+            bool m_isCompiled;
         };
 
     }
@@ -0,0 +1,88 @@
+#include <Core/TreeStructures/AabbUnion.hpp>
+
+#include <Core/CoreMacros.hpp>
+
+namespace Ra
+{
+    namespace Core
+    {
+        AabbUnion::AabbUnion()
+        {
+            clear();
+        }
+
+        void AabbUnion::setAabb( uint index, const Aabb& aabb )
+        {
+            if ( index >= m_leafCount )
+            {
+                if ( aabb.isEmpty() )
+                {
+                    return;
+                }
+                uint leafCount = m_leafCount;
+                while ( leafCount <= index )
+                {
+                    leafCount *= 2;
+                }
+                // The leaves are moved to the new last level, and all the inner nodes refitted.
+                AlignedStdVector<Aabb> nodes( 2 * leafCount );
+                for ( uint i = 0; i < m_leafCount; ++i )
+                {
+                    nodes[leafCount + i] = m_nodes[m_leafCount + i];
+                }
+                m_nodes.swap( nodes );
+                m_dirty.assign( leafCount, true );
+                m_leafCount = leafCount;
+            }
+
+            Aabb& leaf = m_nodes[m_leafCount + index];
+            if ( aabb.isEmpty() ? leaf.isEmpty() : leaf.min() == aabb.min() && leaf.max() == aabb.max() )
+            {
+                return;
+            }
+            if ( aabb.isEmpty() )
+            {
+                leaf.setEmpty();
+            }
+            else
+            {
+                leaf = aabb;
+            }
+            // The ancestors of a dirty node are already dirty.
+            for ( uint node = ( m_leafCount + index ) / 2; node != 0 && !m_dirty[node]; node /= 2 )
+            {
+                m_dirty[node] = true;
+            }
+        }
+
+        Aabb AabbUnion::getAabb( uint index ) const
+        {
+            return index < m_leafCount ? m_nodes[m_leafCount + index] : Aabb();
+        }
+
+        const Aabb& AabbUnion::getUnion()
+        {
+            refit( 1 );
+            return m_nodes[1];
+        }
+
+        void AabbUnion::clear()
+        {
+            m_leafCount = 1;
+            m_nodes.assign( 2, Aabb() );
+            m_dirty.assign( 1, false );
+        }
+
+        void AabbUnion::refit( uint node )
+        {
+            if ( node >= m_leafCount || !m_dirty[node] )
+            {
+                return;
+            }
+            refit( 2 * node );
+            refit( 2 * node + 1 );
+            m_nodes[node] = m_nodes[2 * node].merged( m_nodes[2 * node + 1] );
+            m_dirty[node] = false;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef RADIUMENGINE_AABB_UNION_HPP_
+#define RADIUMENGINE_AABB_UNION_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Containers/AlignedStdVector.hpp>
+
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Union of a set of AABBs stored in indexed slots, kept up to date when a few of them change.
+        /// The slots are the leaves of a complete binary tree whose nodes bound their children :
+        /// changing a slot only marks its ancestors as out of date, and getUnion() refits them,
+        /// in O(changed slots * log(slots)).
+        class RA_CORE_API AabbUnion
+        {
+        public:
+            AabbUnion();
+
+            /// Sets the AABB of a slot, growing the tree if needed. Empty AABBs clear the slot.
+            void setAabb( uint index, const Aabb& aabb );
+
+            /// Returns the AABB of a slot, which is empty if it was never set.
+            Aabb getAabb( uint index ) const;
+
+            /// Returns the union of the AABBs of all the slots.
+            const Aabb& getUnion();
+
+            /// Clears all the slots.
+            void clear();
+
+        private:
+            /// Recomputes the out of date nodes below node.
+            void refit( uint node );
+
+        private:
+            /// Number of leaves, a power of two. The root is node 1, the children of node n
+            /// are nodes 2n and 2n + 1, and the leaves are nodes [m_leafCount, 2 m_leafCount).
+            uint m_leafCount;
+            AlignedStdVector<Aabb> m_nodes;
+            /// True for the inner nodes whose AABB is out of date, and then for all their ancestors.
+            std::vector<bool> m_dirty;
+        };
+    }
+}
+
+#endif // RADIUMENGINE_AABB_UNION_HPP_
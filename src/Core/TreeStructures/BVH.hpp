@@ -6,7 +6,10 @@
 
 #include <Core/Mesh/TriangleMesh.hpp>
 #include <Core/Math/Frustum.hpp>
+#include <Core/Containers/AlignedStdVector.hpp>
 
+#include <atomic>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -16,6 +19,17 @@ namespace Ra
 {
     namespace Core
     {
+        /// Counters of a frustum culling query (see BVH::cull()).
+        struct CullingStats
+        {
+            CullingStats() : m_nodeTests( 0 ), m_planeTests( 0 ), m_visible( 0 ), m_culled( 0 ) {}
+
+            uint m_nodeTests;   /// Number of nodes and objects tested.
+            uint m_planeTests;  /// Number of box-plane tests.
+            uint m_visible;     /// Number of objects returned.
+            uint m_culled;      /// Number of objects rejected.
+        };
+
         /// This class stores a 3-dimensional hierarchy of meshes of arbitrary type.
         /// Built on a binary tree
         template <typename T>
@@ -40,6 +54,12 @@ namespace Ra
                     return m_data;
                 }
 
+                /// Reads the box of the data again.
+                inline void updateAabb()
+                {
+                    m_aabb = m_data->getAabb();
+                }
+
                 inline bool isFinal() const
                 {
                     return m_children.empty();
@@ -58,6 +78,28 @@ namespace Ra
 
             typedef Node * Nodep;
 
+            /// Node of the flat hierarchy built by buildTopDown().
+            /// The two children of an inner node are stored next to each other, starting at
+            /// an even index, so that a pair of siblings fits in 64 bytes.
+            struct FlatNode
+            {
+                float m_min[3];
+                uint  m_index;  /// First child for an inner node, first primitive for a leaf.
+                float m_max[3];
+                uint  m_count;  /// Number of primitives of a leaf, 0 for an inner node.
+
+                inline bool isLeaf() const { return m_count != 0; }
+                inline Aabb getAabb() const;
+            };
+            static_assert( sizeof( FlatNode ) == 32, "Flat nodes should be 32 bytes." );
+
+            /// Maximum number of primitives in a leaf of the flat hierarchy.
+            static constexpr uint MaxLeafSize = 4;
+            /// Number of bins used to evaluate the surface area heuristic.
+            static constexpr uint NumBins = 16;
+            /// Parent of the root node.
+            static constexpr uint InvalidNode = uint( -1 );
+
         public:
             RA_CORE_ALIGNED_NEW
 
@@ -66,26 +108,121 @@ namespace Ra
             inline BVH( const BVH& other ) = default;
             inline BVH& operator= ( const BVH& other ) = default;
 
+            /// Adds an object. It is inserted in the flat hierarchy if it is built,
+            /// otherwise the hierarchy is built by the next update().
             inline void insertLeaf(const std::shared_ptr<T>& t);
 
-            //TODO removeLeaf()
+            /// Removes an object inserted with insertLeaf(), in O(log n). The hierarchy is built
+            /// again by the next update() once the removals outnumber the remaining objects.
+            inline void removeLeaf(const std::shared_ptr<T>& t);
+
+            /// Reads the box of a moved object again and refits the nodes above it, in O(log n).
+            inline void updateLeaf(const std::shared_ptr<T>& t);
 
             inline void clear();
 
+            /// Builds the flat hierarchy if it is not up to date.
             inline void update();
 
+            /// Greedy pairwise merging of the leaves, O(n^3). Only used by getInFrustumSlow(),
+            /// until the leaves change.
             inline void buildBottomUpSlow();
 
             //TODO void buildBottomUpFast();
 
-            //TODO void buildTopDown();
+            /// Builds the flat hierarchy by splitting the leaves with a binned surface
+            /// area heuristic. Subtrees are built in parallel (see Core::parallelFor()).
+            inline void buildTopDown();
 
+            /// Collects the objects in the frustum with the tree of buildBottomUpSlow(), or by testing
+            /// each of them if the leaves changed since it was built.
             void getInFrustumSlow(std::vector<std::shared_ptr<T>> & objects, const Frustum & frustum) const;
 
+            /// Collects the objects whose box is not fully outside the frustum, using the flat hierarchy.
+            inline void getInFrustum(std::vector<std::shared_ptr<T>> & objects, const Frustum & frustum) const;
+
+            /// Same result as getInFrustum(), faster on coherent queries : the children of a node
+            /// skip the planes the node is fully inside, and each node and object first tests
+            /// the plane which rejected it in the previous query.
+            inline void cull( const Frustum& frustum, std::vector<std::shared_ptr<T>>& objects,
+                              CullingStats* stats = nullptr );
+
+            /// Nodes of the flat hierarchy, the root is the first one.
+            inline const AlignedStdVector<FlatNode>& getNodes() const { return m_nodes; }
+
+            /// Indices of the leaves referenced by the ranges of the flat nodes.
+            inline const std::vector<uint>& getPrimitives() const { return m_primitives; }
+
+            /// Returns the object of the i-th inserted leaf.
+            inline std::shared_ptr<T> getLeafData( uint i ) const { return m_leaves[i]->getData(); }
+
+            inline uint getLeafCount() const { return m_leaves.size(); }
+
+        protected:
+            /// Returns the box of the contents of a node of the flat hierarchy.
+            inline Aabb computeAabb( uint node ) const;
+            inline void setAabb( uint node, const Aabb& aabb );
+
+            /// Points the children or the leaves of a node back to it, once it has moved.
+            inline void setParentOfContents( uint node );
+
+            /// Returns the first node of a free pair of siblings.
+            inline uint allocatePair();
+
+            /// Recomputes the boxes from the given node up to the root, rotating the
+            /// subtrees on the way when it reduces their area.
+            inline void refit( uint node );
+
+            /// Swaps a child of the node with a grandchild if it reduces the area of the other child.
+            inline void rotate( uint node );
+
+        protected:
+            /// Splits nodes of the flat hierarchy. Splits are deferred in tasks when the
+            /// given task list is not null and the node has less than taskSize primitives.
+            struct TopDownBuilder
+            {
+                struct BuildTask
+                {
+                    uint m_node;
+                    uint m_begin;
+                    uint m_end;
+                };
+
+                inline void split( uint node, uint begin, uint end, std::vector<BuildTask>* tasks );
+
+                const std::vector<NodePtr>& m_leaves;
+                const AlignedStdVector<Vector3>& m_centroids;
+                std::vector<uint>& m_primitives;
+                AlignedStdVector<FlatNode>& m_nodes;
+                std::vector<uint>& m_parents;
+                std::vector<uint>& m_leafNodes;
+                std::atomic<uint> m_nodeCount;
+                uint m_taskSize;
+            };
+
         protected:
             std::vector<NodePtr> m_leaves;
+            /// Root of the pointer tree of buildBottomUpSlow(), reset when the leaves change.
             NodePtr m_root;
-            Aabb m_root_aabb;
+
+            AlignedStdVector<FlatNode> m_nodes;
+            std::vector<uint> m_primitives;
+
+            /// Parent of each node of the flat hierarchy, InvalidNode for the root and free nodes.
+            std::vector<uint> m_parents;
+            /// Flat node containing each leaf.
+            std::vector<uint> m_leafNodes;
+            /// First nodes of the pairs of siblings released by removeLeaf().
+            std::vector<uint> m_freePairs;
+            /// Index of each object in m_leaves.
+            std::unordered_map<const T*, uint> m_leafIndices;
+
+            /// Plane which last rejected each flat node and each leaf (see cull()).
+            std::vector<uchar> m_nodePlanes;
+            std::vector<uchar> m_leafPlanes;
+            /// Number of leaves when the flat hierarchy was last built. The hierarchy is
+            /// built again when insertions doubled it.
+            uint m_builtLeafCount;
 
             bool m_upToDate;
         };
@@ -1,17 +1,89 @@
 #include <Core/TreeStructures/BVH.hpp>
+#include <Core/Math/Math.hpp>
 #include <Core/Mesh/MeshUtils.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+#include <Core/TreeStructures/SahBinning.hpp>
 
-#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <numeric>
 
 #include <Core/Math/ColorPresets.hpp>
-#include <Engine/Renderer/RenderObject/Primitives/DrawPrimitives.hpp>
-//#include <Engine/Renderer/Renderers/DebugRender.hpp>
 
 namespace Ra
 {
     namespace Core
     {
 
+        namespace BVHInternal
+        {
+            // True if the box is entirely on the negative side of one of the frustum planes.
+            template <typename S>
+            inline bool isOutside( const S* min, const S* max, const Frustum& frustum )
+            {
+                for ( uint i = 0; i < 6; ++i )
+                {
+                    const Vector4& plane = frustum.m_planes[i];
+                    // Corner of the box the furthest along the plane normal.
+                    const Scalar x = plane[0] >= 0 ? max[0] : min[0];
+                    const Scalar y = plane[1] >= 0 ? max[1] : min[1];
+                    const Scalar z = plane[2] >= 0 ? max[2] : min[2];
+                    if ( plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0 )
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // Tests the box against the planes of the mask, starting with the cached plane.
+            // Returns false if the box is outside a plane, which is then cached. Otherwise
+            // removes from the mask the planes the box is fully inside.
+            template <typename S>
+            inline bool cullPlanes( const S* min, const S* max, const Frustum& frustum, uint& mask,
+                                    uchar& lastPlane, uint& planeTests )
+            {
+                for ( uint k = 0; k < 6; ++k )
+                {
+                    const uint i = ( lastPlane + k ) % 6;
+                    if ( !( mask & ( 1u << i ) ) )
+                    {
+                        continue;
+                    }
+                    ++planeTests;
+
+                    const Vector4& plane = frustum.m_planes[i];
+                    const bool px = plane[0] >= 0;
+                    const bool py = plane[1] >= 0;
+                    const bool pz = plane[2] >= 0;
+                    // Corners of the box the furthest along and against the plane normal.
+                    const Scalar farDist = plane[0] * ( px ? max[0] : min[0] ) + plane[1] * ( py ? max[1] : min[1] )
+                                         + plane[2] * ( pz ? max[2] : min[2] ) + plane[3];
+                    if ( farDist < 0 )
+                    {
+                        lastPlane = uchar( i );
+                        return false;
+                    }
+                    const Scalar nearDist = plane[0] * ( px ? min[0] : max[0] ) + plane[1] * ( py ? min[1] : max[1] )
+                                          + plane[2] * ( pz ? min[2] : max[2] ) + plane[3];
+                    if ( nearDist >= 0 )
+                    {
+                        mask &= ~( 1u << i );
+                    }
+                }
+                return true;
+            }
+        }
+
+        template <typename T>
+        constexpr uint BVH<T>::MaxLeafSize;
+
+        template <typename T>
+        constexpr uint BVH<T>::NumBins;
+
+        template <typename T>
+        constexpr uint BVH<T>::InvalidNode;
+
         template <typename T>
         inline BVH<T>::Node::Node(const std::shared_ptr<T>& t)
             :m_aabb(t->getAabb()), m_data(t)
@@ -44,28 +116,319 @@ namespace Ra
         }
 
 
+        template <typename T>
+        inline Aabb BVH<T>::FlatNode::getAabb() const
+        {
+            return Aabb( Vector3( m_min[0], m_min[1], m_min[2] ), Vector3( m_max[0], m_max[1], m_max[2] ) );
+        }
+
         template <typename T>
         inline BVH<T>::BVH()
-            :m_root(nullptr), m_root_aabb(), m_upToDate(true)
+            :m_root(nullptr), m_builtLeafCount(0), m_upToDate(true)
         {}
 
         template <typename T>
         inline void BVH<T>::insertLeaf(const std::shared_ptr<T>& t)
         {
+            CORE_ASSERT( m_leafIndices.find( t.get() ) == m_leafIndices.end(), "Object already inserted" );
+
+            const uint leaf = m_leaves.size();
             m_leaves.push_back(std::shared_ptr<Node>(new Node(t)));
-            m_root_aabb.extend(t->getAabb());
+            m_leafIndices[t.get()] = leaf;
+            m_leafNodes.push_back( InvalidNode );
+            m_leafPlanes.push_back( 0 );
+
+            // The pointer tree of buildBottomUpSlow() is not updated.
+            m_root = nullptr;
+
+            if ( m_nodes.empty() || m_leaves.size() > 2 * m_builtLeafCount )
+            {
+                m_nodes.clear();
+                m_upToDate = false ;
+                return;
+            }
+
+            // Find the node which becomes the sibling of the new leaf : go down while the
+            // increase of area of the subtree is lower than the cost of a new parent.
+            const Aabb aabb = m_leaves[leaf]->getAabb();
+            uint sibling = 0;
+            while ( !m_nodes[sibling].isLeaf() )
+            {
+                const Scalar area = SahBinning::surfaceArea( m_nodes[sibling].getAabb() );
+                const Scalar mergedArea = SahBinning::surfaceArea( m_nodes[sibling].getAabb().merged( aabb ) );
+                const Scalar inherited = mergedArea - area;
+
+                Scalar childCosts[2];
+                for ( uint c = 0; c < 2; ++c )
+                {
+                    const FlatNode& child = m_nodes[m_nodes[sibling].m_index + c];
+                    const Scalar merged = SahBinning::surfaceArea( child.getAabb().merged( aabb ) );
+                    childCosts[c] = inherited + ( child.isLeaf() ? merged : merged - SahBinning::surfaceArea( child.getAabb() ) );
+                }
+
+                if ( mergedArea < std::min( childCosts[0], childCosts[1] ) )
+                {
+                    break;
+                }
+                sibling = m_nodes[sibling].m_index + ( childCosts[1] < childCosts[0] ? 1 : 0 );
+            }
+
+            // The sibling moves down to a new pair of nodes, next to the new leaf.
+            const uint pair = allocatePair();
+            m_nodes[pair] = m_nodes[sibling];
+            m_parents[pair] = sibling;
+            setParentOfContents( pair );
 
-            m_upToDate = false ;
+            FlatNode& newLeaf = m_nodes[pair + 1];
+            newLeaf.m_index = m_primitives.size();
+            newLeaf.m_count = 1;
+            m_primitives.push_back( leaf );
+            m_parents[pair + 1] = sibling;
+            m_leafNodes[leaf] = pair + 1;
+            setAabb( pair + 1, aabb );
+
+            m_nodes[sibling].m_index = pair;
+            m_nodes[sibling].m_count = 0;
+            refit( sibling );
         }
 
         template <typename T>
-        inline void BVH<T>::clear()
+        inline void BVH<T>::removeLeaf(const std::shared_ptr<T>& t)
         {
-            //TODO Clear tree
+            auto pos = m_leafIndices.find( t.get() );
+            CORE_ASSERT( pos != m_leafIndices.end(), "Object not in the hierarchy" );
+            const uint leaf = pos->second;
+            m_leafIndices.erase( pos );
+
+            // The pointer tree of buildBottomUpSlow() is not updated.
+            m_root = nullptr;
+
+            if ( !m_nodes.empty() )
+            {
+                // Remove the leaf from the range of its node.
+                const uint node = m_leafNodes[leaf];
+                FlatNode& flat = m_nodes[node];
+                const uint last = flat.m_index + flat.m_count - 1;
+                uint i = flat.m_index;
+                while ( m_primitives[i] != leaf )
+                {
+                    ++i;
+                }
+                std::swap( m_primitives[i], m_primitives[last] );
+                --flat.m_count;
 
+                if ( flat.m_count > 0 )
+                {
+                    refit( node );
+                }
+                else if ( node == 0 )
+                {
+                    m_nodes.clear();
+                }
+                else
+                {
+                    // The sibling replaces the parent and the pair is released.
+                    const uint parent = m_parents[node];
+                    const uint pair = m_nodes[parent].m_index;
+                    const uint sibling = node == pair ? pair + 1 : pair;
+                    m_nodes[parent] = m_nodes[sibling];
+                    setParentOfContents( parent );
+                    m_parents[pair] = InvalidNode;
+                    m_parents[pair + 1] = InvalidNode;
+                    m_freePairs.push_back( pair );
+                    if ( m_parents[parent] != InvalidNode )
+                    {
+                        refit( m_parents[parent] );
+                    }
+                }
+            }
+
+            // The last leaf takes the index of the removed one.
+            const uint lastLeaf = m_leaves.size() - 1;
+            if ( leaf != lastLeaf )
+            {
+                m_leaves[leaf] = m_leaves[lastLeaf];
+                m_leafNodes[leaf] = m_leafNodes[lastLeaf];
+                m_leafPlanes[leaf] = m_leafPlanes[lastLeaf];
+                m_leafIndices[m_leaves[leaf]->getData().get()] = leaf;
+                if ( !m_nodes.empty() )
+                {
+                    const FlatNode& flat = m_nodes[m_leafNodes[leaf]];
+                    for ( uint i = flat.m_index; i < flat.m_index + flat.m_count; ++i )
+                    {
+                        if ( m_primitives[i] == lastLeaf )
+                        {
+                            m_primitives[i] = leaf;
+                        }
+                    }
+                }
+            }
+            m_leaves.pop_back();
+            m_leafNodes.pop_back();
+            m_leafPlanes.pop_back();
+
+            // Each removal leaves an unused slot in m_primitives : the hierarchy is built again
+            // once they outnumber the leaves, as it is when insertions doubled them.
+            if ( m_primitives.size() > 2 * m_leaves.size() )
+            {
+                m_nodes.clear();
+            }
+            if ( m_nodes.empty() )
+            {
+                m_upToDate = false;
+            }
+        }
+
+        template <typename T>
+        inline void BVH<T>::updateLeaf(const std::shared_ptr<T>& t)
+        {
+            auto pos = m_leafIndices.find( t.get() );
+            CORE_ASSERT( pos != m_leafIndices.end(), "Object not in the hierarchy" );
+            m_leaves[pos->second]->updateAabb();
+            m_root = nullptr;
+
+            if ( !m_nodes.empty() )
+            {
+                refit( m_leafNodes[pos->second] );
+            }
+        }
+
+        template <typename T>
+        inline Aabb BVH<T>::computeAabb( uint node ) const
+        {
+            const FlatNode& flat = m_nodes[node];
+            Aabb aabb;
+            if ( flat.isLeaf() )
+            {
+                for ( uint i = flat.m_index; i < flat.m_index + flat.m_count; ++i )
+                {
+                    aabb.extend( m_leaves[m_primitives[i]]->getAabb() );
+                }
+            }
+            else
+            {
+                aabb = m_nodes[flat.m_index].getAabb().merged( m_nodes[flat.m_index + 1].getAabb() );
+            }
+            return aabb;
+        }
+
+        template <typename T>
+        inline void BVH<T>::setAabb( uint node, const Aabb& aabb )
+        {
+            // Rounded outwards, so that the nodes still hold their contents in single precision.
+            FlatNode& flat = m_nodes[node];
+            for ( uint k = 0; k < 3; ++k )
+            {
+                flat.m_min[k] = Math::floatBelow( aabb.min()[k] );
+                flat.m_max[k] = Math::floatAbove( aabb.max()[k] );
+            }
+        }
+
+        template <typename T>
+        inline void BVH<T>::setParentOfContents( uint node )
+        {
+            const FlatNode& flat = m_nodes[node];
+            if ( flat.isLeaf() )
+            {
+                for ( uint i = flat.m_index; i < flat.m_index + flat.m_count; ++i )
+                {
+                    m_leafNodes[m_primitives[i]] = node;
+                }
+            }
+            else
+            {
+                m_parents[flat.m_index] = node;
+                m_parents[flat.m_index + 1] = node;
+            }
+        }
+
+        template <typename T>
+        inline uint BVH<T>::allocatePair()
+        {
+            if ( !m_freePairs.empty() )
+            {
+                const uint pair = m_freePairs.back();
+                m_freePairs.pop_back();
+                return pair;
+            }
+            const uint pair = m_nodes.size();
+            m_nodes.resize( pair + 2 );
+            m_parents.resize( pair + 2, InvalidNode );
+            m_nodePlanes.resize( pair + 2, 0 );
+            return pair;
+        }
+
+        template <typename T>
+        inline void BVH<T>::refit( uint node )
+        {
+            while ( node != InvalidNode )
+            {
+                if ( !m_nodes[node].isLeaf() )
+                {
+                    rotate( node );
+                }
+                setAabb( node, computeAabb( node ) );
+                node = m_parents[node];
+            }
+        }
+
+        template <typename T>
+        inline void BVH<T>::rotate( uint node )
+        {
+            // Candidate swaps of a child with one of the children of its sibling. The swap
+            // keeps the box of the node and changes the box of the sibling.
+            const uint pair = m_nodes[node].m_index;
+            uint bestChild = InvalidNode;
+            uint bestGrandChild = InvalidNode;
+            Scalar bestGain = 0;
+            for ( uint c = 0; c < 2; ++c )
+            {
+                const uint child = pair + c;
+                const uint sibling = pair + 1 - c;
+                const FlatNode& siblingNode = m_nodes[sibling];
+                if ( siblingNode.isLeaf() )
+                {
+                    continue;
+                }
+                const Scalar area = SahBinning::surfaceArea( siblingNode.getAabb() );
+                for ( uint g = 0; g < 2; ++g )
+                {
+                    const uint kept = siblingNode.m_index + 1 - g;
+                    const Scalar gain = area - SahBinning::surfaceArea(
+                        m_nodes[child].getAabb().merged( m_nodes[kept].getAabb() ) );
+                    if ( gain > bestGain )
+                    {
+                        bestGain = gain;
+                        bestChild = child;
+                        bestGrandChild = siblingNode.m_index + g;
+                    }
+                }
+            }
+
+            if ( bestChild != InvalidNode )
+            {
+                std::swap( m_nodes[bestChild], m_nodes[bestGrandChild] );
+                setParentOfContents( bestChild );
+                setParentOfContents( bestGrandChild );
+                const uint sibling = bestChild == pair ? pair + 1 : pair;
+                setAabb( sibling, computeAabb( sibling ) );
+            }
+        }
+
+        template <typename T>
+        inline void BVH<T>::clear()
+        {
             m_leaves.clear();
             m_root = nullptr;
-            m_root_aabb = Aabb();
+            m_nodes.clear();
+            m_primitives.clear();
+            m_parents.clear();
+            m_leafNodes.clear();
+            m_freePairs.clear();
+            m_leafIndices.clear();
+            m_nodePlanes.clear();
+            m_leafPlanes.clear();
+            m_builtLeafCount = 0;
 
             //m_upToDate = true ;
         }
@@ -74,7 +437,7 @@ namespace Ra
         inline void BVH<T>::update()
         {
             if (!m_upToDate)
-                buildBottomUpSlow();
+                buildTopDown();
         }
 
         template <typename T>
@@ -83,12 +446,18 @@ namespace Ra
             /*if (m_root != nullptr)
                 clear();*/
 
+            if ( m_leaves.size() < 2 )
+            {
+                m_root = m_leaves.empty() ? nullptr : m_leaves[0];
+                return;
+            }
+
             // We start from known leaves, bottom up
             std::vector<NodePtr> toMerge(m_leaves);
 
             // As long as there are several leaves to merge
             while (toMerge.size() > 2) {
-                Scalar low = m_root_aabb.isEmpty() ? 0 : m_root_aabb.volume();
+                Scalar low = std::numeric_limits<Scalar>::max();
                 typename std::vector<NodePtr>::iterator l_min, r_min;
                 Aabb merge;
 
@@ -118,10 +487,221 @@ namespace Ra
 
             // Final node (the root) is the merger of last two nodes
             m_root = std::shared_ptr<Node>(new Node(toMerge[0], toMerge[1]));
+        }
+
+        template <typename T>
+        inline void BVH<T>::TopDownBuilder::split( uint node, uint begin, uint end, std::vector<BuildTask>* tasks )
+        {
+            const uint count = end - begin;
+            if ( tasks && count < m_taskSize )
+            {
+                tasks->push_back( BuildTask{ node, begin, end } );
+                return;
+            }
+
+            Aabb bounds;
+            Aabb centroidBounds;
+            for ( uint i = begin; i < end; ++i )
+            {
+                bounds.extend( m_leaves[m_primitives[i]]->getAabb() );
+                centroidBounds.extend( m_centroids[m_primitives[i]] );
+            }
+
+            FlatNode& flat = m_nodes[node];
+            for ( uint k = 0; k < 3; ++k )
+            {
+                flat.m_min[k] = Math::floatBelow( bounds.min()[k] );
+                flat.m_max[k] = Math::floatAbove( bounds.max()[k] );
+            }
+
+            // A leaf costs its area times its number of primitives.
+            SahBinning::Split best;
+            if ( count > 1 )
+            {
+                best = SahBinning::findBestSplit<NumBins>( begin, end, centroidBounds,
+                    [this]( uint i ) { return m_leaves[m_primitives[i]]->getAabb(); },
+                    [this]( uint i ) -> const Vector3& { return m_centroids[m_primitives[i]]; } );
+            }
+
+            if ( count == 1 || ( count <= MaxLeafSize && !SahBinning::isWorthSplitting( bounds, count, best ) ) )
+            {
+                flat.m_index = begin;
+                flat.m_count = count;
+                for ( uint i = begin; i < end; ++i )
+                {
+                    m_leafNodes[m_primitives[i]] = node;
+                }
+                return;
+            }
+
+            uint mid;
+            if ( best.isValid() )
+            {
+                auto first = m_primitives.begin();
+                mid = uint( std::partition( first + begin, first + end, [&]( uint p )
+                {
+                    return best.isLeft( m_centroids[p] );
+                } ) - first );
+            }
+            else
+            {
+                // All the centroids are at the same place : split the range in halves.
+                mid = begin + count / 2;
+            }
+
+            const uint children = m_nodeCount.fetch_add( 2 );
+            flat.m_index = children;
+            flat.m_count = 0;
+            m_parents[children] = node;
+            m_parents[children + 1] = node;
+
+            split( children, begin, mid, tasks );
+            split( children + 1, mid, end, tasks );
+        }
+
+        template <typename T>
+        inline void BVH<T>::buildTopDown()
+        {
+            const uint numLeaves = m_leaves.size();
 
-            m_upToDate = true ;
+            m_nodes.clear();
+            m_primitives.resize( numLeaves );
+            std::iota( m_primitives.begin(), m_primitives.end(), 0 );
+            m_leafNodes.assign( numLeaves, InvalidNode );
+            m_freePairs.clear();
+            m_builtLeafCount = numLeaves;
+
+            if ( numLeaves == 0 )
+            {
+                m_upToDate = true;
+                return;
+            }
+
+            AlignedStdVector<Vector3> centroids( numLeaves );
+            for ( uint i = 0; i < numLeaves; ++i )
+            {
+                centroids[i] = m_leaves[i]->getAabb().center();
+            }
+
+            // A binary tree has less than twice as many nodes as primitives.
+            // Node 1 is left unused so that siblings start at even indices.
+            m_nodes.resize( 2 * numLeaves );
+            m_parents.assign( 2 * numLeaves, InvalidNode );
+
+            TopDownBuilder builder{ m_leaves, centroids, m_primitives, m_nodes, m_parents, m_leafNodes,
+                                    {2}, std::max( numLeaves / 32, 1024u ) };
+
+            // Split the top of the tree, then build the remaining subtrees in parallel.
+            std::vector<typename TopDownBuilder::BuildTask> tasks;
+            builder.split( 0, 0, numLeaves, &tasks );
+            parallelFor( 0, tasks.size(), [&builder, &tasks]( uint i )
+            {
+                builder.split( tasks[i].m_node, tasks[i].m_begin, tasks[i].m_end, nullptr );
+            }, 1 );
+
+            m_nodes.resize( builder.m_nodeCount );
+            m_parents.resize( builder.m_nodeCount );
+            m_nodePlanes.assign( builder.m_nodeCount, 0 );
+            m_upToDate = true;
         }
 
+        template <typename T>
+        inline void BVH<T>::getInFrustum(std::vector<std::shared_ptr<T>> & objects, const Frustum & frustum) const
+        {
+            if ( m_nodes.empty() )
+            {
+                return;
+            }
+
+            std::vector<uint> toCheck( 1, 0 );
+            while ( !toCheck.empty() )
+            {
+                const FlatNode& node = m_nodes[toCheck.back()];
+                toCheck.pop_back();
+
+                if ( BVHInternal::isOutside( node.m_min, node.m_max, frustum ) )
+                {
+                    continue;
+                }
+
+                if ( node.isLeaf() )
+                {
+                    for ( uint i = node.m_index; i < node.m_index + node.m_count; ++i )
+                    {
+                        // The box of a single primitive is the box of the leaf.
+                        const Aabb& aabb = m_leaves[m_primitives[i]]->getAabb();
+                        if ( node.m_count == 1
+                             || !BVHInternal::isOutside( aabb.min().data(), aabb.max().data(), frustum ) )
+                        {
+                            objects.push_back( m_leaves[m_primitives[i]]->getData() );
+                        }
+                    }
+                }
+                else
+                {
+                    toCheck.push_back( node.m_index + 1 );
+                    toCheck.push_back( node.m_index );
+                }
+            }
+        }
+
+        template <typename T>
+        inline void BVH<T>::cull( const Frustum& frustum, std::vector<std::shared_ptr<T>>& objects,
+                                  CullingStats* stats )
+        {
+            CullingStats counters;
+            if ( !m_nodes.empty() )
+            {
+                // Nodes to visit, with the mask of the planes their parent is not fully inside.
+                std::vector<std::pair<uint, uint>> toCheck( 1, std::make_pair( 0u, 0x3fu ) );
+                while ( !toCheck.empty() )
+                {
+                    const uint index = toCheck.back().first;
+                    uint mask = toCheck.back().second;
+                    toCheck.pop_back();
+
+                    const FlatNode& node = m_nodes[index];
+                    ++counters.m_nodeTests;
+                    if ( mask != 0 && !BVHInternal::cullPlanes( node.m_min, node.m_max, frustum, mask,
+                                                                m_nodePlanes[index], counters.m_planeTests ) )
+                    {
+                        continue;
+                    }
+
+                    if ( !node.isLeaf() )
+                    {
+                        toCheck.push_back( std::make_pair( node.m_index + 1, mask ) );
+                        toCheck.push_back( std::make_pair( node.m_index, mask ) );
+                        continue;
+                    }
+
+                    for ( uint i = node.m_index; i < node.m_index + node.m_count; ++i )
+                    {
+                        const uint leaf = m_primitives[i];
+                        // The box of a single object is the box of the leaf.
+                        if ( node.m_count > 1 && mask != 0 )
+                        {
+                            const Aabb& aabb = m_leaves[leaf]->getAabb();
+                            uint objectMask = mask;
+                            ++counters.m_nodeTests;
+                            if ( !BVHInternal::cullPlanes( aabb.min().data(), aabb.max().data(), frustum, objectMask,
+                                                           m_leafPlanes[leaf], counters.m_planeTests ) )
+                            {
+                                continue;
+                            }
+                        }
+                        objects.push_back( m_leaves[leaf]->getData() );
+                        ++counters.m_visible;
+                    }
+                }
+            }
+
+            counters.m_culled = m_leaves.size() - counters.m_visible;
+            if ( stats != nullptr )
+            {
+                *stats = counters;
+            }
+        }
 
         // Dummy function to transform Vector3 to Vector4
         inline Vector4 fromV3(Vector3 v, int x) {
@@ -132,7 +712,19 @@ namespace Ra
         inline void BVH<T>::getInFrustumSlow(std::vector<std::shared_ptr<T>> & objects, const Frustum & frustum) const
         {
 
-            if (m_root)
+            // Without an up to date pointer tree, every object is tested.
+            if ( !m_root )
+            {
+                for ( const auto& leaf : m_leaves )
+                {
+                    const Aabb aabb = leaf->getAabb();
+                    if ( !BVHInternal::isOutside( aabb.min().data(), aabb.max().data(), frustum ) )
+                    {
+                        objects.push_back( leaf->getData() );
+                    }
+                }
+            }
+            else
             {
                 std::vector<NodePtr> toCheck;
                 toCheck.push_back(m_root);
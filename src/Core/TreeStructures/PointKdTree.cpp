@@ -0,0 +1,165 @@
+#include <Core/TreeStructures/PointKdTree.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace Ra
+{
+    namespace Core
+    {
+        constexpr uint PointKdTree::MaxLeafSize;
+        constexpr uint PointKdTree::StackSize;
+
+        void PointKdTree::build( const VectorArray<Vector3>& points )
+        {
+            clear();
+            const uint numPoints = points.size();
+            if ( numPoints == 0 )
+            {
+                return;
+            }
+
+            m_indices.resize( numPoints );
+            std::iota( m_indices.begin(), m_indices.end(), 0 );
+            m_points.assign( points.begin(), points.end() );
+
+            m_nodes.reserve( 2 * ( numPoints / MaxLeafSize + 1 ) );
+            m_nodes.resize( 1 );
+            split( 0, 0, numPoints );
+
+            // Sort the copy of the points in the order of the leaves.
+            for ( uint i = 0; i < numPoints; ++i )
+            {
+                m_points[i] = points[m_indices[i]];
+            }
+        }
+
+        void PointKdTree::split( uint node, uint begin, uint end )
+        {
+            Aabb bounds;
+            for ( uint i = begin; i < end; ++i )
+            {
+                bounds.extend( m_points[m_indices[i]] );
+            }
+            for ( uint k = 0; k < 3; ++k )
+            {
+                m_nodes[node].m_min[k] = float( bounds.min()[k] );
+                m_nodes[node].m_max[k] = float( bounds.max()[k] );
+            }
+
+            const uint count = end - begin;
+            if ( count <= MaxLeafSize )
+            {
+                m_nodes[node].m_index = begin;
+                m_nodes[node].m_count = count;
+                return;
+            }
+
+            uint axis;
+            bounds.sizes().maxCoeff( &axis );
+            const uint mid = begin + count / 2;
+            auto first = m_indices.begin();
+            std::nth_element( first + begin, first + mid, first + end, [this, axis]( uint a, uint b )
+            {
+                return m_points[a][axis] < m_points[b][axis];
+            } );
+
+            const uint children = m_nodes.size();
+            m_nodes.resize( children + 2 );
+            m_nodes[node].m_index = children;
+            m_nodes[node].m_count = 0;
+
+            split( children, begin, mid );
+            split( children + 1, mid, end );
+        }
+
+        void PointKdTree::clear()
+        {
+            m_nodes.clear();
+            m_points.clear();
+            m_indices.clear();
+        }
+
+        int PointKdTree::getNearestToRay( const Ray& ray ) const
+        {
+            if ( m_nodes.empty() )
+            {
+                return -1;
+            }
+
+            // The distance of the points of a node to the line is at least the distance of the
+            // center of the node minus its radius. The bound is lowered by the rounding error
+            // of the distances, so that nodes are only skipped if they cannot hold a better point.
+            constexpr Scalar tolerance = 8 * std::numeric_limits<Scalar>::epsilon();
+            auto lowerBound = [&ray, tolerance]( const Node& node )
+            {
+                Vector3 center;
+                Vector3 half;
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    center[k] = ( Scalar( node.m_min[k] ) + Scalar( node.m_max[k] ) ) / 2;
+                    half[k] = ( Scalar( node.m_max[k] ) - Scalar( node.m_min[k] ) ) / 2;
+                }
+                const Scalar radius = half.norm();
+                const Scalar distance = std::sqrt( ray.squaredDistance( center ) ) - radius;
+                const Scalar range = ( center - ray.origin() ).norm() + radius;
+                return distance > 0 ? distance * distance - tolerance * range * range : Scalar( 0 );
+            };
+
+            struct StackEntry
+            {
+                uint m_node;
+                Scalar m_bound;
+            };
+            StackEntry stack[StackSize];
+            uint stackSize = 0;
+            stack[stackSize++] = StackEntry{ 0, 0 };
+
+            Scalar best = std::numeric_limits<Scalar>::max();
+            int nearest = -1;
+            while ( stackSize > 0 )
+            {
+                const StackEntry entry = stack[--stackSize];
+                if ( entry.m_bound > best )
+                {
+                    continue;
+                }
+
+                const Node& node = m_nodes[entry.m_node];
+                if ( node.isLeaf() )
+                {
+                    for ( uint i = node.m_index; i < node.m_index + node.m_count; ++i )
+                    {
+                        const Scalar d = ray.squaredDistance( m_points[i] );
+                        const int index = int( m_indices[i] );
+                        if ( d < best || ( d == best && index < nearest ) )
+                        {
+                            best = d;
+                            nearest = index;
+                        }
+                    }
+                }
+                else
+                {
+                    // Push the farthest child first so that the closest one is visited first.
+                    const Scalar left = lowerBound( m_nodes[node.m_index] );
+                    const Scalar right = lowerBound( m_nodes[node.m_index + 1] );
+                    CORE_ASSERT( stackSize + 2 <= StackSize, "Traversal stack overflow." );
+                    if ( left <= right )
+                    {
+                        stack[stackSize++] = StackEntry{ node.m_index + 1, right };
+                        stack[stackSize++] = StackEntry{ node.m_index, left };
+                    }
+                    else
+                    {
+                        stack[stackSize++] = StackEntry{ node.m_index, left };
+                        stack[stackSize++] = StackEntry{ node.m_index + 1, right };
+                    }
+                }
+            }
+            return nearest;
+        }
+    }
+}
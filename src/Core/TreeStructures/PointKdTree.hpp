@@ -0,0 +1,67 @@
+#ifndef RADIUMENGINE_POINT_KDTREE_HPP_
+#define RADIUMENGINE_POINT_KDTREE_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Math/Ray.hpp>
+#include <Core/Containers/VectorArray.hpp>
+#include <Core/Containers/AlignedStdVector.hpp>
+
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Kd-tree of a point cloud, split at the median of the largest axis of each node.
+        /// The tree keeps a copy of the points, sorted in the order of the leaves.
+        class RA_CORE_API PointKdTree
+        {
+        public:
+            /// Node of the tree. The two children of an inner node are stored next to
+            /// each other, after their parent.
+            struct Node
+            {
+                float m_min[3];
+                uint  m_index;  /// First child for an inner node, first point for a leaf.
+                float m_max[3];
+                uint  m_count;  /// Number of points of a leaf, 0 for an inner node.
+
+                inline bool isLeaf() const { return m_count != 0; }
+            };
+            static_assert( sizeof( Node ) == 32, "Nodes should be 32 bytes." );
+
+            /// Maximum number of points in a leaf.
+            static constexpr uint MaxLeafSize = 8;
+            /// Size of the traversal stack, larger than the depth of the tree.
+            static constexpr uint StackSize = 64;
+
+        public:
+            PointKdTree() = default;
+
+            void build( const VectorArray<Vector3>& points );
+
+            void clear();
+
+            inline bool isEmpty() const { return m_nodes.empty(); }
+
+            /// Returns the index of the point with the lowest ray.squaredDistance(), -1 if the tree
+            /// is empty. Ties are broken by the lowest index, so that the result is the one of a linear scan.
+            int getNearestToRay( const Ray& ray ) const;
+
+            inline const AlignedStdVector<Node>& getNodes() const { return m_nodes; }
+
+        private:
+            void split( uint node, uint begin, uint end );
+
+        private:
+            AlignedStdVector<Node> m_nodes;
+            /// Points sorted by leaf, and their index in the cloud the tree was built from.
+            AlignedStdVector<Vector3> m_points;
+            std::vector<uint> m_indices;
+        };
+    }
+}
+
+#endif // RADIUMENGINE_POINT_KDTREE_HPP_
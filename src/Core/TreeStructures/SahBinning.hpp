@@ -0,0 +1,59 @@
+#ifndef RADIUMENGINE_SAH_BINNING_HPP_
+#define RADIUMENGINE_SAH_BINNING_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <Core/Math/LinearAlgebra.hpp>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Binned surface area heuristic shared by the top-down builders of the bounding
+        /// volume hierarchies (BVH, TriangleBVH and TriangleKdTree).
+        /// The primitives of a node are sorted into bins of equal width along each axis of
+        /// the bounds of their centroids, and the node is split between the two bins which
+        /// minimize the area of each side times its number of primitives.
+        namespace SahBinning
+        {
+            /// Returns the surface area of the box, or 0 if it is empty.
+            inline Scalar surfaceArea( const Aabb& aabb );
+
+            /// Split between two bins of centroids.
+            struct Split
+            {
+                /// Builds an invalid split.
+                inline Split();
+
+                /// Returns true if a split separating the primitives was found.
+                inline bool isValid() const { return m_axis < 3; }
+
+                /// Returns true if a primitive of this centroid goes to the first child.
+                inline bool isLeft( const Vector3& centroid ) const;
+
+                uint m_axis;    /// Axis of the split, 3 if there is none.
+                uint m_bin;     /// Last bin of the first child.
+                Scalar m_cost;  /// Sum over both children of their area times their primitive count.
+                Scalar m_origin;
+                Scalar m_scale;
+                uint m_lastBin;
+            };
+
+            /// Returns the best split of the primitives [begin, end) between NumBins bins.
+            /// getBox(i) and getCentroid(i) return the box and the centroid of the i-th primitive,
+            /// and centroidBounds bounds the centroids.
+            template <uint NumBins, typename GetBox, typename GetCentroid>
+            inline Split findBestSplit( uint begin, uint end, const Aabb& centroidBounds,
+                                        const GetBox& getBox, const GetCentroid& getCentroid );
+
+            /// Returns true if splitting a node of the given bounds and primitive count is expected
+            /// to be cheaper than keeping it as a leaf : an inner node costs one traversal step plus
+            /// the cost of its children.
+            inline bool isWorthSplitting( const Aabb& bounds, uint count, const Split& split );
+        }
+    }
+}
+
+#include <Core/TreeStructures/SahBinning.inl>
+
+#endif // RADIUMENGINE_SAH_BINNING_HPP_
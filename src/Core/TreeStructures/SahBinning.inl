@@ -0,0 +1,101 @@
+#include <Core/TreeStructures/SahBinning.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace SahBinning
+        {
+            inline Scalar surfaceArea( const Aabb& aabb )
+            {
+                if ( aabb.isEmpty() )
+                {
+                    return 0;
+                }
+                const Vector3 d = aabb.sizes();
+                return 2 * ( d.x() * d.y() + d.y() * d.z() + d.z() * d.x() );
+            }
+
+            inline Split::Split()
+                : m_axis( 3 ), m_bin( 0 ), m_cost( std::numeric_limits<Scalar>::max() ),
+                  m_origin( 0 ), m_scale( 0 ), m_lastBin( 0 )
+            {
+            }
+
+            inline bool Split::isLeft( const Vector3& centroid ) const
+            {
+                return std::min( uint( ( centroid[m_axis] - m_origin ) * m_scale ), m_lastBin ) <= m_bin;
+            }
+
+            template <uint NumBins, typename GetBox, typename GetCentroid>
+            inline Split findBestSplit( uint begin, uint end, const Aabb& centroidBounds,
+                                        const GetBox& getBox, const GetCentroid& getCentroid )
+            {
+                static_assert( NumBins > 1, "At least two bins are needed to split." );
+
+                Split best;
+                best.m_lastBin = NumBins - 1;
+
+                const Vector3 extent = centroidBounds.sizes();
+                for ( uint axis = 0; axis < 3; ++axis )
+                {
+                    if ( !( extent[axis] > 0 ) )
+                    {
+                        continue;
+                    }
+
+                    const Scalar origin = centroidBounds.min()[axis];
+                    const Scalar scale = Scalar( NumBins ) / extent[axis];
+                    Aabb binBounds[NumBins];
+                    uint binCounts[NumBins] = {0};
+                    for ( uint i = begin; i < end; ++i )
+                    {
+                        const uint b = std::min( uint( ( getCentroid( i )[axis] - origin ) * scale ), NumBins - 1 );
+                        binBounds[b].extend( getBox( i ) );
+                        ++binCounts[b];
+                    }
+
+                    // rightCosts[b] and rightCounts[b] describe bins ]b, NumBins[.
+                    Scalar rightCosts[NumBins];
+                    uint rightCounts[NumBins];
+                    Aabb side;
+                    uint sideCount = 0;
+                    for ( uint b = NumBins - 1; b > 0; --b )
+                    {
+                        side.extend( binBounds[b] );
+                        sideCount += binCounts[b];
+                        rightCosts[b - 1] = surfaceArea( side ) * sideCount;
+                        rightCounts[b - 1] = sideCount;
+                    }
+
+                    side.setEmpty();
+                    sideCount = 0;
+                    for ( uint b = 0; b < NumBins - 1; ++b )
+                    {
+                        side.extend( binBounds[b] );
+                        sideCount += binCounts[b];
+                        const Scalar cost = surfaceArea( side ) * sideCount + rightCosts[b];
+                        if ( sideCount > 0 && rightCounts[b] > 0 && cost < best.m_cost )
+                        {
+                            best.m_axis = axis;
+                            best.m_bin = b;
+                            best.m_cost = cost;
+                            best.m_origin = origin;
+                            best.m_scale = scale;
+                        }
+                    }
+                }
+                return best;
+            }
+
+            inline bool isWorthSplitting( const Aabb& bounds, uint count, const Split& split )
+            {
+                const Scalar area = surfaceArea( bounds );
+                return split.isValid() && area + split.m_cost < area * count;
+            }
+        }
+    }
+}
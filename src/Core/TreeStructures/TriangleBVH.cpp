@@ -0,0 +1,347 @@
+#include <Core/TreeStructures/TriangleBVH.hpp>
+
+#include <Core/Math/Math.hpp>
+#include <Core/Math/RayCast.hpp>
+#include <Core/Mesh/MeshUtils.hpp>
+#include <Core/TreeStructures/SahBinning.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+namespace Ra
+{
+    namespace Core
+    {
+        constexpr uint TriangleBVH::MaxLeafSize;
+        constexpr uint TriangleBVH::NumBins;
+        constexpr uint TriangleBVH::MaxSahDepth;
+        constexpr uint TriangleBVH::StackSize;
+
+        namespace
+        {
+            /// Stores the box in single precision, rounding outwards.
+            inline void setBounds( TriangleBVH::Node& node, const Aabb& aabb )
+            {
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    node.m_min[k] = Math::floatBelow( aabb.min()[k] );
+                    node.m_max[k] = Math::floatAbove( aabb.max()[k] );
+                }
+            }
+
+            /// Ray data reused by all the box tests of a query.
+            struct RaySlabs
+            {
+                RaySlabs( const Ray& ray ) : m_origin( ray.origin() )
+                {
+                    for ( uint k = 0; k < 3; ++k )
+                    {
+                        // A large finite value avoids 0 * inf when the origin is on a slab.
+                        const Scalar d = ray.direction()[k];
+                        m_invDir[k] = d != 0 ? 1 / d : std::numeric_limits<Scalar>::max();
+                    }
+                }
+
+                /// Returns true if the ray enters the box at a parameter in [0, tMax], written in tEntry.
+                inline bool intersect( const TriangleBVH::Node& node, Scalar tMax, Scalar& tEntry ) const
+                {
+                    // The exit parameter is enlarged to cover the rounding errors of the slab
+                    // distances and of the triangle intersections : a triangle lying on a face
+                    // of its box, exactly at tMax, must not be missed.
+                    constexpr Scalar robustness = 1 + Scalar( 1e-4 );
+
+                    Scalar tMin = 0;
+                    Scalar tExit = tMax;
+                    for ( uint k = 0; k < 3; ++k )
+                    {
+                        Scalar t0 = ( Scalar( node.m_min[k] ) - m_origin[k] ) * m_invDir[k];
+                        Scalar t1 = ( Scalar( node.m_max[k] ) - m_origin[k] ) * m_invDir[k];
+                        if ( t0 > t1 )
+                        {
+                            std::swap( t0, t1 );
+                        }
+                        tMin = std::max( tMin, t0 );
+                        tExit = std::min( tExit, t1 );
+                    }
+                    tEntry = tMin;
+                    return tMin <= tExit * robustness;
+                }
+
+                Vector3 m_origin;
+                Vector3 m_invDir;
+            };
+
+            struct StackEntry
+            {
+                uint m_node;
+                Scalar m_tEntry;
+            };
+        }
+
+        void TriangleBVH::build( const TriangleMesh& mesh )
+        {
+            clear();
+            const uint numTriangles = mesh.m_triangles.size();
+            if ( numTriangles == 0 )
+            {
+                return;
+            }
+
+            AlignedStdVector<Aabb> boxes( numTriangles );
+            AlignedStdVector<Vector3> centroids( numTriangles );
+            for ( uint i = 0; i < numTriangles; ++i )
+            {
+                const Triangle& t = mesh.m_triangles[i];
+                boxes[i].setEmpty();
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    boxes[i].extend( mesh.m_vertices[t[k]] );
+                }
+                centroids[i] = boxes[i].center();
+            }
+
+            m_triangles.resize( numTriangles );
+            std::iota( m_triangles.begin(), m_triangles.end(), 0 );
+
+            // A binary tree has less than twice as many nodes as leaves.
+            m_nodes.reserve( 2 * numTriangles );
+            m_nodes.resize( 1 );
+            split( 0, 0, numTriangles, 0, boxes, centroids );
+        }
+
+        void TriangleBVH::split( uint node, uint begin, uint end, uint depth,
+                                 const AlignedStdVector<Aabb>& boxes, const AlignedStdVector<Vector3>& centroids )
+        {
+            const uint count = end - begin;
+
+            Aabb bounds;
+            Aabb centroidBounds;
+            for ( uint i = begin; i < end; ++i )
+            {
+                bounds.extend( boxes[m_triangles[i]] );
+                centroidBounds.extend( centroids[m_triangles[i]] );
+            }
+            setBounds( m_nodes[node], bounds );
+
+            SahBinning::Split best;
+            if ( count > 1 && depth < MaxSahDepth )
+            {
+                best = SahBinning::findBestSplit<NumBins>( begin, end, centroidBounds,
+                    [&]( uint i ) -> const Aabb& { return boxes[m_triangles[i]]; },
+                    [&]( uint i ) -> const Vector3& { return centroids[m_triangles[i]]; } );
+            }
+
+            if ( count == 1 || ( count <= MaxLeafSize && !SahBinning::isWorthSplitting( bounds, count, best ) ) )
+            {
+                m_nodes[node].m_index = begin;
+                m_nodes[node].m_count = count;
+                return;
+            }
+
+            auto first = m_triangles.begin();
+            uint mid;
+            if ( best.isValid() )
+            {
+                mid = uint( std::partition( first + begin, first + end, [&]( uint t )
+                {
+                    return best.isLeft( centroids[t] );
+                } ) - first );
+            }
+            else
+            {
+                // Deep nodes and coincident centroids are split at the median of the largest axis,
+                // which bounds the depth of the tree.
+                uint axis;
+                centroidBounds.sizes().maxCoeff( &axis );
+                mid = begin + count / 2;
+                std::nth_element( first + begin, first + mid, first + end, [&]( uint a, uint b )
+                {
+                    return centroids[a][axis] < centroids[b][axis];
+                } );
+            }
+
+            const uint children = m_nodes.size();
+            m_nodes.resize( children + 2 );
+            m_nodes[node].m_index = children;
+            m_nodes[node].m_count = 0;
+
+            split( children, begin, mid, depth + 1, boxes, centroids );
+            split( children + 1, mid, end, depth + 1, boxes, centroids );
+        }
+
+        Aabb TriangleBVH::computeLeafAabb( const TriangleMesh& mesh, const Node& node ) const
+        {
+            Aabb aabb;
+            for ( uint i = node.m_index; i < node.m_index + node.m_count; ++i )
+            {
+                const Triangle& t = mesh.m_triangles[m_triangles[i]];
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    aabb.extend( mesh.m_vertices[t[k]] );
+                }
+            }
+            return aabb;
+        }
+
+        void TriangleBVH::refit( const TriangleMesh& mesh )
+        {
+            CORE_ASSERT( mesh.m_triangles.size() == m_triangles.size(), "Triangles changed since the build." );
+
+            // Children are stored after their parent.
+            for ( uint i = m_nodes.size(); i > 0; --i )
+            {
+                Node& node = m_nodes[i - 1];
+                if ( node.isLeaf() )
+                {
+                    setBounds( node, computeLeafAabb( mesh, node ) );
+                }
+                else
+                {
+                    const Node& left = m_nodes[node.m_index];
+                    const Node& right = m_nodes[node.m_index + 1];
+                    for ( uint k = 0; k < 3; ++k )
+                    {
+                        node.m_min[k] = std::min( left.m_min[k], right.m_min[k] );
+                        node.m_max[k] = std::max( left.m_max[k], right.m_max[k] );
+                    }
+                }
+            }
+        }
+
+        void TriangleBVH::clear()
+        {
+            m_nodes.clear();
+            m_triangles.clear();
+        }
+
+        TriangleBVH::Hit TriangleBVH::castRay( const TriangleMesh& mesh, const Ray& ray ) const
+        {
+            Hit hit;
+            if ( m_nodes.empty() )
+            {
+                return hit;
+            }
+
+            const RaySlabs slabs( ray );
+            Scalar best = std::numeric_limits<Scalar>::max();
+            StackEntry stack[StackSize];
+            uint stackSize = 0;
+
+            Scalar tEntry;
+            if ( !slabs.intersect( m_nodes[0], best, tEntry ) )
+            {
+                return hit;
+            }
+
+            uint current = 0;
+            while ( true )
+            {
+                const Node& node = m_nodes[current];
+                bool descend = false;
+                if ( node.isLeaf() )
+                {
+                    std::array<Vector3, 3> v;
+                    for ( uint i = node.m_index; i < node.m_index + node.m_count; ++i )
+                    {
+                        const int triangle = int( m_triangles[i] );
+                        MeshUtils::getTriangleVertices( mesh, triangle, v );
+                        Scalar t;
+                        if ( RayCast::vsTriangle( ray, v[0], v[1], v[2], t )
+                             && ( t < best || ( t == best && triangle < hit.m_triangle ) ) )
+                        {
+                            best = t;
+                            hit.m_triangle = triangle;
+                        }
+                    }
+                }
+                else
+                {
+                    // Visit the closest child first, the other one is skipped if the hit
+                    // found meanwhile is closer than its entry point.
+                    Scalar tLeft, tRight;
+                    const bool left = slabs.intersect( m_nodes[node.m_index], best, tLeft );
+                    const bool right = slabs.intersect( m_nodes[node.m_index + 1], best, tRight );
+                    if ( left && right )
+                    {
+                        const bool leftFirst = tLeft <= tRight;
+                        CORE_ASSERT( stackSize < StackSize, "Traversal stack overflow." );
+                        stack[stackSize++] = leftFirst ? StackEntry{ node.m_index + 1, tRight }
+                                                       : StackEntry{ node.m_index, tLeft };
+                        current = leftFirst ? node.m_index : node.m_index + 1;
+                        descend = true;
+                    }
+                    else if ( left || right )
+                    {
+                        current = left ? node.m_index : node.m_index + 1;
+                        descend = true;
+                    }
+                }
+
+                if ( !descend )
+                {
+                    // Equal entry points may still hold a triangle with a lower index.
+                    while ( stackSize > 0 && stack[stackSize - 1].m_tEntry > best )
+                    {
+                        --stackSize;
+                    }
+                    if ( stackSize == 0 )
+                    {
+                        break;
+                    }
+                    current = stack[--stackSize].m_node;
+                }
+            }
+
+            if ( hit.m_triangle >= 0 )
+            {
+                hit.m_t = best;
+            }
+            return hit;
+        }
+
+        bool TriangleBVH::anyHit( const TriangleMesh& mesh, const Ray& ray, Scalar tMax ) const
+        {
+            if ( m_nodes.empty() )
+            {
+                return false;
+            }
+
+            const RaySlabs slabs( ray );
+            uint stack[StackSize];
+            uint stackSize = 0;
+            stack[stackSize++] = 0;
+
+            std::array<Vector3, 3> v;
+            while ( stackSize > 0 )
+            {
+                const Node& node = m_nodes[stack[--stackSize]];
+                Scalar tEntry;
+                if ( !slabs.intersect( node, tMax, tEntry ) )
+                {
+                    continue;
+                }
+                if ( node.isLeaf() )
+                {
+                    for ( uint i = node.m_index; i < node.m_index + node.m_count; ++i )
+                    {
+                        MeshUtils::getTriangleVertices( mesh, m_triangles[i], v );
+                        Scalar t;
+                        if ( RayCast::vsTriangle( ray, v[0], v[1], v[2], t ) && t <= tMax )
+                        {
+                            return true;
+                        }
+                    }
+                }
+                else
+                {
+                    CORE_ASSERT( stackSize + 2 <= StackSize, "Traversal stack overflow." );
+                    stack[stackSize++] = node.m_index + 1;
+                    stack[stackSize++] = node.m_index;
+                }
+            }
+            return false;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef RADIUMENGINE_TRIANGLE_BVH_HPP_
+#define RADIUMENGINE_TRIANGLE_BVH_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Math/Ray.hpp>
+#include <Core/Mesh/TriangleMesh.hpp>
+#include <Core/Containers/AlignedStdVector.hpp>
+
+#include <limits>
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Bounding volume hierarchy of the triangles of a mesh, for ray queries.
+        /// The hierarchy only stores triangle indices : the queries take the mesh it was built
+        /// from. When the vertices move without changing the triangles (e.g. skinning),
+        /// refit() updates the boxes in O(n) instead of building the hierarchy again.
+        class RA_CORE_API TriangleBVH
+        {
+        public:
+            /// Node of the hierarchy. The two children of an inner node are stored next to
+            /// each other, after their parent.
+            struct Node
+            {
+                float m_min[3];
+                uint  m_index;  /// First child for an inner node, first triangle for a leaf.
+                float m_max[3];
+                uint  m_count;  /// Number of triangles of a leaf, 0 for an inner node.
+
+                inline bool isLeaf() const { return m_count != 0; }
+            };
+            static_assert( sizeof( Node ) == 32, "Nodes should be 32 bytes." );
+
+            /// Result of a ray query.
+            struct Hit
+            {
+                Hit() : m_triangle( -1 ), m_t( -1 ) {}
+
+                int m_triangle;     /// Index of the hit triangle, -1 if there is no hit.
+                Scalar m_t;         /// Ray parameter of the hit.
+            };
+
+            /// Maximum number of triangles in a leaf.
+            static constexpr uint MaxLeafSize = 4;
+            /// Number of bins used to evaluate the surface area heuristic.
+            static constexpr uint NumBins = 16;
+            /// Depth from which nodes are split at the median, to bound the traversal stack.
+            static constexpr uint MaxSahDepth = 32;
+            /// Size of the traversal stack, larger than the depth of the tree.
+            static constexpr uint StackSize = 96;
+
+        public:
+            TriangleBVH() = default;
+
+            /// Builds the hierarchy of the triangles of the mesh.
+            void build( const TriangleMesh& mesh );
+
+            /// Recomputes the boxes from the vertices of the mesh, which must have the
+            /// same triangles as the one the hierarchy was built from.
+            void refit( const TriangleMesh& mesh );
+
+            void clear();
+
+            inline bool isEmpty() const { return m_nodes.empty(); }
+
+            /// Returns the closest triangle hit by the ray. Ties are broken by the lowest
+            /// triangle index, so that the result is the one of a linear scan.
+            Hit castRay( const TriangleMesh& mesh, const Ray& ray ) const;
+
+            /// Returns true if the ray hits a triangle with a parameter in [0, tMax].
+            bool anyHit( const TriangleMesh& mesh, const Ray& ray,
+                         Scalar tMax = std::numeric_limits<Scalar>::max() ) const;
+
+            inline const AlignedStdVector<Node>& getNodes() const { return m_nodes; }
+
+            /// Triangle indices referenced by the ranges of the leaves.
+            inline const std::vector<uint>& getTriangles() const { return m_triangles; }
+
+        private:
+            void split( uint node, uint begin, uint end, uint depth,
+                        const AlignedStdVector<Aabb>& boxes, const AlignedStdVector<Vector3>& centroids );
+
+            /// Returns the box of the triangles of a leaf.
+            Aabb computeLeafAabb( const TriangleMesh& mesh, const Node& node ) const;
+
+        private:
+            AlignedStdVector<Node> m_nodes;
+            std::vector<uint> m_triangles;
+        };
+    }
+}
+
+#endif // RADIUMENGINE_TRIANGLE_BVH_HPP_
@@ -0,0 +1,408 @@
+#include <Core/TreeStructures/TriangleKdTree.hpp>
+
+#include <Core/Geometry/Distance/DistanceQueries.hpp>
+#include <Core/Math/Math.hpp>
+#include <Core/Mesh/MeshUtils.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+#include <Core/TreeStructures/SahBinning.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+
+namespace Ra
+{
+    namespace Core
+    {
+        constexpr uint TriangleKdTree::MaxLeafSize;
+        constexpr uint TriangleKdTree::NumBins;
+        constexpr uint TriangleKdTree::MaxSahDepth;
+        constexpr uint TriangleKdTree::StackSize;
+        constexpr uint TriangleKdTree::MinTaskSize;
+
+        namespace
+        {
+            typedef TriangleKdTree::Node Node;
+            typedef TriangleKdTree::Neighbour Neighbour;
+
+            /// Stores the box in single precision, rounding outwards.
+            inline void setBounds( Node& node, const Aabb& aabb )
+            {
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    node.m_min[k] = Math::floatBelow( aabb.min()[k] );
+                    node.m_max[k] = Math::floatAbove( aabb.max()[k] );
+                }
+            }
+
+            /// Lower bound of the squared distance from q to the triangles of the node. It is
+            /// lowered by the rounding error of the triangle distances, so that nodes are only
+            /// skipped if they cannot hold a closer triangle.
+            inline Scalar lowerBound( const Node& node, const Vector3& q )
+            {
+                constexpr Scalar tolerance = 16 * std::numeric_limits<Scalar>::epsilon();
+                Scalar distance = 0;
+                Scalar range = 0;
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    const Scalar lo = Scalar( node.m_min[k] ) - q[k];
+                    const Scalar hi = q[k] - Scalar( node.m_max[k] );
+                    const Scalar d = std::max( std::max( lo, hi ), Scalar( 0 ) );
+                    distance += d * d;
+                    range = std::max( range, std::max( std::abs( lo ), std::abs( hi ) ) );
+                }
+                return distance - tolerance * range * range;
+            }
+
+            /// Order of the k nearest triangles query : by distance, then by index.
+            inline bool isCloser( const Neighbour& a, const Neighbour& b )
+            {
+                return a.m_squaredDistance < b.m_squaredDistance
+                       || ( a.m_squaredDistance == b.m_squaredDistance && a.m_triangle < b.m_triangle );
+            }
+
+            /// Returns the square of a distance, which may be the largest Scalar.
+            inline Scalar getSquaredBound( Scalar distance )
+            {
+                return distance < std::sqrt( std::numeric_limits<Scalar>::max() )
+                       ? distance * distance : std::numeric_limits<Scalar>::max();
+            }
+
+            struct BuildTask
+            {
+                uint m_node;
+                uint m_begin;
+                uint m_end;
+                uint m_depth;
+            };
+
+            /// Splits the nodes of the tree, as BVH::buildTopDown() does. Children are allocated
+            /// with an atomic counter so that subtrees can be built by several tasks.
+            struct Builder
+            {
+                Builder( const AlignedStdVector<Aabb>& boxes, const AlignedStdVector<Vector3>& centroids,
+                         std::vector<uint>& triangles, AlignedStdVector<Node>& nodes,
+                         TriangleKdTree::SplitMethod method, uint taskSize )
+                    : m_boxes( boxes ), m_centroids( centroids ), m_triangles( triangles ), m_nodes( nodes ),
+                      m_method( method ), m_nodeCount( 1 ), m_taskSize( taskSize ) {}
+
+                void split( uint node, uint begin, uint end, uint depth, std::vector<BuildTask>* tasks );
+
+                const AlignedStdVector<Aabb>& m_boxes;
+                const AlignedStdVector<Vector3>& m_centroids;
+                std::vector<uint>& m_triangles;
+                AlignedStdVector<Node>& m_nodes;
+                const TriangleKdTree::SplitMethod m_method;
+                std::atomic<uint> m_nodeCount;
+                const uint m_taskSize;
+            };
+
+            void Builder::split( uint node, uint begin, uint end, uint depth, std::vector<BuildTask>* tasks )
+            {
+                const uint count = end - begin;
+                if ( tasks && count < m_taskSize )
+                {
+                    tasks->push_back( BuildTask{ node, begin, end, depth } );
+                    return;
+                }
+
+                Aabb bounds;
+                Aabb centroidBounds;
+                for ( uint i = begin; i < end; ++i )
+                {
+                    bounds.extend( m_boxes[m_triangles[i]] );
+                    centroidBounds.extend( m_centroids[m_triangles[i]] );
+                }
+                setBounds( m_nodes[node], bounds );
+
+                // Nodes are split with the SAH as long as it is cheaper than a leaf, and at the median
+                // otherwise, until they are small enough.
+                SahBinning::Split best;
+                if ( m_method == TriangleKdTree::SAH && depth < TriangleKdTree::MaxSahDepth && count > 1 )
+                {
+                    best = SahBinning::findBestSplit<TriangleKdTree::NumBins>( begin, end, centroidBounds,
+                        [this]( uint i ) -> const Aabb& { return m_boxes[m_triangles[i]]; },
+                        [this]( uint i ) -> const Vector3& { return m_centroids[m_triangles[i]]; } );
+                }
+                const bool sah = best.isValid() && ( count > TriangleKdTree::MaxLeafSize
+                                                     || SahBinning::isWorthSplitting( bounds, count, best ) );
+                if ( count <= TriangleKdTree::MaxLeafSize && !sah )
+                {
+                    m_nodes[node].m_index = begin;
+                    m_nodes[node].m_count = count;
+                    return;
+                }
+
+                auto first = m_triangles.begin();
+                uint mid;
+                if ( sah )
+                {
+                    mid = uint( std::partition( first + begin, first + end, [&]( uint t )
+                    {
+                        return best.isLeft( m_centroids[t] );
+                    } ) - first );
+                }
+                else
+                {
+                    uint axis;
+                    centroidBounds.sizes().maxCoeff( &axis );
+                    mid = begin + count / 2;
+                    std::nth_element( first + begin, first + mid, first + end, [&]( uint a, uint b )
+                    {
+                        return m_centroids[a][axis] < m_centroids[b][axis];
+                    } );
+                }
+
+                const uint children = m_nodeCount.fetch_add( 2 );
+                m_nodes[node].m_index = children;
+                m_nodes[node].m_count = 0;
+
+                split( children, begin, mid, depth + 1, tasks );
+                split( children + 1, mid, end, depth + 1, tasks );
+            }
+        }
+
+        void TriangleKdTree::build( const TriangleMesh& mesh, SplitMethod method )
+        {
+            clear();
+            const uint numTriangles = mesh.m_triangles.size();
+            if ( numTriangles == 0 )
+            {
+                return;
+            }
+
+            AlignedStdVector<Aabb> boxes( numTriangles );
+            AlignedStdVector<Vector3> centroids( numTriangles );
+            parallelFor( 0, numTriangles, [&]( uint i )
+            {
+                const Triangle& t = mesh.m_triangles[i];
+                boxes[i].setEmpty();
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    boxes[i].extend( mesh.m_vertices[t[k]] );
+                }
+                centroids[i] = boxes[i].center();
+            } );
+
+            m_triangles.resize( numTriangles );
+            std::iota( m_triangles.begin(), m_triangles.end(), 0 );
+
+            // A binary tree has less than twice as many nodes as leaves.
+            m_nodes.resize( 2 * numTriangles );
+            Builder builder( boxes, centroids, m_triangles, m_nodes, method,
+                             std::max( numTriangles / 32, MinTaskSize ) );
+
+            // Split the top of the tree, then build the remaining subtrees in parallel.
+            std::vector<BuildTask> tasks;
+            builder.split( 0, 0, numTriangles, 0, &tasks );
+            parallelFor( 0, tasks.size(), [&builder, &tasks]( uint i )
+            {
+                builder.split( tasks[i].m_node, tasks[i].m_begin, tasks[i].m_end, tasks[i].m_depth, nullptr );
+            }, 1 );
+
+            m_nodes.resize( builder.m_nodeCount );
+        }
+
+        void TriangleKdTree::clear()
+        {
+            m_nodes.clear();
+            m_triangles.clear();
+        }
+
+        template <typename Func>
+        inline void TriangleKdTree::traverse( const Vector3& q, Scalar bound, const Func& f ) const
+        {
+            if ( m_nodes.empty() )
+            {
+                return;
+            }
+
+            struct StackEntry
+            {
+                uint m_node;
+                Scalar m_bound;
+            };
+            StackEntry stack[StackSize];
+            uint stackSize = 0;
+            stack[stackSize++] = StackEntry{ 0, lowerBound( m_nodes[0], q ) };
+
+            while ( stackSize > 0 )
+            {
+                const StackEntry entry = stack[--stackSize];
+                if ( entry.m_bound > bound )
+                {
+                    continue;
+                }
+
+                const Node& node = m_nodes[entry.m_node];
+                if ( node.isLeaf() )
+                {
+                    bound = f( node, bound );
+                }
+                else
+                {
+                    // Push the farthest child first so that the closest one is visited first.
+                    const Scalar left = lowerBound( m_nodes[node.m_index], q );
+                    const Scalar right = lowerBound( m_nodes[node.m_index + 1], q );
+                    CORE_ASSERT( stackSize + 2 <= StackSize, "Traversal stack overflow." );
+                    if ( left <= right )
+                    {
+                        stack[stackSize++] = StackEntry{ node.m_index + 1, right };
+                        stack[stackSize++] = StackEntry{ node.m_index, left };
+                    }
+                    else
+                    {
+                        stack[stackSize++] = StackEntry{ node.m_index, left };
+                        stack[stackSize++] = StackEntry{ node.m_index + 1, right };
+                    }
+                }
+            }
+        }
+
+        TriangleKdTree::ClosestPoint TriangleKdTree::getClosestPoint( const TriangleMesh& mesh, const Vector3& q,
+                                                                      Scalar maxDistance, Scalar tolerance ) const
+        {
+            ClosestPoint closest;
+            closest.m_squaredDistance = getSquaredBound( maxDistance );
+            const Scalar good = tolerance > 0 ? tolerance * tolerance : Scalar( -1 );
+            std::array<Vector3, 3> v;
+            traverse( q, closest.m_squaredDistance, [&]( const Node& leaf, Scalar )
+            {
+                for ( uint i = leaf.m_index; i < leaf.m_index + leaf.m_count; ++i )
+                {
+                    if ( closest.m_triangle >= 0 && closest.m_squaredDistance <= good )
+                    {
+                        // Skip all the remaining nodes, whose bounds are larger.
+                        return -std::numeric_limits<Scalar>::max();
+                    }
+                    const int triangle = int( m_triangles[i] );
+                    MeshUtils::getTriangleVertices( mesh, triangle, v );
+                    const DistanceQueries::PointToTriangleOutput result =
+                        DistanceQueries::pointToTriSq( q, v[0], v[1], v[2] );
+                    if ( result.distanceSquared < closest.m_squaredDistance
+                         || ( result.distanceSquared == closest.m_squaredDistance
+                              && ( closest.m_triangle < 0 || triangle < closest.m_triangle ) ) )
+                    {
+                        closest.m_triangle = triangle;
+                        closest.m_point = result.meshPoint;
+                        closest.m_squaredDistance = result.distanceSquared;
+                    }
+                }
+                // The bound given by maxDistance alone is not a hit, and must not stop the search.
+                return closest.m_triangle >= 0 && closest.m_squaredDistance <= good
+                           ? -std::numeric_limits<Scalar>::max()
+                           : closest.m_squaredDistance;
+            } );
+
+            if ( closest.m_triangle < 0 )
+            {
+                closest = ClosestPoint();
+            }
+            return closest;
+        }
+
+        uint TriangleKdTree::findNearestTriangles( const TriangleMesh& mesh, const Vector3& q, uint k,
+                                                   Neighbour* neighboursOut ) const
+        {
+            if ( k == 0 )
+            {
+                return 0;
+            }
+
+            // The neighbours are kept in a heap whose top is the farthest one.
+            uint count = 0;
+            std::array<Vector3, 3> v;
+            traverse( q, std::numeric_limits<Scalar>::max(), [&]( const Node& leaf, Scalar )
+            {
+                for ( uint i = leaf.m_index; i < leaf.m_index + leaf.m_count; ++i )
+                {
+                    const int triangle = int( m_triangles[i] );
+                    MeshUtils::getTriangleVertices( mesh, triangle, v );
+                    const Neighbour neighbour( triangle, DistanceQueries::pointToTriSq( q, v[0], v[1], v[2] ).distanceSquared );
+                    if ( count < k )
+                    {
+                        neighboursOut[count++] = neighbour;
+                        std::push_heap( neighboursOut, neighboursOut + count, isCloser );
+                    }
+                    else if ( isCloser( neighbour, neighboursOut[0] ) )
+                    {
+                        std::pop_heap( neighboursOut, neighboursOut + count, isCloser );
+                        neighboursOut[count - 1] = neighbour;
+                        std::push_heap( neighboursOut, neighboursOut + count, isCloser );
+                    }
+                }
+                return count < k ? std::numeric_limits<Scalar>::max() : neighboursOut[0].m_squaredDistance;
+            } );
+
+            std::sort_heap( neighboursOut, neighboursOut + count, isCloser );
+            return count;
+        }
+
+        void TriangleKdTree::getNearestTriangles( const TriangleMesh& mesh, const Vector3& q, uint k,
+                                                  std::vector<Neighbour>& neighboursOut ) const
+        {
+            neighboursOut.resize( k );
+            neighboursOut.resize( findNearestTriangles( mesh, q, k, neighboursOut.data() ) );
+        }
+
+        void TriangleKdTree::getTrianglesInRadius( const TriangleMesh& mesh, const Vector3& q, Scalar radius,
+                                                   std::vector<uint>& trianglesOut ) const
+        {
+            trianglesOut.clear();
+            if ( !( radius >= 0 ) )
+            {
+                return;
+            }
+
+            const Scalar bound = getSquaredBound( radius );
+            std::array<Vector3, 3> v;
+            traverse( q, bound, [&]( const Node& leaf, Scalar )
+            {
+                for ( uint i = leaf.m_index; i < leaf.m_index + leaf.m_count; ++i )
+                {
+                    MeshUtils::getTriangleVertices( mesh, m_triangles[i], v );
+                    if ( DistanceQueries::pointToTriSq( q, v[0], v[1], v[2] ).distanceSquared <= bound )
+                    {
+                        trianglesOut.push_back( m_triangles[i] );
+                    }
+                }
+                return bound;
+            } );
+            std::sort( trianglesOut.begin(), trianglesOut.end() );
+        }
+
+        void TriangleKdTree::getClosestPoints( const TriangleMesh& mesh, const VectorArray<Vector3>& queries,
+                                               std::vector<ClosestPoint>& closestOut, Scalar maxDistance ) const
+        {
+            closestOut.resize( queries.size() );
+            parallelFor( 0, queries.size(), [&]( uint i )
+            {
+                closestOut[i] = getClosestPoint( mesh, queries[i], maxDistance );
+            } );
+        }
+
+        void TriangleKdTree::getNearestTriangles( const TriangleMesh& mesh, const VectorArray<Vector3>& queries,
+                                                  uint k, std::vector<Neighbour>& neighboursOut ) const
+        {
+            neighboursOut.resize( queries.size() * k );
+            parallelFor( 0, queries.size(), [&]( uint i )
+            {
+                Neighbour* neighbours = neighboursOut.data() + i * k;
+                std::fill( neighbours + findNearestTriangles( mesh, queries[i], k, neighbours ),
+                           neighbours + k, Neighbour() );
+            } );
+        }
+
+        void TriangleKdTree::getTrianglesInRadius( const TriangleMesh& mesh, const VectorArray<Vector3>& queries,
+                                                   Scalar radius, std::vector<std::vector<uint>>& trianglesOut ) const
+        {
+            trianglesOut.resize( queries.size() );
+            parallelFor( 0, queries.size(), [&]( uint i )
+            {
+                getTrianglesInRadius( mesh, queries[i], radius, trianglesOut[i] );
+            } );
+        }
+    }
+}
@@ -0,0 +1,148 @@
+#ifndef RADIUMENGINE_TRIANGLE_KDTREE_HPP_
+#define RADIUMENGINE_TRIANGLE_KDTREE_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Mesh/TriangleMesh.hpp>
+#include <Core/Containers/VectorArray.hpp>
+#include <Core/Containers/AlignedStdVector.hpp>
+
+#include <limits>
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// Kd-tree of the triangles of a mesh, for proximity queries (closest point, k nearest
+        /// triangles, triangles in a radius). Triangles are split by the centroid of their box,
+        /// and each node stores the box of its triangles, so that nodes may overlap.
+        /// Like TriangleBVH, the tree only stores triangle indices : the queries take the mesh
+        /// it was built from. All the queries give the results of a linear scan of the triangles
+        /// with DistanceQueries::pointToTriSq(), ties being broken by the lowest triangle index.
+        class RA_CORE_API TriangleKdTree
+        {
+        public:
+            /// Node of the tree. The two children of an inner node are stored next to
+            /// each other, a leaf references a range of getTriangles().
+            struct Node
+            {
+                float m_min[3];
+                uint  m_index;  /// First child for an inner node, first triangle for a leaf.
+                float m_max[3];
+                uint  m_count;  /// Number of triangles of a leaf, 0 for an inner node.
+
+                inline bool isLeaf() const { return m_count != 0; }
+            };
+            static_assert( sizeof( Node ) == 32, "Nodes should be 32 bytes." );
+
+            /// How the triangles of a node are split between its children.
+            enum SplitMethod
+            {
+                MEDIAN = 0, // Median of the largest axis : fast build, balanced tree.
+                SAH,        // Binned surface area heuristic : slower build, faster queries.
+            };
+
+            /// Result of a closest point query.
+            struct ClosestPoint
+            {
+                ClosestPoint()
+                    : m_triangle( -1 ), m_point( Vector3::Zero() ),
+                      m_squaredDistance( std::numeric_limits<Scalar>::max() ) {}
+
+                int m_triangle;             /// Index of the closest triangle, -1 if there is none.
+                Vector3 m_point;            /// Closest point on the triangle.
+                Scalar m_squaredDistance;   /// Squared distance to the query point.
+            };
+
+            /// Result of a k nearest triangles query.
+            struct Neighbour
+            {
+                Neighbour() : m_triangle( -1 ), m_squaredDistance( std::numeric_limits<Scalar>::max() ) {}
+                Neighbour( int triangle, Scalar squaredDistance )
+                    : m_triangle( triangle ), m_squaredDistance( squaredDistance ) {}
+
+                int m_triangle;             /// Index of the triangle, -1 if there is none.
+                Scalar m_squaredDistance;   /// Squared distance to the query point.
+            };
+
+            /// Maximum number of triangles in a leaf.
+            static constexpr uint MaxLeafSize = 8;
+            /// Number of bins used to evaluate the surface area heuristic.
+            static constexpr uint NumBins = 16;
+            /// Depth from which nodes are split at the median, to bound the traversal stack.
+            static constexpr uint MaxSahDepth = 32;
+            /// Size of the traversal stack, larger than the depth of the tree.
+            static constexpr uint StackSize = 96;
+            /// Subtrees with fewer triangles are built by a single task.
+            static constexpr uint MinTaskSize = 1024;
+
+        public:
+            TriangleKdTree() = default;
+
+            /// Builds the tree of the triangles of the mesh. Subtrees are built in parallel
+            /// (see Core::parallelFor()).
+            void build( const TriangleMesh& mesh, SplitMethod method = SAH );
+
+            void clear();
+
+            inline bool isEmpty() const { return m_nodes.empty(); }
+
+            /// Returns the closest point of the mesh to q. If no triangle is at a distance of
+            /// at most maxDistance, the result has no triangle.
+            /// If tolerance is positive, the query stops at the first triangle found at a distance
+            /// of at most tolerance, which may not be the closest one.
+            ClosestPoint getClosestPoint( const TriangleMesh& mesh, const Vector3& q,
+                                          Scalar maxDistance = std::numeric_limits<Scalar>::max(),
+                                          Scalar tolerance = 0 ) const;
+
+            /// Writes the k triangles closest to q in neighboursOut, sorted by distance.
+            /// neighboursOut has less than k entries if the mesh has less than k triangles.
+            void getNearestTriangles( const TriangleMesh& mesh, const Vector3& q, uint k,
+                                      std::vector<Neighbour>& neighboursOut ) const;
+
+            /// Writes the triangles at a distance of at most radius from q in trianglesOut,
+            /// sorted by index.
+            void getTrianglesInRadius( const TriangleMesh& mesh, const Vector3& q, Scalar radius,
+                                       std::vector<uint>& trianglesOut ) const;
+
+            /// Batch queries, processed in parallel (see Core::parallelFor()). The output vectors
+            /// are resized, so that they do not allocate when they are reused.
+            /// closestOut[i] is the closest point to queries[i].
+            void getClosestPoints( const TriangleMesh& mesh, const VectorArray<Vector3>& queries,
+                                   std::vector<ClosestPoint>& closestOut,
+                                   Scalar maxDistance = std::numeric_limits<Scalar>::max() ) const;
+
+            /// neighboursOut[i * k + j] is the j-th nearest triangle to queries[i], without
+            /// triangle if the mesh has less than j + 1 triangles.
+            void getNearestTriangles( const TriangleMesh& mesh, const VectorArray<Vector3>& queries, uint k,
+                                      std::vector<Neighbour>& neighboursOut ) const;
+
+            /// trianglesOut[i] holds the triangles at a distance of at most radius from queries[i].
+            void getTrianglesInRadius( const TriangleMesh& mesh, const VectorArray<Vector3>& queries,
+                                       Scalar radius, std::vector<std::vector<uint>>& trianglesOut ) const;
+
+            inline const AlignedStdVector<Node>& getNodes() const { return m_nodes; }
+
+            /// Triangle indices referenced by the ranges of the leaves.
+            inline const std::vector<uint>& getTriangles() const { return m_triangles; }
+
+        private:
+            /// Calls f( leaf, bound ) on the leaves which may hold a triangle at a squared distance
+            /// of at most bound from q, closest first. f returns the new bound.
+            template <typename Func>
+            inline void traverse( const Vector3& q, Scalar bound, const Func& f ) const;
+
+            /// Writes the k nearest triangles to q in neighboursOut[0, k) and returns their number.
+            uint findNearestTriangles( const TriangleMesh& mesh, const Vector3& q, uint k,
+                                       Neighbour* neighboursOut ) const;
+
+        private:
+            AlignedStdVector<Node> m_nodes;
+            std::vector<uint> m_triangles;
+        };
+    }
+}
+
+#endif // RADIUMENGINE_TRIANGLE_KDTREE_HPP_
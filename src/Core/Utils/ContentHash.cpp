@@ -0,0 +1,40 @@
+#include <Core/Utils/ContentHash.hpp>
+
+#include <cstring>
+
+namespace Ra
+{
+    namespace Core
+    {
+        namespace
+        {
+            /// Finalizer of MurmurHash3, so that each bit of a word changes half of the hash bits.
+            inline std::uint64_t mix( std::uint64_t h )
+            {
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdull;
+                h ^= h >> 33;
+                h *= 0xc4ceb9fe1a85ec53ull;
+                h ^= h >> 33;
+                return h;
+            }
+        }
+
+        void ContentHash::add( const void* data, std::size_t size )
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>( data );
+            std::size_t i = 0;
+            for ( ; i + sizeof( std::uint64_t ) <= size; i += sizeof( std::uint64_t ) )
+            {
+                std::uint64_t word;
+                std::memcpy( &word, bytes + i, sizeof( word ) );
+                m_hash = mix( m_hash ^ word );
+            }
+
+            // The last bytes are hashed with their number, so that trailing zeros count.
+            std::uint64_t word = 0;
+            std::memcpy( &word, bytes + i, size - i );
+            m_hash = mix( m_hash ^ word ^ ( std::uint64_t( size - i ) << 61 ) );
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef RADIUMENGINE_CONTENT_HASH_HPP_
+#define RADIUMENGINE_CONTENT_HASH_HPP_
+
+#include <Core/RaCore.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Ra
+{
+    namespace Core
+    {
+        /// 64 bit hash of the bytes of some arrays, to find the data loaded several times, e.g. a
+        /// mesh referenced by many nodes of a scene. Equal contents have equal hashes, and
+        /// different contents are very unlikely to, but must still be compared to be sure.
+        /// The arrays must not hold padding bytes.
+        class RA_CORE_API ContentHash
+        {
+        public:
+            /// Adds size bytes to the hashed content, reading them 8 by 8.
+            void add( const void* data, std::size_t size );
+
+            /// Adds the size and the elements of an array.
+            template <typename T, typename Allocator>
+            inline void add( const std::vector<T, Allocator>& array )
+            {
+                const std::uint64_t size = array.size();
+                add( &size, sizeof( size ) );
+                add( array.data(), array.size() * sizeof( T ) );
+            }
+
+            /// Returns the hash of the content added so far.
+            inline std::uint64_t get() const { return m_hash; }
+
+        private:
+            std::uint64_t m_hash = 0xcbf29ce484222325ull;
+        };
+    }
+}
+
+#endif // RADIUMENGINE_CONTENT_HASH_HPP_
@@ -73,9 +73,9 @@ namespace Ra
                 const auto ro = getRoMgr()->getRenderObject(idx);
                 if (ro->isVisible())
                 {
-                    const Ra::Core::Transform& t = ro->getLocalTransform();
+                    const Ra::Core::Transform t = ro->getLocalTransform();
                     Core::Ray transformedRay = Ra::Core::transformRay(ray, t.inverse());
-                    auto result = Ra::Core::MeshUtils::castRay(ro->getMesh()->getGeometry(), transformedRay);
+                    auto result = ro->getMesh()->castRay(transformedRay);
                     const int& tidx = result.m_hitTriangle;
                     if (tidx >= 0)
                     {
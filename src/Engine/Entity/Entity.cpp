@@ -12,12 +12,11 @@ namespace Ra
     namespace Engine
     {
 
-        Entity::Entity( const std::string& name )
+        Entity::Entity( const std::string& name, TransformStore* transforms )
                 : Core::IndexedObject()
-                , m_transform( Core::Transform::Identity())
-                , m_doubleBufferedTransform( Core::Transform::Identity() )
+                , m_transforms( transforms )
+                , m_transformSlot( transforms->allocate() )
                 , m_name( name )
-                , m_transformChanged( false )
         {
         }
 
@@ -27,6 +26,7 @@ namespace Ra
             // ordering of signals.
             m_components.clear();
             RadiumEngine::getInstance()->getSignalManager()->fireEntityDestroyed( ItemEntry(this) );
+            m_transforms->release( m_transformSlot );
         }
 
         void Entity::addComponent( Engine::Component* component )
@@ -75,19 +75,10 @@ namespace Ra
             m_components.erase(pos);
         }
 
-        void Entity::swapTransformBuffers()
-        {
-            if ( m_transformChanged )
-            {
-                m_transform = m_doubleBufferedTransform;
-                m_transformChanged = false;
-            }
-        }
-
         void Entity::rayCastQuery(const Core::Ray& r) const
         {
             // put ray in local frame.
-            Core::Ray transformedRay = Ra::Core::transformRay(r, m_transform.inverse());
+            Core::Ray transformedRay = Ra::Core::transformRay(r, getTransform().inverse());
             for (const auto& c : m_components)
             {
                 c->rayCastQuery(transformedRay);
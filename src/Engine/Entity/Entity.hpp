@@ -12,6 +12,8 @@
 #include <Core/Math/LinearAlgebra.hpp>
 #include <Core/Math/Ray.hpp>
 
+#include <Engine/Entity/TransformStore.hpp>
+
 namespace Ra
 {
     namespace Engine
@@ -31,7 +33,8 @@ namespace Ra
         {
         public:
             RA_CORE_ALIGNED_NEW
-            explicit Entity( const std::string& name = "" );
+            /// The transform of the entity is stored in the given store (see EntityManager).
+            Entity( const std::string& name, TransformStore* transforms );
 
             // Entities are not copyable.
             Entity( const Entity& entity ) = delete;
@@ -44,12 +47,16 @@ namespace Ra
             inline void rename( const std::string& name );
 
             // Transform
+            /// The transform set during a frame is returned by getTransform() from the next
+            /// frame on, when the transform store publishes it (see TransformStore::swapBuffers()).
             inline void setTransform( const Core::Transform& transform );
             inline void setTransform( const Core::Matrix4& transform );
-            Core::Transform getTransform() const;
-            Core::Matrix4 getTransformAsMatrix() const;
+            inline Core::Transform getTransform() const;
+            inline Core::Matrix4 getTransformAsMatrix() const;
 
-            void swapTransformBuffers();
+            /// Returns the epoch at which the current transform was published, which changes
+            /// each time the transform changes.
+            inline uint getTransformEpoch() const;
 
             // Components
             /// Add a component to the given entity. Ownership is transfered to the component.
@@ -73,15 +80,12 @@ namespace Ra
             virtual void rayCastQuery(const Core::Ray& r) const;
 
         private:
-            Core::Transform m_transform;
-            Core::Transform m_doubleBufferedTransform;
+            TransformStore* m_transforms;
+            TransformStore::Slot m_transformSlot;
 
             std::string m_name;
 
             std::vector<std::unique_ptr<Component>> m_components;
-
-            bool m_transformChanged;
-            mutable std::mutex m_transformMutex;
         };
 
     } // namespace Engine
@@ -16,8 +16,7 @@ namespace Ra
 
         inline void Entity::setTransform( const Core::Transform& transform )
         {
-            m_transformChanged = true;
-            m_doubleBufferedTransform = transform;
+            m_transforms->setTransform( m_transformSlot, transform );
         }
 
         inline void Entity::setTransform( const Core::Matrix4& transform )
@@ -27,14 +26,17 @@ namespace Ra
 
         inline Core::Transform Entity::getTransform() const
         {
-            std::lock_guard<std::mutex> lock( m_transformMutex );
-            return m_transform;
+            return m_transforms->getTransform( m_transformSlot );
         }
 
         inline Core::Matrix4 Entity::getTransformAsMatrix() const
         {
-            std::lock_guard<std::mutex> lock( m_transformMutex );
-            return m_transform.matrix();
+            return m_transforms->getTransform( m_transformSlot ).matrix();
+        }
+
+        inline uint Entity::getTransformEpoch() const
+        {
+            return m_transforms->getEpoch( m_transformSlot );
         }
 
         inline uint Entity::getNumComponents() const
@@ -0,0 +1,65 @@
+#include <Engine/Entity/TransformStore.hpp>
+
+namespace Ra
+{
+    namespace Engine
+    {
+        TransformStore::TransformStore()
+            : m_front( 0 ), m_epoch( 1 )
+        {
+        }
+
+        TransformStore::Slot TransformStore::allocate()
+        {
+            Slot slot;
+            if ( !m_freeSlots.empty() )
+            {
+                slot = m_freeSlots.back();
+                m_freeSlots.pop_back();
+                m_transforms[0][slot] = Core::Transform::Identity();
+                m_transforms[1][slot] = Core::Transform::Identity();
+            }
+            else
+            {
+                slot = Slot( m_epochs.size() );
+                m_transforms[0].push_back( Core::Transform::Identity() );
+                m_transforms[1].push_back( Core::Transform::Identity() );
+                m_epochs.push_back( 0 );
+                m_changed.push_back( 0 );
+            }
+            m_epochs[slot] = getEpoch();
+            m_changed[slot] = 0;
+            return slot;
+        }
+
+        void TransformStore::release( Slot slot )
+        {
+            CORE_ASSERT( slot < m_epochs.size(), "Invalid transform slot" );
+            m_changed[slot] = 0;
+            m_freeSlots.push_back( slot );
+        }
+
+        void TransformStore::swapBuffers()
+        {
+            const uint back = 1 - m_front.load( std::memory_order_relaxed );
+            const uint epoch = m_epoch.load( std::memory_order_relaxed ) + 1;
+
+            m_epoch.store( epoch, std::memory_order_release );
+            m_front.store( back, std::memory_order_release );
+
+            // The new back buffer is the previous front one, which must catch up
+            // with the published transforms before being written again.
+            const Core::AlignedStdVector<Core::Transform>& published = m_transforms[back];
+            Core::AlignedStdVector<Core::Transform>& next = m_transforms[1 - back];
+            for ( Slot i = 0; i < m_changed.size(); ++i )
+            {
+                if ( m_changed[i] )
+                {
+                    next[i] = published[i];
+                    m_epochs[i] = epoch;
+                    m_changed[i] = 0;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef RADIUMENGINE_TRANSFORM_STORE_HPP_
+#define RADIUMENGINE_TRANSFORM_STORE_HPP_
+
+#include <Engine/RaEngine.hpp>
+
+#include <atomic>
+#include <vector>
+
+#include <Core/Math/LinearAlgebra.hpp>
+#include <Core/Containers/AlignedStdVector.hpp>
+
+namespace Ra
+{
+    namespace Engine
+    {
+        /// Double buffered transforms of all the entities, stored in contiguous arrays indexed
+        /// by a slot per entity.
+        /// During a frame, the tasks write the back buffer while the front buffer is read without
+        /// any lock. swapBuffers() publishes the new transforms by flipping the index of the front
+        /// buffer, and starts a new epoch. The epoch at which the transform of a slot was last
+        /// published lets the users of a transform know when their cached data is outdated.
+        /// Slots must only be allocated and released between frames.
+        class RA_ENGINE_API TransformStore
+        {
+        public:
+            typedef uint Slot;
+
+            TransformStore();
+
+            TransformStore( const TransformStore& ) = delete;
+            TransformStore& operator=( const TransformStore& ) = delete;
+
+            /// Returns a new slot, initialized to the identity.
+            Slot allocate();
+
+            /// Makes the slot available to other entities.
+            void release( Slot slot );
+
+            /// Returns the published transform of the slot.
+            inline const Core::Transform& getTransform( Slot slot ) const;
+
+            /// Writes the transform of the slot, which will be published by the next swapBuffers().
+            /// Different slots may be written concurrently.
+            inline void setTransform( Slot slot, const Core::Transform& transform );
+
+            /// Returns the epoch at which the current transform of the slot was published.
+            inline uint getEpoch( Slot slot ) const;
+
+            /// Returns the current epoch, incremented by each swapBuffers().
+            uint getEpoch() const { return m_epoch.load( std::memory_order_acquire ); }
+
+            /// Publishes the transforms written since the last call.
+            /// Must not be called while transforms are read or written.
+            void swapBuffers();
+
+        private:
+            /// Front and back transforms. Both buffers hold the same transform for
+            /// all the slots which have not been written since the last swap.
+            Core::AlignedStdVector<Core::Transform> m_transforms[2];
+
+            /// Epoch of the last publication of each slot.
+            std::vector<uint> m_epochs;
+
+            /// Non-zero for the slots written since the last swap. Bytes rather than
+            /// bits so that different slots can be written concurrently.
+            std::vector<uchar> m_changed;
+
+            std::vector<Slot> m_freeSlots;
+
+            std::atomic<uint> m_front;
+            std::atomic<uint> m_epoch;
+        };
+    }
+}
+
+#include <Engine/Entity/TransformStore.inl>
+
+#endif // RADIUMENGINE_TRANSFORM_STORE_HPP_
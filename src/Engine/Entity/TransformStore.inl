@@ -0,0 +1,26 @@
+#include "TransformStore.hpp"
+
+namespace Ra
+{
+    namespace Engine
+    {
+        inline const Core::Transform& TransformStore::getTransform( Slot slot ) const
+        {
+            CORE_ASSERT( slot < m_epochs.size(), "Invalid transform slot" );
+            return m_transforms[m_front.load( std::memory_order_acquire )][slot];
+        }
+
+        inline void TransformStore::setTransform( Slot slot, const Core::Transform& transform )
+        {
+            CORE_ASSERT( slot < m_epochs.size(), "Invalid transform slot" );
+            m_transforms[1 - m_front.load( std::memory_order_relaxed )][slot] = transform;
+            m_changed[slot] = 1;
+        }
+
+        inline uint TransformStore::getEpoch( Slot slot ) const
+        {
+            CORE_ASSERT( slot < m_epochs.size(), "Invalid transform slot" );
+            return m_epochs[slot];
+        }
+    }
+}
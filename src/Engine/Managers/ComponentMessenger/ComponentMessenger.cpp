@@ -4,5 +4,57 @@ namespace Ra {
 namespace Engine
 {
     RA_SINGLETON_IMPLEMENTATION( ComponentMessenger );
+
+    ComponentMessenger::EntityHandles ComponentMessenger::resolveAll(const Entity* entity) const
+    {
+        EntityHandles handles;
+        std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+
+        auto getList = m_entityGetLists.find(entity);
+        if (getList != m_entityGetLists.end())
+        {
+            handles.m_outputs = getList->second;
+        }
+
+        auto rwList = m_entityRwLists.find(entity);
+        if (rwList != m_entityRwLists.end())
+        {
+            handles.m_readWrites = rwList->second;
+        }
+
+        auto setList = m_entitySetLists.find(entity);
+        if (setList != m_entitySetLists.end())
+        {
+            handles.m_inputs = setList->second;
+        }
+
+        return handles;
+    }
+
+    const ComponentMessenger::Slot* ComponentMessenger::findSlot(
+            const std::unordered_map<const Entity*, CallbackMap>& lists, const Entity* entity, const Key& key)
+    {
+        auto entityList = lists.find(entity);
+        if (entityList == lists.end())
+        {
+            return nullptr;
+        }
+        auto pos = entityList->second.find(key);
+        return pos != entityList->second.end() ? pos->second : nullptr;
+    }
+
+    void ComponentMessenger::addSlot(std::unordered_map<const Entity*, CallbackMap>& lists, const Entity* entity,
+                                     const Key& key, CallbackBase* callback, const void* data)
+    {
+        CallbackMap& entityList = lists[entity];
+        CORE_ASSERT(entityList.find(key) == entityList.end(), "Entry already registered");
+
+        // Slots are never erased so that the handles stay valid.
+        m_slots.emplace_back();
+        Slot& slot = m_slots.back();
+        slot.m_callback.reset(callback);
+        slot.m_data = data;
+        entityList[key] = &slot;
+    }
 }
 }
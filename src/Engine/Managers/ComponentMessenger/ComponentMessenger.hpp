@@ -5,10 +5,13 @@
 
 #include <unordered_map>
 #include <vector>
+#include <deque>
+#include <mutex>
 #include <typeindex>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <shared_mutex>
 
 #include <Core/Utils/Singleton.hpp>
 #include <Engine/Component/Component.hpp>
@@ -37,6 +40,12 @@ namespace Ra
         /// and rw() functions.
         /// For more efficiency the underlying function pointers are directly accessible
         /// as well and can be queried with the same identifiers.
+        /// The most efficient access is through handles : an entry is resolved once into a typed
+        /// handle (see resolveOutput(), resolveReadWrite(), resolveInput() and resolveAll()),
+        /// which is then read without any lookup. Data registered with a direct pointer instead
+        /// of a function is read through a handle without calling any function.
+        /// All the functions can be called concurrently by several threads. Handle accesses
+        /// do not lock anything.
         class RA_ENGINE_API ComponentMessenger
         {
         RA_SINGLETON_INTERFACE(ComponentMessenger);
@@ -105,8 +114,76 @@ namespace Ra
                 typename CallbackTypes<T>::ReadWrite m_cb;
             };
 
-            /// A dictionary of callback entries identified with the key.
-            typedef std::unordered_map<Key, std::unique_ptr<CallbackBase>, HashFunc> CallbackMap;
+            /// A registered entry. Entries are never moved, so that handles can point to them.
+            struct Slot
+            {
+                /// Callback of the entry, always valid.
+                std::unique_ptr<CallbackBase> m_callback;
+                /// Registered data if the entry was registered with a direct pointer, else nullptr.
+                const void* m_data;
+            };
+
+            /// A dictionary of entries identified with the key.
+            typedef std::unordered_map<Key, Slot*, HashFunc> CallbackMap;
+
+        public:
+            /// Handle on an output entry, see resolveOutput().
+            template<typename T>
+            class OutputHandle
+            {
+            public:
+                OutputHandle() : m_slot( nullptr ) {}
+                bool isValid() const { return m_slot != nullptr; }
+            private:
+                friend class ComponentMessenger;
+                const Slot* m_slot;
+            };
+
+            /// Handle on a read/write entry, see resolveReadWrite().
+            template<typename T>
+            class ReadWriteHandle
+            {
+            public:
+                ReadWriteHandle() : m_slot( nullptr ) {}
+                bool isValid() const { return m_slot != nullptr; }
+            private:
+                friend class ComponentMessenger;
+                const Slot* m_slot;
+            };
+
+            /// Handle on an input entry, see resolveInput().
+            template<typename T>
+            class InputHandle
+            {
+            public:
+                InputHandle() : m_slot( nullptr ) {}
+                bool isValid() const { return m_slot != nullptr; }
+            private:
+                friend class ComponentMessenger;
+                const Slot* m_slot;
+            };
+
+            /// All the entries of an entity, from which handles are resolved without locking
+            /// the messenger (see resolveAll()). Returned handles are invalid when the entry
+            /// does not exist.
+            class EntityHandles
+            {
+            public:
+                template<typename T>
+                inline OutputHandle<T> output( const std::string& id ) const;
+
+                template<typename T>
+                inline ReadWriteHandle<T> readWrite( const std::string& id ) const;
+
+                template<typename T>
+                inline InputHandle<T> input( const std::string& id ) const;
+
+            private:
+                friend class ComponentMessenger;
+                CallbackMap m_outputs;
+                CallbackMap m_readWrites;
+                CallbackMap m_inputs;
+            };
 
         public:
             ComponentMessenger() { }
@@ -137,6 +214,35 @@ namespace Ra
             template<typename ReturnType>
             inline const ReturnType& get(const Entity* entity, const std::string& id);
 
+            //
+            // Handles
+            //
+
+            // Note : resolve functions return an invalid handle when the data is not available.
+
+            template<typename ReturnType>
+            inline OutputHandle<ReturnType> resolveOutput(const Entity* entity, const std::string& id) const;
+
+            template<typename ReturnType>
+            inline ReadWriteHandle<ReturnType> resolveReadWrite(const Entity* entity, const std::string& id) const;
+
+            template<typename ReturnType>
+            inline InputHandle<ReturnType> resolveInput(const Entity* entity, const std::string& id) const;
+
+            /// Returns all the entries of an entity at once, to resolve several handles.
+            EntityHandles resolveAll(const Entity* entity) const;
+
+            /// Access the data through a valid handle. Only the data registered with a function
+            /// costs a function call.
+            template<typename ReturnType>
+            inline const ReturnType& get(const OutputHandle<ReturnType>& handle) const;
+
+            template<typename ReturnType>
+            inline ReturnType* rw(const ReadWriteHandle<ReturnType>& handle) const;
+
+            template<typename ReturnType>
+            inline void set(const InputHandle<ReturnType>& handle, const ReturnType* x) const;
+
 
 
             //
@@ -169,11 +275,37 @@ namespace Ra
             inline void registerInput(const Entity* entity, Component* comp, const std::string& id,
                                       const typename CallbackTypes<ReturnType>::Setter& cb);
 
+            /// Register data which stays at the same address for the lifetime of the component,
+            /// to be read through handles without any function call.
+            template<typename ReturnType>
+            inline void registerOutput(const Entity* entity, Component* comp, const std::string& id,
+                                       const ReturnType* data);
+
+            template<typename ReturnType>
+            inline void registerReadWrite(const Entity* entity, Component* comp, const std::string& id,
+                                          ReturnType* data);
+
+        private:
+            /// Returns the entry of the key in the given lists, or nullptr.
+            /// The lock must be held.
+            static const Slot* findSlot(const std::unordered_map<const Entity*, CallbackMap>& lists,
+                                        const Entity* entity, const Key& key);
+
+            /// Adds an entry to the given lists. The lock must be held.
+            void addSlot(std::unordered_map<const Entity*, CallbackMap>& lists, const Entity* entity,
+                         const Key& key, CallbackBase* callback, const void* data);
+
         private:
             std::unordered_map<const Entity*, CallbackMap> m_entityGetLists; /// Per-entity callback get list.
             std::unordered_map<const Entity*, CallbackMap> m_entitySetLists; /// Per-entity callback set list.
             std::unordered_map<const Entity*, CallbackMap> m_entityRwLists;  /// Per-entity callback read-write list.
 
+            /// Storage of all the entries.
+            std::deque<Slot> m_slots;
+
+            /// Protects the lists and the storage : lookups share the lock, registrations own it.
+            mutable std::shared_timed_mutex m_mutex;
+
         };
 
     }
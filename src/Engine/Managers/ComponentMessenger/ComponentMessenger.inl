@@ -14,27 +14,30 @@ namespace Ra
         inline typename ComponentMessenger::CallbackTypes<ReturnType>::Getter ComponentMessenger::getterCallback(
                 const Entity* entity, const std::string& id)
         {
-            CORE_ASSERT(canGet<ReturnType>(entity, id), "Unregistered callback");
-            return static_cast<GetterCallback <ReturnType>*>(m_entityGetLists[entity][Key(id, std::type_index(
-                    typeid(ReturnType)))].get())->m_cb;
+            std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+            const Slot* slot = findSlot(m_entityGetLists, entity, Key(id, std::type_index(typeid(ReturnType))));
+            CORE_ASSERT(slot, "Unregistered callback");
+            return static_cast<GetterCallback <ReturnType>*>(slot->m_callback.get())->m_cb;
         }
 
         template<typename ReturnType>
         inline typename ComponentMessenger::CallbackTypes<ReturnType>::ReadWrite ComponentMessenger::rwCallback(
                 const Entity* entity, const std::string& id)
         {
-            CORE_ASSERT(canRw<ReturnType>(entity, id), "Unregistered callback");
-            return static_cast<RwCallback <ReturnType>*>(m_entityRwLists[entity][Key(id, std::type_index(
-                    typeid(ReturnType)))].get())->m_cb;
+            std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+            const Slot* slot = findSlot(m_entityRwLists, entity, Key(id, std::type_index(typeid(ReturnType))));
+            CORE_ASSERT(slot, "Unregistered callback");
+            return static_cast<RwCallback <ReturnType>*>(slot->m_callback.get())->m_cb;
         }
 
         template<typename ReturnType>
         inline typename ComponentMessenger::CallbackTypes<ReturnType>::Setter ComponentMessenger::setterCallback(
                 const Entity* entity, const std::string& id)
         {
-            CORE_ASSERT(canSet<ReturnType>(entity, id), "Unregistered callback");
-            return static_cast<SetterCallback <ReturnType>*>(m_entitySetLists[entity][Key(id, std::type_index(
-                    typeid(ReturnType)))].get())->m_cb;
+            std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+            const Slot* slot = findSlot(m_entitySetLists, entity, Key(id, std::type_index(typeid(ReturnType))));
+            CORE_ASSERT(slot, "Unregistered callback");
+            return static_cast<SetterCallback <ReturnType>*>(slot->m_callback.get())->m_cb;
         }
 
         template<typename ReturnType>
@@ -52,55 +55,22 @@ namespace Ra
         template<typename ReturnType>
         inline bool ComponentMessenger::canGet(const Entity* entity, const std::string& id)
         {
-            // Attempt to find the given entity list.
-            const auto& entityListPos = m_entityGetLists.find(entity);
-            if (entityListPos == m_entityGetLists.end())
-                return false; // Entity has no registered component
-
-            Key key(id, std::type_index(typeid(ReturnType)));
-            const CallbackMap& entityList = entityListPos->second;
-
-            // Check if there are components exporting the given type,
-            // so let's try to find if there is one with the requested id.
-            const auto& callbackEntry = entityList.find(key);
-            const bool found = (callbackEntry != entityList.end());
-            return found;
+            std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+            return findSlot(m_entityGetLists, entity, Key(id, std::type_index(typeid(ReturnType)))) != nullptr;
         }
 
         template<typename ReturnType>
         inline bool ComponentMessenger::canSet(const Entity* entity, const std::string& id)
         {
-            // Attempt to find the given entity list.
-            auto entityListPos = m_entitySetLists.find(entity);
-            if (entityListPos == m_entitySetLists.end())
-                return false; // Entity has no registered component
-
-            Key key(id, std::type_index(typeid(ReturnType)));
-            const CallbackMap& entityList = entityListPos->second;
-
-            // Check if there are components exporting the given type,
-            // so let's try to find if there is one with the requested id.
-            const auto& callbackEntry = entityList.find(key);
-            const bool found = (callbackEntry != entityList.end());
-            return found;
+            std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+            return findSlot(m_entitySetLists, entity, Key(id, std::type_index(typeid(ReturnType)))) != nullptr;
         }
 
         template<typename ReturnType>
         inline bool ComponentMessenger::canRw(const Entity* entity, const std::string& id)
         {
-            // Attempt to find the given entity list.
-            const auto& entityListPos = m_entityRwLists.find(entity);
-            if (entityListPos == m_entityRwLists.end())
-                return false; // Entity has no registered component
-
-            Key key(id, std::type_index(typeid(ReturnType)));
-            const CallbackMap& entityList = entityListPos->second;
-
-            // Check if there are components exporting the given type,
-            // so let's try to find if there is one with the requested id.
-            const auto& callbackEntry = entityList.find(key);
-            const bool found = (callbackEntry != entityList.end());
-            return found;
+            std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+            return findSlot(m_entityRwLists, entity, Key(id, std::type_index(typeid(ReturnType)))) != nullptr;
         }
 
         template<typename ReturnType>
@@ -108,15 +78,11 @@ namespace Ra
                                                 const typename CallbackTypes<ReturnType>::Getter& cb)
         {
             CORE_ASSERT(entity && comp->getEntity() == entity, "Component not added to entity");
-            // Will insert a new entity entry if it doesn't exist.
-            CallbackMap& entityList = m_entityGetLists[entity];
-
-            Key key(id, std::type_index(typeid(ReturnType)));
-            CORE_ASSERT(entityList.find(key) == entityList.end(), "Output function already registered");
+            GetterCallback <ReturnType>* callback = new GetterCallback<ReturnType>();
+            callback->m_cb = cb;
 
-            GetterCallback <ReturnType>* getter = new GetterCallback<ReturnType>();
-            getter->m_cb = cb;
-            entityList[key].reset(getter);
+            std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+            addSlot(m_entityGetLists, entity, Key(id, std::type_index(typeid(ReturnType))), callback, nullptr);
         }
 
         template<typename ReturnType>
@@ -124,15 +90,11 @@ namespace Ra
                                                    const typename CallbackTypes<ReturnType>::ReadWrite& cb)
         {
             CORE_ASSERT(entity && comp->getEntity() == entity, "Component not added to entity");
-            // Will insert a new entity entry if it doesn't exist.
-            CallbackMap& entityList = m_entityRwLists[entity];
+            RwCallback <ReturnType>* callback = new RwCallback<ReturnType>();
+            callback->m_cb = cb;
 
-            Key key(id, std::type_index(typeid(ReturnType)));
-            CORE_ASSERT(entityList.find(key) == entityList.end(), "Rw function already registered");
-
-            RwCallback <ReturnType>* rw = new RwCallback<ReturnType>();
-            rw->m_cb = cb;
-            entityList[key].reset(rw);
+            std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+            addSlot(m_entityRwLists, entity, Key(id, std::type_index(typeid(ReturnType))), callback, nullptr);
         }
 
         template<typename ReturnType>
@@ -140,15 +102,124 @@ namespace Ra
                                                const typename CallbackTypes<ReturnType>::Setter& cb)
         {
             CORE_ASSERT(entity && comp->getEntity() == entity, "Component not added to entity");
-            // Will insert a new entity entry if it doesn't exist.
-            CallbackMap& entityList = m_entitySetLists[entity];
+            SetterCallback <ReturnType>* callback = new SetterCallback<ReturnType>();
+            callback->m_cb = cb;
+
+            std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+            addSlot(m_entitySetLists, entity, Key(id, std::type_index(typeid(ReturnType))), callback, nullptr);
+        }
+
+        template<typename ReturnType>
+        inline void ComponentMessenger::registerOutput(const Entity* entity, Component* comp, const std::string& id,
+                                                       const ReturnType* data)
+        {
+            CORE_ASSERT(entity && comp->getEntity() == entity, "Component not added to entity");
+            GetterCallback <ReturnType>* callback = new GetterCallback<ReturnType>();
+            callback->m_cb = [data]() { return data; };
+
+            std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+            addSlot(m_entityGetLists, entity, Key(id, std::type_index(typeid(ReturnType))), callback, data);
+        }
+
+        template<typename ReturnType>
+        inline void ComponentMessenger::registerReadWrite(const Entity* entity, Component* comp, const std::string& id,
+                                                          ReturnType* data)
+        {
+            CORE_ASSERT(entity && comp->getEntity() == entity, "Component not added to entity");
+            RwCallback <ReturnType>* callback = new RwCallback<ReturnType>();
+            callback->m_cb = [data]() { return data; };
+
+            std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+            addSlot(m_entityRwLists, entity, Key(id, std::type_index(typeid(ReturnType))), callback, data);
+        }
+
+        template<typename ReturnType>
+        inline ComponentMessenger::OutputHandle<ReturnType> ComponentMessenger::resolveOutput(
+                const Entity* entity, const std::string& id) const
+        {
+            OutputHandle<ReturnType> handle;
+            std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+            handle.m_slot = findSlot(m_entityGetLists, entity, Key(id, std::type_index(typeid(ReturnType))));
+            return handle;
+        }
+
+        template<typename ReturnType>
+        inline ComponentMessenger::ReadWriteHandle<ReturnType> ComponentMessenger::resolveReadWrite(
+                const Entity* entity, const std::string& id) const
+        {
+            ReadWriteHandle<ReturnType> handle;
+            std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+            handle.m_slot = findSlot(m_entityRwLists, entity, Key(id, std::type_index(typeid(ReturnType))));
+            return handle;
+        }
+
+        template<typename ReturnType>
+        inline ComponentMessenger::InputHandle<ReturnType> ComponentMessenger::resolveInput(
+                const Entity* entity, const std::string& id) const
+        {
+            InputHandle<ReturnType> handle;
+            std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+            handle.m_slot = findSlot(m_entitySetLists, entity, Key(id, std::type_index(typeid(ReturnType))));
+            return handle;
+        }
 
-            Key key(id, std::type_index(typeid(ReturnType)));
-            CORE_ASSERT(entityList.find(key) == entityList.end(), "Input function already registered");
+        template<typename ReturnType>
+        inline const ReturnType& ComponentMessenger::get(const OutputHandle<ReturnType>& handle) const
+        {
+            CORE_ASSERT(handle.isValid(), "Invalid handle");
+            const Slot* slot = handle.m_slot;
+            if (slot->m_data != nullptr)
+            {
+                return *static_cast<const ReturnType*>(slot->m_data);
+            }
+            return CallbackTypes<ReturnType>::getHelper(static_cast<GetterCallback <ReturnType>*>(slot->m_callback.get())->m_cb);
+        }
 
-            SetterCallback <ReturnType>* setter = new SetterCallback<ReturnType>();
-            setter->m_cb = cb;
-            entityList[key].reset(setter);
+        template<typename ReturnType>
+        inline ReturnType* ComponentMessenger::rw(const ReadWriteHandle<ReturnType>& handle) const
+        {
+            CORE_ASSERT(handle.isValid(), "Invalid handle");
+            const Slot* slot = handle.m_slot;
+            if (slot->m_data != nullptr)
+            {
+                // Read/write entries are registered from non-const pointers.
+                return static_cast<ReturnType*>(const_cast<void*>(slot->m_data));
+            }
+            return static_cast<RwCallback <ReturnType>*>(slot->m_callback.get())->m_cb();
+        }
+
+        template<typename ReturnType>
+        inline void ComponentMessenger::set(const InputHandle<ReturnType>& handle, const ReturnType* x) const
+        {
+            CORE_ASSERT(handle.isValid(), "Invalid handle");
+            static_cast<SetterCallback <ReturnType>*>(handle.m_slot->m_callback.get())->m_cb(x);
+        }
+
+        template<typename T>
+        inline ComponentMessenger::OutputHandle<T> ComponentMessenger::EntityHandles::output(const std::string& id) const
+        {
+            OutputHandle<T> handle;
+            const auto& pos = m_outputs.find(Key(id, std::type_index(typeid(T))));
+            handle.m_slot = pos != m_outputs.end() ? pos->second : nullptr;
+            return handle;
+        }
+
+        template<typename T>
+        inline ComponentMessenger::ReadWriteHandle<T> ComponentMessenger::EntityHandles::readWrite(const std::string& id) const
+        {
+            ReadWriteHandle<T> handle;
+            const auto& pos = m_readWrites.find(Key(id, std::type_index(typeid(T))));
+            handle.m_slot = pos != m_readWrites.end() ? pos->second : nullptr;
+            return handle;
+        }
+
+        template<typename T>
+        inline ComponentMessenger::InputHandle<T> ComponentMessenger::EntityHandles::input(const std::string& id) const
+        {
+            InputHandle<T> handle;
+            const auto& pos = m_inputs.find(Key(id, std::type_index(typeid(T))));
+            handle.m_slot = pos != m_inputs.end() ? pos->second : nullptr;
+            return handle;
         }
 
     }
@@ -14,7 +14,7 @@ namespace Ra
 
         EntityManager::EntityManager()
         {
-            Entity* ent( SystemEntity::createInstance() );
+            Entity* ent( SystemEntity::createInstance( &m_transforms ) );
             ent->idx = m_entities.emplace( std::move(ent) );
             CORE_ASSERT( ent == SystemEntity::getInstance(), "Invalid singleton instanciation");
             m_entitiesName.insert( std::pair< std::string, Core::Index> (ent->getName(),ent->idx ));
@@ -34,7 +34,7 @@ namespace Ra
                 LOG( logWARNING ) << "Entity `" << name << "` already exists";
                 entityName = name + "_";
             }
-            Core::Index idx = m_entities.emplace( new Entity(entityName) );
+            Core::Index idx = m_entities.emplace( new Entity( entityName, &m_transforms ) );
             auto& ent = m_entities[idx];
             ent->idx = idx;
 
@@ -113,10 +113,7 @@ namespace Ra
 
         void EntityManager::swapBuffers()
         {
-            for ( uint i = 0; i < m_entities.size(); ++i )
-            {
-                m_entities[i]->swapTransformBuffers();
-            }
+            m_transforms.swapBuffers();
         }
 
         void EntityManager::deleteEntities()
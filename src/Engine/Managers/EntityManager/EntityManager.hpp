@@ -11,6 +11,8 @@
 #include <Core/Utils/Singleton.hpp>
 #include <Core/Index/IndexMap.hpp>
 
+#include <Engine/Entity/TransformStore.hpp>
+
 namespace Ra
 {
     namespace Engine
@@ -80,8 +82,12 @@ namespace Ra
              */
             std::vector<Entity*> getEntities() const;
 
+            /// Publishes the transforms set on the entities during the frame.
             void swapBuffers();
 
+            /// Returns the store holding the transforms of all the entities.
+            const TransformStore& getTransformStore() const { return m_transforms; }
+
             /**
              * @brief Get an entity given its name.
              * @param name Name of the entity to retrieve.
@@ -95,6 +101,9 @@ namespace Ra
             void deleteEntities();
 
         private:
+            /// Declared first so that it outlives the entities.
+            TransformStore m_transforms;
+
             Core::IndexMap<std::unique_ptr<Entity>> m_entities;
             std::map<std::string, Core::Index> m_entitiesName;
 
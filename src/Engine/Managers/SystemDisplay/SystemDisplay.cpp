@@ -5,8 +5,8 @@ namespace Ra
     namespace Engine
     {
 
-        SystemEntity::SystemEntity()
-            : Entity("System Display Entity")
+        SystemEntity::SystemEntity( TransformStore* transforms )
+            : Entity("System Display Entity", transforms)
         {
             addComponent( new UiComponent );
             addComponent( new DebugComponent );
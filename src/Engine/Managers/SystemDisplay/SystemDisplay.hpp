@@ -56,7 +56,7 @@ namespace Ra
         RA_SINGLETON_INTERFACE(SystemEntity);
 
         public:
-            SystemEntity();
+            explicit SystemEntity( TransformStore* transforms );
 
             virtual ~SystemEntity() {};
 
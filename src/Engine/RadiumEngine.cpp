@@ -11,6 +11,7 @@
 
 
 #include <Core/Log/Log.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
 #include <Core/String/StringUtils.hpp>
 #include <Core/Event/EventEnums.hpp>
 #include <Core/Event/KeyEvent.hpp>
@@ -36,6 +37,7 @@ namespace Ra
     {
 
         RadiumEngine::RadiumEngine()
+            : m_taskGraphVersion( 0 ), m_persistentTasks( false ), m_pipelinedFrames( false )
         {
         }
 
@@ -93,22 +95,63 @@ namespace Ra
             ShaderProgramManager::destroyInstance();
         }
 
+        void RadiumEngine::setPipelinedFrames( bool on )
+        {
+            m_pipelinedFrames = on;
+            m_renderObjectManager->setPipelinedFrames( on );
+        }
+
         void RadiumEngine::endFrameSync()
         {
             m_entityManager->swapBuffers();
+            // The world bounds of the render objects follow the geometry of the swapped meshes.
+            m_renderObjectManager->swapMeshBuffers();
+            m_renderObjectManager->updateWorldTransforms();
             m_signalManager->fireFrameEnded();
         }
 
         void RadiumEngine::getTasks( Core::TaskQueue* taskQueue,  Scalar dt )
         {
             static uint frameCounter = 0;
-            FrameInfo frameInfo;
-            frameInfo.m_dt = dt;
-            frameInfo.m_numFrame = frameCounter++;
+            m_frameInfo.m_dt = dt;
+            m_frameInfo.m_numFrame = frameCounter++;
+
+            if ( m_persistentTasks )
+            {
+                // Replay the compiled graph if no component changed since it was generated.
+                const uint version = getTaskGraphVersion();
+                if ( taskQueue->isGraphCompiled() && version == m_taskGraphVersion )
+                {
+                    return;
+                }
+                m_taskGraphVersion = version;
+            }
+
+            if ( taskQueue->isGraphCompiled() )
+            {
+                taskQueue->clearGraph();
+            }
+
             for ( auto& syst : m_systems )
             {
-                syst.second->generateTasks( taskQueue, frameInfo );
+                syst.second->generateTasks( taskQueue, m_frameInfo );
+            }
+
+            if ( m_persistentTasks )
+            {
+                taskQueue->compileGraph();
+            }
+        }
+
+        uint RadiumEngine::getTaskGraphVersion() const
+        {
+            // Both terms only increase, so their sum changes whenever one of them does.
+            uint version = m_systems.size();
+            for ( const auto& syst : m_systems )
+            {
+                version += syst.second->getComponentsVersion();
             }
+            return version;
         }
 
         void RadiumEngine::registerSystem( const std::string& name, System* system )
@@ -8,6 +8,8 @@
 #include <Core/File/FileData.hpp>
 #include <Core/File/FileLoaderInterface.hpp>
 
+#include <Engine/FrameInfo.hpp>
+
 #include <map>
 #include <string>
 #include <memory>
@@ -49,8 +51,23 @@ namespace Ra
             void initialize();
             void cleanup();
 
+            /// Fills the task queue with the tasks of all systems for the frame.
+            /// With persistent tasks, the tasks are compiled into a task graph which is
+            /// kept in the queue and only regenerated when the components of a system change.
             void getTasks( Core::TaskQueue* taskQueue, Scalar dt );
 
+            /// Toggles the persistent task graph. Systems must generate tasks which can
+            /// be replayed on later frames (see System::generateTasks()).
+            void setPersistentTasks( bool on ) { m_persistentTasks = on; }
+            bool hasPersistentTasks() const { return m_persistentTasks; }
+
+            /// Toggles pipelined frames, where the tasks computing a frame run while the previous
+            /// frame is rendered. Entity transforms and meshes modified through
+            /// Mesh::getGeometryForUpdate() are double buffered, and the buffers are swapped
+            /// by endFrameSync(). Must be called after initialize(), between frames.
+            void setPipelinedFrames( bool on );
+            bool hasPipelinedFrames() const { return m_pipelinedFrames; }
+
             void registerSystem( const std::string& name,
                                  System* system );
             System* getSystem( const std::string& system ) const;
@@ -82,6 +99,10 @@ namespace Ra
 
             const std::vector< std::shared_ptr<Asset::FileLoaderInterface> >& getFileLoaders() const;
 
+        private:
+            /// Returns a counter which changes each time a system or a component is added or removed.
+            uint getTaskGraphVersion() const;
+
         private:
             std::map<std::string, std::shared_ptr<System>> m_systems;
 
@@ -91,6 +112,13 @@ namespace Ra
             std::unique_ptr<EntityManager>       m_entityManager;
             std::unique_ptr<SignalManager>       m_signalManager;
             std::unique_ptr<Asset::FileData>     m_loadedFile;
+
+            /// Information on the current frame, referenced by the tasks.
+            FrameInfo m_frameInfo;
+            /// Version of the systems when the task graph was compiled.
+            uint m_taskGraphVersion;
+            bool m_persistentTasks;
+            bool m_pipelinedFrames;
         };
 
     } // namespace Engine
@@ -1,13 +1,62 @@
 #include <Engine/Renderer/Mesh/Mesh.hpp>
 
+#include <algorithm>
 #include <numeric>
 
+#include <Core/Containers/MakeShared.hpp>
+#include <Core/Geometry/PointCloud/PointCloud.hpp>
 #include <Core/Mesh/MeshUtils.hpp>
 #include <Core/Mesh/HalfEdge.hpp>
+#include <Core/Math/Packing.hpp>
 #include <Engine/Renderer/OpenGL/OpenGL.hpp>
 namespace Ra {
     namespace Engine {
 
+        namespace
+        {
+            /// Description of a vertex attribute, as given to glVertexAttribPointer().
+            struct VertexFormat
+            {
+                GLint m_size;
+                GLenum m_type;
+                GLboolean m_normalized;
+                GLsizei m_stride;
+            };
+
+            /// Sends the count vertices of an attribute to the bound VBO, which holds vboSize vertices.
+            /// Only the dirty ranges are sent when the VBO keeps its size and is not mostly modified,
+            /// else the whole VBO is sent again and the attribute is specified in the bound VAO.
+            /// getData( begin, end ) returns the vertices [begin, end) in the given format.
+            template < typename GetData >
+            void uploadVertexData( uint attrib, const VertexFormat& format, uint count, uint& vboSize,
+                                   Core::DirtyRanges& ranges, const GetData& getData )
+            {
+                if ( count != vboSize || ranges.isAll() || ranges.isEmpty() || 2 * ranges.getCount() > count )
+                {
+                    GL_ASSERT( glBufferData( GL_ARRAY_BUFFER, GLsizeiptr( count ) * format.m_stride,
+                                             getData( 0, count ), GL_DYNAMIC_DRAW ) );
+                    GL_ASSERT( glVertexAttribPointer( attrib, format.m_size, format.m_type, format.m_normalized,
+                                                      format.m_stride, nullptr ) );
+                    GL_ASSERT( glEnableVertexAttribArray( attrib ) );
+                    vboSize = count;
+                }
+                else
+                {
+                    for ( const auto& r : ranges.getRanges() )
+                    {
+                        const uint end = std::min( r.m_end, count );
+                        if ( r.m_begin < end )
+                        {
+                            GL_ASSERT( glBufferSubData( GL_ARRAY_BUFFER, GLintptr( r.m_begin ) * format.m_stride,
+                                                        GLsizeiptr( end - r.m_begin ) * format.m_stride,
+                                                        getData( r.m_begin, end ) ) );
+                        }
+                    }
+                }
+                ranges.clear();
+            }
+        }
+
         // Dirty is initializes as false so that we do not create the vao while
         // we have no data to send to the gpu.
         Mesh::Mesh( const std::string& name, MeshRenderMode renderMode )
@@ -16,6 +65,15 @@ namespace Ra {
             , m_renderMode(renderMode)
             , m_numElements (0)
             , m_isDirty( false )
+            , m_pipelined( false )
+            , m_shared( false )
+            , m_hasBackData( false )
+            , m_geometryEpoch( 0 )
+            , m_rayCastTrianglesDirty( true )
+            , m_rayCastVerticesDirty( true )
+            , m_normalFormat( NORMAL_FLOAT )
+            , m_obbEpoch( 0 )
+            , m_hasObb( false )
         {
             CORE_ASSERT( m_renderMode == RM_LINES
                       || m_renderMode == RM_LINES_ADJACENCY
@@ -23,6 +81,10 @@ namespace Ra {
                       || m_renderMode == RM_POINTS
                       || m_renderMode == RM_LINE_STRIP_ADJACENCY,
                          "Unsupported render mode" );
+            for ( auto& outdated : m_backOutdated )
+            {
+                outdated = true;
+            }
         }
 
         Mesh::~Mesh()
@@ -41,6 +103,32 @@ namespace Ra {
             }
         }
 
+        std::shared_ptr<Mesh> Mesh::clone() const
+        {
+            auto mesh = Core::make_shared<Mesh>( m_name, m_renderMode );
+            mesh->m_mesh = m_mesh;
+            mesh->m_v3Data = m_v3Data;
+            mesh->m_v4Data = m_v4Data;
+            mesh->m_numElements = m_numElements;
+            mesh->m_normalFormat = m_normalFormat;
+            mesh->m_pipelined = m_pipelined;
+
+            // All the data goes to the buffers of the copy at its first update.
+            for ( uint i = 0; i < MAX_MESH; ++i )
+            {
+                mesh->setDirty( MeshData( i ) );
+            }
+            for ( uint i = 0; i < MAX_VEC3; ++i )
+            {
+                mesh->setDirty( Vec3Data( i ) );
+            }
+            for ( uint i = 0; i < MAX_VEC4; ++i )
+            {
+                mesh->setDirty( Vec4Data( i ) );
+            }
+            return mesh;
+        }
+
         void Mesh::render()
         {
             if ( m_vao != 0 )
@@ -50,6 +138,32 @@ namespace Ra {
             }
         }
 
+        void Mesh::renderInstances( uint instanceVbo, uint first, uint count )
+        {
+            if ( m_vao != 0 )
+            {
+                GL_ASSERT( glBindVertexArray( m_vao ) );
+                GL_ASSERT( glBindBuffer( GL_ARRAY_BUFFER, instanceVbo ) );
+
+                // The columns of the two matrices of each instance. The attributes are disabled
+                // afterwards, as the VAO is also drawn without instances.
+                const GLsizei stride = 2 * sizeof( Core::Matrix4f );
+                for ( uint i = 0; i < 8; ++i )
+                {
+                    const std::size_t offset = std::size_t( first ) * stride + i * sizeof( Core::Vector4f );
+                    GL_ASSERT( glVertexAttribPointer( INSTANCE_ATTRIB + i, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offset ) );
+                    GL_ASSERT( glVertexAttribDivisor( INSTANCE_ATTRIB + i, 1 ) );
+                    GL_ASSERT( glEnableVertexAttribArray( INSTANCE_ATTRIB + i ) );
+                }
+                GL_ASSERT( glDrawElementsInstanced( static_cast<GLenum >(m_renderMode), m_numElements, GL_UNSIGNED_INT,
+                                                    (void*)0, count ) );
+                for ( uint i = 0; i < 8; ++i )
+                {
+                    GL_ASSERT( glDisableVertexAttribArray( INSTANCE_ATTRIB + i ) );
+                }
+            }
+        }
+
         void Mesh::loadGeometry(const Core::TriangleMesh& mesh)
         {
             m_mesh = mesh;
@@ -63,9 +177,8 @@ namespace Ra {
 
             for (uint i = 0; i < MAX_MESH; ++i)
             {
-                m_dataDirty[i] = true;
+                setDirty( MeshData( i ) );
             }
-            m_isDirty = true;
         }
 
         void Mesh::updateMeshGeometry(MeshData type, const Core::Vector3Array& data)
@@ -74,8 +187,116 @@ namespace Ra {
                 m_mesh.m_vertices = data;
             if(type == VERTEX_NORMAL)
                 m_mesh.m_normals = data;
-            m_dataDirty[static_cast<uint>(type)] = true;
-            m_isDirty = true;
+            setDirty( type );
+        }
+
+        Core::TriangleMesh& Mesh::getGeometryForUpdate( MeshData type )
+        {
+            std::lock_guard<std::mutex> lock( m_backMeshMutex );
+            if ( !m_backDirty[type] )
+            {
+                // Start from the current data, as the caller may only modify part of it.
+                // Without pipelining, the back buffer keeps the data before the update, to find
+                // the vertices which changed in swapBuffers().
+                updateBackBuffer( type );
+                m_backDirty[type] = true;
+                m_hasBackData = true;
+            }
+            return m_pipelined ? m_backMesh : m_mesh;
+        }
+
+        void Mesh::updateBackBuffer( MeshData type )
+        {
+            if ( type == INDEX )
+            {
+                if ( m_backOutdated[INDEX].exchange( false ) )
+                {
+                    m_backMesh.m_triangles = m_mesh.m_triangles;
+                }
+                return;
+            }
+
+            const Core::Vector3Array& front = type == VERTEX_POSITION ? m_mesh.m_vertices : m_mesh.m_normals;
+            Core::Vector3Array& back = type == VERTEX_POSITION ? m_backMesh.m_vertices : m_backMesh.m_normals;
+            Core::DirtyRanges& stale = m_backStaleRanges[type];
+            if ( m_backOutdated[type].exchange( false ) || stale.isAll() || back.size() != front.size() )
+            {
+                back = front;
+            }
+            else
+            {
+                // The buffers were swapped : the back one only misses the vertices modified since.
+                for ( const auto& r : stale.getRanges() )
+                {
+                    std::copy( front.begin() + r.m_begin, front.begin() + std::min<uint>( r.m_end, front.size() ),
+                               back.begin() + r.m_begin );
+                }
+            }
+            stale.clear();
+        }
+
+        void Mesh::swapBuffers()
+        {
+            if ( !m_hasBackData )
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock( m_backMeshMutex );
+            if ( m_backDirty[INDEX] )
+            {
+                if ( m_pipelined )
+                {
+                    std::swap( m_mesh.m_triangles, m_backMesh.m_triangles );
+                }
+                // The indices are sent entirely, and only if they changed.
+                Core::DirtyRanges changed;
+                if ( m_mesh.m_triangles.size() == m_backMesh.m_triangles.size() )
+                {
+                    changed.addDifferences( m_backMesh.m_triangles, m_mesh.m_triangles );
+                }
+                else
+                {
+                    changed.addAll();
+                }
+                if ( !changed.isEmpty() )
+                {
+                    setDirty( INDEX );
+                }
+            }
+            if ( m_backDirty[VERTEX_POSITION] )
+            {
+                swapVertexBuffers( VERTEX_POSITION, m_mesh.m_vertices, m_backMesh.m_vertices );
+            }
+            if ( m_backDirty[VERTEX_NORMAL] )
+            {
+                swapVertexBuffers( VERTEX_NORMAL, m_mesh.m_normals, m_backMesh.m_normals );
+            }
+            m_backDirty.fill( false );
+            m_hasBackData = false;
+        }
+
+        void Mesh::swapVertexBuffers( MeshData type, Core::Vector3Array& front, Core::Vector3Array& back )
+        {
+            if ( m_pipelined )
+            {
+                std::swap( front, back );
+            }
+            if ( front.size() != back.size() )
+            {
+                setDirty( type );
+                return;
+            }
+
+            // Deformations often move part of the vertices only (e.g. skinning with few bones
+            // moving) : the other ones are not sent again, nor copied to the back buffer.
+            Core::DirtyRanges& ranges = m_backStaleRanges[type];
+            ranges.clear();
+            ranges.addDifferences( back, front );
+            for ( const auto& r : ranges.getRanges() )
+            {
+                setDirty( type, r.m_begin, r.m_end );
+            }
         }
 
         void Mesh::loadGeometry(const Core::Vector3Array &vertices, const std::vector<uint> &indices)
@@ -106,16 +327,60 @@ namespace Ra {
             // Mark mesh as dirty.
             for (uint i = 0; i < MAX_MESH; ++i)
             {
-                m_dataDirty[i] = true;
+                setDirty( MeshData( i ) );
             }
-            m_isDirty = true;
 
         }
 
+        Core::MeshUtils::RayCastResult Mesh::castRay( const Core::Ray& ray ) const
+        {
+            std::lock_guard<std::mutex> lock( m_rayCastMutex );
+            // Flags are cleared before reading the geometry, so that an update made meanwhile
+            // is seen by the next query.
+            const bool trianglesDirty = m_rayCastTrianglesDirty.exchange( false );
+            const bool verticesDirty = m_rayCastVerticesDirty.exchange( false );
+
+            if ( m_mesh.m_triangles.empty() )
+            {
+                if ( trianglesDirty || verticesDirty || m_rayCastPoints.isEmpty() )
+                {
+                    m_rayCastBvh.clear();
+                    m_rayCastPoints.build( m_mesh.m_vertices );
+                }
+                return Core::MeshUtils::castRay( m_mesh, m_rayCastPoints, ray );
+            }
+
+            if ( trianglesDirty || m_rayCastBvh.isEmpty() )
+            {
+                m_rayCastPoints.clear();
+                m_rayCastBvh.build( m_mesh );
+            }
+            else if ( verticesDirty )
+            {
+                // Deformations (e.g. skinning) keep the triangles : refitting is enough.
+                m_rayCastBvh.refit( m_mesh );
+            }
+            return Core::MeshUtils::castRay( m_mesh, m_rayCastBvh, ray );
+        }
+
+        Core::Obb Mesh::getObb() const
+        {
+            std::lock_guard<std::mutex> lock( m_obbMutex );
+            const uint epoch = m_geometryEpoch;
+            if ( !m_hasObb || epoch != m_obbEpoch )
+            {
+                m_obb = m_mesh.m_vertices.empty() ? Core::Obb() : Core::PointCloud::pcaObb( m_mesh.m_vertices );
+                m_obbEpoch = epoch;
+                m_hasObb = true;
+            }
+            return m_obb;
+        }
+
         void Mesh::addData( const Vec3Data& type, const Core::Vector3Array& data )
         {
             m_v3Data[static_cast<uint>(type)] = data;
             m_dataDirty[MAX_MESH + static_cast<uint>(type)] = true;
+            m_dirtyRanges[MAX_MESH + static_cast<uint>(type)].addAll();
             m_isDirty = true;
         }
 
@@ -123,9 +388,19 @@ namespace Ra {
         {
             m_v4Data[static_cast<uint>(type)] = data;
             m_dataDirty[MAX_MESH + MAX_VEC3 + static_cast<uint>(type)] = true;
+            m_dirtyRanges[MAX_MESH + MAX_VEC3 + static_cast<uint>(type)].addAll();
             m_isDirty = true;
         }
 
+        void Mesh::setNormalFormat( NormalFormat format )
+        {
+            if ( format != m_normalFormat )
+            {
+                m_normalFormat = format;
+                setDirty( VERTEX_NORMAL );
+            }
+        }
+
         // Template parameter must be a Core::VectorNArray
         template< typename VecArray >
         void Mesh::sendGLData( const VecArray& arr, const uint vboIdx )
@@ -137,20 +412,12 @@ namespace Ra {
             GLenum type = GL_FLOAT;
 #endif
             constexpr GLuint size = VecArray::Vector::RowsAtCompileTime;
-            const GLboolean normalized  = GL_FALSE;
-            constexpr GLint64 ptr = 0;
+            const VertexFormat format = { size, type, GL_FALSE, sizeof( typename VecArray::Vector ) };
 
             // This vbo has not been created yet
             if ( m_vbos[vboIdx] == 0 && arr.size() > 0 )
             {
                 GL_ASSERT( glGenBuffers( 1, &m_vbos[vboIdx] ) );
-                GL_ASSERT( glBindBuffer( GL_ARRAY_BUFFER, m_vbos[vboIdx] ) );
-
-                // Use (vboIdx - 1) as attribute index because vbo 0 is actually ibo.
-                GL_ASSERT( glVertexAttribPointer( vboIdx - 1, size, type, normalized,
-                                                  sizeof( typename VecArray::Vector ), (GLvoid*)ptr ) );
-
-                GL_ASSERT( glEnableVertexAttribArray( vboIdx - 1 ) );
                 // Set dirty as true to send data, see below
                 m_dataDirty[vboIdx] = true;
             }
@@ -158,12 +425,56 @@ namespace Ra {
             if ( m_dataDirty[vboIdx] == true && m_vbos[vboIdx] != 0 && arr.size() > 0 )
             {
                 GL_ASSERT( glBindBuffer( GL_ARRAY_BUFFER, m_vbos[vboIdx] ) );
-                GL_ASSERT( glBufferData( GL_ARRAY_BUFFER, arr.size() * sizeof( typename VecArray::Vector ),
-                arr.data(), GL_DYNAMIC_DRAW ) );
+                // Use (vboIdx - 1) as attribute index because vbo 0 is actually ibo.
+                uploadVertexData( vboIdx - 1, format, arr.size(), m_vboSizes[vboIdx], m_dirtyRanges[vboIdx],
+                                  [&arr]( uint begin, uint ) { return arr.data() + begin; } );
                 m_dataDirty[vboIdx] = false;
             }
         }
 
+        void Mesh::sendNormalGLData()
+        {
+            if ( m_normalFormat == NORMAL_FLOAT )
+            {
+                sendGLData( m_mesh.m_normals, VERTEX_NORMAL );
+                return;
+            }
+
+            const auto& normals = m_mesh.m_normals;
+            if ( m_vbos[VERTEX_NORMAL] == 0 && normals.size() > 0 )
+            {
+                GL_ASSERT( glGenBuffers( 1, &m_vbos[VERTEX_NORMAL] ) );
+                m_dataDirty[VERTEX_NORMAL] = true;
+            }
+
+            if ( m_dataDirty[VERTEX_NORMAL] == true && m_vbos[VERTEX_NORMAL] != 0 && normals.size() > 0 )
+            {
+                GL_ASSERT( glBindBuffer( GL_ARRAY_BUFFER, m_vbos[VERTEX_NORMAL] ) );
+                // Only the sent vertices are packed. The shaders still read vec3 normals.
+                if ( m_normalFormat == NORMAL_HALF )
+                {
+                    const VertexFormat format = { 4, GL_HALF_FLOAT, GL_FALSE, 4 * sizeof( std::uint16_t ) };
+                    uploadVertexData( VERTEX_NORMAL - 1, format, normals.size(), m_vboSizes[VERTEX_NORMAL],
+                                      m_dirtyRanges[VERTEX_NORMAL], [&]( uint begin, uint end )
+                    {
+                        Core::Packing::packHalf( normals, begin, end, m_halfNormals );
+                        return m_halfNormals.data();
+                    } );
+                }
+                else
+                {
+                    const VertexFormat format = { 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof( std::uint32_t ) };
+                    uploadVertexData( VERTEX_NORMAL - 1, format, normals.size(), m_vboSizes[VERTEX_NORMAL],
+                                      m_dirtyRanges[VERTEX_NORMAL], [&]( uint begin, uint end )
+                    {
+                        Core::Packing::packSnorm1010102( normals, begin, end, m_packedNormals );
+                        return m_packedNormals.data();
+                    } );
+                }
+                m_dataDirty[VERTEX_NORMAL] = false;
+            }
+        }
+
         void Mesh::updateGL()
         {
             if ( m_isDirty )
@@ -203,11 +514,12 @@ namespace Ra {
                                                  m_mesh.m_triangles.data(), GL_DYNAMIC_DRAW ) );
                     }
                     m_dataDirty[INDEX] = false;
+                    m_dirtyRanges[INDEX].clear();
                 }
 
                 // Geometry data
                 sendGLData(m_mesh.m_vertices, VERTEX_POSITION);
-                sendGLData(m_mesh.m_normals,  VERTEX_NORMAL);
+                sendNormalGLData();
 
                 // Vec3 data
                 sendGLData(m_v3Data[VERTEX_TANGENT],   MAX_MESH + VERTEX_TANGENT);
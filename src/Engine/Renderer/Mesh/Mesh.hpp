@@ -6,9 +6,18 @@
 #include <vector>
 #include <array>
 #include <map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 
 #include <Core/Containers/VectorArray.hpp>
+#include <Core/Containers/DirtyRanges.hpp>
+#include <Core/Math/Obb.hpp>
 #include <Core/Mesh/TriangleMesh.hpp>
+#include <Core/Mesh/MeshUtils.hpp>
+#include <Core/TreeStructures/TriangleBVH.hpp>
+#include <Core/Geometry/PointCloud/PointHashGrid.hpp>
 
 
 
@@ -92,6 +101,17 @@ namespace Ra
             /// Total number of vertex attributes.
             constexpr static uint MAX_DATA = MAX_MESH + MAX_VEC3 + MAX_VEC4;
 
+            /// First of the 8 attributes of the instances (see renderInstances()).
+            constexpr static uint INSTANCE_ATTRIB = MAX_DATA - 1;
+
+            /// Formats of the normals in their VBO (see Core::Packing).
+            enum NormalFormat : uint
+            {
+                NORMAL_FLOAT = 0,   /// 3 scalars per normal.
+                NORMAL_HALF,        /// 4 half floats per normal (GL_HALF_FLOAT), the last one being 0.
+                NORMAL_PACKED,      /// Signed normalized 10:10:10:2 integers (GL_INT_2_10_10_10_REV).
+            };
+
         public:
             Mesh( const std::string& name, MeshRenderMode renderMode = RM_TRIANGLES );
             ~Mesh();
@@ -99,6 +119,14 @@ namespace Ra
             /// Returns the name of the mesh.
             inline const std::string& getName() const;
 
+            /// Returns a new mesh with the same name, render mode and data, which has its own
+            /// openGL buffers and is not shared. Used to modify one of the render objects sharing a mesh.
+            std::shared_ptr<Mesh> clone() const;
+
+            /// Returns true if the mesh was handed out by a MeshCache, so that several render
+            /// objects may draw it.
+            bool isShared() const { return m_shared; }
+
             /// GL_POINTS, GL_LINES, GL_TRIANGLES, GL_TRIANGLE_ADJACENCY, etc...
             inline void setRenderMode( MeshRenderMode mode );
             MeshRenderMode getRenderMode() const { return m_renderMode; }
@@ -107,6 +135,26 @@ namespace Ra
             inline const Core::TriangleMesh& getGeometry() const;
             inline Core::TriangleMesh& getGeometry();
 
+            /// Returns the geometry to be modified by the engine tasks. Only the data of the given
+            /// type is valid in the returned mesh.
+            /// When the mesh is pipelined (see setPipelined()) it is rendered while the tasks run,
+            /// so the modifications go to a back buffer which is handed over to the renderer by
+            /// swapBuffers(). Otherwise this is the geometry itself, and the back buffer keeps
+            /// the data from before the modifications.
+            /// This function is thread safe.
+            Core::TriangleMesh& getGeometryForUpdate( MeshData type );
+
+            /// Hands the data modified through getGeometryForUpdate() over to the renderer.
+            /// Only the vertices which differ from the previous ones are marked as dirty, so that
+            /// a deformation moving part of the mesh only sends these vertices to the GPU.
+            /// Called by the engine at the end of each frame.
+            void swapBuffers();
+
+            /// Toggles the back buffer of getGeometryForUpdate(). Set by the render object manager
+            /// for pipelined frames (see RadiumEngine::setPipelinedFrames()), between frames.
+            void setPipelined( bool on ) { m_pipelined = on; }
+            bool isPipelined() const { return m_pipelined; }
+
             /// Use the given geometry as base for a display mesh. Normals are optionnal.
             void loadGeometry( const Core::TriangleMesh& mesh);
 
@@ -125,8 +173,16 @@ namespace Ra
             inline Core::Vector3Array& getData( const Vec3Data& type );
             inline Core::Vector4Array& getData( const Vec4Data& type );
 
+            /// Returns a counter incremented each time the positions or the indices are marked as
+            /// dirty, so that the bounds computed from the geometry can be kept up to date.
+            uint getGeometryEpoch() const { return m_geometryEpoch; }
+
             /// Mark one of the data types as dirty, forcing an update of the openGL buffer.
+            /// Must be called after modifying the geometry outside of getGeometryForUpdate().
             inline void setDirty( const MeshData& type );
+            /// Mark the vertices [begin, end) of the positions or normals as dirty. Unless the number
+            /// of vertices changed, updateGL() only sends the dirty vertices to the openGL buffer.
+            inline void setDirty( const MeshData& type, uint begin, uint end );
             inline void setDirty( const Vec3Data& type );
             inline void setDirty( const Vec4Data& type );
 
@@ -137,7 +193,31 @@ namespace Ra
             /// Draw the mesh.
             void render();
 
+            /// Draws count instances of the mesh. Their model and normal matrices, as two
+            /// consecutive Core::Matrix4f per instance, are read from the openGL buffer
+            /// instanceVbo from the instance first, as the attributes INSTANCE_ATTRIB to
+            /// INSTANCE_ATTRIB + 7 (see Shaders/Instancing.glsl).
+            void renderInstances( uint instanceVbo, uint first, uint count );
+
+            /// Sets the format of the normals sent to the GPU. The packed formats take 8 or 4 bytes
+            /// per normal instead of 12, as the shaders read them as floats anyway.
+            void setNormalFormat( NormalFormat format );
+            NormalFormat getNormalFormat() const { return m_normalFormat; }
+
+            /// Casts a ray, given in the frame of the mesh, against its geometry. Same result as
+            /// Core::MeshUtils::castRay(), using a hierarchy of the triangles (or a kd-tree of the
+            /// points of a point cloud) built by the first query and kept up to date afterwards.
+            /// This function is thread safe.
+            Core::MeshUtils::RayCastResult castRay( const Core::Ray& ray ) const;
+
+            /// Returns a box bounding the vertices along their principal axes, which is usually
+            /// tighter than their AABB once transformed. It is computed by the first call after
+            /// the geometry changed (see getGeometryEpoch()). This function is thread safe.
+            Core::Obb getObb() const;
+
         private:
+            friend class MeshCache;
+
             Mesh(const Mesh& rhs) = delete;
             void operator=(const Mesh& rhs) = delete;
 
@@ -145,6 +225,19 @@ namespace Ra
             template < typename VecArray >
             void sendGLData( const VecArray& arr, const uint vboIdx );
 
+            /// Sends the normals to their VBO, in the format of m_normalFormat.
+            void sendNormalGLData();
+
+            /// Copies to the back buffer the data of type which changed since the buffers were
+            /// swapped, so that it holds the front data again.
+            /// Must be called with m_backMeshMutex locked.
+            void updateBackBuffer( MeshData type );
+
+            /// Swaps the vertex data of type written in the back buffer with the front one when
+            /// pipelined, and marks the vertices which differ as dirty. The back buffer keeps the
+            /// previous data, which is updated from these ranges by the next updateBackBuffer().
+            void swapVertexBuffers( MeshData type, Core::Vector3Array& front, Core::Vector3Array& back );
+
         private:
             std::string m_name;  /// Name of the mesh.
 
@@ -165,12 +258,43 @@ namespace Ra
 
             std::array<uint, MAX_DATA> m_vbos = {{ 0 }}; /// Indices of our openGL VBOs.
             std::array<bool, MAX_DATA> m_dataDirty = {{ false }}; /// Dirty bits of our vertex data.
+            std::array<Core::DirtyRanges, MAX_DATA> m_dirtyRanges; /// Dirty vertices of our vertex data.
+            std::array<uint, MAX_DATA> m_vboSizes = {{ 0 }}; /// Number of vertices in our VBOs.
+
+            NormalFormat m_normalFormat; /// Format of the normals in their VBO.
+            std::vector<std::uint16_t> m_halfNormals;   /// Normals packed as half floats for the VBO.
+            std::vector<std::uint32_t> m_packedNormals; /// Normals packed as 10:10:10:2 integers for the VBO.
 
             uint m_numElements; /// number of elements to draw. For triangles this is 3*numTriangles but not for lines.
             // (val) : this is a bit hacky.
 
             bool m_isDirty; /// General dirty bit of the mesh.
             // TODO (Val) this flag could just be replaced by an efficient "or" of the other flags.
+
+            bool m_pipelined; /// See setPipelined().
+            bool m_shared; /// See isShared().
+            /// Geometry written by the tasks in pipelined mode, else the geometry before they wrote it.
+            Core::TriangleMesh m_backMesh;
+            std::array<bool, MAX_MESH> m_backDirty = {{ false }}; /// Data written in m_backMesh.
+            /// Vertices of m_backMesh which differ from the front ones since the last swap.
+            std::array<Core::DirtyRanges, MAX_MESH> m_backStaleRanges;
+            /// Data of m_backMesh which must be copied again entirely, e.g. after a new geometry
+            /// was loaded (see setDirty()).
+            std::array<std::atomic<bool>, MAX_MESH> m_backOutdated;
+            std::atomic<bool> m_hasBackData; /// True if some data is waiting in m_backMesh.
+            std::atomic<uint> m_geometryEpoch; /// See getGeometryEpoch().
+            std::mutex m_backMeshMutex; /// Protects the back buffer from concurrent tasks.
+
+            mutable Core::TriangleBVH m_rayCastBvh;             /// Hierarchy of the triangles for castRay().
+            mutable Core::PointHashGrid m_rayCastPoints;        /// Grid of the vertices of a point cloud for castRay().
+            mutable std::atomic<bool> m_rayCastTrianglesDirty;  /// The ray cast structures must be built again.
+            mutable std::atomic<bool> m_rayCastVerticesDirty;   /// The ray cast structures must be updated.
+            mutable std::mutex m_rayCastMutex;                  /// Protects the ray cast structures.
+
+            mutable Core::Obb m_obb;        /// Cached result of getObb().
+            mutable uint m_obbEpoch;        /// Geometry epoch of m_obb.
+            mutable bool m_hasObb;          /// True once m_obb is computed.
+            mutable std::mutex m_obbMutex;  /// Protects the cached box.
         };
 
     } // namespace Engine
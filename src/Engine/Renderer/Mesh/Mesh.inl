@@ -37,9 +37,33 @@ namespace Engine {
         return m_v4Data[static_cast<uint>(type)];
     }
 
-    void Mesh::setDirty(const Mesh::MeshData &type) { m_dataDirty[type] = true; m_isDirty = true;}
-    void Mesh::setDirty(const Mesh::Vec3Data &type) { m_dataDirty[MAX_MESH + type] = true; m_isDirty = true;}
-    void Mesh::setDirty(const Mesh::Vec4Data &type) { m_dataDirty[MAX_MESH + MAX_VEC3 + type ] = true ; m_isDirty = true;}
+    void Mesh::setDirty(const Mesh::MeshData &type)
+    {
+        m_dirtyRanges[type].addAll();
+        // The data may have been replaced entirely, the back buffer must be copied again.
+        m_backOutdated[type] = true;
+        setDirty( type, 0, 0 );
+    }
+
+    void Mesh::setDirty(const Mesh::MeshData &type, uint begin, uint end)
+    {
+        m_dirtyRanges[type].add( begin, end );
+        m_dataDirty[type] = true;
+        m_isDirty = true;
+        // Ray queries refit their hierarchy when vertices move, and build it again for new triangles.
+        if ( type == INDEX )
+        {
+            m_rayCastTrianglesDirty = true;
+            ++m_geometryEpoch;
+        }
+        else if ( type == VERTEX_POSITION )
+        {
+            m_rayCastVerticesDirty = true;
+            ++m_geometryEpoch;
+        }
+    }
+    void Mesh::setDirty(const Mesh::Vec3Data &type) { m_dataDirty[MAX_MESH + type] = true; m_dirtyRanges[MAX_MESH + type].addAll(); m_isDirty = true;}
+    void Mesh::setDirty(const Mesh::Vec4Data &type) { m_dataDirty[MAX_MESH + MAX_VEC3 + type ] = true ; m_dirtyRanges[MAX_MESH + MAX_VEC3 + type].addAll(); m_isDirty = true;}
 
    }
 }
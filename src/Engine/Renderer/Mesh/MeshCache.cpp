@@ -0,0 +1,110 @@
+#include <Engine/Renderer/Mesh/MeshCache.hpp>
+
+#include <Core/File/MaterialData.hpp>
+#include <Core/Utils/ContentHash.hpp>
+#include <Engine/Renderer/Mesh/Mesh.hpp>
+#include <Engine/Renderer/Material/Material.hpp>
+#include <Engine/Renderer/Material/MaterialConverters.hpp>
+
+namespace Ra
+{
+    namespace Engine
+    {
+        std::shared_ptr<Mesh> MeshCache::share( const std::shared_ptr<Mesh>& mesh )
+        {
+            CORE_ASSERT( mesh != nullptr, "Null mesh." );
+            const std::uint64_t hash = getContentHash( *mesh );
+            auto range = m_meshes.equal_range( hash );
+            for ( auto it = range.first; it != range.second; )
+            {
+                std::shared_ptr<Mesh> cached = it->second.lock();
+                if ( cached == nullptr )
+                {
+                    // Mesh no longer used.
+                    it = m_meshes.erase( it );
+                }
+                else if ( cached == mesh || hasSameContent( *cached, *mesh ) )
+                {
+                    return cached;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            m_meshes.emplace( hash, mesh );
+            mesh->m_shared = true;
+            return mesh;
+        }
+
+        uint MeshCache::getMeshCount() const
+        {
+            uint count = 0;
+            for ( const auto& m : m_meshes )
+            {
+                count += m.second.expired() ? 0 : 1;
+            }
+            return count;
+        }
+
+        std::shared_ptr<Material> MeshCache::shareMaterial( const Asset::MaterialData& data )
+        {
+            auto it = m_materials.find( &data );
+            if ( it == m_materials.end() )
+            {
+                auto converter = EngineMaterialConverters::getMaterialConverter( data.getType() );
+                std::shared_ptr<Material> material( converter.first ? converter.second( &data ) : nullptr );
+                it = m_materials.emplace( &data, material ).first;
+            }
+            return it->second;
+        }
+
+        void MeshCache::clearMaterials()
+        {
+            m_materials.clear();
+        }
+
+        void MeshCache::clear()
+        {
+            m_meshes.clear();
+            m_materials.clear();
+        }
+
+        std::uint64_t MeshCache::getContentHash( const Mesh& mesh )
+        {
+            Core::ContentHash hash;
+            const uint renderMode = mesh.getRenderMode();
+            hash.add( &renderMode, sizeof( renderMode ) );
+            hash.add( mesh.getGeometry().m_vertices );
+            hash.add( mesh.getGeometry().m_normals );
+            hash.add( mesh.getGeometry().m_triangles );
+            for ( uint i = 0; i < Mesh::MAX_VEC3; ++i )
+            {
+                hash.add( mesh.getData( Mesh::Vec3Data( i ) ) );
+            }
+            for ( uint i = 0; i < Mesh::MAX_VEC4; ++i )
+            {
+                hash.add( mesh.getData( Mesh::Vec4Data( i ) ) );
+            }
+            return hash.get();
+        }
+
+        bool MeshCache::hasSameContent( const Mesh& a, const Mesh& b )
+        {
+            bool same = a.getRenderMode() == b.getRenderMode()
+                        && a.getGeometry().m_vertices == b.getGeometry().m_vertices
+                        && a.getGeometry().m_normals == b.getGeometry().m_normals
+                        && a.getGeometry().m_triangles == b.getGeometry().m_triangles;
+            for ( uint i = 0; i < Mesh::MAX_VEC3 && same; ++i )
+            {
+                same = a.getData( Mesh::Vec3Data( i ) ) == b.getData( Mesh::Vec3Data( i ) );
+            }
+            for ( uint i = 0; i < Mesh::MAX_VEC4 && same; ++i )
+            {
+                same = a.getData( Mesh::Vec4Data( i ) ) == b.getData( Mesh::Vec4Data( i ) );
+            }
+            return same;
+        }
+
+    } // namespace Engine
+} // namespace Ra
@@ -0,0 +1,63 @@
+#ifndef RADIUMENGINE_MESH_CACHE_HPP
+#define RADIUMENGINE_MESH_CACHE_HPP
+
+#include <Engine/RaEngine.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace Ra
+{
+    namespace Asset
+    {
+        class MaterialData;
+    }
+
+    namespace Engine
+    {
+        class Mesh;
+        class Material;
+
+        /// Meshes loaded from assets, so that the render objects displaying the same geometry
+        /// share one Mesh : its data is stored once on the CPU and on the GPU, and the renderer
+        /// draws the objects as instances. The meshes are found by a hash of their content and
+        /// compared on collisions. The cache does not keep its meshes alive. The meshes it hands
+        /// out are marked as shared (see Mesh::isShared()) : a render object must get its own
+        /// copy before modifying its mesh (see RenderObject::unshareMesh()).
+        class RA_ENGINE_API MeshCache
+        {
+        public:
+            /// Returns the mesh of the cache with the same render mode, geometry and vertex data
+            /// as mesh, or adds mesh to the cache and returns it. Meshes modified after being
+            /// shared (e.g. deformed) are only shared again by meshes with their new content.
+            std::shared_ptr<Mesh> share( const std::shared_ptr<Mesh>& mesh );
+
+            /// Returns the number of meshes of the cache which are still in use.
+            uint getMeshCount() const;
+
+            /// Returns the material converted from data, which is converted once for all the render
+            /// objects of an asset, so that they can also be drawn as instances. The materials are
+            /// found by the address of their data : clearMaterials() must be called once the asset
+            /// is loaded. Returns nullptr if data has no converter.
+            std::shared_ptr<Material> shareMaterial( const Asset::MaterialData& data );
+
+            /// Forgets the materials of the loaded asset.
+            void clearMaterials();
+
+            /// Empties the cache, without changing the meshes and materials already shared.
+            void clear();
+
+        private:
+            static std::uint64_t getContentHash( const Mesh& mesh );
+            static bool hasSameContent( const Mesh& a, const Mesh& b );
+
+        private:
+            std::unordered_multimap<std::uint64_t, std::weak_ptr<Mesh>> m_meshes;
+            std::unordered_map<const Asset::MaterialData*, std::shared_ptr<Material>> m_materials;
+        };
+
+    } // namespace Engine
+} // namespace Ra
+
+#endif // RADIUMENGINE_MESH_CACHE_HPP
@@ -24,9 +24,12 @@ namespace Ra {
     namespace Engine {
         RenderObject::RenderObject(const std::string &name, Component *comp,
                                    const RenderObjectType &type, int lifetime)
-        : IndexedObject(), m_localTransform(Core::Transform::Identity()), m_component(comp), m_name(name), m_type(type),
-        m_renderTechnique(nullptr), m_mesh(nullptr), m_lifetime(lifetime), m_visible(true), m_pickable(true),
-        m_xray(false), m_transparent(false), m_dirty(true), m_hasLifetime(lifetime > 0)
+        : IndexedObject(), m_localTransform(Core::Transform::Identity()), m_worldTransform(Core::Transform::Identity()),
+        m_pendingLocalTransform(Core::Transform::Identity()), m_hasPendingLocalTransform(false),
+        m_worldTransformEpoch(0), m_worldAabbChanged(false), m_normalMatrix(Core::Matrix4::Identity()),
+        m_component(comp), m_name(name), m_type(type),
+        m_renderTechnique(nullptr), m_mesh(nullptr), m_meshEpoch(0), m_lifetime(lifetime), m_visible(true), m_pickable(true),
+        m_xray(false), m_transparent(false), m_dirty(true), m_hasLifetime(lifetime > 0), m_pipelined(false)
         {
 
         }
@@ -191,9 +194,38 @@ namespace Ra {
         void RenderObject::setMesh(const std::shared_ptr<Mesh> &mesh)
         {
             m_mesh = mesh;
+            m_mesh->setPipelined( m_pipelined );
+            computeMeshAabb();
+            computeWorldTransform();
+        }
+
+        void RenderObject::computeMeshAabb()
+        {
+            // The epoch is read first, so that a later modification is seen by the next update.
+            m_meshEpoch = m_mesh->getGeometryEpoch();
             m_aabb = Core::MeshUtils::getAabb(m_mesh->getGeometry());
         }
         
+        void RenderObject::setPipelined( bool on )
+        {
+            m_pipelined = on;
+            if ( m_mesh )
+            {
+                m_mesh->setPipelined( on );
+            }
+        }
+
+        void RenderObject::unshareMesh()
+        {
+            if ( m_mesh->isShared() )
+            {
+                // Do not update while the mesh is replaced.
+                std::lock_guard<std::mutex> lock( m_updateMutex );
+                m_mesh = m_mesh->clone();
+                m_meshEpoch = m_mesh->getGeometryEpoch();
+            }
+        }
+
         std::shared_ptr<const Mesh> RenderObject::getMesh() const
         {
             return m_mesh;
@@ -204,26 +236,76 @@ namespace Ra {
             return m_mesh;
         }
         
-        Core::Transform RenderObject::getTransform() const
+        const Core::Transform& RenderObject::getTransform() const
         {
-            return m_component->getEntity()->getTransform() * m_localTransform;
+            return m_worldTransform;
         }
         
         Core::Matrix4 RenderObject::getTransformAsMatrix() const
         {
-            return getTransform().matrix();
+            return m_worldTransform.matrix();
+        }
+        
+        const Core::Aabb& RenderObject::getAabb() const
+        {
+            return m_worldAabb;
+        }
+        
+        bool RenderObject::updateWorldTransform()
+        {
+            const Entity* entity = m_component != nullptr ? m_component->getEntity() : nullptr;
+            // The mesh may have been deformed or loaded again (e.g. skinning).
+            const bool meshChanged = m_mesh != nullptr && m_mesh->getGeometryEpoch() != m_meshEpoch;
+            if (meshChanged)
+            {
+                computeMeshAabb();
+            }
+            bool localChanged = false;
+            {
+                std::lock_guard<std::mutex> lock( m_transformMutex );
+                if (m_hasPendingLocalTransform)
+                {
+                    m_localTransform = m_pendingLocalTransform;
+                    m_hasPendingLocalTransform = false;
+                    localChanged = true;
+                }
+            }
+            if (meshChanged || localChanged || m_worldTransformEpoch == 0 || entity == nullptr || entity->getTransformEpoch() != m_worldTransformEpoch)
+            {
+                computeWorldTransform();
+            }
+            const bool changed = m_worldAabbChanged;
+            m_worldAabbChanged = false;
+            return changed;
         }
         
-        Core::Aabb RenderObject::getAabb() const
+        void RenderObject::computeWorldTransform()
         {
-            Core::Aabb result;
+            const Entity* entity = m_component != nullptr ? m_component->getEntity() : nullptr;
+            if (entity != nullptr)
+            {
+                m_worldTransform = entity->getTransform() * m_localTransform;
+                m_worldTransformEpoch = entity->getTransformEpoch();
+            }
+            else
+            {
+                m_worldTransform = m_localTransform;
+                m_worldTransformEpoch = 0;
+            }
             
+            m_worldAabb.setEmpty();
             for (int i = 0; i < 8; ++i)
             {
-                result.extend(getTransform() * m_aabb.corner((Core::Aabb::CornerType) i));
+                m_worldAabb.extend(m_worldTransform * m_aabb.corner((Core::Aabb::CornerType) i));
             }
-            
-            return result;
+            m_worldAabbChanged = true;
+            // Computed here rather than on demand, as the draws are prepared in parallel.
+            m_normalMatrix = m_worldTransform.matrix().inverse().transpose();
+        }
+        
+        const Core::Matrix4& RenderObject::getNormalMatrix() const
+        {
+            return m_normalMatrix;
         }
         
         Core::Aabb RenderObject::getMeshAabb() const
@@ -233,22 +315,31 @@ namespace Ra {
         
         void RenderObject::setLocalTransform(const Core::Transform &transform)
         {
-            m_localTransform = transform;
+            if ( !m_pipelined )
+            {
+                m_localTransform = transform;
+                computeWorldTransform();
+                return;
+            }
+            std::lock_guard<std::mutex> lock( m_transformMutex );
+            m_pendingLocalTransform = transform;
+            m_hasPendingLocalTransform = true;
         }
         
         void RenderObject::setLocalTransform(const Core::Matrix4 &transform)
         {
-            m_localTransform = Core::Transform(transform);
+            setLocalTransform(Core::Transform(transform));
         }
         
-        const Core::Transform &RenderObject::getLocalTransform() const
+        Core::Transform RenderObject::getLocalTransform() const
         {
-            return m_localTransform;
+            std::lock_guard<std::mutex> lock( m_transformMutex );
+            return m_hasPendingLocalTransform ? m_pendingLocalTransform : m_localTransform;
         }
         
-        const Core::Matrix4 &RenderObject::getLocalTransformAsMatrix() const
+        Core::Matrix4 RenderObject::getLocalTransformAsMatrix() const
         {
-            return m_localTransform.matrix();
+            return getLocalTransform().matrix();
         }
         
         void RenderObject::hasBeenRenderedOnce()
@@ -282,24 +373,27 @@ namespace Ra {
                     return;
                 }
                 
-                Core::Matrix4 M = getTransformAsMatrix();
-                Core::Matrix4 N = M.inverse().transpose();
-                
                 // bind data
                 shader->bind();
                 shader->setUniform("transform.proj", rdata.projMatrix);
                 shader->setUniform("transform.view", rdata.viewMatrix);
-                shader->setUniform("transform.model", M);
-                shader->setUniform("transform.worldNormal", N);
                 lightParams.bind(shader);
                 
                 getRenderTechnique()->getMaterial()->bind(shader);
                 
                 // render
-                getMesh()->render();
+                renderMesh(shader);
             }
         }
         
+        void RenderObject::renderMesh(const ShaderProgram *shader)
+        {
+            shader->setUniform("transform.model", m_worldTransform.matrix());
+            shader->setUniform("transform.worldNormal", getNormalMatrix());
+            
+            getMesh()->render();
+        }
+        
     } // namespace Engine
 } // namespace Ra
 
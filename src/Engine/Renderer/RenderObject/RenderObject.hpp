@@ -105,6 +105,10 @@ namespace Ra
 
             void setLifetime(int lifetime);
 
+            /// Toggles the double buffering of the data modified by the frame tasks, for
+            /// pipelined frames (see RenderObjectManager::setPipelinedFrames()).
+            void setPipelined( bool on );
+
             bool isDirty() const;
 
             void setRenderTechnique( const std::shared_ptr<RenderTechnique>& technique );
@@ -115,16 +119,39 @@ namespace Ra
             std::shared_ptr<const Mesh> getMesh() const;
             const std::shared_ptr<Mesh>& getMesh();
 
-            Core::Transform getTransform() const;
+            /// Gives the render object its own copy of its mesh if the mesh comes from a MeshCache
+            /// (see Mesh::isShared()), so that modifying it only changes this object.
+            /// Replaces the mesh, so it must be called from the main thread, between frames
+            /// (e.g. when setting up the object or handling an event), before modifying the mesh.
+            void unshareMesh();
+
+            /// World transform and AABB, cached until the transform of the entity, the local
+            /// transform, the mesh or its geometry change (see updateWorldTransform()).
+            const Core::Transform& getTransform() const;
             Core::Matrix4 getTransformAsMatrix() const;
 
-            Core::Aabb getAabb() const;
+            const Core::Aabb& getAabb() const;
             Core::Aabb getMeshAabb() const;
 
+            /// Inverse transpose of the world transform, transforming the normals.
+            const Core::Matrix4& getNormalMatrix() const;
+
+            /// Updates the cached world transform and AABB if the transform of the entity or the
+            /// geometry of the mesh changed since they were computed. Called at the end of each
+            /// frame by the render object manager, once the entity transforms and the mesh
+            /// buffers are published.
+            /// Returns true if the world AABB changed since the previous call, here or
+            /// through setLocalTransform() or setMesh().
+            bool updateWorldTransform();
+
+            /// With pipelined frames (see setPipelined()), the local transform is only applied by
+            /// the next updateWorldTransform(), so that the frame tasks can move the object while
+            /// the renderer draws the previous frame. Otherwise the world transform and AABB are
+            /// updated at once. getLocalTransform() returns the last transform which was set.
             void setLocalTransform( const Core::Transform& transform );
             void setLocalTransform( const Core::Matrix4& transform );
-            const Core::Transform& getLocalTransform() const;
-            const Core::Matrix4& getLocalTransformAsMatrix() const;
+            Core::Transform getLocalTransform() const;
+            Core::Matrix4 getLocalTransformAsMatrix() const;
 
             /// Basically just decreases lifetime counter.
             /// If it goes to zero, then render object notifies the manager that it needs to be deleted.
@@ -134,9 +161,34 @@ namespace Ra
             
             //            virtual void render( const RenderParameters& lightParams, const RenderData& rdata, const ShaderProgram* altShader = nullptr );
             virtual void render( const RenderParameters& lightParams, const RenderData& rdata, RenderTechnique::PassName passname = RenderTechnique::LIGHTING_OPAQUE );
+
+            /// Sets the model matrices of the object and draws its mesh with a shader which is
+            /// already bound, with its view, light and material uniforms (see Renderer::renderDraws()).
+            void renderMesh( const ShaderProgram* shader );
             
+        private:
+            /// Computes the world transform and AABB from the current entity transform.
+            void computeWorldTransform();
+
+            /// Computes the AABB of the mesh from its current geometry.
+            void computeMeshAabb();
+
         private:
             Core::Transform m_localTransform;
+            /// Local transform set during the frame, applied by updateWorldTransform().
+            Core::Transform m_pendingLocalTransform;
+            bool m_hasPendingLocalTransform;
+            mutable std::mutex m_transformMutex;
+
+            Core::Transform m_worldTransform;
+            Core::Aabb m_worldAabb;
+            /// Epoch of the entity transform used for the world transform,
+            /// 0 if the render object was not attached to an entity yet.
+            uint m_worldTransformEpoch;
+            /// True when the world AABB was computed since the last updateWorldTransform().
+            bool m_worldAabbChanged;
+            /// Normal matrix, computed with the world transform.
+            Core::Matrix4 m_normalMatrix;
 
             Component* m_component;
             std::string m_name;
@@ -147,6 +199,8 @@ namespace Ra
 
             // No ptr ?
             Core::Aabb m_aabb;
+            /// Geometry epoch of the mesh when m_aabb was computed (see Mesh::getGeometryEpoch()).
+            uint m_meshEpoch;
 
             mutable std::mutex m_updateMutex;
 
@@ -158,6 +212,7 @@ namespace Ra
             bool m_transparent;
             bool m_dirty;
             bool m_hasLifetime;
+            bool m_pipelined;
         };
 
     } // namespace Engine
@@ -12,11 +12,14 @@
 
 #include <Engine/Managers/SignalManager/SignalManager.hpp>
 
+#include <algorithm>
+
 namespace Ra
 {
     namespace Engine
     {
         RenderObjectManager::RenderObjectManager()
+            : m_pipelinedFrames( false )
         {
         }
 
@@ -35,14 +38,23 @@ namespace Ra
             std::lock_guard<std::mutex> lock( m_doubleBufferMutex );
 
             std::shared_ptr<RenderObject> newRenderObject( renderObject );
+            newRenderObject->setPipelined( m_pipelinedFrames );
+            newRenderObject->updateWorldTransform();
             Core::Index index = m_renderObjects.insert( newRenderObject );
 
             newRenderObject->idx = index;
 
             auto type = renderObject->getType();
+            if ( type == RenderObjectType::Fancy )
+            {
+                m_sceneBvh.insertLeaf( newRenderObject );
+            }
 
             m_renderObjectByType[(int)type].insert( index );
 
+            m_sceneBounds.setAabb( index.getValue(), isBounded( *newRenderObject ) ? newRenderObject->getAabb()
+                                                                                   : Core::Aabb() );
+
             Engine::RadiumEngine::getInstance()->getSignalManager()->fireRenderObjectAdded(
                     ItemEntry( renderObject->getComponent()->getEntity(),
                                renderObject->getComponent(),
@@ -67,7 +79,12 @@ namespace Ra
             m_renderObjects.remove( index );
 
             auto type = renderObject->getType();
+            if ( type == RenderObjectType::Fancy )
+            {
+                m_sceneBvh.removeLeaf( renderObject );
+            }
             m_renderObjectByType[(int)type].erase( index );
+            m_sceneBounds.setAabb( index.getValue(), Core::Aabb() );
             renderObject.reset();
         }
 
@@ -116,14 +133,73 @@ namespace Ra
             m_renderObjects.remove( idx );
 
             auto type = ro->getType();
+            if ( type == RenderObjectType::Fancy )
+            {
+                m_sceneBvh.removeLeaf( ro );
+            }
 
             m_renderObjectByType[(int)type].erase( idx );
+            m_sceneBounds.setAabb( idx.getValue(), Core::Aabb() );
 
             ro->hasExpired();
 
             ro.reset();
         }
 
+        void RenderObjectManager::swapMeshBuffers()
+        {
+            std::lock_guard<std::mutex> lock( m_doubleBufferMutex );
+            for ( const auto& ro : m_renderObjects )
+            {
+                if ( ro->getMesh() )
+                {
+                    ro->getMesh()->swapBuffers();
+                }
+            }
+        }
+
+        void RenderObjectManager::setPipelinedFrames( bool on )
+        {
+            std::lock_guard<std::mutex> lock( m_doubleBufferMutex );
+            m_pipelinedFrames = on;
+            for ( const auto& ro : m_renderObjects )
+            {
+                ro->setPipelined( on );
+            }
+        }
+
+        void RenderObjectManager::updateWorldTransforms()
+        {
+            std::lock_guard<std::mutex> lock( m_doubleBufferMutex );
+            for ( const auto& ro : m_renderObjects )
+            {
+                const bool changed = ro->updateWorldTransform();
+                if ( changed && ro->getType() == RenderObjectType::Fancy )
+                {
+                    m_sceneBvh.updateLeaf( ro );
+                }
+                // Objects may also have been shown or hidden.
+                const bool bounded = isBounded( *ro );
+                if ( changed || bounded == m_sceneBounds.getAabb( ro->idx.getValue() ).isEmpty() )
+                {
+                    m_sceneBounds.setAabb( ro->idx.getValue(), bounded ? ro->getAabb() : Core::Aabb() );
+                }
+            }
+            // Builds the whole hierarchy after the first objects are added or when
+            // insertions degraded it.
+            m_sceneBvh.update();
+        }
+
+        void RenderObjectManager::getRenderObjectsInFrustum( const Core::Frustum& frustum,
+                                                             std::vector<std::shared_ptr<RenderObject>>& objectsOut,
+                                                             Core::CullingStats* stats )
+        {
+            std::lock_guard<std::mutex> lock( m_doubleBufferMutex );
+            // Render objects may have been added since the last update.
+            m_sceneBvh.update();
+            m_sceneBvh.cull( frustum, objectsOut, stats );
+        }
+
         uint RenderObjectManager::getNumFaces() const
         {
             uint result = 0;
@@ -150,30 +226,61 @@ namespace Ra
             return result;
         }
 
-        Core::Aabb RenderObjectManager::getSceneAabb() const
+        bool RenderObjectManager::isBounded( const RenderObject& renderObject )
         {
-            Core::Aabb aabb;
+            return renderObject.isVisible() && renderObject.getType() != RenderObjectType::UI;
+        }
 
-            auto ui = Engine::SystemEntity::uiCmp();
-            bool skipUi = m_renderObjects.size() != ui->m_renderObjects.size();
-            for ( auto ro: m_renderObjects)
+        Core::Aabb RenderObjectManager::getSceneAabb( bool exact ) const
+        {
+            std::lock_guard<std::mutex> lock( m_doubleBufferMutex );
+
+            // The UI objects are only bounded when there is nothing else to show.
+            const bool onlyUi = m_renderObjectByType[(int)RenderObjectType::UI].size() == m_renderObjects.size();
+            std::vector<std::shared_ptr<RenderObject>> objects;
+            for ( const auto& ro : m_renderObjects )
             {
-                if (ro->isVisible() && (!skipUi || ro->getComponent() != ui))
+                if ( ro->isVisible() && ( onlyUi || ro->getType() != RenderObjectType::UI ) )
                 {
-                    Core::Transform t = ro->getComponent()->getEntity()->getTransform();
-                    auto mesh = ro->getMesh();
-                    auto pos = mesh->getGeometry().m_vertices;
+                    objects.push_back( ro );
+                }
+            }
 
-                    for (auto& p : pos)
+            if ( !exact )
+            {
+                if ( !onlyUi )
+                {
+                    return m_sceneBounds.getUnion();
+                }
+                Core::Aabb aabb;
+                for ( const auto& ro : objects )
+                {
+                    aabb.extend( ro->getAabb() );
+                }
+                return aabb;
+            }
+
+            // Starting with the largest objects, the objects whose world AABB is already within
+            // the bounds of the others cannot extend them.
+            std::sort( objects.begin(), objects.end(),
+                       []( const std::shared_ptr<RenderObject>& a, const std::shared_ptr<RenderObject>& b )
+                       {
+                           return a->getAabb().sizes().squaredNorm() > b->getAabb().sizes().squaredNorm();
+                       } );
+            Core::Aabb aabb;
+            for ( const auto& ro : objects )
+            {
+                if ( !ro->getAabb().isEmpty() && !aabb.contains( ro->getAabb() ) )
+                {
+                    // The corners of the cached oriented box of the mesh, instead of its vertices.
+                    const Core::Obb obb = ro->getMesh()->getObb();
+                    if ( !obb.m_aabb.isEmpty() )
                     {
-                        p = t * ro->getLocalTransform() * p;
+                        for ( int i = 0; i < 8; ++i )
+                        {
+                            aabb.extend( ro->getTransform() * obb.worldCorner( i ) );
+                        }
                     }
-
-                    const Ra::Core::Vector3 bmin = pos.getMap().rowwise().minCoeff().head<3>();
-                    const Ra::Core::Vector3 bmax = pos.getMap().rowwise().maxCoeff().head<3>();
-
-                    aabb.extend(bmin);
-                    aabb.extend(bmax);
                 }
             }
             return aabb;
@@ -14,6 +14,7 @@
 #include <Core/Index/Index.hpp>
 #include <Core/Index/IndexMap.hpp>
 #include <Core/TreeStructures/BVH.hpp>
+#include <Core/TreeStructures/AabbUnion.hpp>
 #include <Core/Math/Frustum.hpp>
 
 #include <Engine/Renderer/RenderObject/RenderObjectTypes.hpp>
@@ -60,15 +61,51 @@ namespace Ra
             /// Return the total number of vertices drawn
             uint getNumVertices() const;
 
-            /// Return the AABB of all visible render objects
-            Core::Aabb getSceneAabb() const;
+            /// Return the AABB of all visible render objects, ignoring the UI objects unless there
+            /// are only UI objects. The union of the cached world AABBs of the objects is returned,
+            /// which is updated with the objects that changed since the last call. If exact is true,
+            /// the tighter bounds of the transformed oriented boxes of the meshes are computed
+            /// (see Mesh::getObb()), for the objects not already within the bounds of the others.
+            Core::Aabb getSceneAabb( bool exact = false ) const;
+
+            /// Hands the mesh data modified by the tasks over to the renderer (see Mesh::swapBuffers()).
+            void swapMeshBuffers();
+
+            /// Toggles the double buffering of the render objects and of their meshes, for the
+            /// current and future objects (see RadiumEngine::setPipelinedFrames()).
+            void setPipelinedFrames( bool on );
+
+            /// Updates the cached world transforms of the render objects whose entity moved
+            /// (see RenderObject::updateWorldTransform()), and refits the scene hierarchy
+            /// around them. Called once the entity transforms of the frame are published.
+            void updateWorldTransforms();
+
+            /// Appends the fancy render objects whose world AABB is not fully outside the frustum.
+            /// The counters of the query are written in stats if it is not null.
+            void getRenderObjectsInFrustum( const Core::Frustum& frustum,
+                                            std::vector<std::shared_ptr<RenderObject>>& objectsOut,
+                                            Core::CullingStats* stats = nullptr );
+
+        private:
+            /// Returns true if the render object contributes to the scene AABB.
+            static bool isBounded( const RenderObject& renderObject );
 
         private:
             Core::IndexMap<std::shared_ptr<RenderObject>> m_renderObjects;
 
+            /// Hierarchy of the world AABBs of the fancy render objects. Debug and UI objects
+            /// are short-lived or drawn in screen space, so they are not culled.
+            Core::BVH<RenderObject> m_sceneBvh;
+
+            /// World AABBs of the bounded render objects, by index.
+            mutable Core::AabbUnion m_sceneBounds;
+
             std::array<std::set<Core::Index>, (int)RenderObjectType::Count> m_renderObjectByType;
 
             mutable std::mutex m_doubleBufferMutex;
+
+            /// See setPipelinedFrames().
+            bool m_pipelinedFrames;
         };
 
     } // namespace Engine
@@ -35,11 +35,13 @@ namespace Ra {
             m_files.push_back(globjects::File::create("Shaders/Structs.glsl"));
             m_files.push_back(globjects::File::create("Shaders/Tonemap.glsl"));
             m_files.push_back(globjects::File::create("Shaders/LightingFunctions.glsl"));
+            m_files.push_back(globjects::File::create("Shaders/Instancing.glsl"));
             
             m_namedStrings.push_back(globjects::NamedString::create("/Helpers.glsl", m_files[0].get()));
             m_namedStrings.push_back(globjects::NamedString::create("/Structs.glsl", m_files[1].get()));
             m_namedStrings.push_back(globjects::NamedString::create("/Tonemap.glsl", m_files[2].get()));
             m_namedStrings.push_back(globjects::NamedString::create("/LightingFunctions.glsl", m_files[3].get()));
+            m_namedStrings.push_back(globjects::NamedString::create("/Instancing.glsl", m_files[4].get()));
             
             m_defaultShaderProgram = addShaderProgram("Default Program", m_defaultVsName, m_defaultFsName);
             
@@ -1,13 +1,16 @@
 #include <Engine/Renderer/Renderer.hpp>
 
 #include <globjects/Framebuffer.h>
+#include <globjects/Program.h>
 
+#include <algorithm>
 #include <iostream>
 
 #include <Core/Log/Log.hpp>
 #include <Core/Math/ColorPresets.hpp>
 #include <Core/Mesh/MeshUtils.hpp>
 #include <Core/Mesh/MeshPrimitives.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
 
 #include <Engine/RadiumEngine.hpp>
 #include <Engine/Renderer/OpenGL/OpenGL.hpp>
@@ -41,6 +44,9 @@ namespace Ra {
                 GL_COLOR_ATTACHMENT6,
                 GL_COLOR_ATTACHMENT7
             };
+
+            // Number of render objects whose matrices are prepared by the same thread.
+            constexpr uint PrepareGrainSize = 64;
         }
 
         Renderer::Renderer( )
@@ -50,9 +56,13 @@ namespace Ra {
             , m_displayedTexture( nullptr )
             , m_renderQueuesUpToDate( false )
             , m_quadMesh( nullptr )
+            , m_instanceVbo( 0 )
             , m_drawDebug( true )
             , m_wireframe( false )
             , m_postProcessEnabled( true )
+            , m_frustumCulling( true )
+            , m_cullingFrustumFrozen( false )
+            , m_cullingViewProj( Core::Matrix4::Identity() )
             , m_brushRadius( 0 )
         {
             GL_CHECK_ERROR;
@@ -60,6 +70,10 @@ namespace Ra {
 
         Renderer::~Renderer()
         {
+            if ( m_instanceVbo != 0 )
+            {
+                glDeleteBuffers( 1, &m_instanceVbo );
+            }
             ShaderProgramManager::destroyInstance();
         }
 
@@ -223,48 +237,214 @@ namespace Ra {
             m_uiRenderObjects.clear();
             m_xrayRenderObjects.clear();
 
-            m_roMgr->getRenderObjectsByType( renderData, m_fancyRenderObjects, RenderObjectType::Fancy );
+            m_timerData.cullingStart = Core::Timer::Clock::now();
+            m_timerData.culling = Core::CullingStats();
+            if ( m_frustumCulling )
+            {
+                // Fancy objects are fetched from the scene hierarchy, skipping
+                // whole subtrees outside of the camera frustum. All the passes draw from
+                // the camera, so this single query feeds all of them : the xray objects are
+                // split below, and the transparent ones by the renderers (updateStepInternal()).
+                if ( !m_cullingFrustumFrozen )
+                {
+                    m_cullingViewProj = renderData.projMatrix * renderData.viewMatrix;
+                }
+                m_roMgr->getRenderObjectsInFrustum( Core::Frustum( m_cullingViewProj ),
+                                                    m_fancyRenderObjects, &m_timerData.culling );
+            }
+            else
+            {
+                m_roMgr->getRenderObjectsByType( renderData, m_fancyRenderObjects, RenderObjectType::Fancy );
+            }
+            m_timerData.cullingEnd = Core::Timer::Clock::now();
+
             m_roMgr->getRenderObjectsByType( renderData, m_debugRenderObjects, RenderObjectType::Debug );
             m_roMgr->getRenderObjectsByType( renderData, m_uiRenderObjects,    RenderObjectType::UI );
 
-            for ( auto it = m_fancyRenderObjects.begin(); it != m_fancyRenderObjects.end(); )
+            extractXRay( m_fancyRenderObjects );
+            extractXRay( m_debugRenderObjects );
+            extractXRay( m_uiRenderObjects );
+        }
+
+        void Renderer::extractXRay( std::vector<RenderObjectPtr>& renderQueue )
+        {
+            // Moves the xray objects in a single pass instead of erasing them one by one.
+            auto end = std::remove_if( renderQueue.begin(), renderQueue.end(),
+                                       [this]( const RenderObjectPtr& ro )
+                                       {
+                                           if ( ro->isXRay() )
+                                           {
+                                               m_xrayRenderObjects.push_back( ro );
+                                               return true;
+                                           }
+                                           return false;
+                                       } );
+            renderQueue.erase( end, renderQueue.end() );
+        }
+
+        void Renderer::clearDraws()
+        {
+            m_drawQueue.clear();
+            m_drawItems.clear();
+            m_drawObjects.clear();
+            m_drawObjectIds.clear();
+            m_drawShaderIds.clear();
+            m_drawMaterialIds.clear();
+            m_drawShaderInstancing.clear();
+            m_drawMeshIds.clear();
+        }
+
+        void Renderer::addDraws( const RenderData& renderData, const std::vector<RenderObjectPtr>& renderObjects,
+                                 RenderTechnique::PassName pass )
+        {
+            const Core::Matrix4 viewProj = renderData.projMatrix * renderData.viewMatrix;
+            for ( const auto& ro : renderObjects )
             {
-                if ( (*it)->isXRay() )
+                const ShaderProgram* shader = ro->isVisible() ? ro->getRenderTechnique()->getShader( pass ) : nullptr;
+                if ( shader == nullptr )
                 {
-                    m_xrayRenderObjects.push_back( *it );
-                    it = m_fancyRenderObjects.erase( it );
+                    continue;
                 }
-                else
+                const Material* material = ro->getRenderTechnique()->getMaterial().get();
+                const uint shaderId = m_drawShaderIds.emplace( shader, uint( m_drawShaderIds.size() ) ).first->second;
+                const uint materialId = m_drawMaterialIds.emplace( material, uint( m_drawMaterialIds.size() ) ).first->second;
+
+                // The shaders which handle instances declare their matrices as attributes.
+                auto instancing = m_drawShaderInstancing.find( shader );
+                if ( instancing == m_drawShaderInstancing.end() )
                 {
-                    ++it;
+                    const bool hasInstances = shader->getProgramObject()->getAttributeLocation( "in_instanceModel" ) >= 0;
+                    instancing = m_drawShaderInstancing.emplace( shader, hasInstances ).first;
                 }
-            }
+                const uint geometry = instancing->second
+                                      ? m_drawMeshIds.emplace( ro->getMesh().get(), uint( m_drawMeshIds.size() ) ).first->second
+                                      : Core::DrawQueue::NoGeometry;
 
-            for ( auto it = m_debugRenderObjects.begin(); it != m_debugRenderObjects.end(); )
-            {
-                if ( (*it)->isXRay() )
+                // Depth of the origin of the object, in [0, 1] when it is in front of the camera.
+                const Core::Vector4 p = viewProj * ro->getTransform().translation().homogeneous();
+                const Scalar depth = p.w() > 0 ? Scalar( 0.5 ) * p.z() / p.w() + Scalar( 0.5 ) : Scalar( 0 );
+
+                const uint object = m_drawObjectIds.emplace( ro.get(), uint( m_drawObjects.size() ) ).first->second;
+                if ( object == m_drawObjects.size() )
                 {
-                    m_xrayRenderObjects.push_back( *it );
-                    it = m_debugRenderObjects.erase( it );
+                    m_drawObjects.push_back( ro.get() );
                 }
-                else
+
+                m_drawQueue.add( uint( m_drawItems.size() ), uint( pass ), shaderId, materialId, depth, geometry );
+                m_drawItems.emplace_back( object, shader );
+            }
+        }
+
+        void Renderer::prepareDraws( const RenderData& renderData )
+        {
+            m_drawQueue.sort();
+
+            // Each render object is prepared once, the normal matrices of the objects which did
+            // not move being cached by the objects.
+            const uint numObjects = m_drawObjects.size();
+            m_drawModelMatrices.resize( numObjects );
+            m_drawNormalMatrices.resize( numObjects );
+            m_drawMvpMatrices.resize( numObjects );
+            const Core::Matrix4 viewProj = renderData.projMatrix * renderData.viewMatrix;
+            Core::parallelFor( 0, numObjects, [&]( uint i )
+            {
+                const RenderObject* ro = m_drawObjects[i];
+                m_drawModelMatrices[i] = ro->getTransform().matrix();
+                m_drawNormalMatrices[i] = ro->getNormalMatrix();
+                m_drawMvpMatrices[i] = viewProj * m_drawModelMatrices[i];
+            }, PrepareGrainSize );
+
+            // The instances of each batch are consecutive in m_instanceMatrices, which is sent at
+            // once for all the passes.
+            const auto& draws = m_drawQueue.getDraws();
+            m_drawFirstInstances.resize( draws.size() );
+            uint numInstances = 0;
+            for ( uint i = 0; i < draws.size(); i += std::max( draws[i].m_instances, 1u ) )
+            {
+                m_drawFirstInstances[i] = numInstances;
+                numInstances += draws[i].m_instances > 1 ? draws[i].m_instances : 0;
+            }
+            if ( numInstances == 0 )
+            {
+                return;
+            }
+            m_instanceMatrices.resize( 2 * numInstances );
+            Core::parallelFor( 0, uint( draws.size() ), [&]( uint i )
+            {
+                if ( draws[i].m_instances > 1 )
                 {
-                    ++it;
+                    for ( uint j = 0; j < draws[i].m_instances; ++j )
+                    {
+                        const uint object = m_drawItems[draws[i + j].m_object].first;
+                        const uint instance = m_drawFirstInstances[i] + j;
+                        m_instanceMatrices[2 * instance] = m_drawModelMatrices[object].cast<float>();
+                        m_instanceMatrices[2 * instance + 1] = m_drawNormalMatrices[object].cast<float>();
+                    }
                 }
+            }, PrepareGrainSize );
+
+            if ( m_instanceVbo == 0 )
+            {
+                GL_ASSERT( glGenBuffers( 1, &m_instanceVbo ) );
             }
+            GL_ASSERT( glBindBuffer( GL_ARRAY_BUFFER, m_instanceVbo ) );
+            GL_ASSERT( glBufferData( GL_ARRAY_BUFFER, m_instanceMatrices.size() * sizeof( Core::Matrix4f ),
+                                     m_instanceMatrices.data(), GL_STREAM_DRAW ) );
+            GL_ASSERT( glBindBuffer( GL_ARRAY_BUFFER, 0 ) );
+        }
 
-            for ( auto it = m_uiRenderObjects.begin(); it != m_uiRenderObjects.end(); )
+        void Renderer::renderDraws( const RenderParameters& lightParams, const RenderData& renderData,
+                                    RenderTechnique::PassName pass )
+        {
+            uint begin, end;
+            m_drawQueue.getPassRange( uint( pass ), begin, end );
+            const auto& draws = m_drawQueue.getDraws();
+            const ShaderProgram* shader = nullptr;
+            bool instanced = false;
+            for ( uint i = begin; i < end; i += draws[i].m_instances )
             {
-                if ( (*it)->isXRay() )
+                const uint object = m_drawItems[draws[i].m_object].first;
+                RenderObject* ro = m_drawObjects[object];
+                // The first draw of a pass always binds its shader.
+                if ( draws[i].m_bindShader )
+                {
+                    if ( instanced )
+                    {
+                        shader->setUniform( "transform.instanced", 0 );
+                        instanced = false;
+                    }
+                    shader = m_drawItems[draws[i].m_object].second;
+                    shader->bind();
+                    shader->setUniform( "transform.proj", renderData.projMatrix );
+                    shader->setUniform( "transform.view", renderData.viewMatrix );
+                    lightParams.bind( shader );
+                }
+                if ( draws[i].m_bindMaterial )
                 {
-                    m_xrayRenderObjects.push_back( *it );
-                    it = m_uiRenderObjects.erase( it );
+                    ro->getRenderTechnique()->getMaterial()->bind( shader );
+                }
+                if ( instanced != ( draws[i].m_instances > 1 ) )
+                {
+                    instanced = !instanced;
+                    shader->setUniform( "transform.instanced", instanced ? 1 : 0 );
+                }
+                if ( instanced )
+                {
+                    ro->getMesh()->renderInstances( m_instanceVbo, m_drawFirstInstances[i], draws[i].m_instances );
                 }
                 else
                 {
-                    ++it;
+                    shader->setUniform( "transform.model", m_drawModelMatrices[object] );
+                    shader->setUniform( "transform.worldNormal", m_drawNormalMatrices[object] );
+                    shader->setUniform( "transform.mvp", m_drawMvpMatrices[object] );
+                    ro->getMesh()->render();
                 }
             }
+            // Other renderings of the objects with the shader do not use the instances.
+            if ( instanced )
+            {
+                shader->setUniform( "transform.instanced", 0 );
+            }
         }
 
         // subroutine to Renderer::splitRenderQueuesForPicking()
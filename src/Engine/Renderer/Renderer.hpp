@@ -8,11 +8,19 @@
 #include <mutex>
 #include <memory>
 #include <chrono>
+#include <unordered_map>
+#include <utility>
 
 #include <Core/Math/LinearAlgebra.hpp>
 #include <Core/Time/Timer.hpp>
 #include <Core/Event/EventEnums.hpp>
 #include <Core/File/FileData.hpp>
+#include <Core/Math/Frustum.hpp>
+#include <Core/TreeStructures/BVH.hpp>
+#include <Core/Containers/DrawQueue.hpp>
+#include <Core/Containers/AlignedStdVector.hpp>
+
+#include <Engine/Renderer/RenderTechnique/RenderTechnique.hpp>
 
 #include <Engine/Culling/cullingfilter.hpp>
 
@@ -32,7 +40,9 @@ namespace Ra
         class Camera;
         class RenderObject;
         class Light;
+        class Material;
         class Mesh;
+        class RenderParameters;
         class ShaderProgram;
         class ShaderProgramManager;
         class Texture;
@@ -63,14 +73,21 @@ namespace Ra
             typedef std::shared_ptr<RenderObject> RenderObjectPtr;
 
         public:
+            RA_CORE_ALIGNED_NEW
+
             struct TimerData
             {
                 Core::Timer::TimePoint renderStart;
                 Core::Timer::TimePoint updateEnd;
+                Core::Timer::TimePoint cullingStart;
+                Core::Timer::TimePoint cullingEnd;
                 Core::Timer::TimePoint feedRenderQueuesEnd;
                 Core::Timer::TimePoint mainRenderEnd;
                 Core::Timer::TimePoint postProcessEnd;
                 Core::Timer::TimePoint renderEnd;
+
+                /// Counters of the frustum culling of the fancy render objects.
+                Core::CullingStats culling;
             };
 
             enum PickingMode
@@ -143,6 +160,18 @@ namespace Ra
                 m_postProcessEnabled = enabled;
             }
 
+            /// Only draws the fancy render objects which intersect the camera frustum (enabled by default).
+            inline void enableFrustumCulling(bool enabled)
+            {
+                m_frustumCulling = enabled;
+            }
+
+            /// Keeps culling against the current frustum while the camera moves, to inspect culling.
+            inline void freezeCullingFrustum(bool frozen)
+            {
+                m_cullingFrustumFrozen = frozen;
+            }
+
             /**
              * @brief Tell the renderer it needs to render.
              * This method does the following steps :
@@ -297,14 +326,47 @@ namespace Ra
              */
             virtual void uiInternal( const RenderData& renderData ) = 0; // idem ?
 
+            /**
+             * @brief Clears the draws of m_drawQueue.
+             */
+            void clearDraws();
+
+            /**
+             * @brief Adds to m_drawQueue the draws of a pass of the visible render objects which
+             * have a shader for it. Once m_drawQueue is sorted, they are ordered by shader, material,
+             * and then front to back, the objects sharing their mesh being batched when their
+             * shader reads the matrices of the instances (see Shaders/Instancing.glsl).
+             */
+            void addDraws( const RenderData& renderData, const std::vector<RenderObjectPtr>& renderObjects,
+                           RenderTechnique::PassName pass );
+
+            /**
+             * @brief Sorts the draws, and computes in parallel the model, normal and
+             * model-view-projection matrices of their render objects, once for all the passes.
+             * The matrices of the batched draws are sent to m_instanceVbo.
+             */
+            void prepareDraws( const RenderData& renderData );
+
+            /**
+             * @brief Renders the sorted draws of a pass, only binding the shaders, their view and
+             * light uniforms, and the materials when they change from a draw to the next. Each
+             * batch of objects sharing a mesh is a single instanced draw call.
+             */
+            void renderDraws( const RenderParameters& lightParams, const RenderData& renderData,
+                              RenderTechnique::PassName pass );
+
         private:
 
             // 0.
             void saveExternalFBOInternal();
 
-            // 1.
+            // 1. Fills the queues of the passes, with the fancy objects in the camera frustum only
+            // if frustum culling is enabled.
             void feedRenderQueuesInternal(const RenderData &renderData);
 
+            // Moves the xray render objects of the queue to m_xrayRenderObjects
+            void extractXRay(std::vector<RenderObjectPtr>& renderQueue);
+
             // 2.0
             void updateRenderObjectsInternal( const RenderData& renderData);
 
@@ -360,6 +422,27 @@ namespace Ra
             std::array<std::vector<RenderObjectPtr>,3> m_uiRenderObjectsPicking;
             std::array<const ShaderProgram*,3>               m_pickingShaders;
 
+            // Draws of the frame, sorted to limit the state changes (see addDraws())
+            Core::DrawQueue m_drawQueue;
+            // Index in m_drawObjects and shader of each draw of m_drawQueue
+            std::vector<std::pair<uint, const ShaderProgram*>> m_drawItems;
+            // Render objects of the draws, and their matrices computed by prepareDraws()
+            std::vector<RenderObject*> m_drawObjects;
+            std::unordered_map<const RenderObject*, uint> m_drawObjectIds;
+            Core::AlignedStdVector<Core::Matrix4> m_drawModelMatrices;
+            Core::AlignedStdVector<Core::Matrix4> m_drawNormalMatrices;
+            Core::AlignedStdVector<Core::Matrix4> m_drawMvpMatrices;
+            // Indices of the shaders and materials in the sort keys of the draws
+            std::unordered_map<const ShaderProgram*, uint> m_drawShaderIds;
+            std::unordered_map<const Material*, uint> m_drawMaterialIds;
+            // Geometries of the draws, for the shaders which handle instances
+            std::unordered_map<const ShaderProgram*, bool> m_drawShaderInstancing;
+            std::unordered_map<const Mesh*, uint> m_drawMeshIds;
+            // Model and normal matrices of the batched draws, and first instance of each batch
+            Core::AlignedStdVector<Core::Matrix4f> m_instanceMatrices;
+            std::vector<uint> m_drawFirstInstances;
+            uint m_instanceVbo;
+
             // Simple quad mesh, used to render the final image
             std::unique_ptr<Mesh> m_quadMesh;
 
@@ -367,6 +450,10 @@ namespace Ra
             bool m_wireframe;           // Are we rendering in "real" wireframe mode
             bool m_postProcessEnabled;  // Should we do post processing ?
 
+            bool m_frustumCulling;       // Should we cull fancy objects outside the frustum ?
+            bool m_cullingFrustumFrozen; // Should we keep the frustum of a previous frame ?
+            Core::Matrix4 m_cullingViewProj; // View-projection matrix of the culling frustum.
+
         private:
             // Qt has the nice idea to bind an fbo before giving you the opengl context,
             // this flag is used to save it (and render the final screen on it)
@@ -2,8 +2,6 @@
 
 #include <Engine/Renderer/Renderers/ForwardRenderer.hpp>
 
-#include <iostream>
-
 #include <Core/Log/Log.hpp>
 #include <Core/Math/ColorPresets.hpp>
 #include <Core/Containers/Algorithm.hpp>
@@ -58,8 +56,6 @@ namespace Ra
         CullingRenderer::CullingRenderer()
             : ForwardRenderer()
         {
-            m_cullingEnabled = true;
-            m_cullingFixed = false;
         }
 
         CullingRenderer::~CullingRenderer()
@@ -97,35 +93,9 @@ namespace Ra
 
             GL_ASSERT(glPointSize(3.));
 
-            if (m_cullingEnabled)
-            {
-                // Updates used camera in culling filter
-                if (!m_cullingFixed)
-                    m_cullingFilter.setFustrum(renderData);
-
-                std::cout << "Number of objects before culling : " << m_fancyRenderObjects.size() << std::endl;
-
-                std::vector<RenderObjectPtr> filtered;
-                for (const auto &ro : m_fancyRenderObjects)
-                {
-                    if (m_cullingFilter.intersectsFustrum(ro->getAabb()))
-                    {
-                        filtered.push_back(ro);
-                    }
-                }
-                m_fancyRenderObjects = filtered;
-                std::cout << "Number of objects after culling : " << m_fancyRenderObjects.size() << std::endl;
-            }
-
             // Set in RenderParam the configuration about ambiant lighting (instead of hard constant direclty in shaders)
             RenderParameters params;
-            for (const auto &ro : m_fancyRenderObjects)
-            {
-             //   auto bb = Ra::Engine::DrawPrimitives::Primitive(Ra::Engine::SystemEntity::dbgCmp(), Ra::Engine::DrawPrimitives::AABB(ro->getAabb(), Core::Colors::Magenta()));
-             //   bb->setLifetime(1);
-             //   Ra::Engine::SystemEntity::dbgCmp()->addRenderObject(bb);
-                ro->render(params, renderData, RenderTechnique::Z_PREPASS);
-            }
+            renderDraws(params, renderData, RenderTechnique::Z_PREPASS);
 
             // Light pass
             GL_ASSERT(glDepthFunc(GL_LEQUAL));
@@ -143,10 +113,7 @@ namespace Ra
                     RenderParameters params;
                     l->getRenderParameters(params);
 
-                    for (const auto &ro : m_fancyRenderObjects)
-                    {
-                        ro->render(params, renderData, RenderTechnique::LIGHTING_OPAQUE);
-                    }
+                    renderDraws(params, renderData, RenderTechnique::LIGHTING_OPAQUE);
                 }
             }
             else
@@ -157,10 +124,7 @@ namespace Ra
                 RenderParameters params;
                 l.getRenderParameters(params);
 
-                for (const auto &ro : m_fancyRenderObjects)
-                {
-                    ro->render(params, renderData, RenderTechnique::LIGHTING_OPAQUE);
-                }
+                renderDraws(params, renderData, RenderTechnique::LIGHTING_OPAQUE);
             }
 
 #ifndef NO_TRANSPARENCY
@@ -185,10 +149,7 @@ namespace Ra
                     RenderParameters params;
                     l->getRenderParameters(params);
 
-                    for (const auto &ro : m_transparentRenderObjects)
-                    {
-                        ro->render(params, renderData, RenderTechnique::LIGHTING_TRANSPARENT);
-                    }
+                    renderDraws(params, renderData, RenderTechnique::LIGHTING_TRANSPARENT);
                 }
             }
             else
@@ -199,10 +160,7 @@ namespace Ra
                 RenderParameters params;
                 l.getRenderParameters(params);
 
-                for (const auto &ro : m_transparentRenderObjects)
-                {
-                    ro->render(params, renderData, RenderTechnique::LIGHTING_TRANSPARENT);
-                }
+                renderDraws(params, renderData, RenderTechnique::LIGHTING_TRANSPARENT);
             }
 
             m_oitFbo->unbind();
@@ -4,7 +4,6 @@
 
 #include <Engine/Renderer/Renderers/ForwardRenderer.hpp>
 
-#include <Engine/Culling/cullingfilter.hpp>
 #include <string>
 
 namespace Ra
@@ -20,14 +19,15 @@ namespace Ra
             CullingRenderer();
             virtual ~CullingRenderer();
 
+            /// The culling itself is done by Renderer when feeding the render queues.
             inline void enableCulling(bool enabled)
             {
-                m_cullingEnabled = enabled;
+                enableFrustumCulling(enabled);
             }
 
             inline void fixCulling(bool fixed)
             {
-                m_cullingFixed = fixed;
+                freezeCullingFrustum(fixed);
             }
 
             virtual std::string getRendererName() const override
@@ -38,12 +38,6 @@ namespace Ra
         protected:
 
             void renderInternal(const RenderData &renderData) override;
-
-            bool m_cullingEnabled;
-            bool m_cullingFixed;
-
-            CullingFilter m_cullingFilter;
-
         };
 
     }
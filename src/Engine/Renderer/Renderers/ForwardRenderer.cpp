@@ -1,5 +1,6 @@
 #include <Engine/Renderer/Renderers/ForwardRenderer.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 #include <Core/Log/Log.hpp>
@@ -139,19 +140,18 @@ namespace Ra {
 #ifndef NO_TRANSPARENCY
             m_transparentRenderObjects.clear();
             
-            for (auto it = m_fancyRenderObjects.begin(); it != m_fancyRenderObjects.end();)
-            {
-                std::shared_ptr<RenderObject> ro = *it;
-                if (ro->isTransparent())
-                {
-                    m_transparentRenderObjects.push_back(ro);
-                    it = m_fancyRenderObjects.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
-            }
+            // Moves the transparent objects in a single pass instead of erasing them one by one.
+            auto end = std::remove_if(m_fancyRenderObjects.begin(), m_fancyRenderObjects.end(),
+                                      [this](const RenderObjectPtr &ro)
+                                      {
+                                          if (ro->isTransparent())
+                                          {
+                                              m_transparentRenderObjects.push_back(ro);
+                                              return true;
+                                          }
+                                          return false;
+                                      });
+            m_fancyRenderObjects.erase(end, m_fancyRenderObjects.end());
             
             m_fancyTransparentCount = m_transparentRenderObjects.size();
             
@@ -160,6 +160,16 @@ namespace Ra {
             
             // FIXME(charly) Do we want ui too  ?
 #endif
+            
+            // Sorts the draws of the fancy objects, so that the passes bind each shader and
+            // material once per light, and prepares their matrices for all the passes.
+            clearDraws();
+            addDraws(renderData, m_fancyRenderObjects, RenderTechnique::Z_PREPASS);
+            addDraws(renderData, m_fancyRenderObjects, RenderTechnique::LIGHTING_OPAQUE);
+#ifndef NO_TRANSPARENCY
+            addDraws(renderData, m_transparentRenderObjects, RenderTechnique::LIGHTING_TRANSPARENT);
+#endif
+            prepareDraws(renderData);
         }
         
         void ForwardRenderer::renderInternal(const RenderData &renderData)
@@ -194,13 +204,7 @@ namespace Ra {
 
             // Set in RenderParam the configuration about ambiant lighting (instead of hard constant direclty in shaders)
             RenderParameters params;
-            for (const auto &ro : m_fancyRenderObjects)
-            {
-             //   auto bb = Ra::Engine::DrawPrimitives::Primitive(Ra::Engine::SystemEntity::dbgCmp(), Ra::Engine::DrawPrimitives::AABB(ro->getAabb(), Core::Colors::Magenta()));
-             //   bb->setLifetime(1);
-             //   Ra::Engine::SystemEntity::dbgCmp()->addRenderObject(bb);
-                ro->render(params, renderData, RenderTechnique::Z_PREPASS);
-            }
+            renderDraws(params, renderData, RenderTechnique::Z_PREPASS);
             
             // Light pass
             GL_ASSERT(glDepthFunc(GL_LEQUAL));
@@ -218,10 +222,7 @@ namespace Ra {
                     RenderParameters params;
                     l->getRenderParameters(params);
                     
-                    for (const auto &ro : m_fancyRenderObjects)
-                    {
-                        ro->render(params, renderData, RenderTechnique::LIGHTING_OPAQUE);
-                    }
+                    renderDraws(params, renderData, RenderTechnique::LIGHTING_OPAQUE);
                 }
             }
             else
@@ -232,10 +233,7 @@ namespace Ra {
                 RenderParameters params;
                 l.getRenderParameters(params);
                 
-                for (const auto &ro : m_fancyRenderObjects)
-                {
-                    ro->render(params, renderData, RenderTechnique::LIGHTING_OPAQUE);
-                }
+                renderDraws(params, renderData, RenderTechnique::LIGHTING_OPAQUE);
             }
             
 #ifndef NO_TRANSPARENCY
@@ -260,10 +258,7 @@ namespace Ra {
                     RenderParameters params;
                     l->getRenderParameters(params);
                     
-                    for (const auto &ro : m_transparentRenderObjects)
-                    {
-                        ro->render(params, renderData, RenderTechnique::LIGHTING_TRANSPARENT);
-                    }
+                    renderDraws(params, renderData, RenderTechnique::LIGHTING_TRANSPARENT);
                 }
             }
             else
@@ -274,10 +269,7 @@ namespace Ra {
                 RenderParameters params;
                 l.getRenderParameters(params);
                 
-                for (const auto &ro : m_transparentRenderObjects)
-                {
-                    ro->render(params, renderData, RenderTechnique::LIGHTING_TRANSPARENT);
-                }
+                renderDraws(params, renderData, RenderTechnique::LIGHTING_TRANSPARENT);
             }
             
             m_oitFbo->unbind();
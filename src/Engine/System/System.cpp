@@ -9,6 +9,7 @@ namespace Ra
     namespace Engine
     {
         System::System()
+            : m_componentsVersion( 0 )
         {
         }
 
@@ -33,6 +34,7 @@ namespace Ra
 #endif // DEBUG
             m_components.push_back({ ent, component });
             component->setSystem( this );
+            ++m_componentsVersion;
 
         }
 
@@ -47,6 +49,7 @@ namespace Ra
             CORE_ASSERT( pos->first == ent, "Component belongs to a different entity" );
             component->setSystem(nullptr);
             m_components.erase( pos );
+            ++m_componentsVersion;
         }
 
 
@@ -58,6 +61,7 @@ namespace Ra
             {
                 m_components.erase( pos );
             }
+            ++m_componentsVersion;
         }
 
         std::vector< Component* > System::getEntityComponents( const Entity* entity )
@@ -55,8 +55,12 @@ namespace Ra
              * A very basic version of this method could be to iterate on components
              * and just call Component::update() method on them.
              * This update depends on time (e.g. physics system).
+             * When the engine uses a persistent task graph (see RadiumEngine::setPersistentTasks()),
+             * this is only called when the components of a system change and the generated tasks
+             * are replayed on the following frames. Tasks must then read the frame data through
+             * the frameInfo reference when they are processed instead of copying it.
              *
-             * @param dt Time elapsed since last call.
+             * @param frameInfo Information on the current frame, valid until the engine is cleaned up.
              */
             virtual void generateTasks( Core::TaskQueue* taskQueue, const Engine::FrameInfo& frameInfo ) = 0;
 
@@ -73,6 +77,9 @@ namespace Ra
             /// Returns the components stored for the given entity.
             std::vector< Component* > getEntityComponents( const Entity* entity );
 
+            /// Returns a counter incremented each time a component is registered or unregistered.
+            uint getComponentsVersion() const { return m_componentsVersion; }
+
             /**
              * Factory method for component creation from file data.
              * Given a given file and the corresponding entity, the system will create the
@@ -83,6 +90,10 @@ namespace Ra
         protected:
             /// List of active components.
             std::vector< std::pair<const Entity*, Component*> > m_components;
+
+        private:
+            /// Incremented each time the list of active components changes.
+            uint m_componentsVersion;
         };
 
     } // namespace Engine
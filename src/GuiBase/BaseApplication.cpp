@@ -10,6 +10,7 @@
 #include <Core/Math/ColorPresets.hpp>
 #include <Core/Tasks/Task.hpp>
 #include <Core/Tasks/TaskQueue.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
 #include <Core/String/StringUtils.hpp>
 #include <Core/Utils/Version.hpp>
 
@@ -86,8 +87,13 @@ namespace GuiBase
         QCommandLineOption pluginLoadOpt(QStringList{"l", "load", "loadPlugin"}, "Only load plugin with the given name (filename without the extension). If this option is not used, all plugins in the plugins folder will be loaded. ", "name");
         QCommandLineOption pluginIgnoreOpt(QStringList{"i", "ignore", "ignorePlugin"}, "Ignore plugins with the given name. If the name appears within both load and ignore options, it will be ignored.", "name");
         QCommandLineOption fileOpt(QStringList{"f", "file", "scene"}, "Open a scene file at startup.", "file name", "foo.bar");
+        QCommandLineOption persistentTasksOpt(QStringList{"persistent-tasks"}, "Compile the engine tasks once and replay them on each frame.");
+        QCommandLineOption criticalPathOpt(QStringList{"critical-path"}, "Start first the tasks on the critical path of the previous frame.");
+        QCommandLineOption pipelinedOpt(QStringList{"pipelined"}, "Run the engine tasks of the next frame while the current frame is rendered.");
+        QCommandLineOption profileTasksOpt(QStringList{"profile-tasks"}, "Record the performance counters of each task (shown in the task graph).");
+        QCommandLineOption plyNormalsOpt(QStringList{"ply-normals"}, "Estimate the normals of the PLY point clouds which have none when loading them.");
 
-        parser.addOptions({fpsOpt, pluginOpt, pluginLoadOpt, pluginIgnoreOpt, fileOpt, maxThreadsOpt, numFramesOpt });
+        parser.addOptions({fpsOpt, pluginOpt, pluginLoadOpt, pluginIgnoreOpt, fileOpt, maxThreadsOpt, numFramesOpt, persistentTasksOpt, criticalPathOpt, pipelinedOpt, profileTasksOpt, plyNormalsOpt });
         parser.process(*this);
 
         if (parser.isSet(fpsOpt))       m_targetFPS = parser.value(fpsOpt).toUInt();
@@ -177,11 +183,13 @@ namespace GuiBase
         // Create engine
         m_engine.reset(Engine::RadiumEngine::createInstance());
         m_engine->initialize();
+        m_engine->setPersistentTasks( parser.isSet(persistentTasksOpt) );
+        m_engine->setPipelinedFrames( parser.isSet(pipelinedOpt) );
         addBasicShaders();
 #ifdef IO_USE_TINYPLY
         // Register before AssimpFileLoader, in order to ease override of such
         // custom loader (first loader able to load is taking the file)
-        m_engine->registerFileLoader( std::shared_ptr<Asset::FileLoaderInterface>(new IO::TinyPlyFileLoader()) );
+        m_engine->registerFileLoader( std::shared_ptr<Asset::FileLoaderInterface>(new IO::TinyPlyFileLoader( parser.isSet(plyNormalsOpt) )) );
 #endif
 #ifdef IO_USE_ASSIMP
         m_engine->registerFileLoader( std::shared_ptr<Asset::FileLoaderInterface>(new IO::AssimpFileLoader()) );
@@ -211,6 +219,10 @@ namespace GuiBase
         // unless monothread CPU
         uint numThreads =  std::max( m_maxThreads == 0 ? RA_MAX_THREAD : std::min(m_maxThreads, RA_MAX_THREAD), 1u);
         m_taskQueue.reset( new Core::TaskQueue(numThreads) );
+        m_taskQueue->setCriticalPathPriorities( parser.isSet(criticalPathOpt) );
+        m_taskQueue->setProfiling( parser.isSet(profileTasksOpt) );
+        // Parallel loops share the threads of the task queue.
+        Core::setParallelTaskQueue( m_taskQueue.get() );
 
         setupScene();
         emit starting();
@@ -338,20 +350,35 @@ namespace GuiBase
         // Get picking results from last frame and forward it to the selection.
         m_viewer->processPicking();
 
+        // Background jobs finished since the last frame are delivered before the tasks are created.
+        auto startEngineTasks = [this, dt, &timerData]()
+        {
+            timerData.tasksStart = Core::Timer::Clock::now();
+            m_taskQueue->processCompletedJobs();
+            m_engine->getTasks( m_taskQueue.get(), dt );
+
+            if (m_recordGraph) {m_taskQueue->printTaskGraph(std::cout);}
+
+            m_taskQueue->startTasks();
+        };
+
         // ----------
         // 2. Kickoff rendering
+        // With pipelined frames, the tasks computing the next frame are started first and run
+        // while this frame is rendered from the front buffers (swapped in endFrameSync()).
+        const bool pipelined = m_engine->hasPipelinedFrames();
+        if ( pipelined )
+        {
+            startEngineTasks();
+        }
         m_viewer->startRendering( dt );
 
-        timerData.tasksStart = Core::Timer::Clock::now();
-
         // ----------
-        // 3. Run the engine task queue.
-        m_engine->getTasks( m_taskQueue.get(), dt );
-
-        if (m_recordGraph) {m_taskQueue->printTaskGraph(std::cout);}
-
-        // Run one frame of tasks
-        m_taskQueue->startTasks();
+        // 3. Run one frame of tasks of the engine task queue.
+        if ( !pipelined )
+        {
+            startEngineTasks();
+        }
         m_taskQueue->waitForTasks();
         timerData.taskData = m_taskQueue->getTimerData();
         m_taskQueue->flushTaskQueue();
@@ -442,6 +469,7 @@ namespace GuiBase
         emit stopping();
         m_mainWindow->cleanup();
         m_engine->cleanup();
+        Core::setParallelTaskQueue( nullptr );
 
         // This will remove the directory if empty.
         QDir().rmdir( m_exportFoldername.c_str());
@@ -157,7 +157,9 @@ namespace Ra {
         
         void AssimpGeometryDataLoader::loadMeshFrame(const aiNode *node, const Core::Transform &parentFrame,
                                                      const std::map<uint, uint> &indexTable,
-                                                     std::vector<std::unique_ptr<Asset::GeometryData> > &data) const
+                                                     std::vector<std::unique_ptr<Asset::GeometryData> > &data,
+                                                     std::vector<bool> &framed,
+                                                     std::set<std::string> &usedNames) const
         {
             const uint child_size = node->mNumChildren;
             const uint mesh_size = node->mNumMeshes;
@@ -173,13 +175,27 @@ namespace Ra {
                 auto it = indexTable.find(ID);
                 if (it != indexTable.end())
                 {
-                    data[it->second]->setFrame(frame);
+                    // A mesh referenced by several nodes is loaded once per node, so that the
+                    // engine displays each of them (sharing their mesh, see Engine::MeshCache).
+                    // Each copy is named after its node, as components are found by name.
+                    if (framed[it->second])
+                    {
+                        data.push_back(std::unique_ptr<Asset::GeometryData>(new Asset::GeometryData(*data[it->second])));
+                        data.back()->setName(uniqueName(data[it->second]->getName() + "_" + assimpToCore(node->mName),
+                                                        usedNames));
+                        data.back()->setFrame(frame);
+                    }
+                    else
+                    {
+                        data[it->second]->setFrame(frame);
+                        framed[it->second] = true;
+                    }
                 }
             }
             
             for (uint i = 0; i < child_size; ++i)
             {
-                loadMeshFrame(node->mChildren[i], frame, indexTable, data);
+                loadMeshFrame(node->mChildren[i], frame, indexTable, data, framed, usedNames);
             }
         }
         
@@ -187,13 +203,17 @@ namespace Ra {
                                                  Asset::GeometryData &data,
                                                  std::set<std::string> &usedNames) const
         {
-            std::string name = assimpToCore(mesh.mName);
+            data.setName(uniqueName(assimpToCore(mesh.mName), usedNames));
+        }
+        
+        std::string AssimpGeometryDataLoader::uniqueName(std::string name, std::set<std::string> &usedNames) const
+        {
             while (usedNames.find(name) != usedNames.end())
             {
                 name.append("_");
             }
             usedNames.insert(name);
-            data.setName(name);
+            return name;
         }
         
         void AssimpGeometryDataLoader::fetchType(const aiMesh &mesh, Asset::GeometryData &data) const
@@ -527,7 +547,8 @@ namespace Ra {
                     
                 }
             }
-            loadMeshFrame(scene->mRootNode, Core::Transform::Identity(), indexTable, data);
+            std::vector<bool> framed(data.size(), false);
+            loadMeshFrame(scene->mRootNode, Core::Transform::Identity(), indexTable, data, framed, usedNames);
         }
         
     } // namespace Asset
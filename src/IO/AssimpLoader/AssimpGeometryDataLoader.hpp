@@ -56,11 +56,16 @@ namespace Ra {
             void loadMeshFrame( const aiNode*                                          node,
                                const Core::Transform&                                 parentFrame,
                                const std::map< uint, uint >&                          indexTable,
-                               std::vector< std::unique_ptr< Asset::GeometryData > >& data ) const;
+                               std::vector< std::unique_ptr< Asset::GeometryData > >& data,
+                               std::vector< bool >&                                   framed,
+                               std::set< std::string >&                               usedNames ) const;
             
             /// NAME
             void fetchName(const aiMesh& mesh, Asset::GeometryData& data, std::set<std::string>& usedNames) const;
             
+            /// Returns name, made unique among usedNames by appending underscores, and adds it to them.
+            std::string uniqueName(std::string name, std::set<std::string>& usedNames) const;
+            
             /// TYPE
             void fetchType( const aiMesh& mesh, Asset::GeometryData& data ) const;
             
@@ -1,5 +1,7 @@
 #include <IO/TinyPlyLoader/TinyPlyFileLoader.hpp>
 
+#include <Core/Geometry/PointCloud/PointCloud.hpp>
+
 #include <tinyply/tinyply.h>
 
 #include <string>
@@ -11,7 +13,8 @@ const std::string plyExt ("ply");
 namespace Ra {
     namespace IO {
 
-        TinyPlyFileLoader::TinyPlyFileLoader()
+        TinyPlyFileLoader::TinyPlyFileLoader( bool estimateNormals )
+            : m_estimateNormals( estimateNormals )
         {
 
         }
@@ -105,6 +108,9 @@ namespace Ra {
 
             if (normalCount != 0) {
                 geometry->setNormals(*(reinterpret_cast<std::vector<Eigen::Matrix <float, 3, 1, Eigen::DontAlign>> *> (&normals)));
+            } else if ( m_estimateNormals ) {
+                // Point clouds need normals to be lit.
+                Core::PointCloud::estimateNormals(geometry->getVertices(), geometry->getNormals());
             }
 
 
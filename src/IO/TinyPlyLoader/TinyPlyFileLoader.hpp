@@ -11,7 +11,9 @@ namespace Ra {
         class RA_IO_API TinyPlyFileLoader : public Asset::FileLoaderInterface
         {
         public:
-            TinyPlyFileLoader();
+            /// If estimateNormals is true, the normals of the point clouds which have none are
+            /// estimated from their neighbourhoods at load time, which is costly on large clouds.
+            explicit TinyPlyFileLoader( bool estimateNormals = false );
 
             virtual ~TinyPlyFileLoader();
 
@@ -19,6 +21,9 @@ namespace Ra {
             bool handleFileExtension( const std::string& extension ) const override;
             Asset::FileData * loadFile( const std::string& filename ) override;
             std::string name() const override;
+
+        private:
+            bool m_estimateNormals;
         };
 
     } // namespace IO
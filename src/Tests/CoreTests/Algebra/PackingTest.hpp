@@ -0,0 +1,108 @@
+#ifndef RADIUM_PACKING_TESTS_HPP_
+#define RADIUM_PACKING_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Math/Packing.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+
+namespace RaTests {
+
+class PackingTests : public Test
+{
+    void checkHalf()
+    {
+        using Ra::Core::Packing::packHalf;
+        using Ra::Core::Packing::unpackHalf;
+
+        // All the halves but NaNs go back to themselves.
+        bool exact = true;
+        for ( uint h = 0; h < 0x10000; ++h )
+        {
+            if ( ( h & 0x7c00 ) != 0x7c00 || ( h & 0x3ff ) == 0 )
+            {
+                exact = exact && packHalf( unpackHalf( std::uint16_t( h ) ) ) == h;
+            }
+        }
+        RA_UNIT_TEST( exact, "Halves should be converted exactly." );
+
+        RA_UNIT_TEST( unpackHalf( packHalf( 1.f ) ) == 1.f && unpackHalf( packHalf( -2.5f ) ) == -2.5f
+                      && packHalf( 65504.f ) == 0x7bff && packHalf( 65520.f ) == 0x7c00
+                      && packHalf( -1e10f ) == 0xfc00 && packHalf( 1e-10f ) == 0
+                      && std::isnan( unpackHalf( packHalf( std::numeric_limits<float>::quiet_NaN() ) ) ),
+                      "Wrong special half values." );
+
+        // Other floats round to the nearest half, ties to even.
+        std::mt19937 generator( 17 );
+        std::uniform_real_distribution<float> mantissa( 1.f, 2.f );
+        bool nearest = true;
+        for ( uint i = 0; i < 100000; ++i )
+        {
+            const float x = std::ldexp( mantissa( generator ), int( generator() % 41 ) - 26 ) * ( i % 2 == 0 ? 1.f : -1.f );
+            const std::uint16_t h = packHalf( x );
+            const std::uint16_t sign = h & 0x8000;
+            const std::uint16_t magnitude = h & 0x7fff;
+            const float error = std::abs( unpackHalf( h ) - x );
+            const float below = magnitude > 0 ? std::abs( unpackHalf( std::uint16_t( sign | ( magnitude - 1 ) ) ) - x )
+                                              : error + 1;
+            const float above = std::abs( unpackHalf( std::uint16_t( sign | ( magnitude + 1 ) ) ) - x );
+            nearest = nearest && error <= below && error <= above
+                      && ( ( error != below && error != above ) || ( magnitude & 1 ) == 0 );
+        }
+        RA_UNIT_TEST( nearest, "Floats should be rounded to the nearest half." );
+    }
+
+    void checkSnorm()
+    {
+        using Ra::Core::Packing::packSnorm1010102;
+        using Ra::Core::Packing::unpackSnorm1010102;
+
+        std::mt19937 generator( 19 );
+        std::normal_distribution<Scalar> coordinate;
+        Ra::Core::Vector3Array normals;
+        bool close = true;
+        for ( uint i = 0; i < 10000; ++i )
+        {
+            const Ra::Core::Vector3 n =
+                Ra::Core::Vector3( coordinate( generator ), coordinate( generator ), coordinate( generator ) ).normalized();
+            normals.push_back( n );
+            close = close && ( unpackSnorm1010102( packSnorm1010102( n ) ) - n ).cwiseAbs().maxCoeff() <= 0.5f / 511;
+        }
+        RA_UNIT_TEST( close, "Packed normals should be within half a step of the normals." );
+
+        const std::uint32_t p = packSnorm1010102( Ra::Core::Vector3( 1.f, -1.f, 2.f ), -1.f );
+        RA_UNIT_TEST( ( p & 0x3ff ) == 511 && ( p >> 10 & 0x3ff ) == 0x201 && ( p >> 20 & 0x3ff ) == 511 && p >> 30 == 3
+                      && unpackSnorm1010102( 0x200 ).x() == -1.f,
+                      "Wrong packed bounds." );
+
+        std::vector<std::uint32_t> packed;
+        std::vector<std::uint16_t> halves;
+        Ra::Core::Packing::packSnorm1010102( normals, 100, 300, packed );
+        Ra::Core::Packing::packHalf( normals, 100, 300, halves );
+        bool arrays = packed.size() == 200 && halves.size() == 800;
+        for ( uint i = 0; i < 200 && arrays; ++i )
+        {
+            arrays = packed[i] == packSnorm1010102( normals[100 + i] ) && halves[4 * i + 3] == 0;
+            for ( uint k = 0; k < 3; ++k )
+            {
+                arrays = arrays && halves[4 * i + k] == Ra::Core::Packing::packHalf( normals[100 + i][k] );
+            }
+        }
+        RA_UNIT_TEST( arrays, "Arrays should be packed as each of their vectors." );
+    }
+
+public:
+    void run() override
+    {
+        checkHalf();
+        checkSnorm();
+    }
+};
+
+RA_TEST_CLASS( PackingTests );
+}
+
+#endif // RADIUM_PACKING_TESTS_HPP_
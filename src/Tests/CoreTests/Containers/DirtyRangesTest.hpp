@@ -0,0 +1,113 @@
+#ifndef RADIUM_DIRTY_RANGES_TESTS_HPP_
+#define RADIUM_DIRTY_RANGES_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Containers/DirtyRanges.hpp>
+#include <Core/Containers/VectorArray.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+
+#include <algorithm>
+#include <random>
+
+namespace RaTests {
+
+class DirtyRangesTests : public Test
+{
+    // Checks that the ranges are sorted, separated, and hold all the modified elements,
+    // and exactly them if exact is true.
+    bool check( const Ra::Core::DirtyRanges& ranges, const std::vector<bool>& modified, bool exact )
+    {
+        const auto& r = ranges.getRanges();
+        bool valid = r.size() <= Ra::Core::DirtyRanges::MaxRanges;
+        std::vector<bool> covered( modified.size(), false );
+        for ( uint i = 0; i < r.size(); ++i )
+        {
+            valid = valid && r[i].m_begin < r[i].m_end && ( i == 0 || r[i - 1].m_end < r[i].m_begin );
+            for ( uint j = r[i].m_begin; j < r[i].m_end && j < covered.size(); ++j )
+            {
+                covered[j] = true;
+            }
+        }
+        for ( uint j = 0; j < modified.size(); ++j )
+        {
+            valid = valid && ( exact ? covered[j] == modified[j] : covered[j] || !modified[j] );
+        }
+        return valid;
+    }
+
+public:
+    void run() override
+    {
+        std::mt19937 generator( 13 );
+        const uint size = 1000;
+
+        // Few ranges are kept as they are, overlapping and adjacent ones being merged.
+        Ra::Core::DirtyRanges ranges;
+        std::vector<bool> modified( size, false );
+        bool exact = true;
+        for ( uint i = 0; i < 12; ++i )
+        {
+            const uint begin = generator() % size;
+            const uint end = std::min( size, begin + uint( generator() % 40 ) );
+            ranges.add( begin, end );
+            std::fill( modified.begin() + begin, modified.begin() + end, true );
+            exact = exact && check( ranges, modified, true );
+        }
+        ranges.add( 10, 20 );
+        ranges.add( 20, 30 );
+        std::fill( modified.begin() + 10, modified.begin() + 30, true );
+        exact = exact && check( ranges, modified, true );
+        RA_UNIT_TEST( exact, "Few ranges should hold exactly the modified elements." );
+        RA_UNIT_TEST( ranges.getCount() == uint( std::count( modified.begin(), modified.end(), true ) ),
+                      "Wrong number of modified elements." );
+
+        // Many ranges are merged, still holding all the modified elements.
+        bool bounded = true;
+        for ( uint i = 0; i < 500; ++i )
+        {
+            const uint begin = generator() % size;
+            const uint end = std::min( size, begin + 1 + uint( generator() % 3 ) );
+            ranges.add( begin, end );
+            std::fill( modified.begin() + begin, modified.begin() + end, true );
+            bounded = bounded && check( ranges, modified, false );
+        }
+        RA_UNIT_TEST( bounded, "Merged ranges should hold all the modified elements." );
+
+        // Differences between arrays, found in parallel over several chunks.
+        Ra::Core::TaskQueue queue( 4 );
+        Ra::Core::setParallelTaskQueue( &queue );
+        const uint count = 5 * Ra::Core::DirtyRanges::DifferencesGrainSize;
+        Ra::Core::Vector3Array before( count, Ra::Core::Vector3::Zero() );
+        Ra::Core::Vector3Array after = before;
+        std::vector<bool> changed( count, false );
+        for ( uint begin : { 0u, 100u, Ra::Core::DirtyRanges::DifferencesGrainSize - 3, count - 7 } )
+        {
+            for ( uint i = begin; i < begin + 7; ++i )
+            {
+                after[i].y() = 1.f;
+                changed[i] = true;
+            }
+        }
+        Ra::Core::DirtyRanges differences;
+        differences.addDifferences( before, after );
+        RA_UNIT_TEST( check( differences, changed, true ) && differences.getRanges().size() == 4,
+                      "Differences should give exactly the changed elements." );
+        differences.clear();
+        differences.addDifferences( before, before );
+        RA_UNIT_TEST( differences.isEmpty(), "Equal arrays should have no difference." );
+        Ra::Core::setParallelTaskQueue( nullptr );
+
+        ranges.addAll();
+        ranges.add( 3, 5 );
+        RA_UNIT_TEST( ranges.isAll() && ranges.getRanges().empty() && !ranges.isEmpty(),
+                      "All the elements should be modified." );
+        ranges.clear();
+        RA_UNIT_TEST( ranges.isEmpty() && !ranges.isAll(), "Cleared ranges should be empty." );
+    }
+};
+
+RA_TEST_CLASS( DirtyRangesTests );
+}
+
+#endif // RADIUM_DIRTY_RANGES_TESTS_HPP_
@@ -0,0 +1,170 @@
+#ifndef RADIUM_DRAW_QUEUE_TESTS_HPP_
+#define RADIUM_DRAW_QUEUE_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Containers/DrawQueue.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <tuple>
+
+namespace RaTests {
+
+class DrawQueueTests : public Test
+{
+    struct DrawState
+    {
+        uint m_pass;
+        uint m_shader;
+        uint m_material;
+        Scalar m_depth;
+    };
+
+    void checkQueue()
+    {
+        // Many objects sharing a few shaders and materials, drawn in three passes.
+        std::mt19937 generator( 11 );
+        std::uniform_real_distribution<Scalar> depth( -0.1f, 1.1f );
+        std::vector<DrawState> states;
+        Ra::Core::DrawQueue queue;
+        for ( uint i = 0; i < 20000; ++i )
+        {
+            const uint pass = 1u << ( generator() % 3 );
+            const uint shader = generator() % 6;
+            const DrawState state{ pass, shader, uint( shader * 10 + generator() % 10 ), depth( generator ) };
+            queue.add( uint( states.size() ), state.m_pass, state.m_shader, state.m_material, state.m_depth );
+            states.push_back( state );
+        }
+        queue.sort();
+
+        const auto& draws = queue.getDraws();
+        bool sorted = draws.size() == states.size();
+        bool bindsMatch = true;
+        std::vector<bool> drawn( states.size(), false );
+        std::set<std::tuple<uint, uint>> shaders;
+        std::set<std::tuple<uint, uint, uint>> materials;
+        for ( uint i = 0; i < draws.size() && sorted; ++i )
+        {
+            const DrawState& s = states[draws[i].m_object];
+            sorted = !drawn[draws[i].m_object];
+            drawn[draws[i].m_object] = true;
+            shaders.emplace( s.m_pass, s.m_shader );
+            materials.emplace( s.m_pass, s.m_shader, s.m_material );
+            if ( i > 0 )
+            {
+                const DrawState& p = states[draws[i - 1].m_object];
+                sorted = sorted && std::make_tuple( p.m_pass, p.m_shader, p.m_material )
+                                   <= std::make_tuple( s.m_pass, s.m_shader, s.m_material );
+                if ( p.m_pass == s.m_pass && p.m_shader == s.m_shader && p.m_material == s.m_material )
+                {
+                    // Front to back, with depths outside of [0, 1] in the first and last buckets.
+                    sorted = sorted && std::min( std::max( p.m_depth, 0.f ), 1.f )
+                                       <= std::min( std::max( s.m_depth, 0.f ), 1.f ) + 1e-6f;
+                }
+                const bool newShader = p.m_pass != s.m_pass || p.m_shader != s.m_shader;
+                bindsMatch = bindsMatch && draws[i].m_bindShader == newShader
+                             && draws[i].m_bindMaterial == ( newShader || p.m_material != s.m_material );
+            }
+        }
+        RA_UNIT_TEST( sorted, "Draws should be sorted by pass, shader, material and depth." );
+        RA_UNIT_TEST( bindsMatch && draws[0].m_bindShader && draws[0].m_bindMaterial,
+                      "Draws should bind the state when it changes." );
+        RA_UNIT_TEST( queue.getShaderBindCount() == shaders.size() && queue.getMaterialBindCount() == materials.size(),
+                      "Each shader and material should be bound once per pass." );
+
+        bool rangesMatch = true;
+        uint previousEnd = 0;
+        for ( uint pass : { 1u, 2u, 4u } )
+        {
+            uint begin, end;
+            queue.getPassRange( pass, begin, end );
+            rangesMatch = rangesMatch && begin == previousEnd && end > begin && draws[begin].m_bindShader;
+            for ( uint i = begin; i < end; ++i )
+            {
+                rangesMatch = rangesMatch && states[draws[i].m_object].m_pass == pass;
+            }
+            previousEnd = end;
+        }
+        uint begin, end;
+        queue.getPassRange( 15, begin, end );
+        RA_UNIT_TEST( rangesMatch && previousEnd == draws.size() && begin == end,
+                      "Pass ranges should hold the draws of each pass." );
+
+        queue.clear();
+        queue.sort();
+        RA_UNIT_TEST( queue.getDraws().empty() && queue.getShaderBindCount() == 0, "A cleared queue should be empty." );
+    }
+
+    void checkBatches()
+    {
+        // Objects drawing one of a few geometries, every fourth one being never batched.
+        std::mt19937 generator( 23 );
+        std::uniform_real_distribution<Scalar> depth( 0.f, 1.f );
+        std::vector<DrawState> states;
+        std::vector<uint> geometries;
+        Ra::Core::DrawQueue queue;
+        for ( uint i = 0; i < 5000; ++i )
+        {
+            const uint shader = generator() % 3;
+            const DrawState state{ uint( 1 + generator() % 2 ), shader, uint( shader * 10 + generator() % 4 ), depth( generator ) };
+            const uint geometry = i % 4 == 0 ? Ra::Core::DrawQueue::NoGeometry : uint( generator() % 20 );
+            queue.add( uint( states.size() ), state.m_pass, state.m_shader, state.m_material, state.m_depth, geometry );
+            states.push_back( state );
+            geometries.push_back( geometry );
+        }
+        queue.sort();
+
+        // Each batch holds all the draws of its geometry with the same state, and only them.
+        const auto& draws = queue.getDraws();
+        bool batched = draws.size() == states.size();
+        std::set<std::tuple<uint, uint, uint>> batches;
+        std::vector<bool> drawn( states.size(), false );
+        uint batchCount = 0;
+        uint unbatched = 0;
+        for ( uint i = 0; i < draws.size() && batched; )
+        {
+            const uint n = draws[i].m_instances;
+            const DrawState& s = states[draws[i].m_object];
+            const uint geometry = geometries[draws[i].m_object];
+            batched = n > 0 && i + n <= draws.size()
+                      && ( geometry != Ra::Core::DrawQueue::NoGeometry
+                           ? batches.emplace( s.m_pass, s.m_material, geometry ).second
+                           : n == 1 );
+            unbatched += geometry == Ra::Core::DrawQueue::NoGeometry ? 1 : 0;
+            for ( uint j = i; j < i + n && batched; ++j )
+            {
+                const DrawState& d = states[draws[j].m_object];
+                batched = !drawn[draws[j].m_object] && ( j == i || draws[j].m_instances == 0 )
+                          && ( j == i || ( !draws[j].m_bindShader && !draws[j].m_bindMaterial ) )
+                          && geometries[draws[j].m_object] == geometry && d.m_pass == s.m_pass
+                          && d.m_shader == s.m_shader && d.m_material == s.m_material;
+                drawn[draws[j].m_object] = true;
+            }
+            ++batchCount;
+            i += std::max( n, 1u );
+        }
+        RA_UNIT_TEST( batched, "Draws of the same geometry and state should be batched." );
+        RA_UNIT_TEST( batchCount == queue.getBatchCount() && batchCount == batches.size() + unbatched,
+                      "Wrong number of batches." );
+    }
+
+public:
+    void run() override
+    {
+        checkQueue();
+        checkBatches();
+
+        Ra::Core::TaskQueue taskQueue( 4 );
+        Ra::Core::setParallelTaskQueue( &taskQueue );
+        checkQueue();
+        Ra::Core::setParallelTaskQueue( nullptr );
+    }
+};
+
+RA_TEST_CLASS( DrawQueueTests );
+}
+
+#endif // RADIUM_DRAW_QUEUE_TESTS_HPP_
@@ -0,0 +1,149 @@
+#ifndef RADIUM_FRUSTUM_CULLING_TESTS_HPP_
+#define RADIUM_FRUSTUM_CULLING_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Math/FrustumCulling.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace RaTests {
+
+class FrustumCullingTests : public Test
+{
+    // Returns the lowest signed distance of the positive vertex of the box to the planes,
+    // which is negative if the box is outside.
+    Scalar getMargin( const Ra::Core::Frustum& frustum, const Ra::Core::Aabb& aabb )
+    {
+        const Ra::Core::Vector3 c = aabb.center();
+        const Ra::Core::Vector3 e = aabb.max() - c;
+        Scalar margin = std::numeric_limits<Scalar>::max();
+        for ( uint p = 0; p < 6; ++p )
+        {
+            const Ra::Core::Vector4& plane = frustum.m_planes[p];
+            const Scalar d = plane.head<3>().dot( c ) + plane[3];
+            const Scalar r = plane.head<3>().cwiseAbs().dot( e );
+            margin = std::min( margin, d + r );
+        }
+        return margin;
+    }
+
+    void checkBoxes( const Ra::Core::Frustum& frustum, const std::vector<Ra::Core::Aabb>& aabbs )
+    {
+        using namespace Ra::Core::FrustumCulling;
+        using namespace Ra::Core::Simd;
+
+        Ra::Core::AabbArray boxes;
+        for ( const auto& aabb : aabbs )
+        {
+            boxes.push_back( aabb );
+        }
+
+        // The single precision boxes hold the original ones.
+        bool conservative = true;
+        for ( uint i = 0; i < aabbs.size(); ++i )
+        {
+            const double c[3] = { boxes.m_centerX[i], boxes.m_centerY[i], boxes.m_centerZ[i] };
+            const double e[3] = { boxes.m_extentX[i], boxes.m_extentY[i], boxes.m_extentZ[i] };
+            for ( uint k = 0; k < 3; ++k )
+            {
+                conservative = conservative && c[k] - e[k] <= aabbs[i].min()[k] && c[k] + e[k] >= aabbs[i].max()[k];
+            }
+        }
+        RA_UNIT_TEST( conservative, "Stored boxes should contain the original ones." );
+
+        std::vector<uint> scalar;
+        cullBoxes( frustum, boxes, scalar, SCALAR );
+        RA_UNIT_TEST( scalar.size() == ( aabbs.size() + 31 ) / 32, "Wrong size of the bitmask." );
+
+        // Away from the planes, the single precision test agrees with the reference.
+        bool matchesReference = true;
+        uint visible = 0;
+        for ( uint i = 0; i < aabbs.size(); ++i )
+        {
+            const Scalar margin = getMargin( frustum, aabbs[i] );
+            if ( std::abs( margin ) > 1e-2f )
+            {
+                matchesReference = matchesReference && ( isVisible( scalar, i ) == ( margin >= 0 ) );
+            }
+            visible += isVisible( scalar, i );
+        }
+        RA_UNIT_TEST( matchesReference, "Scalar culling should match the reference test." );
+        RA_UNIT_TEST( visible > 0 && visible < aabbs.size(), "Frustum should cut the boxes." );
+        if ( aabbs.size() % 32 != 0 )
+        {
+            RA_UNIT_TEST( scalar.back() >> ( aabbs.size() % 32 ) == 0, "Unused bits should be cleared." );
+        }
+
+        // The SIMD kernels give exactly the same bits, including for the remaining boxes.
+        for ( Kernel kernel : { SSE, AVX } )
+        {
+            if ( !isSupported( kernel ) )
+            {
+                continue;
+            }
+            std::vector<uint> simd;
+            cullBoxes( frustum, boxes, simd, kernel );
+            RA_UNIT_TEST( simd == scalar, ( std::string( getKernelName( kernel ) ) + " kernel should match the scalar one." ).c_str() );
+        }
+
+        std::vector<uint> best;
+        cullBoxes( frustum, boxes, best );
+        RA_UNIT_TEST( best == scalar, "Default kernel should match the scalar one." );
+    }
+
+public:
+    void run() override
+    {
+        const Ra::Core::Matrix4 proj = Ra::Core::MatrixUtils::perspective( 0.8f, 1.3f, 0.5f, 50.f );
+        Ra::Core::Matrix4 view = Ra::Core::Matrix4::Identity();
+        view.block<3, 1>( 0, 3 ) = Ra::Core::Vector3( 1.f, -2.f, -20.f );
+        const Ra::Core::Frustum frustum( proj * view );
+
+        std::mt19937 generator( 42 );
+        std::uniform_real_distribution<Scalar> position( -30.f, 30.f );
+        std::uniform_real_distribution<Scalar> extent( 0.f, 2.f );
+
+        // A count which leaves boxes for the scalar loop after the SIMD ones.
+        std::vector<Ra::Core::Aabb> aabbs;
+        for ( uint i = 0; i < 1003; ++i )
+        {
+            const Ra::Core::Vector3 c( position( generator ), position( generator ), position( generator ) );
+            const Ra::Core::Vector3 e( extent( generator ), extent( generator ), extent( generator ) );
+            aabbs.emplace_back( c - e, c + e );
+        }
+        // Boxes touching the planes, where rounding matters.
+        for ( uint p = 0; p < 6; ++p )
+        {
+            const Ra::Core::Vector4& plane = frustum.m_planes[p];
+            const Scalar norm = plane.head<3>().norm();
+            for ( uint i = 0; i < 8; ++i )
+            {
+                const Ra::Core::Vector3 c = Ra::Core::Vector3( position( generator ), position( generator ), 0.f ) * 0.1f;
+                const Ra::Core::Vector3 onPlane = c - plane.head<3>() * ( ( plane.head<3>().dot( c ) + plane[3] ) / ( norm * norm ) );
+                const Ra::Core::Vector3 e = Ra::Core::Vector3::Constant( Scalar( i ) * 0.01f );
+                aabbs.emplace_back( onPlane - e, onPlane + e );
+            }
+        }
+        checkBoxes( frustum, aabbs );
+
+        // Sizes smaller than a register.
+        aabbs.resize( 3 );
+        aabbs.emplace_back( Ra::Core::Vector3( -1.f, 1.f, 0.f ), Ra::Core::Vector3( 0.f, 3.f, 1.f ) );
+        aabbs.emplace_back( Ra::Core::Vector3( 100.f, 0.f, 0.f ), Ra::Core::Vector3( 101.f, 1.f, 1.f ) );
+        checkBoxes( frustum, aabbs );
+
+        Ra::Core::AabbArray empty;
+        std::vector<uint> visibility( 4, 1u );
+        Ra::Core::FrustumCulling::cullBoxes( frustum, empty, visibility );
+        RA_UNIT_TEST( visibility.empty(), "No box should give an empty bitmask." );
+    }
+};
+
+RA_TEST_CLASS( FrustumCullingTests );
+}
+
+#endif // RADIUM_FRUSTUM_CULLING_TESTS_HPP_
@@ -0,0 +1,74 @@
+#ifndef RADIUM_MAPPING_TESTS_HPP_
+#define RADIUM_MAPPING_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Geometry/Mapping/MappingOperation.hpp>
+#include <Core/Geometry/Distance/DistanceQueries.hpp>
+#include <Core/Mesh/MeshPrimitives.hpp>
+
+#include <algorithm>
+
+namespace RaTests {
+
+class MappingTests : public Test
+{
+    void run() override
+    {
+        using namespace Ra::Core::Geometry;
+
+        // A sphere mapped on a coarser one, and a box inside it.
+        Ra::Core::TriangleMesh source = Ra::Core::MeshUtils::makeGeodesicSphere( 1.1f, 3 );
+        source.append( Ra::Core::MeshUtils::makeBox( Ra::Core::Aabb( Ra::Core::Vector3( -0.3f, -0.2f, -0.1f ),
+                                                                          Ra::Core::Vector3( 0.2f, 0.3f, 0.4f ) ) ) );
+        const Ra::Core::TriangleMesh target = Ra::Core::MeshUtils::makeGeodesicSphere( 1.f, 2 );
+
+        Parametrization linear;
+        Parametrization param;
+        findParametrizationLinear( source, target, linear );
+        findParametrization( source, target, param );
+        RA_UNIT_TEST( param.size() == source.m_vertices.size() && isAllBoundToElement( param ),
+                      "All the vertices should be mapped." );
+
+        bool same = param.size() == linear.size();
+        for ( uint i = 0; i < param.size() && same; ++i )
+        {
+            same = param[i].getID() == linear[i].getID() && param[i].getAlpha() == linear[i].getAlpha()
+                   && param[i].getBeta() == linear[i].getBeta() && param[i].getDelta() == linear[i].getDelta();
+        }
+        RA_UNIT_TEST( same, "Accelerated and linear parametrizations should be the same." );
+
+        Ra::Core::Vector3Array points;
+        applyParametrization( target, param, points );
+        bool restored = points.size() == source.m_vertices.size();
+        for ( uint i = 0; i < points.size() && restored; ++i )
+        {
+            restored = ( points[i] - source.m_vertices[i] ).norm() < 1e-4f;
+        }
+        RA_UNIT_TEST( restored, "Applying the parametrization should give back the vertices." );
+
+        // With a tolerance, vertices are mapped on a triangle close enough.
+        auto squaredDistance = [&]( uint v, uint t )
+        {
+            const auto& tri = target.m_triangles[t];
+            return Ra::Core::DistanceQueries::pointToTriSq( source.m_vertices[v], target.m_vertices[tri[0]],
+                                                            target.m_vertices[tri[1]], target.m_vertices[tri[2]] )
+                .distanceSquared;
+        };
+        Ra::Core::TriangleKdTree tree;
+        tree.build( target );
+        const Scalar tolerance = 0.2f;
+        findParametrization( source, target, tree, param, tolerance );
+        bool close = isAllBoundToElement( param );
+        for ( uint i = 0; i < param.size() && close; ++i )
+        {
+            close = squaredDistance( i, param[i].getID() )
+                    <= std::max( squaredDistance( i, linear[i].getID() ), tolerance * tolerance );
+        }
+        RA_UNIT_TEST( close, "Vertices should be mapped on triangles within the tolerance." );
+    }
+};
+
+RA_TEST_CLASS( MappingTests );
+}
+
+#endif // RADIUM_MAPPING_TESTS_HPP_
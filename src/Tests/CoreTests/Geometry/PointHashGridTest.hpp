@@ -0,0 +1,135 @@
+#ifndef RADIUM_POINT_HASH_GRID_TESTS_HPP_
+#define RADIUM_POINT_HASH_GRID_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Geometry/PointCloud/PointHashGrid.hpp>
+#include <Core/Geometry/PointCloud/PointCloud.hpp>
+#include <Core/Mesh/MeshPrimitives.hpp>
+#include <Core/Mesh/MeshUtils.hpp>
+
+#include <algorithm>
+#include <random>
+
+namespace RaTests {
+
+class PointHashGridTests : public Test
+{
+    typedef Ra::Core::PointHashGrid::Neighbour Neighbour;
+
+    void checkQueries( const Ra::Core::Vector3Array& points, Scalar cellSize )
+    {
+        Ra::Core::PointHashGrid grid;
+        grid.build( points, cellSize );
+        RA_UNIT_TEST( !grid.isEmpty() && grid.getCellCount() <= points.size(), "Grid should have cells." );
+
+        std::mt19937 generator( 5 );
+        std::uniform_real_distribution<Scalar> uniform( -3.f, 3.f );
+        std::normal_distribution<Scalar> normal( 0.f, 1.f );
+        constexpr uint k = 6;
+        constexpr Scalar radius = 0.25f;
+
+        bool radiusOk = true;
+        bool nearestOk = true;
+        bool rayOk = true;
+        std::vector<uint> inRadius;
+        std::vector<Neighbour> nearest;
+        for ( uint n = 0; n < 60; ++n )
+        {
+            // Queries inside and outside the cloud, and on its points.
+            const Ra::Core::Vector3 q = n % 3 == 0 ? points[n * 7 % points.size()]
+                                                   : Ra::Core::Vector3( uniform( generator ), uniform( generator ),
+                                                                        uniform( generator ) );
+            std::vector<Neighbour> all;
+            std::vector<uint> expected;
+            for ( uint i = 0; i < points.size(); ++i )
+            {
+                all.emplace_back( int( i ), ( points[i] - q ).squaredNorm() );
+                if ( all.back().m_squaredDistance <= radius * radius )
+                {
+                    expected.push_back( i );
+                }
+            }
+            std::sort( all.begin(), all.end(), []( const Neighbour& a, const Neighbour& b )
+            {
+                return a.m_squaredDistance < b.m_squaredDistance
+                       || ( a.m_squaredDistance == b.m_squaredDistance && a.m_index < b.m_index );
+            } );
+
+            grid.getPointsInRadius( q, radius, inRadius );
+            radiusOk = radiusOk && inRadius == expected;
+
+            grid.getNearestPoints( q, k, nearest );
+            nearestOk = nearestOk && nearest.size() == std::min<size_t>( k, points.size() );
+            for ( uint j = 0; j < nearest.size() && nearestOk; ++j )
+            {
+                nearestOk = nearest[j].m_index == all[j].m_index && nearest[j].m_squaredDistance == all[j].m_squaredDistance;
+            }
+
+            const Ra::Core::Vector3 direction( normal( generator ), normal( generator ), normal( generator ) );
+            const Ra::Core::Ray ray( q * 2.f, direction.normalized() );
+            int expectedNearest = -1;
+            Scalar best = std::numeric_limits<Scalar>::max();
+            for ( uint i = 0; i < points.size(); ++i )
+            {
+                const Scalar d = ray.squaredDistance( points[i] );
+                if ( d < best )
+                {
+                    best = d;
+                    expectedNearest = int( i );
+                }
+            }
+            rayOk = rayOk && grid.getNearestToRay( ray ) == expectedNearest;
+        }
+        RA_UNIT_TEST( radiusOk, "Points in radius should match a linear scan." );
+        RA_UNIT_TEST( nearestOk, "Nearest points should match a linear scan." );
+        RA_UNIT_TEST( rayOk, "Nearest points to rays should match a linear scan." );
+    }
+
+public:
+    void run() override
+    {
+        // A sampled surface, with the cell size chosen by the grid.
+        Ra::Core::TriangleMesh sphere = Ra::Core::MeshUtils::makeGeodesicSphere( 2.f, 3 );
+        checkQueries( sphere.m_vertices, 0 );
+
+        // A volume with duplicated points, with small and large cells.
+        std::mt19937 generator( 11 );
+        std::uniform_real_distribution<Scalar> uniform( -1.f, 1.f );
+        Ra::Core::Vector3Array volume;
+        for ( uint i = 0; i < 2000; ++i )
+        {
+            volume.push_back( Ra::Core::Vector3( uniform( generator ), uniform( generator ), uniform( generator ) ) );
+        }
+        volume.push_back( volume[3] );
+        checkQueries( volume, 0.05f );
+        checkQueries( volume, 10.f );
+
+        Ra::Core::PointHashGrid empty;
+        std::vector<Neighbour> nearest( 3 );
+        empty.getNearestPoints( Ra::Core::Vector3::Zero(), 4, nearest );
+        RA_UNIT_TEST( nearest.empty() && empty.getNearestToRay( Ra::Core::Ray( Ra::Core::Vector3::Zero(),
+                                                                                Ra::Core::Vector3::UnitX() ) ) == -1,
+                      "Empty grid should have no point." );
+
+        // Normals of a sampled sphere point outwards from its center.
+        std::normal_distribution<Scalar> normal( 0.f, 1.f );
+        Ra::Core::Vector3Array samples;
+        for ( uint i = 0; i < 5000; ++i )
+        {
+            samples.push_back( Ra::Core::Vector3( normal( generator ), normal( generator ), normal( generator ) ).normalized() );
+        }
+        Ra::Core::Vector3Array normals;
+        Ra::Core::PointCloud::estimateNormals( samples, normals );
+        bool radial = normals.size() == samples.size();
+        for ( uint i = 0; i < normals.size() && radial; ++i )
+        {
+            radial = normals[i].dot( samples[i] ) > 0.95f;
+        }
+        RA_UNIT_TEST( radial, "Estimated normals of a sphere should be radial." );
+    }
+};
+
+RA_TEST_CLASS( PointHashGridTests );
+}
+
+#endif // RADIUM_POINT_HASH_GRID_TESTS_HPP_
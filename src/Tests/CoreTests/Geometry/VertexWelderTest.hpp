@@ -0,0 +1,148 @@
+#ifndef RADIUM_VERTEX_WELDER_TESTS_HPP_
+#define RADIUM_VERTEX_WELDER_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Mesh/VertexWelder.hpp>
+#include <Core/Mesh/MeshUtils.hpp>
+#include <Core/Mesh/MeshPrimitives.hpp>
+#include <Core/Containers/RadixSort.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <algorithm>
+#include <random>
+
+namespace RaTests {
+
+class VertexWelderTests : public Test
+{
+    /// Welds the vertices as VertexWelder does, comparing all the pairs of vertices.
+    uint weldLinear( const Ra::Core::Vector3Array& points, Scalar tolerance, const Ra::Core::Vector3Array* normals,
+                     std::vector<uint>& duplicatesMap )
+    {
+        uint numUnique = 0;
+        duplicatesMap.resize( points.size() );
+        for ( uint i = 0; i < points.size(); ++i )
+        {
+            duplicatesMap[i] = i;
+            for ( uint j = 0; j < i; ++j )
+            {
+                if ( ( points[i] - points[j] ).cwiseAbs().maxCoeff() <= tolerance
+                     && ( normals == nullptr || ( *normals )[i] == ( *normals )[j] ) )
+                {
+                    duplicatesMap[i] = duplicatesMap[j];
+                    break;
+                }
+            }
+            numUnique += duplicatesMap[i] == i ? 1 : 0;
+        }
+        return numUnique;
+    }
+
+    void checkRadixSort()
+    {
+        std::mt19937 generator( 3 );
+        std::vector<std::uint64_t> keys( 50000 );
+        std::vector<uint> values( keys.size() );
+        for ( uint i = 0; i < keys.size(); ++i )
+        {
+            // Many equal keys, whose values must stay in order.
+            keys[i] = std::uint64_t( generator() % 5000 ) << ( i % 2 == 0 ? 40 : 8 );
+            values[i] = i;
+        }
+        std::vector<uint> expected = values;
+        std::stable_sort( expected.begin(), expected.end(), [&]( uint a, uint b ) { return keys[a] < keys[b]; } );
+        std::vector<std::uint64_t> sortedKeys = keys;
+        Ra::Core::radixSort( sortedKeys, values );
+        bool sorted = values == expected;
+        for ( uint i = 0; i < values.size() && sorted; ++i )
+        {
+            sorted = sortedKeys[i] == keys[values[i]];
+        }
+        RA_UNIT_TEST( sorted, "Radix sort should be a stable sort." );
+    }
+
+    void checkWelding()
+    {
+        // A grid of points, with exact and slightly moved copies of some of them.
+        std::mt19937 generator( 7 );
+        std::uniform_real_distribution<Scalar> jitter( -1e-3f, 1e-3f );
+        Ra::Core::Vector3Array points;
+        Ra::Core::Vector3Array normals;
+        for ( uint i = 0; i < 1500; ++i )
+        {
+            points.push_back( Ra::Core::Vector3( Scalar( i % 10 ), Scalar( i / 10 % 10 ), Scalar( i / 100 ) ) * 0.1f );
+            normals.push_back( Ra::Core::Vector3::UnitZ() );
+        }
+        for ( uint i = 0; i < 1500; ++i )
+        {
+            const uint source = generator() % 1500;
+            const Ra::Core::Vector3 offset( jitter( generator ), jitter( generator ), jitter( generator ) );
+            points.push_back( i % 3 == 0 ? points[source] : points[source] + offset );
+            normals.push_back( i % 4 == 0 ? Ra::Core::Vector3::UnitX() : normals[source] );
+        }
+        points.push_back( Ra::Core::Vector3( 0.f, -0.f, 0.f ) );
+        normals.push_back( Ra::Core::Vector3::UnitZ() );
+
+        std::vector<uint> map;
+        std::vector<uint> expected;
+        for ( Scalar tolerance : { 0.f, 1e-3f, 0.04f } )
+        {
+            const uint numUnique = Ra::Core::VertexWelder( points, tolerance ).weld( map );
+            RA_UNIT_TEST( numUnique == weldLinear( points, tolerance, nullptr, expected ) && map == expected,
+                          "Welded positions should match comparing all the pairs." );
+
+            Ra::Core::VertexWelder welder( points, tolerance );
+            welder.addAttribute( normals );
+            const uint numWithNormals = welder.weld( map );
+            RA_UNIT_TEST( numWithNormals == weldLinear( points, tolerance, &normals, expected ) && map == expected
+                          && numWithNormals > numUnique, "Vertices with different normals should not be welded." );
+        }
+    }
+
+    void checkMesh()
+    {
+        // Boxes appended to each other have the same vertices.
+        Ra::Core::TriangleMesh mesh = Ra::Core::MeshUtils::makeBox();
+        const Ra::Core::TriangleMesh box = mesh;
+        mesh.append( box );
+        mesh.append( box );
+        std::vector<Ra::Core::VertexIdx> duplicates;
+        RA_UNIT_TEST( Ra::Core::MeshUtils::findDuplicates( mesh, duplicates ), "Appended boxes should have duplicates." );
+
+        std::vector<Ra::Core::VertexIdx> vertexMap;
+        Ra::Core::TriangleMesh welded = mesh;
+        Ra::Core::MeshUtils::removeDuplicates( welded, vertexMap );
+        bool same = welded.m_vertices.size() == box.m_vertices.size() && welded.m_normals.size() == box.m_normals.size()
+                    && welded.m_triangles.size() == mesh.m_triangles.size();
+        for ( uint t = 0; t < mesh.m_triangles.size() && same; ++t )
+        {
+            for ( uint j = 0; j < 3; ++j )
+            {
+                same = same && welded.m_vertices[welded.m_triangles[t][j]] == mesh.m_vertices[mesh.m_triangles[t][j]]
+                       && int( vertexMap[mesh.m_triangles[t][j]] ) == int( welded.m_triangles[t][j] );
+            }
+        }
+        RA_UNIT_TEST( same, "Removing duplicates should keep the triangles." );
+    }
+
+public:
+    void run() override
+    {
+        checkRadixSort();
+        checkWelding();
+        checkMesh();
+
+        // Parallel sort and welding.
+        Ra::Core::TaskQueue queue( 4 );
+        Ra::Core::setParallelTaskQueue( &queue );
+        checkRadixSort();
+        checkWelding();
+        Ra::Core::setParallelTaskQueue( nullptr );
+    }
+};
+
+RA_TEST_CLASS( VertexWelderTests );
+}
+
+#endif // RADIUM_VERTEX_WELDER_TESTS_HPP_
@@ -0,0 +1,179 @@
+#ifndef RADIUM_RAY_BATCH_TESTS_HPP_
+#define RADIUM_RAY_BATCH_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Math/RayBatch.hpp>
+#include <Core/Math/RayCast.hpp>
+#include <Core/Mesh/MeshPrimitives.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+
+namespace RaTests {
+
+class RayBatchTests : public Test
+{
+    // Rays from a sphere of radius 3 towards random points of the unit cube.
+    // The count leaves rays for the scalar loop after the SIMD ones.
+    Ra::Core::RayBatch makeRays( uint count )
+    {
+        std::mt19937 generator( 7 );
+        std::normal_distribution<Scalar> normal( 0.f, 1.f );
+        std::uniform_real_distribution<Scalar> uniform( -1.f, 1.f );
+
+        Ra::Core::RayBatch rays;
+        for ( uint i = 0; i < count; ++i )
+        {
+            const Ra::Core::Vector3 origin =
+                3.f * Ra::Core::Vector3( normal( generator ), normal( generator ), normal( generator ) ).normalized();
+            const Ra::Core::Vector3 target( uniform( generator ), uniform( generator ), uniform( generator ) );
+            rays.push_back( Ra::Core::Ray( origin, ( target - origin ).normalized() ) );
+        }
+        return rays;
+    }
+
+    bool isClose( Scalar a, Scalar b ) { return std::abs( a - b ) <= 1e-4f * ( 1 + std::abs( b ) ); }
+
+    // Checks that all the kernels give exactly the same hits, and returns them.
+    template <typename Cast>
+    std::vector<float> checkKernels( const Cast& cast, const char* description )
+    {
+        using namespace Ra::Core::Simd;
+        std::vector<float> scalar;
+        cast( scalar, SCALAR );
+        for ( Kernel kernel : { SSE, AVX } )
+        {
+            if ( !isSupported( kernel ) )
+            {
+                continue;
+            }
+            std::vector<float> simd;
+            cast( simd, kernel );
+            RA_UNIT_TEST( simd == scalar, ( std::string( getKernelName( kernel ) ) + " : " + description ).c_str() );
+        }
+        return scalar;
+    }
+
+    void testPrimitives( Ra::Core::RayBatch& rays )
+    {
+        const Ra::Core::Aabb aabb( Ra::Core::Vector3( -0.5f, -0.2f, -0.7f ), Ra::Core::Vector3( 0.6f, 0.4f, 0.1f ) );
+        std::vector<float> boxHits = checkKernels( [&]( std::vector<float>& hits, Ra::Core::Simd::Kernel kernel )
+        {
+            Ra::Core::RayCast::vsAabb( rays, aabb, hits, kernel );
+        }, "SIMD box tests should match the scalar ones." );
+
+        bool matchesReference = boxHits.size() == rays.size();
+        uint hits = 0;
+        for ( uint i = 0; i < rays.size() && matchesReference; ++i )
+        {
+            Scalar t;
+            Ra::Core::Vector3 normal;
+            const bool hit = Ra::Core::RayCast::vsAabb( rays.getRay( i ), aabb, t, normal );
+            matchesReference = hit == ( boxHits[i] >= 0 ) && ( !hit || isClose( boxHits[i], t ) );
+            hits += hit ? 1 : 0;
+        }
+        RA_UNIT_TEST( matchesReference, "Batch box tests should match RayCast::vsAabb()." );
+        RA_UNIT_TEST( hits > 0 && hits < rays.size(), "Rays should hit and miss the box." );
+
+        const Ra::Core::Vector3 a( -0.8f, -0.5f, 0.2f );
+        const Ra::Core::Vector3 b( 0.7f, -0.3f, -0.4f );
+        const Ra::Core::Vector3 c( 0.1f, 0.9f, 0.3f );
+        std::vector<float> triangleHits = checkKernels( [&]( std::vector<float>& hits, Ra::Core::Simd::Kernel kernel )
+        {
+            Ra::Core::RayCast::vsTriangle( rays, a, b, c, hits, kernel );
+        }, "SIMD triangle tests should match the scalar ones." );
+
+        matchesReference = triangleHits.size() == rays.size();
+        hits = 0;
+        for ( uint i = 0; i < rays.size() && matchesReference; ++i )
+        {
+            Scalar t;
+            const bool hit = Ra::Core::RayCast::vsTriangle( rays.getRay( i ), a, b, c, t );
+            matchesReference = hit == ( triangleHits[i] >= 0 ) && ( !hit || isClose( triangleHits[i], t ) );
+            hits += hit ? 1 : 0;
+        }
+        RA_UNIT_TEST( matchesReference, "Batch triangle tests should match RayCast::vsTriangle()." );
+        RA_UNIT_TEST( hits > 0 && hits < rays.size(), "Rays should hit and miss the triangle." );
+
+        // Hits beyond the maximum parameter are ignored.
+        Ra::Core::RayBatch shortRays = rays;
+        for ( uint i = 0; i < rays.size(); ++i )
+        {
+            shortRays.set( i, rays.getRay( i ), triangleHits[i] >= 0 ? triangleHits[i] * 0.99f : 10.f );
+        }
+        std::vector<float> shortHits;
+        Ra::Core::RayCast::vsTriangle( shortRays, a, b, c, shortHits );
+        RA_UNIT_TEST( std::all_of( shortHits.begin(), shortHits.end(), []( float t ) { return t < 0; } ),
+                      "Hits beyond the maximum parameter should be ignored." );
+    }
+
+    void testMesh( const Ra::Core::RayBatch& rays )
+    {
+        using namespace Ra::Core::RayCast;
+        using namespace Ra::Core::Simd;
+
+        Ra::Core::TriangleMesh mesh = Ra::Core::MeshUtils::makeGeodesicSphere( 1.f, 3 );
+        mesh.append( Ra::Core::MeshUtils::makeBox( Ra::Core::Aabb( Ra::Core::Vector3( 0.5f, -0.2f, -0.2f ),
+                                                                        Ra::Core::Vector3( 1.5f, 0.2f, 0.2f ) ) ) );
+        Ra::Core::TriangleBVH bvh;
+        std::vector<Ra::Core::TriangleBVH::Hit> hits( 3 );
+        vsTriangleMesh( rays, mesh, bvh, hits );
+        RA_UNIT_TEST( hits.size() == rays.size() && hits[0].m_triangle < 0, "Empty hierarchy should not be hit." );
+
+        bvh.build( mesh );
+        std::vector<Ra::Core::TriangleBVH::Hit> stream;
+        vsTriangleMesh( rays, mesh, bvh, stream, STREAM, SCALAR );
+
+        // Single rays traversing the hierarchy find the same hits, up to the rounding of the
+        // single precision tests. Only rays hitting a shared edge may find another triangle.
+        bool matchesReference = stream.size() == rays.size();
+        uint hitCount = 0;
+        for ( uint i = 0; i < rays.size() && matchesReference; ++i )
+        {
+            const Ra::Core::TriangleBVH::Hit hit = bvh.castRay( mesh, rays.getRay( i ) );
+            matchesReference = ( hit.m_triangle >= 0 ) == ( stream[i].m_triangle >= 0 )
+                               && ( hit.m_triangle < 0 || isClose( stream[i].m_t, hit.m_t ) );
+            hitCount += hit.m_triangle >= 0 ? 1 : 0;
+        }
+        RA_UNIT_TEST( matchesReference, "Batch mesh casts should match TriangleBVH::castRay()." );
+        RA_UNIT_TEST( hitCount > 0 && hitCount < rays.size(), "Rays should hit and miss the mesh." );
+
+        bool same = true;
+        for ( BatchMode mode : { STREAM, PACKET_4, PACKET_8, PACKET_16 } )
+        {
+            for ( Kernel kernel : { SCALAR, SSE, AVX } )
+            {
+                if ( !isSupported( kernel ) )
+                {
+                    continue;
+                }
+                vsTriangleMesh( rays, mesh, bvh, hits, mode, kernel );
+                for ( uint i = 0; i < rays.size(); ++i )
+                {
+                    same = same && hits[i].m_triangle == stream[i].m_triangle && hits[i].m_t == stream[i].m_t;
+                }
+            }
+        }
+        RA_UNIT_TEST( same, "All the modes and kernels should give the same hits." );
+    }
+
+public:
+    void run() override
+    {
+        Ra::Core::RayBatch rays = makeRays( 1003 );
+        testPrimitives( rays );
+        testMesh( rays );
+
+        Ra::Core::RayBatch empty;
+        std::vector<float> hits( 4, 1.f );
+        Ra::Core::RayCast::vsAabb( empty, Ra::Core::Aabb( -Ra::Core::Vector3::Ones(), Ra::Core::Vector3::Ones() ), hits );
+        RA_UNIT_TEST( hits.empty(), "No ray should give no hit." );
+    }
+};
+
+RA_TEST_CLASS( RayBatchTests );
+}
+
+#endif // RADIUM_RAY_BATCH_TESTS_HPP_
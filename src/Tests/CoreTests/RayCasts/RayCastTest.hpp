@@ -3,6 +3,12 @@
 
 #include <Tests/CoreTests/Tests.hpp>
 #include <Core/Math/RayCast.hpp>
+#include <Core/Mesh/MeshPrimitives.hpp>
+#include <Core/Mesh/MeshUtils.hpp>
+#include <Core/TreeStructures/TriangleBVH.hpp>
+#include <Core/TreeStructures/PointKdTree.hpp>
+
+#include <random>
 
 namespace RaTests {
 
@@ -80,6 +86,100 @@ class RayCastAabbTests : public Test
     }
 };
     RA_TEST_CLASS(RayCastAabbTests);
+
+class RayCastMeshTests : public Test
+{
+    typedef Ra::Core::MeshUtils::RayCastResult RayCastResult;
+
+    bool isSame( const RayCastResult& a, const RayCastResult& b )
+    {
+        return a.m_hitTriangle == b.m_hitTriangle && a.m_nearestVertex == b.m_nearestVertex
+            && a.m_edgeVertex0 == b.m_edgeVertex0 && a.m_edgeVertex1 == b.m_edgeVertex1 && a.m_t == b.m_t;
+    }
+
+    // Rays from a sphere around the mesh towards random points near its center.
+    std::vector<Ra::Core::Ray> makeRays( uint count )
+    {
+        std::mt19937 generator( 7 );
+        std::uniform_real_distribution<Scalar> unit( -1.f, 1.f );
+        std::vector<Ra::Core::Ray> rays;
+        for ( uint i = 0; i < count; ++i )
+        {
+            const Ra::Core::Vector3 origin = Ra::Core::Vector3( unit( generator ), unit( generator ), unit( generator ) ).normalized() * 5.f;
+            const Ra::Core::Vector3 target( unit( generator ), unit( generator ), unit( generator ) );
+            rays.emplace_back( origin, ( target - origin ).normalized() );
+        }
+        // Rays through vertices and edges, where neighbour triangles give the same parameter.
+        rays.emplace_back( Ra::Core::Vector3( 0.f, 0.f, 5.f ), Ra::Core::Vector3( 0.f, 0.f, -1.f ) );
+        rays.emplace_back( Ra::Core::Vector3( 5.f, 0.f, 0.f ), Ra::Core::Vector3( -1.f, 0.f, 0.f ) );
+        // A ray starting inside the mesh.
+        rays.emplace_back( Ra::Core::Vector3::Zero(), Ra::Core::Vector3( 0.f, 1.f, 0.f ) );
+        return rays;
+    }
+
+    void checkTriangles( const Ra::Core::TriangleMesh& mesh, const Ra::Core::TriangleBVH& bvh,
+                         const std::vector<Ra::Core::Ray>& rays, const char* description )
+    {
+        bool same = true;
+        bool anyHitMatches = true;
+        uint hits = 0;
+        for ( const auto& ray : rays )
+        {
+            const RayCastResult linear = Ra::Core::MeshUtils::castRay( mesh, ray );
+            same = same && isSame( linear, Ra::Core::MeshUtils::castRay( mesh, bvh, ray ) );
+            hits += linear.m_hitTriangle >= 0 ? 1 : 0;
+
+            anyHitMatches = anyHitMatches && bvh.anyHit( mesh, ray ) == ( linear.m_hitTriangle >= 0 );
+            if ( linear.m_hitTriangle >= 0 )
+            {
+                anyHitMatches = anyHitMatches && bvh.anyHit( mesh, ray, linear.m_t )
+                                && !bvh.anyHit( mesh, ray, linear.m_t * 0.99f );
+            }
+        }
+        RA_UNIT_TEST( hits > 0 && hits < rays.size(), description );
+        RA_UNIT_TEST( same, description );
+        RA_UNIT_TEST( anyHitMatches, description );
+    }
+
+    void run() override
+    {
+        Ra::Core::TriangleMesh mesh = Ra::Core::MeshUtils::makeGeodesicSphere( 1.f, 4 );
+        mesh.append( Ra::Core::MeshUtils::makeBox( Ra::Core::Aabb( Ra::Core::Vector3( 0.5f, -0.2f, -0.2f ),
+                                                                        Ra::Core::Vector3( 1.5f, 0.2f, 0.2f ) ) ) );
+        const std::vector<Ra::Core::Ray> rays = makeRays( 500 );
+
+        Ra::Core::TriangleBVH bvh;
+        RA_UNIT_TEST( bvh.castRay( mesh, rays[0] ).m_triangle < 0 && !bvh.anyHit( mesh, rays[0] ),
+                      "Empty hierarchy should not be hit." );
+        bvh.build( mesh );
+        RA_UNIT_TEST( !bvh.isEmpty() && bvh.getTriangles().size() == mesh.m_triangles.size(),
+                      "Hierarchy should reference all the triangles." );
+        checkTriangles( mesh, bvh, rays, "Hierarchy should give the result of the linear scan." );
+
+        // Deform the mesh without changing its triangles.
+        for ( auto& v : mesh.m_vertices )
+        {
+            v = Ra::Core::Vector3( v.x() * 1.5f + 0.3f * v.y(), v.y() * 0.5f, v.z() + 0.4f * v.x() * v.x() );
+        }
+        bvh.refit( mesh );
+        checkTriangles( mesh, bvh, rays, "Refit hierarchy should give the result of the linear scan." );
+
+        // Point cloud.
+        Ra::Core::TriangleMesh cloud;
+        cloud.m_vertices = mesh.m_vertices;
+        Ra::Core::PointKdTree tree;
+        RA_UNIT_TEST( tree.getNearestToRay( rays[0] ) == -1, "Empty tree should not return a point." );
+        tree.build( cloud.m_vertices );
+        bool same = true;
+        for ( const auto& ray : rays )
+        {
+            same = same && isSame( Ra::Core::MeshUtils::castRay( cloud, ray ),
+                                   Ra::Core::MeshUtils::castRay( cloud, tree, ray ) );
+        }
+        RA_UNIT_TEST( same, "Kd-tree should give the point of the linear scan." );
+    }
+};
+    RA_TEST_CLASS(RayCastMeshTests);
 }
 
 
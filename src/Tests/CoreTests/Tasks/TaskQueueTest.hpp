@@ -0,0 +1,343 @@
+#ifndef RADIUM_TASKQUEUE_TESTS_HPP_
+#define RADIUM_TASKQUEUE_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Tasks/Task.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+#include <Core/Tasks/AsyncJob.hpp>
+
+#include <atomic>
+#include <memory>
+#include <sstream>
+
+namespace RaTests {
+
+class TaskQueueTests : public Test
+{
+    // Builds a diamond-shaped graph repeated several times :
+    // one root, many middle tasks depending on it, one sink depending on all of them.
+    // Each task records its execution order, which is checked against the dependencies.
+    void runGraph( Ra::Core::TaskQueue::SchedulingMode mode )
+    {
+        using Ra::Core::TaskQueue;
+        const uint numThreads = 4;
+        const uint width = 32;
+        const uint numFrames = 20;
+
+        TaskQueue queue( numThreads, mode );
+
+        for ( uint frame = 0; frame < numFrames; ++frame )
+        {
+            std::atomic<uint> counter( 0 );
+            std::vector<uint> order( width + 2, 0 );
+
+            auto makeTask = [&counter, &order]( uint i, const std::string& name )
+            {
+                return new Ra::Core::FunctionTask( [&counter, &order, i]() { order[i] = ++counter; }, name );
+            };
+
+            TaskQueue::TaskId root = queue.registerTask( makeTask( 0, "Root" ) );
+            TaskQueue::TaskId sink = queue.registerTask( makeTask( width + 1, "Sink" ) );
+            for ( uint i = 1; i <= width; ++i )
+            {
+                TaskQueue::TaskId mid = queue.registerTask( makeTask( i, "Middle" ) );
+                queue.addDependency( root, mid );
+            }
+            queue.addPendingDependency( "Middle", sink );
+
+            queue.startTasks();
+            queue.waitForTasks();
+
+            RA_UNIT_TEST( counter == width + 2, "All tasks should have run exactly once." );
+            RA_UNIT_TEST( queue.getTimerData().size() == width + 2, "Missing timer data." );
+            RA_UNIT_TEST( order[0] == 1, "Root task should run first." );
+            RA_UNIT_TEST( order[width + 1] == width + 2, "Sink task should run last." );
+
+            bool allRan = true;
+            for ( uint i = 1; i <= width; ++i )
+            {
+                allRan = allRan && ( order[i] > 1 ) && ( order[i] < width + 2 );
+            }
+            RA_UNIT_TEST( allRan, "Middle tasks did not respect dependencies." );
+
+            queue.flushTaskQueue();
+        }
+    }
+
+    // Compiles a chain of tasks once and replays it on several frames.
+    void runCompiledGraph( Ra::Core::TaskQueue::SchedulingMode mode )
+    {
+        using Ra::Core::TaskQueue;
+        const uint chainLength = 16;
+        const uint numFrames = 20;
+
+        TaskQueue queue( 4, mode );
+
+        // Tasks read the frame number when they run, as the graph is replayed as is.
+        uint frame = 0;
+        std::vector<uint> values( chainLength, 0 );
+        TaskQueue::TaskId previous = TaskQueue::InvalidTaskId;
+        for ( uint i = 0; i < chainLength; ++i )
+        {
+            TaskQueue::TaskId id = queue.registerTask( new Ra::Core::FunctionTask(
+                [&values, &frame, i]() { values[i] = ( i == 0 ? frame : values[i - 1] + 1 ); }, "Chain" ) );
+            if ( previous != TaskQueue::InvalidTaskId )
+            {
+                queue.addDependency( previous, id );
+            }
+            previous = id;
+        }
+        queue.compileGraph();
+        RA_UNIT_TEST( queue.isGraphCompiled(), "Graph should be compiled." );
+
+        for ( frame = 0; frame < numFrames; ++frame )
+        {
+            queue.startTasks();
+            queue.waitForTasks();
+            queue.flushTaskQueue();
+            RA_UNIT_TEST( values[chainLength - 1] == frame + chainLength - 1, "Compiled graph was not replayed in order." );
+        }
+        RA_UNIT_TEST( queue.getTimerData().size() == chainLength, "Compiled graph tasks should be kept." );
+
+        queue.clearGraph();
+        RA_UNIT_TEST( !queue.isGraphCompiled(), "Graph should be cleared." );
+        RA_UNIT_TEST( queue.getTimerData().empty(), "Cleared graph should have no tasks." );
+    }
+
+    // Runs parallel loops from the main thread and from within tasks.
+    void runParallelLoops( Ra::Core::TaskQueue::SchedulingMode mode )
+    {
+        using Ra::Core::TaskQueue;
+        const uint size = 10000;
+        const uint numTasks = 8;
+
+        TaskQueue queue( 4, mode );
+        Ra::Core::setParallelTaskQueue( &queue );
+
+        std::vector<uint> values( size, 0 );
+        Ra::Core::parallelFor( 0, size, [&values]( uint i ) { values[i] = i; } );
+        bool filled = true;
+        for ( uint i = 0; i < size; ++i )
+        {
+            filled = filled && ( values[i] == i );
+        }
+        RA_UNIT_TEST( filled, "parallelFor did not visit each index once." );
+
+        const ulong sum = Ra::Core::parallelReduce( 0, size, ulong( 0 ),
+            [&values]( uint i, ulong& acc ) { acc += values[i]; },
+            []( ulong a, ulong b ) { return a + b; }, 7 );
+        RA_UNIT_TEST( sum == ulong( size ) * ( size - 1 ) / 2, "Wrong parallelReduce result." );
+
+        // Each task runs its own parallel loop on the same pool.
+        std::vector<ulong> taskSums( numTasks, 0 );
+        for ( uint t = 0; t < numTasks; ++t )
+        {
+            queue.registerTask( new Ra::Core::FunctionTask( [&taskSums, &values, t]()
+            {
+                taskSums[t] = Ra::Core::parallelReduce( 0, uint( values.size() ), ulong( 0 ),
+                    [&values, t]( uint i, ulong& acc ) { acc += values[i] * t; },
+                    []( ulong a, ulong b ) { return a + b; } );
+            }, "Reduce" ) );
+        }
+        queue.startTasks();
+        queue.waitForTasks();
+        queue.flushTaskQueue();
+
+        bool tasksOk = true;
+        for ( uint t = 0; t < numTasks; ++t )
+        {
+            tasksOk = tasksOk && ( taskSums[t] == sum * t );
+        }
+        RA_UNIT_TEST( tasksOk, "Wrong parallel loop result within tasks." );
+
+        Ra::Core::setParallelTaskQueue( nullptr );
+    }
+
+    // Checks that ready tasks start by decreasing priority, and the critical path priorities.
+    void runPriorities( Ra::Core::TaskQueue::SchedulingMode mode )
+    {
+        using Ra::Core::TaskQueue;
+        const uint numTasks = 8;
+
+        // With a single thread in SHARED_QUEUE mode, all the tasks are queued before the thread
+        // can pick one, so the execution order is deterministic.
+        TaskQueue queue( 1, mode );
+        uint counter = 0;
+        std::vector<uint> order( numTasks, 0 );
+        for ( uint i = 0; i < numTasks; ++i )
+        {
+            queue.registerTask( new Ra::Core::FunctionTask( [&counter, &order, i]() { order[i] = ++counter; }, "Prio" ),
+                                TaskQueue::Priority( i ) );
+        }
+        queue.startTasks();
+        queue.waitForTasks();
+        queue.flushTaskQueue();
+        if ( mode == TaskQueue::SHARED_QUEUE )
+        {
+            bool sorted = true;
+            for ( uint i = 0; i < numTasks; ++i )
+            {
+                sorted = sorted && ( order[i] == numTasks - i );
+            }
+            RA_UNIT_TEST( sorted, "Tasks did not start by decreasing priority." );
+        }
+
+        // A chain of three tasks and an independent task : the head of the chain is critical.
+        queue.setCriticalPathPriorities( true );
+        for ( uint frame = 0; frame < 3; ++frame )
+        {
+            TaskQueue::TaskId head = queue.registerTask( new Ra::Core::FunctionTask( []() {}, "Head" ) );
+            TaskQueue::TaskId middle = queue.registerTask( new Ra::Core::FunctionTask( []() {}, "Middle" ) );
+            TaskQueue::TaskId tail = queue.registerTask( new Ra::Core::FunctionTask( []() {}, "Tail" ) );
+            TaskQueue::TaskId single = queue.registerTask( new Ra::Core::FunctionTask( []() {}, "Single" ), 1000000 );
+            queue.addDependency( head, middle );
+            queue.addDependency( middle, tail );
+            queue.startTasks();
+            queue.waitForTasks();
+
+            RA_UNIT_TEST( queue.getPriority( head ) > queue.getPriority( middle ), "Wrong critical path priority." );
+            RA_UNIT_TEST( queue.getPriority( middle ) > queue.getPriority( tail ), "Wrong critical path priority." );
+            RA_UNIT_TEST( queue.getPriority( tail ) > 0, "Wrong critical path priority." );
+            RA_UNIT_TEST( queue.getPriority( single ) < 1000000, "Critical path should override priorities." );
+            if ( frame == 0 )
+            {
+                // Without previous durations, each task counts for one microsecond.
+                RA_UNIT_TEST( queue.getPriority( head ) == 3 && queue.getPriority( single ) == 1, "Wrong initial priority." );
+            }
+            queue.flushTaskQueue();
+        }
+    }
+
+    // Runs background jobs while frames of tasks are processed.
+    // With a single thread, the frames are run by the thread waiting for them.
+    void runBackgroundJobs( Ra::Core::TaskQueue::SchedulingMode mode, uint numThreads )
+    {
+        using Ra::Core::TaskQueue;
+        using Ra::Core::AsyncJob;
+        using Ra::Core::AsyncFunctionJob;
+
+        TaskQueue queue( numThreads, mode );
+        Ra::Core::setParallelTaskQueue( &queue );
+
+        // This job runs until cancelled, frames must still complete meanwhile.
+        std::atomic<bool> endlessStarted( false );
+        bool endlessCompleted = false;
+        auto endless = Ra::Core::runInBackground<uint>( "Endless", [&endlessStarted]( const AsyncJob& job )
+        {
+            endlessStarted = true;
+            while ( !job.isCancelled() )
+            {
+                std::this_thread::yield();
+            }
+            return 0u;
+        }, [&endlessCompleted]( uint& ) { endlessCompleted = true; } );
+
+        // Queued behind the endless job, as only one background job can run with one or two threads.
+        uint sum = 0;
+        auto summer = Ra::Core::runInBackground<uint>( "Sum", []( const AsyncJob& )
+        {
+            uint result = 0;
+            for ( uint i = 0; i < 100; ++i )
+            {
+                result += i;
+            }
+            return result;
+        }, [&sum]( uint& result ) { sum = result; } );
+
+        while ( !endlessStarted )
+        {
+            std::this_thread::yield();
+        }
+        for ( uint frame = 0; frame < 10; ++frame )
+        {
+            std::atomic<uint> counter( 0 );
+            for ( uint i = 0; i < 8; ++i )
+            {
+                queue.registerTask( new Ra::Core::FunctionTask( [&counter]() { ++counter; }, "Frame" ) );
+            }
+            queue.startTasks();
+            queue.waitForTasks();
+            queue.flushTaskQueue();
+            queue.processCompletedJobs();
+            RA_UNIT_TEST( counter == 8, "Frame tasks should not wait for background jobs." );
+        }
+        RA_UNIT_TEST( endless->getState() == AsyncJob::RUNNING, "Endless job should be running." );
+        RA_UNIT_TEST( queue.getNumBackgroundJobs() == 2, "Wrong number of background jobs." );
+
+        endless->cancel();
+        endless->wait();
+        summer->wait();
+        queue.processCompletedJobs();
+        RA_UNIT_TEST( endless->getState() == AsyncJob::CANCELLED, "Endless job should be cancelled." );
+        RA_UNIT_TEST( !endlessCompleted, "Cancelled jobs should not be completed." );
+        RA_UNIT_TEST( summer->getState() == AsyncJob::FINISHED && summer->getResult() == 4950, "Wrong job result." );
+        RA_UNIT_TEST( sum == 4950, "Completion callback was not called." );
+        RA_UNIT_TEST( queue.getNumBackgroundJobs() == 0, "All background jobs should be completed." );
+
+        Ra::Core::setParallelTaskQueue( nullptr );
+    }
+
+    // Records the counters of allocating tasks and prints them in the task graph.
+    void runProfiling( Ra::Core::TaskQueue::SchedulingMode mode )
+    {
+        using Ra::Core::TaskQueue;
+        const uint numTasks = 4;
+        const uint allocSize = 1000;
+
+        TaskQueue queue( 2, mode );
+        queue.setProfiling( true );
+        std::vector<std::unique_ptr<char[]>> buffers( numTasks );
+        for ( uint i = 0; i < numTasks; ++i )
+        {
+            queue.registerTask( new Ra::Core::FunctionTask( [&buffers, i]()
+            {
+                buffers[i].reset( new char[allocSize] );
+            }, "Alloc" ) );
+        }
+        queue.startTasks();
+        queue.waitForTasks();
+
+        if ( Ra::Core::ThreadProfiler::hasAllocationCounters() )
+        {
+            bool counted = true;
+            for ( const auto& tdata : queue.getTimerData() )
+            {
+                counted = counted && tdata.counters.allocations >= 1 && tdata.counters.allocatedBytes >= allocSize;
+            }
+            RA_UNIT_TEST( counted, "Allocations were not counted." );
+        }
+        queue.flushTaskQueue();
+
+        // The graph of the next frame shows the counters of the last one.
+        queue.registerTask( new Ra::Core::FunctionTask( []() {}, "Alloc" ) );
+        std::stringstream graph;
+        queue.printTaskGraph( graph );
+        RA_UNIT_TEST( graph.str().find( "Alloc (x4)" ) != std::string::npos, "Task graph should show the counters." );
+        queue.startTasks();
+        queue.waitForTasks();
+        queue.flushTaskQueue();
+    }
+
+    void run() override
+    {
+        runGraph( Ra::Core::TaskQueue::SHARED_QUEUE );
+        runGraph( Ra::Core::TaskQueue::WORK_STEALING );
+        runCompiledGraph( Ra::Core::TaskQueue::SHARED_QUEUE );
+        runCompiledGraph( Ra::Core::TaskQueue::WORK_STEALING );
+        runParallelLoops( Ra::Core::TaskQueue::SHARED_QUEUE );
+        runParallelLoops( Ra::Core::TaskQueue::WORK_STEALING );
+        runPriorities( Ra::Core::TaskQueue::SHARED_QUEUE );
+        runPriorities( Ra::Core::TaskQueue::WORK_STEALING );
+        runBackgroundJobs( Ra::Core::TaskQueue::SHARED_QUEUE, 1 );
+        runBackgroundJobs( Ra::Core::TaskQueue::WORK_STEALING, 1 );
+        runBackgroundJobs( Ra::Core::TaskQueue::SHARED_QUEUE, 2 );
+        runBackgroundJobs( Ra::Core::TaskQueue::WORK_STEALING, 2 );
+        runProfiling( Ra::Core::TaskQueue::SHARED_QUEUE );
+        runProfiling( Ra::Core::TaskQueue::WORK_STEALING );
+    }
+};
+RA_TEST_CLASS(TaskQueueTests);
+}
+
+#endif // RADIUM_TASKQUEUE_TESTS_HPP_
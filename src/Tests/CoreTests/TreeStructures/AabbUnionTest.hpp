@@ -0,0 +1,94 @@
+#ifndef RADIUM_AABB_UNION_TESTS_HPP_
+#define RADIUM_AABB_UNION_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/TreeStructures/AabbUnion.hpp>
+#include <Core/Mesh/MeshUtils.hpp>
+#include <Core/Mesh/MeshPrimitives.hpp>
+
+#include <random>
+
+namespace RaTests {
+
+class AabbUnionTests : public Test
+{
+    static bool isSame( const Ra::Core::Aabb& a, const Ra::Core::Aabb& b )
+    {
+        return a.isEmpty() ? b.isEmpty() : a.min() == b.min() && a.max() == b.max();
+    }
+
+    void checkUnion()
+    {
+        std::mt19937 generator( 5 );
+        std::uniform_real_distribution<Scalar> coordinate( -10.f, 10.f );
+        std::uniform_real_distribution<Scalar> extent( 0.f, 2.f );
+
+        Ra::Core::AabbUnion aabbUnion;
+        std::vector<Ra::Core::Aabb> boxes;
+        RA_UNIT_TEST( aabbUnion.getUnion().isEmpty(), "A union without boxes should be empty." );
+
+        bool same = true;
+        for ( uint step = 0; step < 2000; ++step )
+        {
+            // Sets, moves and clears random slots, the tree growing with the largest index.
+            const uint index = generator() % ( 4 + step / 4 );
+            Ra::Core::Aabb box;
+            if ( generator() % 4 != 0 )
+            {
+                const Ra::Core::Vector3 c( coordinate( generator ), coordinate( generator ), coordinate( generator ) );
+                const Ra::Core::Vector3 h( extent( generator ), extent( generator ), extent( generator ) );
+                box = Ra::Core::Aabb( c - h, c + h );
+            }
+            aabbUnion.setAabb( index, box );
+            if ( index >= boxes.size() )
+            {
+                boxes.resize( index + 1 );
+            }
+            boxes[index] = box;
+
+            if ( step % 7 == 0 )
+            {
+                Ra::Core::Aabb expected;
+                for ( const auto& b : boxes )
+                {
+                    expected.extend( b );
+                }
+                same = same && isSame( aabbUnion.getUnion(), expected );
+            }
+            same = same && isSame( aabbUnion.getAabb( index ), box ) && aabbUnion.getAabb( 1u << 20 ).isEmpty();
+        }
+        RA_UNIT_TEST( same, "The union should match the union of all the boxes." );
+
+        aabbUnion.clear();
+        RA_UNIT_TEST( aabbUnion.getUnion().isEmpty() && aabbUnion.getAabb( 1 ).isEmpty(),
+                      "A cleared union should be empty." );
+    }
+
+    void checkTransformedMesh()
+    {
+        const Ra::Core::TriangleMesh mesh = Ra::Core::MeshUtils::makeBox( Ra::Core::Vector3( 1.f, 2.f, 3.f ) );
+        Ra::Core::Transform transform( Ra::Core::AngleAxis( Scalar( 0.5 ), Ra::Core::Vector3( 1.f, 1.f, 0.f ).normalized() ) );
+        transform.translation() = Ra::Core::Vector3( 1.f, -2.f, 5.f );
+
+        Ra::Core::Aabb expected;
+        for ( const auto& p : mesh.m_vertices )
+        {
+            expected.extend( transform * p );
+        }
+        const Ra::Core::Aabb aabb = Ra::Core::MeshUtils::getAabb( mesh, transform );
+        RA_UNIT_TEST( aabb.min().isApprox( expected.min() ) && aabb.max().isApprox( expected.max() ),
+                      "The transformed mesh AABB should bound the transformed vertices." );
+    }
+
+public:
+    void run() override
+    {
+        checkUnion();
+        checkTransformedMesh();
+    }
+};
+
+RA_TEST_CLASS( AabbUnionTests );
+}
+
+#endif // RADIUM_AABB_UNION_TESTS_HPP_
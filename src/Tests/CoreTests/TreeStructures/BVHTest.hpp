@@ -0,0 +1,254 @@
+#ifndef RADIUM_BVH_TESTS_HPP_
+#define RADIUM_BVH_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/TreeStructures/BVH.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <algorithm>
+#include <memory>
+
+namespace RaTests {
+
+class BVHTests : public Test
+{
+    struct Box
+    {
+        Box( const Ra::Core::Aabb& aabb, uint id ) : m_aabb( aabb ), m_id( id ) {}
+        Ra::Core::Aabb getAabb() const { return m_aabb; }
+
+        Ra::Core::Aabb m_aabb;
+        uint m_id;
+    };
+
+    typedef Ra::Core::BVH<Box> BoxBVH;
+
+    // Fills the hierarchy with boxes of various sizes on a jittered grid, plus a few
+    // boxes sharing the same center.
+    void fill( BoxBVH& bvh, uint size )
+    {
+        uint id = 0;
+        for ( uint i = 0; i < size; ++i )
+        {
+            for ( uint j = 0; j < size; ++j )
+            {
+                for ( uint k = 0; k < size; ++k )
+                {
+                    const Ra::Core::Vector3 c( Scalar( i ) + Scalar( ( j * 7 + k ) % 5 ) * 0.1f,
+                                               Scalar( j ) * 1.5f, Scalar( k ) - Scalar( i % 3 ) * 0.2f );
+                    const Ra::Core::Vector3 h = Ra::Core::Vector3::Constant( 0.1f + Scalar( id % 4 ) * 0.3f );
+                    bvh.insertLeaf( std::make_shared<Box>( Ra::Core::Aabb( c - h, c + h ), id++ ) );
+                }
+            }
+        }
+        for ( uint i = 0; i < 16; ++i )
+        {
+            const Ra::Core::Vector3 h = Ra::Core::Vector3::Constant( 0.5f + Scalar( i ) );
+            bvh.insertLeaf( std::make_shared<Box>( Ra::Core::Aabb( -h, h ), id++ ) );
+        }
+    }
+
+    // Checks that each leaf is referenced once and that nodes bound their contents.
+    void checkStructure( const BoxBVH& bvh )
+    {
+        const auto& nodes = bvh.getNodes();
+        const auto& primitives = bvh.getPrimitives();
+        std::vector<uint> references( bvh.getLeafCount(), 0 );
+        bool bounded = true;
+        bool siblingsAligned = true;
+
+        std::vector<uint> toCheck( 1, 0 );
+        while ( !toCheck.empty() )
+        {
+            const BoxBVH::FlatNode& node = nodes[toCheck.back()];
+            toCheck.pop_back();
+            const Ra::Core::Aabb aabb = node.getAabb();
+            if ( node.isLeaf() )
+            {
+                for ( uint i = node.m_index; i < node.m_index + node.m_count; ++i )
+                {
+                    ++references[primitives[i]];
+                    bounded = bounded && aabb.contains( bvh.getLeafData( primitives[i] )->getAabb() );
+                }
+            }
+            else
+            {
+                siblingsAligned = siblingsAligned && ( node.m_index % 2 == 0 );
+                bounded = bounded && aabb.contains( nodes[node.m_index].getAabb() )
+                                  && aabb.contains( nodes[node.m_index + 1].getAabb() );
+                toCheck.push_back( node.m_index );
+                toCheck.push_back( node.m_index + 1 );
+            }
+        }
+
+        RA_UNIT_TEST( std::all_of( references.begin(), references.end(), []( uint r ) { return r == 1; } ),
+                      "Each leaf should be in exactly one node." );
+        RA_UNIT_TEST( bounded, "Node boxes should contain their contents." );
+        RA_UNIT_TEST( siblingsAligned, "Siblings should start at even indices." );
+    }
+
+    // Compares the frustum query with a test of every box.
+    void checkFrustum( BoxBVH& bvh )
+    {
+        const Ra::Core::Matrix4 proj = Ra::Core::MatrixUtils::perspective( 0.8f, 1.3f, 0.5f, 10.f );
+        Ra::Core::Matrix4 view = Ra::Core::Matrix4::Identity();
+        view.block<3, 1>( 0, 3 ) = Ra::Core::Vector3( -5.f, -5.f, -12.f );
+        const Ra::Core::Frustum frustum( proj * view );
+
+        std::vector<std::shared_ptr<Box>> visible;
+        bvh.getInFrustum( visible, frustum );
+
+        std::vector<uint> found;
+        for ( const auto& box : visible )
+        {
+            found.push_back( box->m_id );
+        }
+        std::sort( found.begin(), found.end() );
+
+        std::vector<uint> expected;
+        for ( uint i = 0; i < bvh.getLeafCount(); ++i )
+        {
+            const auto box = bvh.getLeafData( i );
+            const Ra::Core::Aabb aabb = box->getAabb();
+            if ( !Ra::Core::BVHInternal::isOutside( aabb.min().data(), aabb.max().data(), frustum ) )
+            {
+                expected.push_back( box->m_id );
+            }
+        }
+        std::sort( expected.begin(), expected.end() );
+
+        RA_UNIT_TEST( !expected.empty() && expected.size() < bvh.getLeafCount(), "Frustum should cut the scene." );
+        RA_UNIT_TEST( found == expected, "Frustum query should match the brute force test." );
+
+        // The slow query tests every box when the leaves changed since buildBottomUpSlow().
+        std::vector<std::shared_ptr<Box>> slow;
+        bvh.getInFrustumSlow( slow, frustum );
+        std::vector<uint> slowIds;
+        for ( const auto& box : slow )
+        {
+            slowIds.push_back( box->m_id );
+        }
+        std::sort( slowIds.begin(), slowIds.end() );
+        RA_UNIT_TEST( slowIds == expected, "Slow frustum query should match the brute force test." );
+
+        // Culling twice uses the planes cached by the first query.
+        for ( uint pass = 0; pass < 2; ++pass )
+        {
+            std::vector<std::shared_ptr<Box>> culled;
+            Ra::Core::CullingStats stats;
+            bvh.cull( frustum, culled, &stats );
+
+            std::vector<uint> culledIds;
+            for ( const auto& box : culled )
+            {
+                culledIds.push_back( box->m_id );
+            }
+            std::sort( culledIds.begin(), culledIds.end() );
+
+            RA_UNIT_TEST( culledIds == expected, "Culling should match the brute force test." );
+            RA_UNIT_TEST( stats.m_visible == expected.size() && stats.m_visible + stats.m_culled == bvh.getLeafCount(),
+                          "Wrong culling counts." );
+            RA_UNIT_TEST( stats.m_planeTests < 6 * stats.m_nodeTests, "Plane masks should skip tests." );
+        }
+    }
+
+    // Moves, removes and inserts boxes in a built hierarchy.
+    void checkDynamic( BoxBVH& bvh )
+    {
+        const uint count = bvh.getLeafCount();
+        std::vector<std::shared_ptr<Box>> boxes;
+        for ( uint i = 0; i < count; ++i )
+        {
+            boxes.push_back( bvh.getLeafData( i ) );
+        }
+
+        for ( uint i = 0; i < count; i += 3 )
+        {
+            boxes[i]->m_aabb.translate( Ra::Core::Vector3( Scalar( i % 7 ) - 3.f, 2.f, -Scalar( i % 5 ) ) );
+            bvh.updateLeaf( boxes[i] );
+        }
+        for ( uint i = 1; i < count; i += 4 )
+        {
+            bvh.removeLeaf( boxes[i] );
+        }
+        for ( uint i = 0; i < 100; ++i )
+        {
+            const Ra::Core::Vector3 c( Scalar( i % 10 ), Scalar( i / 10 ), Scalar( i % 3 ) );
+            bvh.insertLeaf( std::make_shared<Box>( Ra::Core::Aabb( c, c + Ra::Core::Vector3::Ones() ), count + i ) );
+        }
+
+        RA_UNIT_TEST( bvh.getLeafCount() == count - ( count + 2 ) / 4 + 100, "Wrong number of leaves." );
+        RA_UNIT_TEST( !bvh.getNodes().empty(), "Hierarchy should be updated in place." );
+        checkStructure( bvh );
+        checkFrustum( bvh );
+
+        // Removing everything empties the hierarchy.
+        for ( uint i = bvh.getLeafCount(); i > 0; --i )
+        {
+            bvh.removeLeaf( bvh.getLeafData( i - 1 ) );
+        }
+        RA_UNIT_TEST( bvh.getLeafCount() == 0 && bvh.getNodes().empty(), "Hierarchy should be empty." );
+    }
+
+    // Removes and inserts the same boxes many times.
+    void checkChurn()
+    {
+        BoxBVH bvh;
+        fill( bvh, 6 );
+        bvh.buildBottomUpSlow();
+        bvh.update();
+
+        const uint count = bvh.getLeafCount();
+        for ( uint i = 0; i < 10 * count; ++i )
+        {
+            const auto box = bvh.getLeafData( ( i * 7 ) % count );
+            bvh.removeLeaf( box );
+            bvh.insertLeaf( box );
+            bvh.update();
+        }
+
+        RA_UNIT_TEST( bvh.getLeafCount() == count, "Wrong number of leaves." );
+        RA_UNIT_TEST( bvh.getPrimitives().size() <= 2 * count, "Slots of removed leaves should be reclaimed." );
+        checkStructure( bvh );
+        checkFrustum( bvh );
+    }
+
+public:
+    void run() override
+    {
+        BoxBVH empty;
+        empty.buildTopDown();
+        RA_UNIT_TEST( empty.getNodes().empty(), "Empty hierarchy should have no node." );
+
+        BoxBVH single;
+        single.insertLeaf( std::make_shared<Box>( Ra::Core::Aabb( Ra::Core::Vector3::Zero(), Ra::Core::Vector3::Ones() ), 0 ) );
+        single.update();
+        RA_UNIT_TEST( single.getNodes().size() >= 1 && single.getNodes()[0].m_count == 1, "Single leaf should be the root." );
+
+        // Sequential build.
+        BoxBVH bvh;
+        fill( bvh, 12 );
+        bvh.update();
+        checkStructure( bvh );
+        checkFrustum( bvh );
+
+        // Parallel build of the subtrees.
+        Ra::Core::TaskQueue queue( 4 );
+        Ra::Core::setParallelTaskQueue( &queue );
+        BoxBVH parallel;
+        fill( parallel, 16 );
+        parallel.buildTopDown();
+        Ra::Core::setParallelTaskQueue( nullptr );
+        checkStructure( parallel );
+        checkFrustum( parallel );
+
+        checkDynamic( bvh );
+        checkChurn();
+    }
+};
+
+RA_TEST_CLASS( BVHTests );
+}
+
+#endif // RADIUM_BVH_TESTS_HPP_
@@ -0,0 +1,190 @@
+#ifndef RADIUM_TRIANGLE_KDTREE_TESTS_HPP_
+#define RADIUM_TRIANGLE_KDTREE_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/TreeStructures/TriangleKdTree.hpp>
+#include <Core/Geometry/Distance/DistanceQueries.hpp>
+#include <Core/Mesh/MeshPrimitives.hpp>
+#include <Core/Mesh/MeshUtils.hpp>
+#include <Core/Tasks/TaskQueue.hpp>
+#include <Core/Tasks/ParallelFor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+namespace RaTests {
+
+class TriangleKdTreeTests : public Test
+{
+    typedef Ra::Core::TriangleKdTree::Neighbour Neighbour;
+
+    // Squared distances from q to all the triangles, as a linear scan computes them.
+    std::vector<Neighbour> scan( const Ra::Core::TriangleMesh& mesh, const Ra::Core::Vector3& q )
+    {
+        std::vector<Neighbour> all;
+        std::array<Ra::Core::Vector3, 3> v;
+        for ( uint i = 0; i < mesh.m_triangles.size(); ++i )
+        {
+            Ra::Core::MeshUtils::getTriangleVertices( mesh, i, v );
+            all.emplace_back( int( i ), Ra::Core::DistanceQueries::pointToTriSq( q, v[0], v[1], v[2] ).distanceSquared );
+        }
+        std::sort( all.begin(), all.end(), []( const Neighbour& a, const Neighbour& b )
+        {
+            return a.m_squaredDistance < b.m_squaredDistance
+                   || ( a.m_squaredDistance == b.m_squaredDistance && a.m_triangle < b.m_triangle );
+        } );
+        return all;
+    }
+
+    void checkStructure( const Ra::Core::TriangleKdTree& tree, uint numTriangles )
+    {
+        const auto& nodes = tree.getNodes();
+        std::vector<uint> seen( numTriangles, 0 );
+        bool valid = !nodes.empty();
+        for ( const auto& node : nodes )
+        {
+            if ( node.isLeaf() )
+            {
+                valid = valid && node.m_count <= Ra::Core::TriangleKdTree::MaxLeafSize;
+                for ( uint i = node.m_index; i < node.m_index + node.m_count; ++i )
+                {
+                    ++seen[tree.getTriangles()[i]];
+                }
+                continue;
+            }
+            for ( uint c = node.m_index; c < node.m_index + 2; ++c )
+            {
+                for ( uint k = 0; k < 3; ++k )
+                {
+                    valid = valid && nodes[c].m_min[k] >= node.m_min[k] && nodes[c].m_max[k] <= node.m_max[k];
+                }
+            }
+        }
+        RA_UNIT_TEST( valid, "Leaves should be small and children inside their parent." );
+        RA_UNIT_TEST( std::all_of( seen.begin(), seen.end(), []( uint n ) { return n == 1; } ),
+                      "Each triangle should be in exactly one leaf." );
+    }
+
+    void checkQueries( const Ra::Core::TriangleKdTree& tree, const Ra::Core::TriangleMesh& mesh,
+                       const Ra::Core::VectorArray<Ra::Core::Vector3>& queries )
+    {
+        constexpr uint k = 5;
+        constexpr Scalar radius = 0.3f;
+
+        bool closestOk = true;
+        bool nearestOk = true;
+        bool radiusOk = true;
+        bool limitOk = true;
+        std::vector<Neighbour> nearest;
+        std::vector<uint> inRadius;
+        for ( const auto& q : queries )
+        {
+            const std::vector<Neighbour> all = scan( mesh, q );
+
+            const auto closest = tree.getClosestPoint( mesh, q );
+            closestOk = closestOk && closest.m_triangle == all[0].m_triangle
+                        && closest.m_squaredDistance == all[0].m_squaredDistance
+                        && std::abs( ( closest.m_point - q ).squaredNorm() - closest.m_squaredDistance ) < 1e-4f;
+
+            // Triangles beyond the maximum distance are ignored.
+            const Scalar limit = std::sqrt( all[0].m_squaredDistance ) * 0.99f;
+            limitOk = limitOk && ( limit == 0 || tree.getClosestPoint( mesh, q, limit ).m_triangle < 0 );
+
+            // A small maximum distance, below the tolerance, still finds a close enough triangle.
+            const Scalar small = std::sqrt( all[0].m_squaredDistance ) * 1.01f + 1e-4f;
+            const auto close = tree.getClosestPoint( mesh, q, small, 2 * small );
+            limitOk = limitOk && close.m_triangle >= 0 && close.m_squaredDistance <= small * small;
+
+            tree.getNearestTriangles( mesh, q, k, nearest );
+            nearestOk = nearestOk && nearest.size() == k;
+            for ( uint j = 0; j < k && nearestOk; ++j )
+            {
+                nearestOk = nearest[j].m_triangle == all[j].m_triangle
+                            && nearest[j].m_squaredDistance == all[j].m_squaredDistance;
+            }
+
+            std::vector<uint> expected;
+            for ( const auto& n : all )
+            {
+                if ( n.m_squaredDistance <= radius * radius )
+                {
+                    expected.push_back( uint( n.m_triangle ) );
+                }
+            }
+            std::sort( expected.begin(), expected.end() );
+            tree.getTrianglesInRadius( mesh, q, radius, inRadius );
+            radiusOk = radiusOk && inRadius == expected;
+        }
+        RA_UNIT_TEST( closestOk, "Closest points should match a linear scan." );
+        RA_UNIT_TEST( limitOk, "Closest point queries should respect the maximum distance." );
+        RA_UNIT_TEST( nearestOk, "Nearest triangles should match a linear scan." );
+        RA_UNIT_TEST( radiusOk, "Triangles in radius should match a linear scan." );
+
+        // Batch queries give the results of single queries.
+        std::vector<Ra::Core::TriangleKdTree::ClosestPoint> closestBatch;
+        std::vector<Neighbour> nearestBatch;
+        std::vector<std::vector<uint>> radiusBatch;
+        tree.getClosestPoints( mesh, queries, closestBatch );
+        tree.getNearestTriangles( mesh, queries, k, nearestBatch );
+        tree.getTrianglesInRadius( mesh, queries, radius, radiusBatch );
+        bool batchOk = closestBatch.size() == queries.size() && nearestBatch.size() == queries.size() * k
+                       && radiusBatch.size() == queries.size();
+        for ( uint i = 0; i < queries.size() && batchOk; ++i )
+        {
+            tree.getNearestTriangles( mesh, queries[i], k, nearest );
+            tree.getTrianglesInRadius( mesh, queries[i], radius, inRadius );
+            batchOk = closestBatch[i].m_triangle == tree.getClosestPoint( mesh, queries[i] ).m_triangle
+                      && radiusBatch[i] == inRadius;
+            for ( uint j = 0; j < k && batchOk; ++j )
+            {
+                batchOk = nearestBatch[i * k + j].m_triangle == nearest[j].m_triangle;
+            }
+        }
+        RA_UNIT_TEST( batchOk, "Batch queries should match single queries." );
+    }
+
+public:
+    void run() override
+    {
+        Ra::Core::TriangleMesh mesh = Ra::Core::MeshUtils::makeGeodesicSphere( 1.f, 4 );
+        mesh.append( Ra::Core::MeshUtils::makeBox( Ra::Core::Aabb( Ra::Core::Vector3( 0.5f, -0.2f, -0.2f ),
+                                                                        Ra::Core::Vector3( 1.5f, 0.2f, 0.2f ) ) ) );
+
+        // Points around the mesh, and points on its vertices.
+        std::mt19937 generator( 3 );
+        std::uniform_real_distribution<Scalar> uniform( -2.f, 2.f );
+        Ra::Core::VectorArray<Ra::Core::Vector3> queries;
+        for ( uint i = 0; i < 100; ++i )
+        {
+            queries.push_back( Ra::Core::Vector3( uniform( generator ), uniform( generator ), uniform( generator ) ) );
+        }
+        for ( uint i = 0; i < mesh.m_vertices.size(); i += 97 )
+        {
+            queries.push_back( mesh.m_vertices[i] );
+        }
+
+        Ra::Core::TriangleKdTree tree;
+        RA_UNIT_TEST( tree.getClosestPoint( mesh, queries[0] ).m_triangle < 0, "Empty tree should have no closest point." );
+        std::vector<Neighbour> nearest( 2 );
+        tree.getNearestTriangles( mesh, queries[0], 3, nearest );
+        RA_UNIT_TEST( nearest.empty(), "Empty tree should have no nearest triangle." );
+
+        tree.build( mesh, Ra::Core::TriangleKdTree::MEDIAN );
+        checkStructure( tree, mesh.m_triangles.size() );
+        checkQueries( tree, mesh, queries );
+
+        // Parallel build of the subtrees and parallel batch queries.
+        Ra::Core::TaskQueue queue( 4 );
+        Ra::Core::setParallelTaskQueue( &queue );
+        tree.build( mesh, Ra::Core::TriangleKdTree::SAH );
+        checkStructure( tree, mesh.m_triangles.size() );
+        checkQueries( tree, mesh, queries );
+        Ra::Core::setParallelTaskQueue( nullptr );
+    }
+};
+
+RA_TEST_CLASS( TriangleKdTreeTests );
+}
+
+#endif // RADIUM_TRIANGLE_KDTREE_TESTS_HPP_
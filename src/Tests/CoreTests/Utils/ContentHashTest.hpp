@@ -0,0 +1,65 @@
+#ifndef RADIUM_CONTENT_HASH_TESTS_HPP_
+#define RADIUM_CONTENT_HASH_TESTS_HPP_
+
+#include <Tests/CoreTests/Tests.hpp>
+#include <Core/Utils/ContentHash.hpp>
+#include <Core/Containers/VectorArray.hpp>
+
+#include <random>
+#include <set>
+
+namespace RaTests {
+
+class ContentHashTests : public Test
+{
+    std::uint64_t hash( const Ra::Core::Vector3Array& vertices, const std::vector<int>& indices )
+    {
+        Ra::Core::ContentHash h;
+        h.add( vertices );
+        h.add( indices );
+        return h.get();
+    }
+
+public:
+    void run() override
+    {
+        std::mt19937 generator( 29 );
+        std::uniform_real_distribution<Scalar> coordinate( -1.f, 1.f );
+        Ra::Core::Vector3Array vertices;
+        std::vector<int> indices;
+        for ( uint i = 0; i < 101; ++i )
+        {
+            vertices.emplace_back( coordinate( generator ), coordinate( generator ), coordinate( generator ) );
+            indices.push_back( int( generator() % 101 ) );
+        }
+
+        const Ra::Core::Vector3Array copy = vertices;
+        const std::uint64_t h = hash( vertices, indices );
+        RA_UNIT_TEST( hash( copy, indices ) == h, "Equal contents should have equal hashes." );
+
+        // Changing a single bit, or moving data from an array to the next, changes the hash.
+        std::set<std::uint64_t> hashes{ h };
+        for ( uint i = 0; i < indices.size(); ++i )
+        {
+            indices[i] ^= 1 << ( i % 31 );
+            hashes.insert( hash( vertices, indices ) );
+            indices[i] ^= 1 << ( i % 31 );
+        }
+        indices.push_back( 0 );
+        hashes.insert( hash( vertices, indices ) );
+        indices.insert( indices.begin(), 0 );
+        hashes.insert( hash( vertices, indices ) );
+        vertices.push_back( Ra::Core::Vector3::Zero() );
+        hashes.insert( hash( vertices, indices ) );
+        std::vector<int> empty;
+        hashes.insert( hash( vertices, empty ) );
+        vertices.clear();
+        hashes.insert( hash( vertices, empty ) );
+        RA_UNIT_TEST( hashes.size() == 101 + 5 + 1, "Different contents should have different hashes." );
+    }
+};
+
+RA_TEST_CLASS( ContentHashTests );
+}
+
+#endif // RADIUM_CONTENT_HASH_TESTS_HPP_
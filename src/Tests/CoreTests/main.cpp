@@ -3,12 +3,25 @@
 #include <Tests/CoreTests/Containers/ContainersTest.hpp>
 #include <Tests/CoreTests/Animation/AnimationTest.hpp>
 #include <Tests/CoreTests/Algebra/AlgebraTests.hpp>
+#include <Tests/CoreTests/Algebra/PackingTest.hpp>
 #include <Tests/CoreTests/Geometry/GeometryTests.hpp>
+#include <Tests/CoreTests/Geometry/MappingTest.hpp>
+#include <Tests/CoreTests/Geometry/PointHashGridTest.hpp>
+#include <Tests/CoreTests/Geometry/VertexWelderTest.hpp>
 #include <Tests/CoreTests/RayCasts/RayCastTest.hpp>
+#include <Tests/CoreTests/RayCasts/RayBatchTest.hpp>
 #include <Tests/CoreTests/String/StringTest.hpp>
+#include <Tests/CoreTests/Utils/ContentHashTest.hpp>
 #include <Tests/CoreTests/Distance/DistanceTests.hpp>
 #include <Tests/CoreTests/Containers/IndexMapTest.hpp>
+#include <Tests/CoreTests/Containers/DrawQueueTest.hpp>
+#include <Tests/CoreTests/Containers/DirtyRangesTest.hpp>
 #include <Tests/CoreTests/TopologicalMesh/ConvertTest.hpp>
+#include <Tests/CoreTests/Tasks/TaskQueueTest.hpp>
+#include <Tests/CoreTests/TreeStructures/BVHTest.hpp>
+#include <Tests/CoreTests/TreeStructures/TriangleKdTreeTest.hpp>
+#include <Tests/CoreTests/TreeStructures/AabbUnionTest.hpp>
+#include <Tests/CoreTests/Geometry/FrustumCullingTest.hpp>
 
 int main()
 {